@@ -48,7 +48,8 @@ DEFINE_int32(lookup_percent, 50,
 DEFINE_int32(erase_percent, 10,
              "Ratio of erase to total workload (expressed as a percentage)");
 
-DEFINE_bool(use_clock_cache, false, "");
+DEFINE_bool(use_clock_cache, false,
+            "Use ClockCache, whose lookups take no lock, instead of LRUCache");
 
 namespace rocksdb {
 
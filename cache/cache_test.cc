@@ -274,6 +274,39 @@ TEST_P(CacheTest, Erase) {
   ASSERT_EQ(1U, deleted_keys_.size());
 }
 
+TEST_P(CacheTest, Contains) {
+  ASSERT_FALSE(cache_->Contains(EncodeKey(100)));
+  Insert(100, 101);
+  ASSERT_TRUE(cache_->Contains(EncodeKey(100)));
+  ASSERT_FALSE(cache_->Contains(EncodeKey(200)));
+  ASSERT_EQ(0U, cache_->GetPinnedUsage());
+  Erase(100);
+  ASSERT_FALSE(cache_->Contains(EncodeKey(100)));
+  ASSERT_EQ(1U, deleted_keys_.size());
+}
+
+TEST_P(CacheTest, EraseManyKeys) {
+  // Enough keys in one shard for its hash table to grow and to collide
+  const int kNumKeys = 2000;
+  std::shared_ptr<Cache> cache = NewCache(kNumKeys, 0, false);
+  for (int i = 0; i < kNumKeys; i++) {
+    Insert(cache, i, i + 1);
+  }
+  for (int i = 0; i < kNumKeys; i += 2) {
+    Erase(cache, i);
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(i % 2 == 0 ? -1 : i + 1, Lookup(cache, i));
+  }
+  for (int i = 0; i < kNumKeys; i += 2) {
+    Insert(cache, i, i + 2);
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(i % 2 == 0 ? i + 2 : i + 1, Lookup(cache, i));
+  }
+  ASSERT_EQ(static_cast<size_t>(kNumKeys), cache->GetUsage());
+}
+
 TEST_P(CacheTest, EntriesArePinned) {
   Insert(100, 101);
   Cache::Handle* h1 = cache_->Lookup(EncodeKey(100));
@@ -689,13 +722,13 @@ TEST_P(CacheTest, DefaultShardBits) {
   ASSERT_EQ(6, sc->GetNumShardBits());
 }
 
-#ifdef SUPPORT_CLOCK_CACHE
+#ifndef ROCKSDB_LITE
 shared_ptr<Cache> (*new_clock_cache_func)(size_t, int, bool) = NewClockCache;
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
                         testing::Values(kLRU, kClock));
 #else
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest, testing::Values(kLRU));
-#endif  // SUPPORT_CLOCK_CACHE
+#endif  // ROCKSDB_LITE
 
 }  // namespace rocksdb
 
@@ -29,7 +29,8 @@ std::shared_ptr<Cache> NewClockCache(size_t capacity, int num_shard_bits,
 #include <atomic>
 #include <deque>
 
-#include "tbb/concurrent_hash_map.h"
+#include <memory>
+#include <vector>
 
 #include "cache/sharded_cache.h"
 #include "port/port.h"
@@ -56,9 +57,9 @@ namespace {
 // to be re-use. This is to avoid memory dealocation, which is hard to deal
 // with in concurrent environment.
 //
-// The cache also maintains a concurrent hash map for lookup. Any concurrent
-// hash map implementation should do the work. We currently use
-// tbb::concurrent_hash_map because it supports concurrent erase.
+// The cache also maintains a hash table for lookup. It is an open addressing
+// table with linear probing (HandleTable below) that readers probe without
+// taking any lock, while writers update it under the shard mutex.
 //
 // Each cache handle has the following flags and counters, which are squeeze
 // in an atomic interger, to make sure the handle always be in a consistent
@@ -139,6 +140,11 @@ namespace {
 // the entry has been erased from cache explicitly. A future improvement could
 // be to remove the mutex completely.
 //
+// The hash table is safe to probe without the mutex because handles are never
+// freed before the cache is: a reader may find a stale handle, but it only
+// uses the handle once Ref() has succeeded and the key has been re-checked,
+// exactly as if the entry had been replaced right after the lookup.
+//
 // Benchmark:
 // We run readrandom db_bench on a test DB of size 13GB, with size of each
 // level:
@@ -201,25 +207,194 @@ struct CacheHandle {
   }
 };
 
-// Key of hash map. We store hash value with the key for convenience.
-struct CacheKey {
-  Slice key;
-  uint32_t hash_value;
+// Hash table from keys to cache handles. Slots hold the hash value next to the
+// handle so probing rarely has to touch other handles. Erase shifts the
+// following entries of the probe sequence back instead of leaving tombstones,
+// and the slot array only grows, by doubling. Arrays replaced by a larger one
+// are kept until the table is destroyed, since readers may still be probing
+// them; together they take less memory than the current array.
+//
+// Find() may run concurrently with the writers, which have to be serialized by
+// the caller. Find() may then miss an entry that is being moved, or return a
+// handle that has just been erased or reused for another key, so callers have
+// to verify what it returns.
+class HandleTable {
+ public:
+  HandleTable() : count_(0) {
+    arrays_.emplace_back(new SlotArray(kInitialSize));
+    array_.store(arrays_.back().get(), std::memory_order_relaxed);
+  }
+
+  // Calls match on the handles stored with the hash value, in probe order,
+  // and returns the first one it accepts, or nullptr.
+  template <typename Match>
+  CacheHandle* Find(uint32_t hash, const Match& match) const {
+    const SlotArray* array = array_.load(std::memory_order_acquire);
+    size_t pos = hash & array->mask;
+    for (size_t i = 0; i <= array->mask; i++) {
+      const Slot& slot = array->slots[pos];
+      CacheHandle* handle = slot.handle.load(std::memory_order_acquire);
+      if (handle == nullptr) {
+        break;
+      }
+      if (slot.hash.load(std::memory_order_relaxed) == hash && match(handle)) {
+        return handle;
+      }
+      pos = (pos + 1) & array->mask;
+    }
+    return nullptr;
+  }
+
+  // Adds the handle, and returns the handle it replaces with the same key,
+  // if any.
+  CacheHandle* Insert(CacheHandle* handle) {
+    SlotArray* array = array_.load(std::memory_order_relaxed);
+    size_t pos = FindSlot(array, handle->key, handle->hash);
+    CacheHandle* existing =
+        array->slots[pos].handle.load(std::memory_order_relaxed);
+    if (existing == nullptr) {
+      // Keep the load factor at or below 3/4, which also keeps a free slot
+      // to end every probe.
+      if ((count_ + 1) * 4 > (array->mask + 1) * 3) {
+        array = Grow();
+        pos = FindSlot(array, handle->key, handle->hash);
+      }
+      count_++;
+    }
+    array->slots[pos].hash.store(handle->hash, std::memory_order_relaxed);
+    array->slots[pos].handle.store(handle, std::memory_order_release);
+    return existing;
+  }
+
+  // Removes and returns the handle of the key, if any.
+  CacheHandle* Remove(const Slice& key, uint32_t hash) {
+    SlotArray* array = array_.load(std::memory_order_relaxed);
+    size_t pos = FindSlot(array, key, hash);
+    CacheHandle* handle =
+        array->slots[pos].handle.load(std::memory_order_relaxed);
+    if (handle != nullptr) {
+      RemoveAt(array, pos);
+    }
+    return handle;
+  }
 
-  CacheKey() = default;
+  // Removes the handle. Returns false if it is not in the table.
+  bool Remove(CacheHandle* handle) {
+    SlotArray* array = array_.load(std::memory_order_relaxed);
+    size_t pos = handle->hash & array->mask;
+    while (true) {
+      CacheHandle* h = array->slots[pos].handle.load(std::memory_order_relaxed);
+      if (h == nullptr) {
+        return false;
+      }
+      if (h == handle) {
+        RemoveAt(array, pos);
+        return true;
+      }
+      pos = (pos + 1) & array->mask;
+    }
+  }
 
-  CacheKey(const Slice& k, uint32_t h) {
-    key = k;
-    hash_value = h;
+  void Clear() {
+    SlotArray* array = array_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i <= array->mask; i++) {
+      array->slots[i].handle.store(nullptr, std::memory_order_release);
+    }
+    count_ = 0;
   }
 
-  static bool equal(const CacheKey& a, const CacheKey& b) {
-    return a.hash_value == b.hash_value && a.key == b.key;
+ private:
+  static const size_t kInitialSize = 16;
+
+  struct Slot {
+    std::atomic<uint32_t> hash;
+    std::atomic<CacheHandle*> handle;
+
+    Slot() : hash(0), handle(nullptr) {}
+  };
+
+  struct SlotArray {
+    // size has to be a power of 2
+    explicit SlotArray(size_t size) : mask(size - 1), slots(new Slot[size]) {}
+
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+  };
+
+  // Returns the slot holding the key, or the free slot that ends its probe
+  // sequence.
+  static size_t FindSlot(const SlotArray* array, const Slice& key,
+                         uint32_t hash) {
+    size_t pos = hash & array->mask;
+    while (true) {
+      const Slot& slot = array->slots[pos];
+      CacheHandle* handle = slot.handle.load(std::memory_order_relaxed);
+      if (handle == nullptr ||
+          (slot.hash.load(std::memory_order_relaxed) == hash &&
+           handle->key == key)) {
+        return pos;
+      }
+      pos = (pos + 1) & array->mask;
+    }
   }
 
-  static size_t hash(const CacheKey& a) {
-    return static_cast<size_t>(a.hash_value);
+  // Empties the slot, moving back the entries that follow it in the same
+  // probe sequence. Entries are copied before their old slot is reused, so
+  // concurrent readers may see one twice but never see a partial entry.
+  static void RemoveAt(SlotArray* array, size_t hole) {
+    size_t pos = hole;
+    while (true) {
+      pos = (pos + 1) & array->mask;
+      Slot& slot = array->slots[pos];
+      CacheHandle* handle = slot.handle.load(std::memory_order_relaxed);
+      if (handle == nullptr) {
+        break;
+      }
+      uint32_t hash = slot.hash.load(std::memory_order_relaxed);
+      size_t home = hash & array->mask;
+      // The entry can move to the hole unless its home slot lies cyclically
+      // in (hole, pos].
+      bool stays = hole <= pos ? (hole < home && home <= pos)
+                               : (hole < home || home <= pos);
+      if (!stays) {
+        array->slots[hole].hash.store(hash, std::memory_order_relaxed);
+        array->slots[hole].handle.store(handle, std::memory_order_release);
+        hole = pos;
+      }
+    }
+    array->slots[hole].handle.store(nullptr, std::memory_order_release);
+  }
+
+  SlotArray* Grow() {
+    const SlotArray* old_array = array_.load(std::memory_order_relaxed);
+    SlotArray* array = new SlotArray((old_array->mask + 1) * 2);
+    arrays_.emplace_back(array);
+    for (size_t i = 0; i <= old_array->mask; i++) {
+      const Slot& slot = old_array->slots[i];
+      CacheHandle* handle = slot.handle.load(std::memory_order_relaxed);
+      if (handle == nullptr) {
+        continue;
+      }
+      uint32_t hash = slot.hash.load(std::memory_order_relaxed);
+      size_t pos = hash & array->mask;
+      while (array->slots[pos].handle.load(std::memory_order_relaxed) !=
+             nullptr) {
+        pos = (pos + 1) & array->mask;
+      }
+      array->slots[pos].hash.store(hash, std::memory_order_relaxed);
+      array->slots[pos].handle.store(handle, std::memory_order_relaxed);
+    }
+    // Publish the filled array
+    array_.store(array, std::memory_order_release);
+    return array;
   }
+
+  // The array readers probe
+  std::atomic<SlotArray*> array_;
+  // The current array and the ones it replaced
+  std::vector<std::unique_ptr<SlotArray>> arrays_;
+  // Number of entries in the current array
+  size_t count_;
 };
 
 struct CleanupContext {
@@ -233,9 +408,6 @@ struct CleanupContext {
 // A cache shard which maintains its own CLOCK cache.
 class ClockCacheShard : public CacheShard {
  public:
-  // Hash map type.
-  typedef tbb::concurrent_hash_map<CacheKey, CacheHandle*, CacheKey> HashTable;
-
   ClockCacheShard();
   ~ClockCacheShard();
 
@@ -353,8 +525,8 @@ class ClockCacheShard : public CacheShard {
   // Whether allow insert into cache if cache is full.
   std::atomic<bool> strict_capacity_limit_;
 
-  // Hash table (tbb::concurrent_hash_map) for lookup.
-  HashTable table_;
+  // Hash table for lookup.
+  HandleTable table_;
 };
 
 ClockCacheShard::ClockCacheShard()
@@ -445,6 +617,9 @@ bool ClockCacheShard::Unref(CacheHandle* handle, bool set_usage,
   if (set_usage) {
     handle->flags.fetch_or(kUsageBit, std::memory_order_relaxed);
   }
+  // Read the charge while still holding the reference. Once it is dropped,
+  // the handle may be evicted and reused by another thread.
+  size_t charge = handle->charge;
   // Use acquire-release semantics as previous operations on the cache entry
   // has to be order before reference count is decreased, and potential cleanup
   // of the entry has to be order after.
@@ -452,7 +627,7 @@ bool ClockCacheShard::Unref(CacheHandle* handle, bool set_usage,
   assert(CountRefs(flags) > 0);
   if (CountRefs(flags) == 1) {
     // this is the last reference.
-    pinned_usage_.fetch_sub(handle->charge, std::memory_order_relaxed);
+    pinned_usage_.fetch_sub(charge, std::memory_order_relaxed);
     // Cleanup if it is the last reference.
     if (!InCache(flags)) {
       MutexLock l(&mutex_);
@@ -482,8 +657,7 @@ bool ClockCacheShard::TryEvict(CacheHandle* handle, CleanupContext* context) {
   uint32_t flags = kInCacheBit;
   if (handle->flags.compare_exchange_strong(flags, 0, std::memory_order_acquire,
                                             std::memory_order_relaxed)) {
-    bool erased __attribute__((__unused__)) =
-        table_.erase(CacheKey(handle->key, handle->hash));
+    bool erased __attribute__((__unused__)) = table_.Remove(handle);
     assert(erased);
     RecycleHandle(handle, context);
     return true;
@@ -564,14 +738,13 @@ CacheHandle* ClockCacheShard::Insert(
   handle->charge = charge;
   handle->deleter = deleter;
   uint32_t flags = hold_reference ? kInCacheBit + kOneRef : kInCacheBit;
-  handle->flags.store(flags, std::memory_order_relaxed);
-  HashTable::accessor accessor;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* existing_handle = accessor->second;
-    table_.erase(accessor);
+  // Use release semantics so that lock-free readers, which can only use the
+  // handle after seeing the in-cache bit, see the new key and value.
+  handle->flags.store(flags, std::memory_order_release);
+  CacheHandle* existing_handle = table_.Insert(handle);
+  if (existing_handle != nullptr) {
     UnsetInCache(existing_handle, context);
   }
-  table_.insert(HashTable::value_type(CacheKey(key, hash), handle));
   if (hold_reference) {
     pinned_usage_.fetch_add(charge, std::memory_order_relaxed);
   }
@@ -585,7 +758,6 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                                Cache::Handle** out_handle,
                                Cache::Priority priority) {
   CleanupContext context;
-  HashTable::accessor accessor;
   char* key_data = new char[key.size()];
   memcpy(key_data, key.data(), key.size());
   Slice key_copy(key_data, key.size());
@@ -604,27 +776,24 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
 }
 
 Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  HashTable::const_accessor accessor;
-  if (!table_.find(accessor, CacheKey(key, hash))) {
-    return nullptr;
-  }
-  CacheHandle* handle = accessor->second;
-  accessor.release();
-  // Ref() could fail if another thread sneak in and evict/erase the cache
-  // entry before we are able to hold reference.
-  if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
-    return nullptr;
-  }
-  // Double check the key since the handle may now representing another key
-  // if other threads sneak in, evict/erase the entry and re-used the handle
-  // for another cache entry.
-  if (hash != handle->hash || key != handle->key) {
-    CleanupContext context;
-    Unref(handle, false, &context);
-    // It is possible Unref() delete the entry, so we need to cleanup.
-    Cleanup(context);
-    return nullptr;
-  }
+  CacheHandle* handle = table_.Find(hash, [&](CacheHandle* candidate) {
+    // Ref() could fail if another thread sneak in and evict/erase the cache
+    // entry before we are able to hold reference.
+    if (!Ref(reinterpret_cast<Cache::Handle*>(candidate))) {
+      return false;
+    }
+    // Double check the key since the handle may now representing another key
+    // if other threads sneak in, evict/erase the entry and re-used the handle
+    // for another cache entry.
+    if (hash != candidate->hash || key != candidate->key) {
+      CleanupContext context;
+      Unref(candidate, false, &context);
+      // It is possible Unref() delete the entry, so we need to cleanup.
+      Cleanup(context);
+      return false;
+    }
+    return true;
+  });
   return reinterpret_cast<Cache::Handle*>(handle);
 }
 
@@ -648,11 +817,9 @@ void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
 bool ClockCacheShard::EraseAndConfirm(const Slice& key, uint32_t hash,
                                       CleanupContext* context) {
   MutexLock l(&mutex_);
-  HashTable::accessor accessor;
   bool erased = false;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* handle = accessor->second;
-    table_.erase(accessor);
+  CacheHandle* handle = table_.Remove(key, hash);
+  if (handle != nullptr) {
     erased = UnsetInCache(handle, context);
   }
   return erased;
@@ -662,7 +829,7 @@ void ClockCacheShard::EraseUnRefEntries() {
   CleanupContext context;
   {
     MutexLock l(&mutex_);
-    table_.clear();
+    table_.Clear();
     for (auto& handle : list_) {
       UnsetInCache(&handle, &context);
     }
@@ -18,37 +18,71 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <new>
 #include <string>
+#ifdef NUMA
+#include <numa.h>
+#endif
 
+#include "util/compression.h"
 #include "util/mutexlock.h"
 
 namespace rocksdb {
 
-LRUHandleTable::LRUHandleTable() : length_(0), elems_(0), list_(nullptr) {
-  Resize();
+namespace {
+// Format of the compressed entries, with the size of the value
+const uint32_t kCompressFormatVersion = 2;
+
+void DeleteCompressedValue(const Slice& key, void* value) {
+  delete static_cast<std::string*>(value);
+}
+}  // namespace
+
+const uint32_t LRUHandle::kInCacheBit;
+const uint32_t LRUHandle::kHitBit;
+const uint32_t LRUHandle::kInLRUBit;
+const uint32_t LRUHandle::kRefsOffset;
+const uint32_t LRUHandle::kOneRef;
+
+LRUHandleTable::Buckets::Buckets(uint32_t _length)
+    : length(_length), list(new std::atomic<LRUHandle*>[_length]) {
+  for (uint32_t i = 0; i < length; i++) {
+    list[i].store(nullptr, std::memory_order_relaxed);
+  }
 }
 
+LRUHandleTable::LRUHandleTable() : buckets_(nullptr), elems_(0) { Resize(); }
+
 LRUHandleTable::~LRUHandleTable() {
   ApplyToAllCacheEntries([](LRUHandle* h) {
-    if (h->refs == 1) {
+    if (h->GetRefs() == 1) {
       h->Free();
     }
   });
-  delete[] list_;
 }
 
-LRUHandle* LRUHandleTable::Lookup(const Slice& key, uint32_t hash) {
-  return *FindPointer(key, hash);
+LRUHandle* LRUHandleTable::Lookup(const Slice& key, uint32_t hash) const {
+  const Buckets* buckets = buckets_.load(std::memory_order_acquire);
+  LRUHandle* h = buckets->list[hash & (buckets->length - 1)].load(
+      std::memory_order_acquire);
+  while (h != nullptr && (h->hash != hash || key != h->key())) {
+    h = h->next_hash.load(std::memory_order_acquire);
+  }
+  return h;
 }
 
 LRUHandle* LRUHandleTable::Insert(LRUHandle* h) {
-  LRUHandle** ptr = FindPointer(h->key(), h->hash);
-  LRUHandle* old = *ptr;
-  h->next_hash = (old == nullptr ? nullptr : old->next_hash);
-  *ptr = h;
+  std::atomic<LRUHandle*>* ptr = FindPointer(h->key(), h->hash);
+  LRUHandle* old = ptr->load(std::memory_order_relaxed);
+  h->next_hash.store(
+      old == nullptr ? nullptr
+                     : old->next_hash.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+  // Publish the entry to lookups
+  ptr->store(h, std::memory_order_release);
   if (old == nullptr) {
     ++elems_;
-    if (elems_ > length_) {
+    if (elems_ > buckets_.load(std::memory_order_relaxed)->length) {
       // Since each cache entry is fairly large, we aim for a small
       // average linked list length (<= 1).
       Resize();
@@ -58,19 +92,24 @@ LRUHandle* LRUHandleTable::Insert(LRUHandle* h) {
 }
 
 LRUHandle* LRUHandleTable::Remove(const Slice& key, uint32_t hash) {
-  LRUHandle** ptr = FindPointer(key, hash);
-  LRUHandle* result = *ptr;
+  std::atomic<LRUHandle*>* ptr = FindPointer(key, hash);
+  LRUHandle* result = ptr->load(std::memory_order_relaxed);
   if (result != nullptr) {
-    *ptr = result->next_hash;
+    ptr->store(result->next_hash.load(std::memory_order_relaxed),
+               std::memory_order_release);
     --elems_;
   }
   return result;
 }
 
-LRUHandle** LRUHandleTable::FindPointer(const Slice& key, uint32_t hash) {
-  LRUHandle** ptr = &list_[hash & (length_ - 1)];
-  while (*ptr != nullptr && ((*ptr)->hash != hash || key != (*ptr)->key())) {
-    ptr = &(*ptr)->next_hash;
+std::atomic<LRUHandle*>* LRUHandleTable::FindPointer(const Slice& key,
+                                                     uint32_t hash) {
+  Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+  std::atomic<LRUHandle*>* ptr = &buckets->list[hash & (buckets->length - 1)];
+  LRUHandle* h = ptr->load(std::memory_order_relaxed);
+  while (h != nullptr && (h->hash != hash || key != h->key())) {
+    ptr = &h->next_hash;
+    h = ptr->load(std::memory_order_relaxed);
   }
   return ptr;
 }
@@ -80,66 +119,253 @@ void LRUHandleTable::Resize() {
   while (new_length < elems_ * 1.5) {
     new_length *= 2;
   }
-  LRUHandle** new_list = new LRUHandle*[new_length];
-  memset(new_list, 0, sizeof(new_list[0]) * new_length);
+  Buckets* new_buckets = new Buckets(new_length);
+  all_buckets_.emplace_back(new_buckets);
+  const Buckets* old_buckets = buckets_.load(std::memory_order_relaxed);
   uint32_t count = 0;
-  for (uint32_t i = 0; i < length_; i++) {
-    LRUHandle* h = list_[i];
+  for (uint32_t i = 0; old_buckets != nullptr && i < old_buckets->length;
+       i++) {
+    LRUHandle* h = old_buckets->list[i].load(std::memory_order_relaxed);
     while (h != nullptr) {
-      LRUHandle* next = h->next_hash;
+      LRUHandle* next = h->next_hash.load(std::memory_order_relaxed);
       uint32_t hash = h->hash;
-      LRUHandle** ptr = &new_list[hash & (new_length - 1)];
-      h->next_hash = *ptr;
-      *ptr = h;
+      std::atomic<LRUHandle*>* ptr = &new_buckets->list[hash & (new_length - 1)];
+      // A lookup still walking the old list may follow this link into the
+      // new list and miss its key, but it always reaches the end of a list.
+      h->next_hash.store(ptr->load(std::memory_order_relaxed),
+                         std::memory_order_release);
+      ptr->store(h, std::memory_order_relaxed);
       h = next;
       count++;
     }
   }
   assert(elems_ == count);
-  delete[] list_;
-  list_ = new_list;
-  length_ = new_length;
+  buckets_.store(new_buckets, std::memory_order_release);
 }
 
 LRUCacheShard::LRUCacheShard()
-    : usage_(0), lru_usage_(0), high_pri_pool_usage_(0) {
+    : capacity_(0),
+      usage_(0),
+      pinned_usage_(0),
+      high_pri_pool_usage_(0),
+      compressed_tier_ratio_(0),
+      compressed_capacity_(0),
+      compressed_usage_(0),
+      epoch_(0) {
   // Make empty circular linked list
   lru_.next = &lru_;
   lru_.prev = &lru_;
   lru_low_pri_ = &lru_;
+  compressed_lru_.next = &compressed_lru_;
+  compressed_lru_.prev = &compressed_lru_;
+  readers_[0].store(0);
+  readers_[1].store(0);
+}
+
+LRUCacheShard::~LRUCacheShard() {
+  // The values of retired entries are already deleted
+  for (auto& retired : retired_) {
+    for (auto entry : retired) {
+      delete[] reinterpret_cast<char*>(entry);
+    }
+  }
 }
 
-LRUCacheShard::~LRUCacheShard() {}
+uint64_t LRUCacheShard::EnterRead() {
+  while (true) {
+    uint64_t epoch = epoch_.load();
+    readers_[epoch & 1].fetch_add(1);
+    // Retry if the epoch moved on before the lookup was counted, since the
+    // entries retired before it may be freed without waiting for it
+    if (epoch_.load() == epoch) {
+      return epoch;
+    }
+    readers_[epoch & 1].fetch_sub(1);
+  }
+}
 
-bool LRUCacheShard::Unref(LRUHandle* e) {
-  assert(e->refs > 0);
-  e->refs--;
-  return e->refs == 0;
+void LRUCacheShard::ExitRead(uint64_t epoch) {
+  readers_[epoch & 1].fetch_sub(1);
 }
 
-// Call deleter and free
+void LRUCacheShard::RemoveFromCache(LRUHandle* e, CleanupContext* context) {
+  mutex_.AssertHeld();
+  if (e->compressed || e->InLRU()) {
+    LRU_Remove(e);
+  }
+  table_.Remove(e->key(), e->hash);
+  // Use acquire-release semantics as previous operations on the entry have
+  // to be ordered before the reference of the cache is dropped, and its
+  // cleanup after.
+  uint32_t state = e->refs.fetch_sub(LRUHandle::kInCacheBit + LRUHandle::kOneRef,
+                                     std::memory_order_acq_rel);
+  assert(state & LRUHandle::kInCacheBit);
+  if (e->compressed) {
+    compressed_usage_ -= e->charge;
+  }
+  if (LRUHandle::CountRefs(state) == 1) {
+    usage_.fetch_sub(e->charge, std::memory_order_relaxed);
+    context->to_delete_value.push_back(e);
+  }
+}
 
-void LRUCacheShard::EraseUnRefEntries() {
-  autovector<LRUHandle*> last_reference_list;
+void LRUCacheShard::AddEvicted(LRUHandle* e, CleanupContext* context) {
+  if (e->helper != nullptr && compressed_capacity_ > 0) {
+    context->to_demote.push_back(e);
+  } else {
+    context->to_delete_value.push_back(e);
+  }
+}
+
+void LRUCacheShard::EvictCompressed(size_t charge, CleanupContext* context) {
+  mutex_.AssertHeld();
+  const size_t capacity = capacity_.load(std::memory_order_relaxed);
+  while ((compressed_usage_ > compressed_capacity_ ||
+          usage_.load(std::memory_order_relaxed) + charge > capacity) &&
+         compressed_lru_.next != &compressed_lru_) {
+    RemoveFromCache(compressed_lru_.next, context);
+  }
+}
+
+LRUHandle* LRUCacheShard::Compress(LRUHandle* e) {
+  const Cache::TierHelper* helper = e->helper;
+  const size_t size = helper->size(e->value);
+  std::unique_ptr<char[]> data(new char[size]);
+  helper->save(e->value, data.get());
+  std::unique_ptr<std::string> compressed(new std::string());
+  if (!LZ4_Compress(CompressionOptions(), kCompressFormatVersion, data.get(),
+                    size, compressed.get()) ||
+      compressed->size() >= size - (size / 8u)) {
+    // Not worth keeping: the value gets deleted as if it had no helper
+    return nullptr;
+  }
+  compressed->shrink_to_fit();
+
+  const Slice key = e->key();
+  LRUHandle* c = reinterpret_cast<LRUHandle*>(
+      new char[sizeof(LRUHandle) - 1 + key.size()]);
+  c->value = compressed.release();
+  c->deleter = &DeleteCompressedValue;
+  c->charge = static_cast<std::string*>(c->value)->size();
+  c->key_length = key.size();
+  c->hash = e->hash;
+  c->refs.store(LRUHandle::kInCacheBit + LRUHandle::kOneRef,
+                std::memory_order_relaxed);
+  c->next = c->prev = nullptr;
+  c->flags = 0;
+  c->detached = false;
+  c->compressed = true;
+  c->helper = nullptr;
+  memcpy(c->key_data, key.data(), key.size());
+  return c;
+}
+
+void LRUCacheShard::InsertCompressed(const autovector<LRUHandle*>& entries) {
+  autovector<LRUHandle*> dropped;
+  CleanupContext context;
   {
     MutexLock l(&mutex_);
-    while (lru_.next != &lru_) {
-      LRUHandle* old = lru_.next;
-      assert(old->InCache());
-      assert(old->refs ==
-             1);  // LRU list contains elements which may be evicted
-      LRU_Remove(old);
-      table_.Remove(old->key(), old->hash);
-      old->SetInCache(false);
-      Unref(old);
-      usage_ -= old->charge;
-      last_reference_list.push_back(old);
+    for (auto c : entries) {
+      if (c->charge > compressed_capacity_ ||
+          table_.Lookup(c->key(), c->hash) != nullptr) {
+        dropped.push_back(c);
+        continue;
+      }
+      table_.Insert(c);
+      // Insert "c" to the head of the compressed list
+      c->next = &compressed_lru_;
+      c->prev = compressed_lru_.prev;
+      c->prev->next = c;
+      c->next->prev = c;
+      compressed_usage_ += c->charge;
+      usage_.fetch_add(c->charge, std::memory_order_relaxed);
+    }
+    // Make room by dropping the oldest compressed entries past their share,
+    // then by demoting regular entries
+    EvictFromLRU(0, &context);
+    Retire(&context);
+  }
+  Cleanup(&context);
+  for (auto c : dropped) {
+    // Never seen by a lookup
+    c->DeleteValue();
+    delete[] reinterpret_cast<char*>(c);
+  }
+}
+
+void LRUCacheShard::Retire(CleanupContext* context) {
+  mutex_.AssertHeld();
+  if (context->to_delete_value.empty() && context->to_demote.empty()) {
+    return;
+  }
+  // Holding mutex_ the epoch cannot move, so the entries are retired in the
+  // epoch entered here, and cannot be freed before Cleanup() exits it.
+  context->epoch = EnterRead();
+  context->reading = true;
+  std::vector<LRUHandle*>& retired = retired_[context->epoch & 1];
+  retired.insert(retired.end(), context->to_delete_value.begin(),
+                 context->to_delete_value.end());
+  retired.insert(retired.end(), context->to_demote.begin(),
+                 context->to_demote.end());
+  // Move on to the next epoch once the lookups of the one before the current
+  // epoch are done. The entries retired in that epoch can then be freed.
+  const uint64_t next_epoch = context->epoch + 1;
+  if (readers_[next_epoch & 1].load() == 0) {
+    context->to_free.swap(retired_[next_epoch & 1]);
+    epoch_.store(next_epoch);
+  }
+}
+
+void LRUCacheShard::Cleanup(CleanupContext* context) {
+  autovector<LRUHandle*> compressed;
+  for (auto entry : context->to_demote) {
+    LRUHandle* c = Compress(entry);
+    if (c != nullptr) {
+      compressed.push_back(c);
     }
+    entry->DeleteValue();
+  }
+  for (auto entry : context->to_delete_value) {
+    entry->DeleteValue();
+  }
+  if (context->reading) {
+    ExitRead(context->epoch);
+  }
+  for (auto entry : context->to_free) {
+    delete[] reinterpret_cast<char*>(entry);
+  }
+  if (!compressed.empty()) {
+    InsertCompressed(compressed);
   }
+}
 
-  for (auto entry : last_reference_list) {
-    entry->Free();
+void LRUCacheShard::EraseUnRefEntries() {
+  CleanupContext context;
+  {
+    MutexLock l(&mutex_);
+    for (LRUHandle* list : {&lru_, &compressed_lru_}) {
+      LRUHandle* e = list->next;
+      while (e != list) {
+        LRUHandle* next = e->next;
+        uint32_t state = e->refs.load(std::memory_order_relaxed);
+        // Entries that are referenced stay in the cache
+        if (LRUHandle::CountRefs(state) == 1 &&
+            e->refs.compare_exchange_strong(state, 0,
+                                            std::memory_order_acquire)) {
+          LRU_Remove(e);
+          table_.Remove(e->key(), e->hash);
+          usage_.fetch_sub(e->charge, std::memory_order_relaxed);
+          if (e->compressed) {
+            compressed_usage_ -= e->charge;
+          }
+          context.to_delete_value.push_back(e);
+        }
+        e = next;
+      }
+    }
+    Retire(&context);
   }
+  Cleanup(&context);
 }
 
 void LRUCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
@@ -147,8 +373,11 @@ void LRUCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
   if (thread_safe) {
     mutex_.Lock();
   }
-  table_.ApplyToAllCacheEntries(
-      [callback](LRUHandle* h) { callback(h->value, h->charge); });
+  table_.ApplyToAllCacheEntries([callback](LRUHandle* h) {
+    if (!h->compressed) {
+      callback(h->value, h->charge);
+    }
+  });
   if (thread_safe) {
     mutex_.Unlock();
   }
@@ -168,7 +397,7 @@ void LRUCacheShard::LRU_Remove(LRUHandle* e) {
   e->next->prev = e->prev;
   e->prev->next = e->next;
   e->prev = e->next = nullptr;
-  lru_usage_ -= e->charge;
+  e->refs.fetch_and(~LRUHandle::kInLRUBit, std::memory_order_relaxed);
   if (e->InHighPriPool()) {
     assert(high_pri_pool_usage_ >= e->charge);
     high_pri_pool_usage_ -= e->charge;
@@ -178,6 +407,7 @@ void LRUCacheShard::LRU_Remove(LRUHandle* e) {
 void LRUCacheShard::LRU_Insert(LRUHandle* e) {
   assert(e->next == nullptr);
   assert(e->prev == nullptr);
+  e->refs.fetch_or(LRUHandle::kInLRUBit, std::memory_order_relaxed);
   if (high_pri_pool_ratio_ > 0 && e->IsHighPri()) {
     // Inset "e" to head of LRU list.
     e->next = &lru_;
@@ -197,7 +427,6 @@ void LRUCacheShard::LRU_Insert(LRUHandle* e) {
     e->SetInHighPriPool(false);
     lru_low_pri_ = e;
   }
-  lru_usage_ += e->charge;
 }
 
 void LRUCacheShard::MaintainPoolSize() {
@@ -210,34 +439,71 @@ void LRUCacheShard::MaintainPoolSize() {
   }
 }
 
-void LRUCacheShard::EvictFromLRU(size_t charge,
-                                 autovector<LRUHandle*>* deleted) {
-  while (usage_ + charge > capacity_ && lru_.next != &lru_) {
+void LRUCacheShard::EvictFromLRU(size_t charge, CleanupContext* context) {
+  mutex_.AssertHeld();
+  const size_t capacity = capacity_.load(std::memory_order_relaxed);
+  // Compressed entries past their share go first, so that regular entries
+  // are not evicted or demoted to make room for them
+  while (compressed_usage_ > compressed_capacity_) {
+    assert(compressed_lru_.next != &compressed_lru_);
+    RemoveFromCache(compressed_lru_.next, context);
+  }
+  // Entries looked up since the last pass are moved at most once each, so
+  // that lookups running meanwhile cannot keep eviction going forever
+  size_t budget = static_cast<size_t>(table_.size());
+  while (usage_.load(std::memory_order_relaxed) + charge > capacity &&
+         lru_.next != &lru_) {
     LRUHandle* old = lru_.next;
     assert(old->InCache());
-    assert(old->refs == 1);  // LRU list contains elements which may be evicted
-    LRU_Remove(old);
-    table_.Remove(old->key(), old->hash);
-    old->SetInCache(false);
-    Unref(old);
-    usage_ -= old->charge;
-    deleted->push_back(old);
+    uint32_t state = old->refs.load(std::memory_order_relaxed);
+    if (LRUHandle::CountRefs(state) > 1) {
+      // Referenced: take it off the list until the last external reference
+      // is released, see Release(). Its hit bit is of no use then. Retry the
+      // entry if the state changed in the meantime.
+      if (old->refs.compare_exchange_strong(
+              state, state & ~(LRUHandle::kHitBit | LRUHandle::kInLRUBit),
+              std::memory_order_relaxed)) {
+        LRU_Remove(old);
+      }
+      continue;
+    }
+    if ((state & LRUHandle::kHitBit) && budget > 0) {
+      // Looked up since the last pass: move it to the head of its pool, as
+      // Lookup() would have done
+      old->refs.fetch_and(~LRUHandle::kHitBit, std::memory_order_relaxed);
+      LRU_Remove(old);
+      LRU_Insert(old);
+      budget--;
+      continue;
+    }
+    // Only the cache holds a reference, and no lookup can add one once the
+    // in-cache bit is cleared. Retry the entry if a lookup came first.
+    if (old->refs.compare_exchange_strong(state, 0,
+                                          std::memory_order_acquire)) {
+      LRU_Remove(old);
+      table_.Remove(old->key(), old->hash);
+      usage_.fetch_sub(old->charge, std::memory_order_relaxed);
+      AddEvicted(old, context);
+    }
   }
+  // The other compressed entries go only once the regular ones are gone
+  EvictCompressed(charge, context);
 }
 
 void LRUCacheShard::SetCapacity(size_t capacity) {
-  autovector<LRUHandle*> last_reference_list;
+  CleanupContext context;
   {
     MutexLock l(&mutex_);
-    capacity_ = capacity;
-    high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
-    EvictFromLRU(0, &last_reference_list);
+    capacity_.store(capacity, std::memory_order_relaxed);
+    high_pri_pool_capacity_ = capacity * high_pri_pool_ratio_;
+    compressed_capacity_ =
+        static_cast<size_t>(capacity * compressed_tier_ratio_);
+    EvictFromLRU(0, &context);
+    Retire(&context);
   }
   // we free the entries here outside of mutex for
   // performance reasons
-  for (auto entry : last_reference_list) {
-    entry->Free();
-  }
+  Cleanup(&context);
 }
 
 void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
@@ -246,184 +512,413 @@ void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
 }
 
 Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  MutexLock l(&mutex_);
+  return LookupWithHelper(key, hash, nullptr);
+}
+
+Cache::Handle* LRUCacheShard::LookupWithHelper(
+    const Slice& key, uint32_t hash, const Cache::TierHelper* helper) {
+  uint64_t epoch = EnterRead();
   LRUHandle* e = table_.Lookup(key, hash);
+  bool found_compressed = false;
+  if (e != nullptr && e->compressed) {
+    // Compressed entries are never handed out
+    found_compressed = true;
+    e = nullptr;
+  }
   if (e != nullptr) {
-    assert(e->InCache());
-    if (e->refs == 1) {
-      LRU_Remove(e);
+    // CAS loop to add a reference and set the hit bit. It fails if the
+    // entry is evicted or erased in the meantime.
+    uint32_t state = e->refs.load(std::memory_order_relaxed);
+    while (true) {
+      if (!(state & LRUHandle::kInCacheBit)) {
+        e = nullptr;
+        break;
+      }
+      // Use acquire semantics on success, as further operations on the
+      // entry have to be ordered after the reference is added.
+      if (e->refs.compare_exchange_weak(
+              state, (state + LRUHandle::kOneRef) | LRUHandle::kHitBit,
+              std::memory_order_acquire, std::memory_order_relaxed)) {
+        if (LRUHandle::CountRefs(state) == 1) {
+          pinned_usage_.fetch_add(e->charge, std::memory_order_relaxed);
+        }
+        break;
+      }
     }
-    e->refs++;
+  }
+  ExitRead(epoch);
+  if (found_compressed && helper != nullptr) {
+    return Promote(key, hash, helper);
   }
   return reinterpret_cast<Cache::Handle*>(e);
 }
 
+Cache::Handle* LRUCacheShard::Promote(const Slice& key, uint32_t hash,
+                                      const Cache::TierHelper* helper) {
+  std::string compressed;
+  bool found = false;
+  CleanupContext context;
+  {
+    MutexLock l(&mutex_);
+    LRUHandle* e = table_.Lookup(key, hash);
+    if (e != nullptr && e->compressed) {
+      compressed.swap(*static_cast<std::string*>(e->value));
+      RemoveFromCache(e, &context);
+      found = true;
+    }
+    Retire(&context);
+  }
+  Cleanup(&context);
+  if (!found) {
+    // Another lookup promoted it first, or it was evicted
+    return Lookup(key, hash);
+  }
+
+  int size = 0;
+  std::unique_ptr<char[]> data(LZ4_Uncompress(
+      compressed.data(), compressed.size(), &size, kCompressFormatVersion));
+  void* value = nullptr;
+  size_t charge = 0;
+  if (data == nullptr ||
+      !helper->create(Slice(data.get(), size), &value, &charge).ok()) {
+    return nullptr;
+  }
+  Cache::Handle* handle = nullptr;
+  Status s = InsertImpl(key, hash, value, charge, helper->deleter, helper,
+                        &handle, Cache::Priority::LOW);
+  if (!s.ok()) {
+    (*helper->deleter)(key, value);
+    return nullptr;
+  }
+  return handle;
+}
+
 bool LRUCacheShard::Ref(Cache::Handle* h) {
   LRUHandle* handle = reinterpret_cast<LRUHandle*>(h);
-  MutexLock l(&mutex_);
-  if (handle->InCache() && handle->refs == 1) {
-    LRU_Remove(handle);
-  }
-  handle->refs++;
+  // The caller holds a reference, so the entry is already pinned
+  uint32_t state =
+      handle->refs.fetch_add(LRUHandle::kOneRef, std::memory_order_relaxed);
+  assert(LRUHandle::CountRefs(state) >
+         ((state & LRUHandle::kInCacheBit) ? 1u : 0u));
+  (void)state;
   return true;
 }
 
 void LRUCacheShard::SetHighPriorityPoolRatio(double high_pri_pool_ratio) {
   MutexLock l(&mutex_);
   high_pri_pool_ratio_ = high_pri_pool_ratio;
-  high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
+  high_pri_pool_capacity_ =
+      capacity_.load(std::memory_order_relaxed) * high_pri_pool_ratio_;
   MaintainPoolSize();
 }
 
+void LRUCacheShard::SetCompressedTierRatio(double compressed_tier_ratio) {
+  CleanupContext context;
+  {
+    MutexLock l(&mutex_);
+    compressed_tier_ratio_ = compressed_tier_ratio;
+    compressed_capacity_ = static_cast<size_t>(
+        capacity_.load(std::memory_order_relaxed) * compressed_tier_ratio_);
+    EvictCompressed(0, &context);
+    Retire(&context);
+  }
+  Cleanup(&context);
+}
+
 bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
   if (handle == nullptr) {
     return false;
   }
   LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
-  bool last_reference = false;
-  {
-    MutexLock l(&mutex_);
-    last_reference = Unref(e);
-    if (last_reference) {
-      usage_ -= e->charge;
+  // Read the entry while still holding the reference. Once it is dropped,
+  // another thread may evict and free the entry.
+  const size_t charge = e->charge;
+  const bool detached = e->detached;
+  uint32_t state = e->refs.load(std::memory_order_relaxed);
+  while (!(state & LRUHandle::kInCacheBit) ||
+         (!force_erase &&
+          (LRUHandle::CountRefs(state) > 2 ||
+           ((state & LRUHandle::kInLRUBit) &&
+            usage_.load(std::memory_order_relaxed) <=
+                capacity_.load(std::memory_order_relaxed))))) {
+    // Use acquire-release semantics as previous operations on the entry have
+    // to be ordered before the reference is dropped, and potential cleanup
+    // of the entry after. Fails if eviction took the entry off the LRU list
+    // in the meantime.
+    if (!e->refs.compare_exchange_weak(state, state - LRUHandle::kOneRef,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed)) {
+      continue;
     }
-    if (e->refs == 1 && e->InCache()) {
-      // The item is still in cache, and nobody else holds a reference to it
-      if (usage_ > capacity_ || force_erase) {
-        // the cache is full
-        // The LRU list must be empty since the cache is full
-        assert(!(usage_ > capacity_) || lru_.next == &lru_);
-        // take this opportunity and remove the item
-        table_.Remove(e->key(), e->hash);
-        e->SetInCache(false);
-        Unref(e);
-        usage_ -= e->charge;
-        last_reference = true;
-      } else {
-        // put the item on the list to be potentially freed
-        LRU_Insert(e);
+    const uint32_t refs = LRUHandle::CountRefs(state);
+    assert(refs > 0);
+    if (state & LRUHandle::kInCacheBit) {
+      if (refs == 2) {
+        // Leave the entry on the LRU list to be evicted in its turn
+        pinned_usage_.fetch_sub(charge, std::memory_order_relaxed);
       }
+      return false;
+    }
+    if (refs > 1) {
+      return false;
+    }
+    // This was the last reference to an entry no longer in the cache
+    pinned_usage_.fetch_sub(charge, std::memory_order_relaxed);
+    usage_.fetch_sub(charge, std::memory_order_relaxed);
+    if (detached) {
+      // No lookup has ever seen it
+      e->Free();
+      return true;
     }
+    CleanupContext context;
+    context.to_delete_value.push_back(e);
+    {
+      MutexLock l(&mutex_);
+      Retire(&context);
+    }
+    Cleanup(&context);
+    return true;
   }
 
-  // free outside of mutex
-  if (last_reference) {
-    e->Free();
+  // The cache is full, the caller asks to erase the entry, or eviction took
+  // it off the LRU list while it was referenced: take this opportunity to
+  // remove it if this is the last reference, or else put it back on the
+  // list. The reference is dropped under the mutex, so that the entry cannot
+  // be freed or moved by another thread in the meantime.
+  CleanupContext context;
+  {
+    MutexLock l(&mutex_);
+    state = e->refs.fetch_sub(LRUHandle::kOneRef, std::memory_order_acq_rel);
+    if (!(state & LRUHandle::kInCacheBit)) {
+      // Erased since the check above
+      if (LRUHandle::CountRefs(state) == 1) {
+        pinned_usage_.fetch_sub(charge, std::memory_order_relaxed);
+        usage_.fetch_sub(charge, std::memory_order_relaxed);
+        context.to_delete_value.push_back(e);
+      }
+    } else if (LRUHandle::CountRefs(state) == 2) {
+      pinned_usage_.fetch_sub(charge, std::memory_order_relaxed);
+      uint32_t expected = state - LRUHandle::kOneRef;
+      if (!force_erase && usage_.load(std::memory_order_relaxed) <=
+                              capacity_.load(std::memory_order_relaxed)) {
+        if (!(expected & LRUHandle::kInLRUBit)) {
+          LRU_Insert(e);
+        }
+      } else if (e->refs.compare_exchange_strong(expected, 0,
+                                                 std::memory_order_acquire)) {
+        // Fails if a lookup references the entry again, which leaves it to
+        // the release of that reference
+        if (expected & LRUHandle::kInLRUBit) {
+          LRU_Remove(e);
+        }
+        table_.Remove(e->key(), e->hash);
+        usage_.fetch_sub(charge, std::memory_order_relaxed);
+        if (force_erase) {
+          context.to_delete_value.push_back(e);
+        } else {
+          AddEvicted(e, &context);
+        }
+      }
+    }
+    Retire(&context);
   }
-  return last_reference;
+  const bool erased =
+      !context.to_delete_value.empty() || !context.to_demote.empty();
+  Cleanup(&context);
+  return erased;
 }
 
 Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                              size_t charge,
                              void (*deleter)(const Slice& key, void* value),
                              Cache::Handle** handle, Cache::Priority priority) {
+  return InsertImpl(key, hash, value, charge, deleter, nullptr, handle,
+                    priority);
+}
+
+Status LRUCacheShard::InsertWithHelper(const Slice& key, uint32_t hash,
+                                       void* value,
+                                       const Cache::TierHelper* helper,
+                                       size_t charge, Cache::Handle** handle,
+                                       Cache::Priority priority) {
+  return InsertImpl(key, hash, value, charge, helper->deleter, helper, handle,
+                    priority);
+}
+
+Status LRUCacheShard::InsertImpl(const Slice& key, uint32_t hash, void* value,
+                                 size_t charge,
+                                 void (*deleter)(const Slice& key, void* value),
+                                 const Cache::TierHelper* helper,
+                                 Cache::Handle** handle,
+                                 Cache::Priority priority) {
   // Allocate the memory here outside of the mutex
   // If the cache is full, we'll have to release it
   // It shouldn't happen very often though.
   LRUHandle* e = reinterpret_cast<LRUHandle*>(
       new char[sizeof(LRUHandle) - 1 + key.size()]);
   Status s;
-  autovector<LRUHandle*> last_reference_list;
+  CleanupContext context;
 
   e->value = value;
   e->deleter = deleter;
   e->charge = charge;
   e->key_length = key.size();
   e->hash = hash;
-  e->refs = (handle == nullptr
-                 ? 1
-                 : 2);  // One from LRUCache, one for the returned handle
+  // One from LRUCache, one for the returned handle
+  e->refs.store(LRUHandle::kInCacheBit +
+                    (handle == nullptr ? 1 : 2) * LRUHandle::kOneRef,
+                std::memory_order_relaxed);
   e->next = e->prev = nullptr;
-  e->SetInCache(true);
+  e->flags = 0;
+  e->detached = false;
+  e->compressed = false;
+  e->helper = helper;
   e->SetPriority(priority);
   memcpy(e->key_data, key.data(), key.size());
 
   {
     MutexLock l(&mutex_);
 
-    // Free the space following strict LRU policy until enough space
-    // is freed or the lru list is empty
-    EvictFromLRU(charge, &last_reference_list);
+    // Free the space following the LRU policy until enough space
+    // is freed or only referenced entries are left
+    EvictFromLRU(charge, &context);
 
-    if (usage_ - lru_usage_ + charge > capacity_ &&
+    if (usage_.load(std::memory_order_relaxed) + charge >
+            capacity_.load(std::memory_order_relaxed) &&
         (strict_capacity_limit_ || handle == nullptr)) {
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
         // into cache and get evicted immediately.
-        last_reference_list.push_back(e);
+        e->refs.store(0, std::memory_order_relaxed);
+        Retire(&context);
       } else {
         delete[] reinterpret_cast<char*>(e);
+        e = nullptr;
         *handle = nullptr;
         s = Status::Incomplete("Insert failed due to LRU cache being full.");
+        Retire(&context);
       }
     } else {
       // insert into the cache
       // note that the cache might get larger than its capacity if not enough
       // space was freed
-      LRUHandle* old = table_.Insert(e);
-      usage_ += e->charge;
+      LRUHandle* old = table_.Lookup(key, hash);
       if (old != nullptr) {
-        old->SetInCache(false);
-        if (Unref(old)) {
-          usage_ -= old->charge;
-          // old is on LRU because it's in cache and its reference count
-          // was just 1 (Unref returned 0)
-          LRU_Remove(old);
-          last_reference_list.push_back(old);
-        }
+        RemoveFromCache(old, &context);
       }
-      if (handle == nullptr) {
-        LRU_Insert(e);
-      } else {
+      table_.Insert(e);
+      usage_.fetch_add(e->charge, std::memory_order_relaxed);
+      LRU_Insert(e);
+      if (handle != nullptr) {
+        pinned_usage_.fetch_add(e->charge, std::memory_order_relaxed);
         *handle = reinterpret_cast<Cache::Handle*>(e);
       }
+      Retire(&context);
+      e = nullptr;
       s = Status::OK();
     }
   }
 
   // we free the entries here outside of mutex for
   // performance reasons
-  for (auto entry : last_reference_list) {
-    entry->Free();
+  Cleanup(&context);
+  if (e != nullptr) {
+    // Never seen by a lookup
+    e->DeleteValue();
+    delete[] reinterpret_cast<char*>(e);
   }
 
   return s;
 }
 
 void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
-  LRUHandle* e;
-  bool last_reference = false;
+  CleanupContext context;
   {
     MutexLock l(&mutex_);
-    e = table_.Remove(key, hash);
+    LRUHandle* e = table_.Lookup(key, hash);
     if (e != nullptr) {
-      last_reference = Unref(e);
-      if (last_reference) {
-        usage_ -= e->charge;
-      }
-      if (last_reference && e->InCache()) {
-        LRU_Remove(e);
-      }
-      e->SetInCache(false);
+      RemoveFromCache(e, &context);
     }
+    Retire(&context);
   }
 
   // mutex not held here
-  // last_reference will only be true if e != nullptr
-  if (last_reference) {
-    e->Free();
+  Cleanup(&context);
+}
+
+bool LRUCacheShard::GetEvictionCandidate(size_t charge, uint32_t* hash) {
+  MutexLock l(&mutex_);
+  if (usage_.load(std::memory_order_relaxed) + charge <=
+          capacity_.load(std::memory_order_relaxed) ||
+      lru_.next == &lru_) {
+    return false;
   }
+  // The first entries that eviction would move to the head of the list are
+  // skipped, up to a few
+  const int kMaxSkipped = 8;
+  LRUHandle* candidate = lru_.next;
+  for (int i = 0; i < kMaxSkipped && candidate != &lru_;
+       i++, candidate = candidate->next) {
+    uint32_t state = candidate->refs.load(std::memory_order_relaxed);
+    if (LRUHandle::CountRefs(state) == 1 && !(state & LRUHandle::kHitBit)) {
+      *hash = candidate->hash;
+      return true;
+    }
+  }
+  *hash = lru_.next->hash;
+  return true;
 }
 
-size_t LRUCacheShard::GetUsage() const {
+bool LRUCacheShard::MayContain(const Slice& key, uint32_t hash) {
+  uint64_t epoch = EnterRead();
+  const bool found = table_.Lookup(key, hash) != nullptr;
+  ExitRead(epoch);
+  return found;
+}
+
+Status LRUCacheShard::InsertUncached(const Slice& key, uint32_t hash,
+                                     void* value, size_t charge,
+                                     void (*deleter)(const Slice& key,
+                                                     void* value),
+                                     Cache::Handle** handle) {
+  LRUHandle* e = reinterpret_cast<LRUHandle*>(
+      new char[sizeof(LRUHandle) - 1 + key.size()]);
+  e->value = value;
+  e->deleter = deleter;
+  e->charge = charge;
+  e->key_length = key.size();
+  e->hash = hash;
+  e->refs.store(LRUHandle::kOneRef,  // Only the returned handle
+                std::memory_order_relaxed);
+  e->next = e->prev = nullptr;
+  e->flags = 0;
+  e->detached = true;
+  e->compressed = false;
+  e->helper = nullptr;
+  e->SetPriority(Cache::Priority::LOW);
+  memcpy(e->key_data, key.data(), key.size());
+
   MutexLock l(&mutex_);
-  return usage_;
+  if (strict_capacity_limit_ &&
+      pinned_usage_.load(std::memory_order_relaxed) + charge >
+          capacity_.load(std::memory_order_relaxed)) {
+    delete[] reinterpret_cast<char*>(e);
+    *handle = nullptr;
+    return Status::Incomplete("Insert failed due to LRU cache being full.");
+  }
+  // Counted as pinned usage until it is released
+  usage_.fetch_add(charge, std::memory_order_relaxed);
+  pinned_usage_.fetch_add(charge, std::memory_order_relaxed);
+  *handle = reinterpret_cast<Cache::Handle*>(e);
+  return Status::OK();
+}
+
+size_t LRUCacheShard::GetUsage() const {
+  return usage_.load(std::memory_order_relaxed);
 }
 
 size_t LRUCacheShard::GetPinnedUsage() const {
-  MutexLock l(&mutex_);
-  assert(usage_ >= lru_usage_);
-  return usage_ - lru_usage_;
+  return pinned_usage_.load(std::memory_order_relaxed);
 }
 
 std::string LRUCacheShard::GetPrintableOptions() const {
@@ -431,32 +926,117 @@ std::string LRUCacheShard::GetPrintableOptions() const {
   char buffer[kBufferSize];
   {
     MutexLock l(&mutex_);
-    snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
-             high_pri_pool_ratio_);
+    snprintf(buffer, kBufferSize,
+             "    high_pri_pool_ratio: %.3lf\n"
+             "    compressed_tier_ratio: %.3lf\n",
+             high_pri_pool_ratio_, compressed_tier_ratio_);
   }
   return std::string(buffer);
 }
 
+namespace {
+// Number of node bits of a NUMA aware cache on this host
+int GetNumaNodeBits() {
+  int num_node_bits = 0;
+  while ((2 << num_node_bits) <= port::NumaNodeCount()) {
+    num_node_bits++;
+  }
+  return num_node_bits;
+}
+}  // namespace
+
 LRUCache::LRUCache(size_t capacity, int num_shard_bits,
-                   bool strict_capacity_limit, double high_pri_pool_ratio)
-    : ShardedCache(capacity, num_shard_bits, strict_capacity_limit) {
-  int num_shards = 1 << num_shard_bits;
-  shards_ = new LRUCacheShard[num_shards];
+                   bool strict_capacity_limit, double high_pri_pool_ratio,
+                   int num_node_bits)
+    : ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
+                   num_node_bits),
+      group_shard_bits_(num_shard_bits - num_node_bits),
+      numa_allocated_(false) {
+  assert(num_shard_bits >= num_node_bits);
+  const int num_groups = 1 << num_node_bits;
+  const int group_size = 1 << group_shard_bits_;
+#ifdef NUMA
+  numa_allocated_ = num_node_bits > 0 && numa_available() != -1 &&
+                    num_groups <= numa_num_configured_nodes();
+#endif
+  for (int g = 0; g < num_groups; g++) {
+    LRUCacheShard* shards;
+#ifdef NUMA
+    if (numa_allocated_) {
+      // The shards of a node group live on that node
+      void* mem = numa_alloc_onnode(sizeof(LRUCacheShard) * group_size, g);
+      if (mem == nullptr) {
+        throw std::bad_alloc();
+      }
+      shards = static_cast<LRUCacheShard*>(mem);
+      for (int i = 0; i < group_size; i++) {
+        new (&shards[i]) LRUCacheShard();
+      }
+    } else
+#endif
+    {
+      shards = new LRUCacheShard[group_size];
+    }
+    shard_groups_.push_back(shards);
+  }
   SetCapacity(capacity);
   SetStrictCapacityLimit(strict_capacity_limit);
+  int num_shards = 1 << num_shard_bits;
   for (int i = 0; i < num_shards; i++) {
-    shards_[i].SetHighPriorityPoolRatio(high_pri_pool_ratio);
+    reinterpret_cast<LRUCacheShard*>(GetShard(i))
+        ->SetHighPriorityPoolRatio(high_pri_pool_ratio);
   }
 }
 
-LRUCache::~LRUCache() { delete[] shards_; }
+LRUCache::LRUCache(const LRUCacheOptions& cache_opts)
+    : LRUCache(cache_opts.capacity,
+               cache_opts.num_shard_bits +
+                   (cache_opts.numa_aware ? GetNumaNodeBits() : 0),
+               cache_opts.strict_capacity_limit,
+               cache_opts.high_pri_pool_ratio,
+               cache_opts.numa_aware ? GetNumaNodeBits() : 0) {
+  if (cache_opts.tiny_lfu_admission) {
+    // Size the sketch for entries of the usual block size
+    const size_t kEntryCharge = 4096;
+    SetAdmissionFilter(std::unique_ptr<TinyLFU>(
+                           new TinyLFU(cache_opts.capacity / kEntryCharge)),
+                       cache_opts.statistics);
+  }
+  if (cache_opts.compressed_tier_ratio > 0 && LZ4_Supported()) {
+    int num_shards = 1 << GetNumShardBits();
+    for (int i = 0; i < num_shards; i++) {
+      reinterpret_cast<LRUCacheShard*>(GetShard(i))
+          ->SetCompressedTierRatio(cache_opts.compressed_tier_ratio);
+    }
+  }
+}
+
+LRUCache::~LRUCache() {
+  for (auto shards : shard_groups_) {
+#ifdef NUMA
+    if (numa_allocated_) {
+      const int group_size = 1 << group_shard_bits_;
+      for (int i = 0; i < group_size; i++) {
+        shards[i].~LRUCacheShard();
+      }
+      numa_free(shards, sizeof(LRUCacheShard) * group_size);
+      continue;
+    }
+#endif
+    delete[] shards;
+  }
+}
 
 CacheShard* LRUCache::GetShard(int shard) {
-  return reinterpret_cast<CacheShard*>(&shards_[shard]);
+  return reinterpret_cast<CacheShard*>(
+      &shard_groups_[shard >> group_shard_bits_]
+                    [shard & ((1 << group_shard_bits_) - 1)]);
 }
 
 const CacheShard* LRUCache::GetShard(int shard) const {
-  return reinterpret_cast<CacheShard*>(&shards_[shard]);
+  return reinterpret_cast<CacheShard*>(
+      &shard_groups_[shard >> group_shard_bits_]
+                    [shard & ((1 << group_shard_bits_) - 1)]);
 }
 
 void* LRUCache::Value(Handle* handle) {
@@ -471,23 +1051,41 @@ uint32_t LRUCache::GetHash(Handle* handle) const {
   return reinterpret_cast<const LRUHandle*>(handle)->hash;
 }
 
-void LRUCache::DisownData() { shards_ = nullptr; }
+void LRUCache::DisownData() { shard_groups_.clear(); }
 
 std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
                                    bool strict_capacity_limit,
                                    double high_pri_pool_ratio) {
-  if (num_shard_bits >= 20) {
+  LRUCacheOptions cache_opts;
+  cache_opts.capacity = capacity;
+  cache_opts.num_shard_bits = num_shard_bits;
+  cache_opts.strict_capacity_limit = strict_capacity_limit;
+  cache_opts.high_pri_pool_ratio = high_pri_pool_ratio;
+  return NewLRUCache(cache_opts);
+}
+
+std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
+  LRUCacheOptions opts = cache_opts;
+  if (opts.num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
-  if (high_pri_pool_ratio < 0.0 || high_pri_pool_ratio > 1.0) {
+  if (opts.high_pri_pool_ratio < 0.0 || opts.high_pri_pool_ratio > 1.0) {
     // invalid high_pri_pool_ratio
     return nullptr;
   }
-  if (num_shard_bits < 0) {
-    num_shard_bits = GetDefaultCacheShardBits(capacity);
+  if (opts.compressed_tier_ratio < 0.0 || opts.compressed_tier_ratio > 1.0) {
+    return nullptr;
+  }
+  // With NUMA aware sharding, the shard bits are those of each node
+  const int num_node_bits = opts.numa_aware ? GetNumaNodeBits() : 0;
+  if (opts.num_shard_bits < 0) {
+    opts.num_shard_bits =
+        GetDefaultCacheShardBits(opts.capacity >> num_node_bits);
+  }
+  if (opts.num_shard_bits + num_node_bits >= 20) {
+    return nullptr;
   }
-  return std::make_shared<LRUCache>(capacity, num_shard_bits,
-                                    strict_capacity_limit, high_pri_pool_ratio);
+  return std::make_shared<LRUCache>(opts);
 }
 
 }  // namespace rocksdb
@@ -10,7 +10,10 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "cache/sharded_cache.h"
 
@@ -27,8 +30,9 @@ namespace rocksdb {
 // are also stored on LRU list.
 //
 // LRUHandle can be in these states:
-// 1. Referenced externally AND in hash table.
-//  In that case the entry is *not* in the LRU. (refs > 1 && in_cache == true)
+// 1. Referenced externally AND in hash table. In that case the entry may
+// still be on the LRU list, until eviction comes across it.
+//  (refs > 1 && in_cache == true)
 // 2. Not referenced externally and in hash table. In that case the entry is
 // in the LRU and can be freed. (refs == 1 && in_cache == true)
 // 3. Referenced externally and not in hash table. In that case the entry is
@@ -44,49 +48,93 @@ namespace rocksdb {
 // that any successful LRUCacheShard::Lookup/LRUCacheShard::Insert have a
 // matching
 // RUCache::Release (to move into state 2) or LRUCacheShard::Erase (for state 3)
+//
+// Lookup() does not take the shard mutex, and Release() only does when the
+// entry has to leave the cache or go back on the LRU list. A hit only
+// updates the reference count and sets the hit bit of the entry, both held
+// in one atomic word, and leaves the entry where it is. The list is fixed up
+// lazily under the mutex: when eviction reaches an entry that was hit, the
+// entry is moved to the head of its pool instead of being evicted, as if it
+// had been moved there on the lookup. An entry that eviction finds still
+// referenced is taken off the list, and the release of its last external
+// reference puts it back at the head of its pool.
+//
+// Lookups probe the hash table while writers change it. Entries and bucket
+// arrays a lookup may still see are therefore not freed right away. Values
+// are deleted as soon as the entry leaves the cache, since a lookup that
+// finds an entry no longer in cache fails to reference it.
+//
+// With a compressed tier, an entry inserted with a TierHelper is not deleted
+// when it is evicted: its value is serialized and compressed once the mutex
+// is released, and the compressed copy is inserted back as a new entry. Such
+// entries share the hash table and the capacity with the others, but sit on
+// a list of their own, and are never handed out: a lookup with a helper
+// removes the compressed entry, makes the value again outside of the mutex
+// and inserts it as a regular entry.
 
 struct LRUHandle {
   void* value;
   void (*deleter)(const Slice&, void* value);
-  LRUHandle* next_hash;
+  std::atomic<LRUHandle*> next_hash;
   LRUHandle* next;
   LRUHandle* prev;
   size_t charge;  // TODO(opt): Only allow uint32_t?
   size_t key_length;
-  uint32_t refs;     // a number of refs to this entry
-                     // cache itself is counted as 1
 
-  // Include the following flags:
-  //   in_cache:    whether this entry is referenced by the hash table.
+  // Reference count and flags that change without holding the shard mutex:
+  //   lowest bit, in_cache: whether this entry is referenced by the hash
+  //     table.
+  //   second lowest bit, hit: whether this entry was looked up since the
+  //     eviction last passed over it.
+  //   third lowest bit, in_lru: whether this entry is on the LRU list. Only
+  //     changes under the shard mutex.
+  //   the rest bits: number of references to this entry; the cache itself is
+  //     counted as 1.
+  std::atomic<uint32_t> refs;
+
+  // Include the following flags, which only change under the shard mutex:
   //   is_high_pri: whether this entry is high priority entry.
   //   in_high_pro_pool: whether this entry is in high-pri pool.
   char flags;
 
+  // Whether this entry was never inserted into the table. Set before the
+  // entry is handed out and never changed.
+  bool detached;
+
+  // Whether the value is the compressed copy of an evicted entry, on the
+  // compressed list. Never changes once the entry is in the table.
+  bool compressed;
+
+  // How to keep the value in the compressed tier, or null
+  const Cache::TierHelper* helper;
+
   uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
 
   char key_data[1];  // Beginning of key
 
-  Slice key() const {
-    // For cheaper lookups, we allow a temporary Handle object
-    // to store a pointer to a key in "value".
-    if (next == this) {
-      return *(reinterpret_cast<Slice*>(value));
-    } else {
-      return Slice(key_data, key_length);
-    }
-  }
+  static const uint32_t kInCacheBit = 1;
+  static const uint32_t kHitBit = 2;
+  static const uint32_t kInLRUBit = 4;
+  static const uint32_t kRefsOffset = 3;
+  static const uint32_t kOneRef = 1 << kRefsOffset;
 
-  bool InCache() { return flags & 1; }
-  bool IsHighPri() { return flags & 2; }
-  bool InHighPriPool() { return flags & 4; }
+  static uint32_t CountRefs(uint32_t state) { return state >> kRefsOffset; }
 
-  void SetInCache(bool in_cache) {
-    if (in_cache) {
-      flags |= 1;
-    } else {
-      flags &= ~1;
-    }
+  // Lookups read the key without holding the shard mutex, so it must not
+  // depend on anything that changes once the entry is in the table.
+  Slice key() const { return Slice(key_data, key_length); }
+
+  bool InCache() const {
+    return refs.load(std::memory_order_relaxed) & kInCacheBit;
+  }
+  bool InLRU() const {
+    return refs.load(std::memory_order_relaxed) & kInLRUBit;
   }
+  uint32_t GetRefs() const {
+    return CountRefs(refs.load(std::memory_order_relaxed));
+  }
+  bool IsHighPri() { return flags & 2; }
+  bool InHighPriPool() { return flags & 4; }
 
   void SetPriority(Cache::Priority priority) {
     if (priority == Cache::Priority::HIGH) {
@@ -104,11 +152,15 @@ struct LRUHandle {
     }
   }
 
-  void Free() {
-    assert((refs == 1 && InCache()) || (refs == 0 && !InCache()));
+  void DeleteValue() {
     if (deleter) {
       (*deleter)(key(), value);
     }
+  }
+
+  void Free() {
+    assert((GetRefs() == 1 && InCache()) || (GetRefs() == 0 && !InCache()));
+    DeleteValue();
     delete[] reinterpret_cast<char*>(this);
   }
 };
@@ -118,21 +170,30 @@ struct LRUHandle {
 // table implementations in some of the compiler/runtime combinations
 // we have tested.  E.g., readrandom speeds up by ~5% over the g++
 // 4.4.3's builtin hashtable.
+//
+// Lookup() may run concurrently with the other methods, which have to be
+// serialized by the caller. It may then miss an entry that Resize() is
+// moving, or return an entry that has just been removed. Bucket arrays
+// replaced by Resize() are kept until the table is destroyed; together they
+// are smaller than the current one.
 class LRUHandleTable {
  public:
   LRUHandleTable();
   ~LRUHandleTable();
 
-  LRUHandle* Lookup(const Slice& key, uint32_t hash);
+  LRUHandle* Lookup(const Slice& key, uint32_t hash) const;
   LRUHandle* Insert(LRUHandle* h);
   LRUHandle* Remove(const Slice& key, uint32_t hash);
 
+  uint32_t size() const { return elems_; }
+
   template <typename T>
   void ApplyToAllCacheEntries(T func) {
-    for (uint32_t i = 0; i < length_; i++) {
-      LRUHandle* h = list_[i];
+    const Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < buckets->length; i++) {
+      LRUHandle* h = buckets->list[i].load(std::memory_order_relaxed);
       while (h != nullptr) {
-        auto n = h->next_hash;
+        auto n = h->next_hash.load(std::memory_order_relaxed);
         assert(h->InCache());
         func(h);
         h = n;
@@ -141,18 +202,26 @@ class LRUHandleTable {
   }
 
  private:
+  struct Buckets {
+    explicit Buckets(uint32_t _length);
+
+    const uint32_t length;
+    std::unique_ptr<std::atomic<LRUHandle*>[]> list;
+  };
+
   // Return a pointer to slot that points to a cache entry that
   // matches key/hash.  If there is no such cache entry, return a
   // pointer to the trailing slot in the corresponding linked list.
-  LRUHandle** FindPointer(const Slice& key, uint32_t hash);
+  std::atomic<LRUHandle*>* FindPointer(const Slice& key, uint32_t hash);
 
   void Resize();
 
   // The table consists of an array of buckets where each bucket is
   // a linked list of cache entries that hash into the bucket.
-  uint32_t length_;
+  std::atomic<Buckets*> buckets_;
   uint32_t elems_;
-  LRUHandle** list_;
+  // The current bucket array and the ones it replaced
+  std::vector<std::unique_ptr<Buckets>> all_buckets_;
 };
 
 // A single shard of sharded cache.
@@ -172,6 +241,9 @@ class LRUCacheShard : public CacheShard {
   // Set percentage of capacity reserved for high-pri cache entries.
   void SetHighPriorityPoolRatio(double high_pri_pool_ratio);
 
+  // Set percentage of capacity that can hold compressed entries.
+  void SetCompressedTierRatio(double compressed_tier_ratio);
+
   // Like Cache methods, but with an extra "hash" parameter.
   virtual Status Insert(const Slice& key, uint32_t hash, void* value,
                         size_t charge,
@@ -179,14 +251,28 @@ class LRUCacheShard : public CacheShard {
                         Cache::Handle** handle,
                         Cache::Priority priority) override;
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
+  virtual Status InsertWithHelper(const Slice& key, uint32_t hash,
+                                  void* value, const Cache::TierHelper* helper,
+                                  size_t charge, Cache::Handle** handle,
+                                  Cache::Priority priority) override;
+  virtual Cache::Handle* LookupWithHelper(
+      const Slice& key, uint32_t hash,
+      const Cache::TierHelper* helper) override;
   virtual bool Ref(Cache::Handle* handle) override;
   virtual bool Release(Cache::Handle* handle,
                        bool force_erase = false) override;
   virtual void Erase(const Slice& key, uint32_t hash) override;
 
-  // Although in some platforms the update of size_t is atomic, to make sure
-  // GetUsage() and GetPinnedUsage() work correctly under any platform, we'll
-  // protect them with mutex_.
+  virtual bool GetEvictionCandidate(size_t charge, uint32_t* hash) override;
+  virtual bool MayContain(const Slice& key, uint32_t hash) override;
+  // MayContain() is exact, and it does not touch the entry
+  virtual bool Contains(const Slice& key, uint32_t hash) override {
+    return MayContain(key, hash);
+  }
+  virtual Status InsertUncached(const Slice& key, uint32_t hash, void* value,
+                                size_t charge,
+                                void (*deleter)(const Slice& key, void* value),
+                                Cache::Handle** handle) override;
 
   virtual size_t GetUsage() const override;
   virtual size_t GetPinnedUsage() const override;
@@ -201,6 +287,20 @@ class LRUCacheShard : public CacheShard {
   void TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri);
 
  private:
+  // Entries that left the cache during one operation under mutex_
+  struct CleanupContext {
+    // Entries whose value has to be deleted, once mutex_ is released
+    autovector<LRUHandle*> to_delete_value;
+    // Evicted entries whose value has to be compressed, then deleted
+    autovector<LRUHandle*> to_demote;
+    // Memory of entries that no lookup can see any more
+    std::vector<LRUHandle*> to_free;
+    // Whether a read epoch was entered, to keep to_delete_value from being
+    // freed by another thread before their values are deleted
+    bool reading = false;
+    uint64_t epoch = 0;
+  };
+
   void LRU_Remove(LRUHandle* e);
   void LRU_Insert(LRUHandle* e);
 
@@ -208,24 +308,74 @@ class LRUCacheShard : public CacheShard {
   // high-pri pool is no larger than the size specify by high_pri_pool_pct.
   void MaintainPoolSize();
 
-  // Just reduce the reference count by 1.
-  // Return true if last reference
-  bool Unref(LRUHandle* e);
-
-  // Free some space following strict LRU policy until enough space
-  // to hold (usage_ + charge) is freed or the lru list is empty
+  // Takes the entry out of its list and the table, and drops the reference
+  // of the cache. Adds the entry to context if that was the last reference.
+  // mutex_ has to be held.
+  void RemoveFromCache(LRUHandle* e, CleanupContext* context);
+
+  // Adds an entry that was just evicted to context, to be compressed if it
+  // has a helper and the compressed tier is enabled.
+  void AddEvicted(LRUHandle* e, CleanupContext* context);
+
+  // Evicts compressed entries, oldest first, while they use more than their
+  // share of capacity or (usage_ + charge) exceeds capacity. mutex_ has to be
+  // held.
+  void EvictCompressed(size_t charge, CleanupContext* context);
+
+  // Makes the compressed copy of an evicted entry, or returns null if its
+  // value does not compress well. Call it without holding mutex_.
+  LRUHandle* Compress(LRUHandle* e);
+
+  // Inserts the compressed copies, unless their keys were inserted again
+  // in the meantime, and evicts entries to make room for them. Call it
+  // without holding mutex_.
+  void InsertCompressed(const autovector<LRUHandle*>& entries);
+
+  // Replaces the compressed entry of the key with the value made by helper,
+  // and returns a handle to it. Call it without holding mutex_.
+  Cache::Handle* Promote(const Slice& key, uint32_t hash,
+                         const Cache::TierHelper* helper);
+
+  Status InsertImpl(const Slice& key, uint32_t hash, void* value,
+                    size_t charge,
+                    void (*deleter)(const Slice& key, void* value),
+                    const Cache::TierHelper* helper, Cache::Handle** handle,
+                    Cache::Priority priority);
+
+  // Free some space, evicting entries from the LRU end of the list until
+  // enough space to hold (usage_ + charge) is freed or the list is empty.
+  // Entries that were hit since the last pass are moved to the head of the
+  // list instead, and referenced entries are taken off the list.
+  // Compressed entries past their share of capacity are evicted before that,
+  // the others after, see EvictCompressed().
   // This function is not thread safe - it needs to be executed while
   // holding the mutex_
-  void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
+  void EvictFromLRU(size_t charge, CleanupContext* context);
+
+  // Retires the entries of context, which are no longer in the table, and
+  // frees the ones retired long enough ago. Has to hold mutex_, and has to be
+  // followed by Cleanup() once mutex_ is released.
+  void Retire(CleanupContext* context);
+
+  // Deletes the values of the entries that left the cache, after moving the
+  // evicted ones to the compressed tier, and frees the memory of retired
+  // entries. Call it without holding mutex_.
+  void Cleanup(CleanupContext* context);
+
+  // Protects entries and bucket arrays seen by a lookup from being freed
+  // until ExitRead().
+  uint64_t EnterRead();
+  void ExitRead(uint64_t epoch);
 
   // Initialized before use.
-  size_t capacity_;
+  std::atomic<size_t> capacity_;
 
-  // Memory size for entries residing in the cache
-  size_t usage_;
+  // Memory size for entries residing in the cache, and for entries no longer
+  // in the cache that are still referenced
+  std::atomic<size_t> usage_;
 
-  // Memory size for entries residing only in the LRU list
-  size_t lru_usage_;
+  // Memory size for entries referenced from outside the cache
+  std::atomic<size_t> pinned_usage_;
 
   // Memory size for entries in high-pri pool.
   size_t high_pri_pool_usage_;
@@ -240,6 +390,15 @@ class LRUCacheShard : public CacheShard {
   // Remember the value to avoid recomputing each time.
   double high_pri_pool_capacity_;
 
+  // Ratio of capacity that can hold compressed entries.
+  double compressed_tier_ratio_;
+
+  // Equals to capacity * compressed_tier_ratio.
+  size_t compressed_capacity_;
+
+  // Memory size for compressed entries, which is part of usage_.
+  size_t compressed_usage_;
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
@@ -247,19 +406,33 @@ class LRUCacheShard : public CacheShard {
 
   // Dummy head of LRU list.
   // lru.prev is newest entry, lru.next is oldest entry.
-  // LRU contains items which can be evicted, ie reference only by cache
+  // LRU contains items which can be evicted, ie reference only by cache, and
+  // referenced items that eviction has not come across yet
   LRUHandle lru_;
 
   // Pointer to head of low-pri pool in LRU list.
   LRUHandle* lru_low_pri_;
 
+  // Dummy head of the list of compressed entries, which are kept out of the
+  // LRU list. compressed_lru_.next is the oldest entry.
+  LRUHandle compressed_lru_;
+
   LRUHandleTable table_;
+
+  // Entries that left the table are freed two epochs later, once no lookup
+  // that started before they left can be running. readers_[i] counts the
+  // lookups running in the epochs of parity i. retired_[i] holds the
+  // entries retired in the last epoch of parity i.
+  std::atomic<uint64_t> epoch_;
+  std::atomic<uint32_t> readers_[2];
+  std::vector<LRUHandle*> retired_[2];
 };
 
 class LRUCache : public ShardedCache {
  public:
   LRUCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-           double high_pri_pool_ratio);
+           double high_pri_pool_ratio, int num_node_bits = 0);
+  explicit LRUCache(const LRUCacheOptions& cache_opts);
   virtual ~LRUCache();
   virtual const char* Name() const override { return "LRUCache"; }
   virtual CacheShard* GetShard(int shard) override;
@@ -270,7 +443,12 @@ class LRUCache : public ShardedCache {
   virtual void DisownData() override;
 
  private:
-  LRUCacheShard* shards_;
+  // The shards of each NUMA node group, see ShardedCache. Without NUMA
+  // awareness, all shards are in one group.
+  std::vector<LRUCacheShard*> shard_groups_;
+  int group_shard_bits_;
+  // Whether the groups are allocated on their nodes by the NUMA library
+  bool numa_allocated_;
 };
 
 }  // namespace rocksdb
@@ -9,6 +9,10 @@
 
 #include <string>
 #include <vector>
+#include "util/compression.h"
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/sync_point.h"
 #include "util/testharness.h"
 
 namespace rocksdb {
@@ -46,6 +50,16 @@ class LRUCacheTest : public testing::Test {
 
   bool Lookup(char key) { return Lookup(std::string(1, key)); }
 
+  Cache::Handle* LookupAndRef(const std::string& key) {
+    return cache_->Lookup(key, 0 /*hash*/);
+  }
+
+  void Release(Cache::Handle* handle) { cache_->Release(handle); }
+
+  bool Contains(const std::string& key) {
+    return cache_->Contains(key, 0 /*hash*/);
+  }
+
   void Erase(const std::string& key) { cache_->Erase(key, 0 /*hash*/); }
 
   void ValidateLRUList(std::vector<std::string> keys,
@@ -93,18 +107,54 @@ TEST_F(LRUCacheTest, BasicLRU) {
   ValidateLRUList({"d", "e", "x", "y", "z"});
   ASSERT_FALSE(Lookup("b"));
   ValidateLRUList({"d", "e", "x", "y", "z"});
+  // Lookups only mark the entries. They are moved to the head of the list
+  // when eviction comes across them.
   ASSERT_TRUE(Lookup("e"));
-  ValidateLRUList({"d", "x", "y", "z", "e"});
+  ValidateLRUList({"d", "e", "x", "y", "z"});
   ASSERT_TRUE(Lookup("z"));
-  ValidateLRUList({"d", "x", "y", "e", "z"});
+  ValidateLRUList({"d", "e", "x", "y", "z"});
   Erase("x");
-  ValidateLRUList({"d", "y", "e", "z"});
+  ValidateLRUList({"d", "e", "y", "z"});
   ASSERT_TRUE(Lookup("d"));
-  ValidateLRUList({"y", "e", "z", "d"});
+  ValidateLRUList({"d", "e", "y", "z"});
   Insert("u");
-  ValidateLRUList({"y", "e", "z", "d", "u"});
+  ValidateLRUList({"d", "e", "y", "z", "u"});
   Insert("v");
-  ValidateLRUList({"e", "z", "d", "u", "v"});
+  ValidateLRUList({"z", "u", "d", "e", "v"});
+  // The mark is cleared once the entry is moved
+  Insert("w");
+  ValidateLRUList({"d", "e", "v", "z", "w"});
+  Insert("t");
+  ValidateLRUList({"e", "v", "z", "w", "t"});
+}
+
+TEST_F(LRUCacheTest, ReferencedEntries) {
+  NewCache(3);
+  Insert("a");
+  Insert("b");
+  Insert("c");
+  Cache::Handle* handle = LookupAndRef("a");
+  ASSERT_NE(nullptr, handle);
+  // Eviction takes the referenced entry off the list instead of moving it
+  Insert("d");
+  ValidateLRUList({"c", "d"});
+  // Releasing the last reference puts it back at the head
+  Release(handle);
+  ValidateLRUList({"c", "d", "a"});
+  Insert("e");
+  ValidateLRUList({"d", "a", "e"});
+}
+
+TEST_F(LRUCacheTest, ContainsDoesNotMark) {
+  NewCache(3);
+  Insert("a");
+  Insert("b");
+  Insert("c");
+  ASSERT_TRUE(Contains("a"));
+  ASSERT_FALSE(Contains("x"));
+  // Unlike a lookup, the probe does not save "a" from eviction
+  Insert("d");
+  ValidateLRUList({"b", "c", "d"});
 }
 
 TEST_F(LRUCacheTest, MidPointInsertion) {
@@ -133,28 +183,258 @@ TEST_F(LRUCacheTest, MidPointInsertion) {
   Insert("a", Cache::Priority::LOW);
   ValidateLRUList({"v", "X", "a", "Y", "Z"}, 2);
 
-  // Low-pri entries will be inserted to head of low-pri pool after lookup.
+  // Looked up entries stay in place until eviction comes across them
   ASSERT_TRUE(Lookup("v"));
-  ValidateLRUList({"X", "a", "v", "Y", "Z"}, 2);
-
-  // High-pri entries will be inserted to the head of the list after lookup.
   ASSERT_TRUE(Lookup("X"));
-  ValidateLRUList({"a", "v", "Y", "Z", "X"}, 2);
   ASSERT_TRUE(Lookup("Z"));
-  ValidateLRUList({"a", "v", "Y", "X", "Z"}, 2);
+  ValidateLRUList({"v", "X", "a", "Y", "Z"}, 2);
 
   Erase("Y");
-  ValidateLRUList({"a", "v", "X", "Z"}, 2);
+  ValidateLRUList({"v", "X", "a", "Z"}, 1);
   Erase("X");
-  ValidateLRUList({"a", "v", "Z"}, 1);
+  ValidateLRUList({"v", "a", "Z"}, 1);
   Insert("d", Cache::Priority::LOW);
   Insert("e", Cache::Priority::LOW);
-  ValidateLRUList({"a", "v", "d", "e", "Z"}, 1);
+  ValidateLRUList({"v", "a", "d", "e", "Z"}, 1);
+
+  // Low-pri entries will be moved to head of low-pri pool on eviction after
+  // lookup.
   Insert("f", Cache::Priority::LOW);
+  ValidateLRUList({"d", "e", "v", "f", "Z"}, 1);
   Insert("g", Cache::Priority::LOW);
-  ValidateLRUList({"d", "e", "f", "g", "Z"}, 1);
-  ASSERT_TRUE(Lookup("d"));
-  ValidateLRUList({"e", "f", "g", "d", "Z"}, 1);
+  ValidateLRUList({"e", "v", "f", "g", "Z"}, 1);
+  ASSERT_TRUE(Lookup("e"));
+  Insert("h", Cache::Priority::LOW);
+  ValidateLRUList({"f", "g", "e", "h", "Z"}, 1);
+
+  // High-pri entries will be moved to the head of the list on eviction after
+  // lookup.
+  Erase("f");
+  Erase("g");
+  Erase("e");
+  Erase("h");
+  Insert("P", Cache::Priority::HIGH);
+  Insert("Q", Cache::Priority::HIGH);
+  Insert("R", Cache::Priority::LOW);
+  Insert("S", Cache::Priority::LOW);
+  ValidateLRUList({"Z", "R", "S", "P", "Q"}, 2);
+  Insert("T", Cache::Priority::LOW);
+  ValidateLRUList({"S", "P", "T", "Q", "Z"}, 2);
+}
+
+namespace {
+void DeleteCounted(const Slice& key, void* value) {
+  ++*reinterpret_cast<int*>(value);
+}
+}  // namespace
+
+TEST_F(LRUCacheTest, TinyLFUAdmission) {
+  for (bool tiny_lfu_admission : {false, true}) {
+    LRUCacheOptions cache_opts;
+    cache_opts.capacity = 100;
+    cache_opts.num_shard_bits = 0;
+    cache_opts.tiny_lfu_admission = tiny_lfu_admission;
+    cache_opts.statistics = CreateDBStatistics();
+    std::shared_ptr<Cache> cache = NewLRUCache(cache_opts);
+    int deleted = 0;
+
+    // Each key is looked up before it is inserted, as the block cache does
+    auto read = [&](const std::string& key) {
+      Cache::Handle* handle = cache->Lookup(key);
+      if (handle == nullptr) {
+        ASSERT_OK(cache->Insert(key, &deleted, 1, &DeleteCounted));
+      } else {
+        cache->Release(handle);
+      }
+    };
+    // A hot set of half the capacity, then a scan ten times the capacity
+    for (int round = 0; round < 5; round++) {
+      for (int i = 0; i < 50; i++) {
+        read("hot" + ToString(i));
+      }
+    }
+    for (int i = 0; i < 1000; i++) {
+      read("scan" + ToString(i));
+    }
+
+    // A rejected entry can still be used through its handle
+    Cache::Handle* handle = nullptr;
+    int scan_deleted = 0;
+    ASSERT_EQ(nullptr, cache->Lookup("scan_handle"));
+    ASSERT_OK(cache->Insert("scan_handle", &scan_deleted, 1, &DeleteCounted,
+                            &handle));
+    ASSERT_NE(nullptr, handle);
+    ASSERT_EQ(&scan_deleted, cache->Value(handle));
+    cache->Release(handle);
+    if (tiny_lfu_admission) {
+      // Nothing was evicted for it, and it is gone once released
+      ASSERT_EQ(950, deleted);
+      ASSERT_EQ(1, scan_deleted);
+      ASSERT_EQ(nullptr, cache->Lookup("scan_handle"));
+      ASSERT_EQ(100U, cache->GetUsage());
+    } else {
+      ASSERT_EQ(0, scan_deleted);
+    }
+
+    int hot_left = 0;
+    for (int i = 0; i < 50; i++) {
+      Cache::Handle* hot_handle = cache->Lookup("hot" + ToString(i));
+      if (hot_handle != nullptr) {
+        hot_left++;
+        cache->Release(hot_handle);
+      }
+    }
+    Statistics* stats = cache_opts.statistics.get();
+    if (tiny_lfu_admission) {
+      ASSERT_EQ(50, hot_left);
+      ASSERT_EQ(0U, stats->getTickerCount(BLOCK_CACHE_ADMISSION_ACCEPTED));
+      ASSERT_EQ(951U, stats->getTickerCount(BLOCK_CACHE_ADMISSION_REJECTED));
+    } else {
+      ASSERT_EQ(0, hot_left);
+      ASSERT_EQ(0U, stats->getTickerCount(BLOCK_CACHE_ADMISSION_REJECTED));
+    }
+    ASSERT_EQ(100U, cache->GetUsage());
+  }
+}
+
+TEST_F(LRUCacheTest, NumaNodeGroups) {
+  uint32_t node = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "ShardedCache::LocalNodeGroup",
+      [&](void* arg) { *static_cast<uint32_t*>(arg) = node; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  std::shared_ptr<Statistics> stats = CreateDBStatistics();
+  // Two node groups of two shards each
+  std::shared_ptr<Cache> cache = std::make_shared<LRUCache>(
+      8 /*capacity*/, 2 /*num_shard_bits*/, false /*strict_capacity_limit*/,
+      0.0 /*high_pri_pool_ratio*/, 1 /*num_node_bits*/);
+  int values[2];
+
+  // Entries are found from all nodes
+  ASSERT_OK(cache->Insert("a", &values[0], 1, nullptr));
+  Cache::Handle* handle = cache->Lookup("a", stats.get());
+  ASSERT_NE(nullptr, handle);
+  cache->Release(handle);
+  ASSERT_EQ(0U, stats->getTickerCount(BLOCK_CACHE_NUMA_REMOTE_HIT));
+  node = 1;
+  handle = cache->Lookup("a", stats.get());
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(&values[0], cache->Value(handle));
+  ASSERT_EQ(1U, stats->getTickerCount(BLOCK_CACHE_NUMA_REMOTE_HIT));
+
+  // Inserting the key on another node replaces the entry
+  ASSERT_OK(cache->Insert("a", &values[1], 1, nullptr));
+  cache->Release(handle);
+  node = 0;
+  handle = cache->Lookup("a", stats.get());
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(&values[1], cache->Value(handle));
+  cache->Release(handle);
+  ASSERT_EQ(2U, stats->getTickerCount(BLOCK_CACHE_NUMA_REMOTE_HIT));
+  ASSERT_EQ(1U, cache->GetUsage());
+
+  // Erasing the key on any node removes it
+  cache->Erase("a");
+  node = 1;
+  ASSERT_EQ(nullptr, cache->Lookup("a"));
+  ASSERT_EQ(0U, cache->GetUsage());
+
+  // Each node gets half of the capacity
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(cache->Insert(ToString(i), &values[0], 1, nullptr));
+  }
+  ASSERT_EQ(4U, cache->GetUsage());
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+namespace {
+size_t StringSize(void* value) {
+  return static_cast<std::string*>(value)->size();
+}
+
+void SaveString(void* value, char* out) {
+  const std::string* str = static_cast<std::string*>(value);
+  memcpy(out, str->data(), str->size());
+}
+
+Status CreateString(const Slice& data, void** value, size_t* charge) {
+  *value = new std::string(data.data(), data.size());
+  *charge = data.size();
+  return Status::OK();
+}
+
+void DeleteString(const Slice& key, void* value) {
+  delete static_cast<std::string*>(value);
+}
+
+const Cache::TierHelper kStringHelper = {StringSize, SaveString, CreateString,
+                                         DeleteString};
+}  // namespace
+
+TEST_F(LRUCacheTest, CompressedTier) {
+  if (!LZ4_Supported()) {
+    fprintf(stderr, "skipping test, LZ4 is not supported\n");
+    return;
+  }
+  LRUCacheOptions cache_opts;
+  cache_opts.capacity = 10000;
+  cache_opts.num_shard_bits = 0;
+  cache_opts.compressed_tier_ratio = 0.5;
+  std::shared_ptr<Cache> cache = NewLRUCache(cache_opts);
+  ASSERT_NE(nullptr, cache);
+
+  // Twice as many entries as the capacity holds, that compress well
+  for (int i = 0; i < 20; i++) {
+    ASSERT_OK(cache->InsertWithHelper(
+        ToString(i), new std::string(1000, static_cast<char>('a' + i)),
+        &kStringHelper, 1000));
+  }
+  ASSERT_LE(cache->GetUsage(), 10000U);
+  ASSERT_GT(cache->GetUsage(), 9000U);
+
+  // The oldest entries are only kept compressed, which a plain lookup misses
+  ASSERT_EQ(nullptr, cache->Lookup("0"));
+  // All of them are found with the helper, and move back into the cache
+  for (int i = 0; i < 20; i++) {
+    Cache::Handle* handle = cache->LookupWithHelper(ToString(i),
+                                                    &kStringHelper);
+    ASSERT_NE(nullptr, handle);
+    ASSERT_EQ(std::string(1000, static_cast<char>('a' + i)),
+              *static_cast<std::string*>(cache->Value(handle)));
+    cache->Release(handle);
+  }
+  Cache::Handle* handle = cache->Lookup("19");
+  ASSERT_NE(nullptr, handle);
+  cache->Release(handle);
+  ASSERT_LE(cache->GetUsage(), 10000U);
+
+  // Erasing a compressed entry removes it
+  ASSERT_EQ(nullptr, cache->Lookup("0"));
+  cache->Erase("0");
+  ASSERT_EQ(nullptr, cache->LookupWithHelper("0", &kStringHelper));
+
+  // Values that do not compress are dropped on eviction
+  Random rnd(301);
+  for (int i = 0; i < 20; i++) {
+    std::string* value = new std::string(1000, 0);
+    for (auto& c : *value) {
+      c = static_cast<char>(rnd.Uniform(256));
+    }
+    ASSERT_OK(cache->InsertWithHelper("random" + ToString(i), value,
+                                      &kStringHelper, 1000));
+  }
+  ASSERT_EQ(nullptr, cache->LookupWithHelper("random0", &kStringHelper));
+  handle = cache->LookupWithHelper("random19", &kStringHelper);
+  ASSERT_NE(nullptr, handle);
+  cache->Release(handle);
+
+  // Shrinking the cache evicts compressed entries too
+  cache->SetCapacity(5000);
+  ASSERT_LE(cache->GetUsage(), 5000U);
+  cache->EraseUnRefEntries();
+  ASSERT_EQ(0U, cache->GetUsage());
 }
 
 }  // namespace rocksdb
@@ -17,13 +17,16 @@
 
 #include <string>
 
+#include "monitoring/statistics.h"
 #include "util/mutexlock.h"
+#include "util/sync_point.h"
 
 namespace rocksdb {
 
 ShardedCache::ShardedCache(size_t capacity, int num_shard_bits,
-                           bool strict_capacity_limit)
+                           bool strict_capacity_limit, int num_node_bits)
     : num_shard_bits_(num_shard_bits),
+      num_node_bits_(num_node_bits),
       capacity_(capacity),
       strict_capacity_limit_(strict_capacity_limit),
       last_id_(1) {}
@@ -47,17 +50,121 @@ void ShardedCache::SetStrictCapacityLimit(bool strict_capacity_limit) {
   strict_capacity_limit_ = strict_capacity_limit;
 }
 
+uint32_t ShardedCache::LocalNodeGroup() const {
+  uint32_t group = static_cast<uint32_t>(port::NumaNodeOfCurrentCore());
+  TEST_SYNC_POINT_CALLBACK("ShardedCache::LocalNodeGroup", &group);
+  return group & ((1u << num_node_bits_) - 1);
+}
+
 Status ShardedCache::Insert(const Slice& key, void* value, size_t charge,
                             void (*deleter)(const Slice& key, void* value),
                             Handle** handle, Priority priority) {
-  uint32_t hash = HashSlice(key);
-  return GetShard(Shard(hash))
-      ->Insert(key, hash, value, charge, deleter, handle, priority);
+  return InsertImpl(key, value, charge, deleter, nullptr, handle, priority);
+}
+
+Status ShardedCache::InsertWithHelper(const Slice& key, void* value,
+                                      const TierHelper* helper, size_t charge,
+                                      Handle** handle, Priority priority) {
+  return InsertImpl(key, value, charge, helper->deleter, helper, handle,
+                    priority);
+}
+
+Status ShardedCache::InsertImpl(const Slice& key, void* value, size_t charge,
+                                void (*deleter)(const Slice& key, void* value),
+                                const TierHelper* helper, Handle** handle,
+                                Priority priority) {
+  const uint32_t key_hash = HashSlice(key);
+  const uint32_t local_group = num_node_bits_ > 0 ? LocalNodeGroup() : 0;
+  uint32_t hash = NodeHash(key_hash, local_group);
+  CacheShard* shard = GetShard(Shard(hash));
+  uint32_t victim_hash;
+  if (admission_filter_ != nullptr &&
+      shard->GetEvictionCandidate(charge, &victim_hash)) {
+    // The filter only knows the hashes outside of any node group
+    if (!admission_filter_->Admit(NodeHash(hash, 0),
+                                  NodeHash(victim_hash, 0))) {
+      RecordTick(admission_statistics_.get(), BLOCK_CACHE_ADMISSION_REJECTED);
+      if (handle == nullptr) {
+        // As if the entry was inserted and evicted right away
+        (*deleter)(key, value);
+        return Status::OK();
+      }
+      return shard->InsertUncached(key, hash, value, charge, deleter, handle);
+    }
+    RecordTick(admission_statistics_.get(), BLOCK_CACHE_ADMISSION_ACCEPTED);
+  }
+  Status s = helper != nullptr
+                 ? shard->InsertWithHelper(key, hash, value, helper, charge,
+                                           handle, priority)
+                 : shard->Insert(key, hash, value, charge, deleter, handle,
+                                 priority);
+  // Lookups from other nodes must not find an older entry of the key. An
+  // insert usually follows a miss on all nodes, so the other groups are only
+  // probed, and locked in the rare case they hold the key.
+  for (uint32_t group = 0; s.ok() && group < (1u << num_node_bits_);
+       group++) {
+    if (group != local_group) {
+      uint32_t group_hash = NodeHash(key_hash, group);
+      CacheShard* group_shard = GetShard(Shard(group_hash));
+      if (group_shard->MayContain(key, group_hash)) {
+        group_shard->Erase(key, group_hash);
+      }
+    }
+  }
+  return s;
 }
 
 Cache::Handle* ShardedCache::Lookup(const Slice& key, Statistics* stats) {
+  return LookupImpl(key, nullptr, stats);
+}
+
+Cache::Handle* ShardedCache::LookupWithHelper(const Slice& key,
+                                              const TierHelper* helper,
+                                              Statistics* stats) {
+  return LookupImpl(key, helper, stats);
+}
+
+Cache::Handle* ShardedCache::LookupImpl(const Slice& key,
+                                        const TierHelper* helper,
+                                        Statistics* stats) {
+  uint32_t hash = HashSlice(key);
+  if (admission_filter_ != nullptr) {
+    admission_filter_->Record(NodeHash(hash, 0));
+  }
+  if (num_node_bits_ == 0) {
+    CacheShard* shard = GetShard(Shard(hash));
+    return helper != nullptr ? shard->LookupWithHelper(key, hash, helper)
+                             : shard->Lookup(key, hash);
+  }
+  // Try the local node first
+  const uint32_t num_groups = 1u << num_node_bits_;
+  const uint32_t local_group = LocalNodeGroup();
+  for (uint32_t i = 0; i < num_groups; i++) {
+    uint32_t group = (local_group + i) & (num_groups - 1);
+    uint32_t group_hash = NodeHash(hash, group);
+    CacheShard* shard = GetShard(Shard(group_hash));
+    Handle* handle = helper != nullptr
+                         ? shard->LookupWithHelper(key, group_hash, helper)
+                         : shard->Lookup(key, group_hash);
+    if (handle != nullptr) {
+      if (i > 0) {
+        RecordTick(stats, BLOCK_CACHE_NUMA_REMOTE_HIT);
+      }
+      return handle;
+    }
+  }
+  return nullptr;
+}
+
+bool ShardedCache::Contains(const Slice& key) {
   uint32_t hash = HashSlice(key);
-  return GetShard(Shard(hash))->Lookup(key, hash);
+  for (uint32_t group = 0; group < (1u << num_node_bits_); group++) {
+    uint32_t group_hash = NodeHash(hash, group);
+    if (GetShard(Shard(group_hash))->Contains(key, group_hash)) {
+      return true;
+    }
+  }
+  return false;
 }
 
 bool ShardedCache::Ref(Handle* handle) {
@@ -72,7 +179,17 @@ bool ShardedCache::Release(Handle* handle, bool force_erase) {
 
 void ShardedCache::Erase(const Slice& key) {
   uint32_t hash = HashSlice(key);
-  GetShard(Shard(hash))->Erase(key, hash);
+  for (uint32_t group = 0; group < (1u << num_node_bits_); group++) {
+    uint32_t group_hash = NodeHash(hash, group);
+    GetShard(Shard(group_hash))->Erase(key, group_hash);
+  }
+}
+
+void ShardedCache::SetAdmissionFilter(
+    std::unique_ptr<TinyLFU>&& admission_filter,
+    const std::shared_ptr<Statistics>& statistics) {
+  admission_filter_ = std::move(admission_filter);
+  admission_statistics_ = statistics;
 }
 
 uint64_t ShardedCache::NewId() {
@@ -140,10 +257,15 @@ std::string ShardedCache::GetPrintableOptions() const {
     ret.append(buffer);
     snprintf(buffer, kBufferSize, "    num_shard_bits : %d\n", num_shard_bits_);
     ret.append(buffer);
+    snprintf(buffer, kBufferSize, "    num_node_bits : %d\n", num_node_bits_);
+    ret.append(buffer);
     snprintf(buffer, kBufferSize, "    strict_capacity_limit : %d\n",
              strict_capacity_limit_);
     ret.append(buffer);
   }
+  snprintf(buffer, kBufferSize, "    tiny_lfu_admission : %d\n",
+           admission_filter_ != nullptr);
+  ret.append(buffer);
   ret.append(GetShard(0)->GetPrintableOptions());
   return ret;
 }
@@ -12,8 +12,10 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 #include <string>
 
+#include "cache/tiny_lfu.h"
 #include "port/port.h"
 #include "rocksdb/cache.h"
 #include "util/hash.h"
@@ -42,14 +44,70 @@ class CacheShard {
                                       bool thread_safe) = 0;
   virtual void EraseUnRefEntries() = 0;
   virtual std::string GetPrintableOptions() const { return ""; }
+
+  // If inserting an entry of the charge would evict entries, sets *hash to
+  // the hash of the first entry to be evicted and returns true. Shards that
+  // cannot tell return false.
+  virtual bool GetEvictionCandidate(size_t charge, uint32_t* hash) {
+    return false;
+  }
+
+  // Returns false if the shard holds no entry of the key. Unlike Lookup(),
+  // it does not reference the entry. Shards that cannot tell cheaply return
+  // true.
+  virtual bool MayContain(const Slice& key, uint32_t hash) { return true; }
+
+  // Returns true if the shard holds an entry of the key. See
+  // Cache::Contains().
+  virtual bool Contains(const Slice& key, uint32_t hash) {
+    Cache::Handle* handle = Lookup(key, hash);
+    if (handle == nullptr) {
+      return false;
+    }
+    Release(handle);
+    return true;
+  }
+
+  // Like Insert() with a handle, except that the entry is not kept in the
+  // cache: it is freed as soon as the handle is released, and it does not
+  // evict any entry.
+  virtual Status InsertUncached(const Slice& key, uint32_t hash, void* value,
+                                size_t charge,
+                                void (*deleter)(const Slice& key, void* value),
+                                Cache::Handle** handle) {
+    return Insert(key, hash, value, charge, deleter, handle,
+                  Cache::Priority::LOW);
+  }
+
+  // Like Insert() and Lookup(), for shards with a compressed tier. See
+  // Cache::InsertWithHelper() and Cache::LookupWithHelper().
+  virtual Status InsertWithHelper(const Slice& key, uint32_t hash,
+                                  void* value, const Cache::TierHelper* helper,
+                                  size_t charge, Cache::Handle** handle,
+                                  Cache::Priority priority) {
+    return Insert(key, hash, value, charge, helper->deleter, handle,
+                  priority);
+  }
+  virtual Cache::Handle* LookupWithHelper(const Slice& key, uint32_t hash,
+                                          const Cache::TierHelper* helper) {
+    return Lookup(key, hash);
+  }
 };
 
 // Generic cache interface which shards cache by hash of keys. 2^num_shard_bits
 // shards will be created, with capacity split evenly to each of the shards.
 // Keys are sharded by the highest num_shard_bits bits of hash value.
+//
+// With num_node_bits > 0, the shards are split into 2^num_node_bits groups,
+// one per NUMA node, and the highest num_node_bits bits of the hash of an
+// entry are replaced by its group. A key is inserted into the group of the
+// node the calling thread runs on, after erasing it from the other groups
+// that hold it, and looked up there first. Hosts with more nodes than groups
+// map several nodes to one group.
 class ShardedCache : public Cache {
  public:
-  ShardedCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit);
+  ShardedCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+               int num_node_bits = 0);
   virtual ~ShardedCache() = default;
   virtual const char* Name() const override = 0;
   virtual CacheShard* GetShard(int shard) = 0;
@@ -66,6 +124,12 @@ class ShardedCache : public Cache {
                         void (*deleter)(const Slice& key, void* value),
                         Handle** handle, Priority priority) override;
   virtual Handle* Lookup(const Slice& key, Statistics* stats) override;
+  virtual bool Contains(const Slice& key) override;
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const TierHelper* helper, size_t charge,
+                                  Handle** handle, Priority priority) override;
+  virtual Handle* LookupWithHelper(const Slice& key, const TierHelper* helper,
+                                   Statistics* stats) override;
   virtual bool Ref(Handle* handle) override;
   virtual bool Release(Handle* handle, bool force_erase = false) override;
   virtual void Erase(const Slice& key) override;
@@ -81,6 +145,18 @@ class ShardedCache : public Cache {
   virtual std::string GetPrintableOptions() const override;
 
   int GetNumShardBits() const { return num_shard_bits_; }
+  int GetNumNodeBits() const { return num_node_bits_; }
+
+  // Puts a TinyLFU admission filter in front of Insert(). All lookups are
+  // recorded in it, and a new entry that would evict another one is only
+  // kept in the cache if it is estimated to be used at least as often as
+  // the entry it would evict. Otherwise it is dropped, or handed out through
+  // a handle that frees it once released. The decisions are counted in the
+  // tickers BLOCK_CACHE_ADMISSION_ACCEPTED and BLOCK_CACHE_ADMISSION_REJECTED
+  // of statistics, which can be null.
+  // Not thread safe: has to be called before the cache is used.
+  void SetAdmissionFilter(std::unique_ptr<TinyLFU>&& admission_filter,
+                          const std::shared_ptr<Statistics>& statistics);
 
  private:
   static inline uint32_t HashSlice(const Slice& s) {
@@ -92,11 +168,34 @@ class ShardedCache : public Cache {
     return (num_shard_bits_ > 0) ? (hash >> (32 - num_shard_bits_)) : 0;
   }
 
+  // Hash of the key in the given node group
+  uint32_t NodeHash(uint32_t hash, uint32_t group) const {
+    if (num_node_bits_ == 0) {
+      return hash;
+    }
+    return (hash & (UINT32_MAX >> num_node_bits_)) |
+           (group << (32 - num_node_bits_));
+  }
+
+  // Node group of the calling thread
+  uint32_t LocalNodeGroup() const;
+
+  // Insert() and Lookup(), with the helper of the compressed tier, or null
+  Status InsertImpl(const Slice& key, void* value, size_t charge,
+                    void (*deleter)(const Slice& key, void* value),
+                    const TierHelper* helper, Handle** handle,
+                    Priority priority);
+  Handle* LookupImpl(const Slice& key, const TierHelper* helper,
+                     Statistics* stats);
+
   int num_shard_bits_;
+  int num_node_bits_;
   mutable port::Mutex capacity_mutex_;
   size_t capacity_;
   bool strict_capacity_limit_;
   std::atomic<uint64_t> last_id_;
+  std::unique_ptr<TinyLFU> admission_filter_;
+  std::shared_ptr<Statistics> admission_statistics_;
 };
 
 extern int GetDefaultCacheShardBits(size_t capacity);
@@ -0,0 +1,80 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+
+#include "cache/tiny_lfu.h"
+
+#include <algorithm>
+
+namespace rocksdb {
+
+const uint32_t TinyLFU::kNumCounters;
+const uint32_t TinyLFU::kCountersPerWord;
+const uint64_t TinyLFU::kMaxCount;
+
+TinyLFU::TinyLFU(size_t expected_entries) : samples_(0) {
+  const uint64_t entries = std::max<uint64_t>(expected_entries, 256);
+  // Four counters per expected entry keep collisions rare
+  uint64_t num_counters = kCountersPerWord;
+  while (num_counters < entries * kNumCounters) {
+    num_counters *= 2;
+  }
+  mask_ = num_counters - 1;
+  sample_size_ = entries * 10;
+  const uint64_t num_words = num_counters / kCountersPerWord;
+  words_.reset(new std::atomic<uint64_t>[num_words]);
+  for (uint64_t i = 0; i < num_words; i++) {
+    words_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void TinyLFU::Record(uint32_t hash) {
+  bool added = false;
+  for (uint32_t i = 0; i < kNumCounters; i++) {
+    const uint64_t index = CounterIndex(hash, i);
+    std::atomic<uint64_t>& word = words_[index / kCountersPerWord];
+    const uint32_t shift = (index % kCountersPerWord) * 4;
+    uint64_t value = word.load(std::memory_order_relaxed);
+    // Saturated counters, the common case for hot keys, are only read
+    while (((value >> shift) & kMaxCount) < kMaxCount) {
+      if (word.compare_exchange_weak(value, value + (1ull << shift),
+                                     std::memory_order_relaxed)) {
+        added = true;
+        break;
+      }
+    }
+  }
+  if (added &&
+      samples_.fetch_add(1, std::memory_order_relaxed) + 1 == sample_size_) {
+    Age();
+  }
+}
+
+uint32_t TinyLFU::Estimate(uint32_t hash) const {
+  uint64_t count = kMaxCount;
+  for (uint32_t i = 0; i < kNumCounters; i++) {
+    const uint64_t index = CounterIndex(hash, i);
+    const uint64_t value =
+        words_[index / kCountersPerWord].load(std::memory_order_relaxed);
+    count = std::min(count, (value >> ((index % kCountersPerWord) * 4)) &
+                                kMaxCount);
+  }
+  return static_cast<uint32_t>(count);
+}
+
+void TinyLFU::Age() {
+  const uint64_t num_words = mask_ / kCountersPerWord + 1;
+  for (uint64_t i = 0; i < num_words; i++) {
+    uint64_t value = words_[i].load(std::memory_order_relaxed);
+    while (!words_[i].compare_exchange_weak(
+        value, (value >> 1) & 0x7777777777777777ull,
+        std::memory_order_relaxed)) {
+    }
+  }
+  samples_.fetch_sub(sample_size_ / 2, std::memory_order_relaxed);
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,70 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+
+namespace rocksdb {
+
+// TinyLFU estimates how often cache keys have been accessed recently, to
+// decide whether a new entry is worth evicting another one for. Accesses are
+// counted in a count-min sketch of 4-bit counters, four counters per key.
+// Once the number of recorded accesses reaches ten times the number of
+// entries the sketch is sized for, all counters are halved, so that the
+// estimates follow changes of the workload.
+//
+// Keys are identified by their 32-bit cache hash. All methods are thread
+// safe; concurrent updates may lose a few increments, which only makes the
+// estimates slightly less accurate.
+class TinyLFU {
+ public:
+  // Sized for about expected_entries distinct keys
+  explicit TinyLFU(size_t expected_entries);
+
+  // Records one access to the key
+  void Record(uint32_t hash);
+
+  // Returns the estimated number of recent accesses to the key, at most 15
+  uint32_t Estimate(uint32_t hash) const;
+
+  // Returns true if the candidate key is estimated to be accessed at least as
+  // often as the victim it would replace
+  bool Admit(uint32_t candidate_hash, uint32_t victim_hash) const {
+    return Estimate(candidate_hash) >= Estimate(victim_hash);
+  }
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(TinyLFU) + (mask_ / kCountersPerWord + 1) * sizeof(uint64_t);
+  }
+
+ private:
+  static const uint32_t kNumCounters = 4;
+  static const uint32_t kCountersPerWord = 16;
+  static const uint64_t kMaxCount = 15;
+
+  // Position of the i-th counter of the key
+  uint64_t CounterIndex(uint32_t hash, uint32_t i) const {
+    uint64_t h = hash * 0x9E3779B97F4A7C15ull;
+    uint64_t step = (h >> 32) | 1;
+    return (h + i * step) & mask_;
+  }
+
+  // Halves all counters
+  void Age();
+
+  // Number of counters minus one; the number is a power of 2
+  uint64_t mask_;
+  // Number of accesses after which the counters are halved
+  uint64_t sample_size_;
+  std::atomic<uint64_t> samples_;
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+}  // namespace rocksdb
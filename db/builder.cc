@@ -137,12 +137,22 @@ Status BuildTable(
         iter, internal_comparator.user_comparator(), &merge, kMaxSequenceNumber,
         &snapshots, earliest_write_conflict_snapshot, env,
         true /* internal key corruption is not ok */, range_del_agg.get());
+    // All the files built here go to level 0
+    std::unique_ptr<FileFilterSummary::Builder> filter_summary_builder;
+    if (ioptions.level0_filter_summary_bits_per_key > 0) {
+      filter_summary_builder.reset(new FileFilterSummary::Builder(
+          ioptions.level0_filter_summary_bits_per_key));
+    }
+
     c_iter.SeekToFirst();
     for (; c_iter.Valid(); c_iter.Next()) {
       const Slice& key = c_iter.key();
       const Slice& value = c_iter.value();
       builder->Add(key, value);
       meta->UpdateBoundaries(key, c_iter.ikey().sequence);
+      if (filter_summary_builder != nullptr) {
+        filter_summary_builder->Add(c_iter.ikey().user_key);
+      }
 
       // TODO(noetzli): Update stats after flush, too.
       if (io_priority == Env::IO_HIGH &&
@@ -168,6 +178,11 @@ Status BuildTable(
       uint64_t file_size = builder->FileSize();
       meta->fd.file_size = file_size;
       meta->marked_for_compaction = builder->NeedCompact();
+      // Range tombstones also hide keys of older files, so lookups must not
+      // skip a file that has them
+      if (filter_summary_builder != nullptr && range_del_agg->IsEmpty()) {
+        meta->filter_summary = filter_summary_builder->Finish();
+      }
       assert(meta->fd.GetFileSize() > 0);
       tp = builder->GetTableProperties();
       if (table_properties) {
@@ -452,8 +452,11 @@ bool Compaction::ShouldFormSubcompactions() const {
   if (immutable_cf_options_.max_subcompactions <= 1 || cfd_ == nullptr) {
     return false;
   }
+  // Outputs to level 0 must stay one file run, so that level-0 files keep
+  // disjoint, ordered sequence number ranges. Compactions into the next
+  // level can be split into key ranges from any start level.
   if (cfd_->ioptions()->compaction_style == kCompactionStyleLevel) {
-    return start_level_ == 0 && output_level_ > 0 && !IsOutputLevelEmpty();
+    return start_level_ < output_level_ && !IsOutputLevelEmpty();
   } else if (cfd_->ioptions()->compaction_style == kCompactionStyleUniversal) {
     return number_levels_ > 1 && output_level_ > 0;
   } else {
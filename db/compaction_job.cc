@@ -75,6 +75,18 @@ struct CompactionJob::SubcompactionState {
   // 'start' is inclusive, 'end' is exclusive, and nullptr means unbounded
   Slice *start, *end;
 
+  // Positions in CompactionJob::split_points_ if there are split points.
+  // All keys processed so far are before split point next_split, and the
+  // subcompaction ends at split point end_split, or is unbounded if that is
+  // split_points_.size(). next_split, end_split and split_done are protected
+  // by CompactionJob::split_mutex_; end_split only shrinks, when another
+  // thread takes over the rest of the range, and end is updated with it.
+  size_t first_split = 0;
+  size_t next_split = 0;
+  size_t end_split = 0;
+  // No more keys are processed, so the range can no longer be split
+  bool split_done = false;
+
   // The return status of this subcompaction
   Status status;
 
@@ -144,6 +156,10 @@ struct CompactionJob::SubcompactionState {
     compaction = std::move(o.compaction);
     start = std::move(o.start);
     end = std::move(o.end);
+    first_split = o.first_split;
+    next_split = o.next_split;
+    end_split = o.end_split;
+    split_done = o.split_done;
     status = std::move(o.status);
     outputs = std::move(o.outputs);
     outfile = std::move(o.outfile);
@@ -378,141 +394,236 @@ void CompactionJob::Prepare() {
 
     assert(sizes_.size() == boundaries_.size() + 1);
 
+    // Ranges taken over by idle threads are added as new subcompactions,
+    // which must not move the running ones
+    compact_->sub_compact_states.reserve(split_points_.size() + 1);
+    const Comparator* ucmp = c->column_family_data()->user_comparator();
+    size_t start_split = 0;
     for (size_t i = 0; i <= boundaries_.size(); i++) {
-      Slice* start = i == 0 ? nullptr : &boundaries_[i - 1];
-      Slice* end = i == boundaries_.size() ? nullptr : &boundaries_[i];
+      size_t end_split = split_points_.size();
+      if (i < boundaries_.size()) {
+        end_split = std::lower_bound(split_points_.begin(),
+                                     split_points_.end(), boundaries_[i],
+                                     [ucmp](const Slice& a, const Slice& b) {
+                                       return ucmp->Compare(a, b) < 0;
+                                     }) -
+                    split_points_.begin();
+      }
+      Slice* start = i == 0 ? nullptr : &split_points_[start_split - 1];
+      Slice* end =
+          end_split == split_points_.size() ? nullptr : &split_points_[end_split];
       compact_->sub_compact_states.emplace_back(c, start, end, sizes_[i]);
+      auto& sub_compact = compact_->sub_compact_states.back();
+      sub_compact.first_split = start_split;
+      sub_compact.next_split = start_split;
+      sub_compact.end_split = end_split;
+      start_split = end_split + 1;
     }
-    MeasureTime(stats_, NUM_SUBCOMPACTIONS_SCHEDULED,
-                compact_->sub_compact_states.size());
   } else {
     compact_->sub_compact_states.emplace_back(c, nullptr, nullptr);
   }
 }
 
-struct RangeWithSize {
-  Range range;
-  uint64_t size;
-
-  RangeWithSize(const Slice& a, const Slice& b, uint64_t s = 0)
-      : range(a, b), size(s) {}
-};
-
-// Generates a histogram representing potential divisions of key ranges from
-// the input. It adds the starting and/or ending keys of certain input files
-// to the working set and then finds the approximate size of data in between
-// each consecutive pair of slices. Then it divides these ranges into
-// consecutive groups such that each group has a similar size.
+// Generates the split points of the compaction and the boundaries of its
+// subcompactions. The table of each input file is asked for keys spread
+// evenly over its data (the keys of sampled index entries for block-based
+// tables), each with the approximate size of the data since the previous
+// one. Sorted together, these give the approximate size of the input below
+// any of them. Split points are picked among them at even size intervals,
+// several per subcompaction so that idle threads can take over part of the
+// range of busy subcompactions, and the boundaries are the split points that
+// divide the input into groups of similar size.
 void CompactionJob::GenSubcompactionBoundaries() {
   auto* c = compact_->compaction;
   auto* cfd = c->column_family_data();
   const Comparator* cfd_comparator = cfd->user_comparator();
-  std::vector<Slice> bounds;
-  int start_lvl = c->start_level();
   int out_lvl = c->output_level();
 
-  // Add the starting and/or ending key of certain input files as a potential
-  // boundary
+  // A file whose table cannot give anchors is a single range up to its
+  // largest key
+  const size_t kMaxAnchorsPerFile = 128;
+  std::vector<TableKeyAnchor> anchors;
   for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
-    int lvl = c->level(lvl_idx);
-    if (lvl >= start_lvl && lvl <= out_lvl) {
-      const LevelFilesBrief* flevel = c->input_levels(lvl_idx);
-      size_t num_files = flevel->num_files;
-
-      if (num_files == 0) {
-        continue;
-      }
-
-      if (lvl == 0) {
-        // For level 0 add the starting and ending key of each file since the
-        // files may have greatly differing key ranges (not range-partitioned)
-        for (size_t i = 0; i < num_files; i++) {
-          bounds.emplace_back(flevel->files[i].smallest_key);
-          bounds.emplace_back(flevel->files[i].largest_key);
-        }
-      } else {
-        // For all other levels add the smallest/largest key in the level to
-        // encompass the range covered by that level
-        bounds.emplace_back(flevel->files[0].smallest_key);
-        bounds.emplace_back(flevel->files[num_files - 1].largest_key);
-        if (lvl == out_lvl) {
-          // For the last level include the starting keys of all files since
-          // the last level is the largest and probably has the widest key
-          // range. Since it's range partitioned, the ending key of one file
-          // and the starting key of the next are very close (or identical).
-          for (size_t i = 1; i < num_files; i++) {
-            bounds.emplace_back(flevel->files[i].smallest_key);
-          }
-        }
+    const LevelFilesBrief* flevel = c->input_levels(lvl_idx);
+    for (size_t i = 0; i < flevel->num_files; i++) {
+      const FdWithKeyRange& f = flevel->files[i];
+      const size_t num_anchors = anchors.size();
+      Status s = cfd->table_cache()->GetKeyAnchors(
+          env_options_, cfd->internal_comparator(), f.fd, kMaxAnchorsPerFile,
+          &anchors);
+      if (!s.ok() || anchors.size() == num_anchors) {
+        anchors.erase(anchors.begin() + num_anchors, anchors.end());
+        anchors.emplace_back(f.largest_key, f.fd.GetFileSize());
       }
     }
   }
 
-  std::sort(bounds.begin(), bounds.end(),
-    [cfd_comparator] (const Slice& a, const Slice& b) -> bool {
-      return cfd_comparator->Compare(ExtractUserKey(a), ExtractUserKey(b)) < 0;
+  std::sort(anchors.begin(), anchors.end(),
+    [cfd_comparator] (const TableKeyAnchor& a, const TableKeyAnchor& b) {
+      return cfd_comparator->Compare(ExtractUserKey(a.internal_key),
+                                     ExtractUserKey(b.internal_key)) < 0;
     });
-  // Remove duplicated entries from bounds
-  bounds.erase(std::unique(bounds.begin(), bounds.end(),
-    [cfd_comparator] (const Slice& a, const Slice& b) -> bool {
-      return cfd_comparator->Compare(ExtractUserKey(a), ExtractUserKey(b)) == 0;
-    }), bounds.end());
-
-  // Combine consecutive pairs of boundaries into ranges with an approximate
-  // size of data covered by keys in that range
-  uint64_t sum = 0;
-  std::vector<RangeWithSize> ranges;
-  auto* v = cfd->current();
-  for (auto it = bounds.begin();;) {
-    const Slice a = *it;
-    it++;
 
-    if (it == bounds.end()) {
-      break;
+  // The distinct user keys of the anchors, with the approximate size of the
+  // input up to each
+  std::vector<std::pair<Slice, uint64_t>> points;
+  uint64_t sum = 0;
+  for (const auto& anchor : anchors) {
+    const Slice user_key = ExtractUserKey(anchor.internal_key);
+    sum += anchor.range_size;
+    if (!points.empty() &&
+        cfd_comparator->Compare(points.back().first, user_key) == 0) {
+      points.back().second = sum;
+    } else {
+      points.emplace_back(user_key, sum);
     }
-
-    const Slice b = *it;
-    uint64_t size = versions_->ApproximateSize(v, a, b, start_lvl, out_lvl + 1);
-    ranges.emplace_back(a, b, size);
-    sum += size;
   }
 
-  // Group the ranges into subcompactions
   const double min_file_fill_percent = 4.0 / 5;
   uint64_t max_output_files = static_cast<uint64_t>(
       std::ceil(sum / min_file_fill_percent /
                 c->mutable_cf_options()->MaxFileSizeForLevel(out_lvl)));
   uint64_t subcompactions =
-      std::min({static_cast<uint64_t>(ranges.size()),
+      std::min({static_cast<uint64_t>(points.size()),
                 static_cast<uint64_t>(db_options_.max_subcompactions),
                 max_output_files});
+  if (subcompactions <= 1) {
+    sizes_.emplace_back(sum);
+    return;
+  }
 
-  if (subcompactions > 1) {
-    double mean = sum * 1.0 / subcompactions;
-    // Greedily add ranges to the subcompaction until the sum of the ranges'
-    // sizes becomes >= the expected mean size of a subcompaction
-    sum = 0;
-    for (size_t i = 0; i < ranges.size() - 1; i++) {
-      sum += ranges[i].size;
-      if (subcompactions == 1) {
-        // If there's only one left to schedule then it goes to the end so no
-        // need to put an end boundary
-        continue;
-      }
-      if (sum >= mean) {
-        boundaries_.emplace_back(ExtractUserKey(ranges[i].range.limit));
-        sizes_.emplace_back(sum);
-        subcompactions--;
-        sum = 0;
+  // The last point is past all keys, so it cannot split anything
+  const uint64_t kSplitPointsPerSubcompaction = 8;
+  const double step =
+      static_cast<double>(sum) / (subcompactions * kSplitPointsPerSubcompaction);
+  double next_offset = step;
+  for (size_t i = 0; i + 1 < points.size(); i++) {
+    if (points[i].second >= next_offset) {
+      split_keys_.emplace_back(points[i].first.data(), points[i].first.size());
+      split_offsets_.push_back(points[i].second);
+      while (next_offset <= points[i].second) {
+        next_offset += step;
       }
     }
-    sizes_.emplace_back(sum + ranges.back().size);
-  } else {
-    // Only one range so its size is the total sum of sizes computed above
-    sizes_.emplace_back(sum);
+  }
+  split_offsets_.push_back(sum);
+  for (const auto& split_key : split_keys_) {
+    split_points_.emplace_back(split_key);
+  }
+
+  // Each boundary is the first split point past an even share of the input
+  uint64_t prev_offset = 0;
+  size_t split = 0;
+  for (uint64_t i = 1; i < subcompactions; i++) {
+    const double target = static_cast<double>(sum) * i / subcompactions;
+    while (split < split_points_.size() && split_offsets_[split] < target) {
+      split++;
+    }
+    if (split == split_points_.size()) {
+      break;
+    }
+    boundaries_.emplace_back(split_points_[split]);
+    sizes_.emplace_back(split_offsets_[split] - prev_offset);
+    prev_offset = split_offsets_[split];
+    split++;
+  }
+  sizes_.emplace_back(sum - prev_offset);
+  if (boundaries_.empty()) {
+    split_keys_.clear();
+    split_points_.clear();
+    split_offsets_.clear();
   }
 }
 
+void CompactionJob::RunSubcompactions(SubcompactionState* sub_compact) {
+  ProcessKeyValueCompaction(sub_compact);
+  while (sub_compact->status.ok() && !split_points_.empty()) {
+    sub_compact = StealSubcompaction();
+    if (sub_compact == nullptr) {
+      break;
+    }
+    TEST_SYNC_POINT_CALLBACK("CompactionJob::RunSubcompactions:Steal",
+                             sub_compact);
+    ProcessKeyValueCompaction(sub_compact);
+  }
+}
+
+CompactionJob::SubcompactionState* CompactionJob::StealSubcompaction() {
+  MutexLock l(&split_mutex_);
+  // The data a subcompaction has left is estimated from the split point it
+  // passed last
+  auto split_offset = [this](size_t split) -> uint64_t {
+    return split == 0 ? 0 : split_offsets_[split - 1];
+  };
+  SubcompactionState* victim = nullptr;
+  uint64_t most_left = 0;
+  for (auto& sub_compact : compact_->sub_compact_states) {
+    if (sub_compact.split_done ||
+        sub_compact.end_split <= sub_compact.next_split) {
+      continue;
+    }
+    const uint64_t left = split_offsets_[sub_compact.end_split] -
+                          split_offset(sub_compact.next_split);
+    if (victim == nullptr || left > most_left) {
+      victim = &sub_compact;
+      most_left = left;
+    }
+  }
+  if (victim == nullptr) {
+    return nullptr;
+  }
+
+  // Take the upper half of what is left
+  const uint64_t middle = split_offset(victim->next_split) + most_left / 2;
+  size_t split = victim->next_split;
+  while (split + 1 < victim->end_split && split_offsets_[split] < middle) {
+    split++;
+  }
+  assert(compact_->sub_compact_states.size() <
+         compact_->sub_compact_states.capacity());
+  compact_->sub_compact_states.emplace_back(
+      compact_->compaction, &split_points_[split], victim->end,
+      split_offsets_[victim->end_split] - split_offsets_[split]);
+  SubcompactionState* stolen = &compact_->sub_compact_states.back();
+  stolen->first_split = split + 1;
+  stolen->next_split = split + 1;
+  stolen->end_split = victim->end_split;
+  victim->end_split = split;
+  victim->end = &split_points_[split];
+  return stolen;
+}
+
+void CompactionJob::StopSplitting(SubcompactionState* sub_compact) {
+  if (!split_points_.empty()) {
+    MutexLock l(&split_mutex_);
+    sub_compact->split_done = true;
+  }
+}
+
+bool CompactionJob::IsPastSubcompactionEnd(SubcompactionState* sub_compact,
+                                           const Slice& user_key) {
+  const Comparator* ucmp =
+      sub_compact->compaction->column_family_data()->user_comparator();
+  if (split_points_.empty()) {
+    return sub_compact->end != nullptr &&
+           ucmp->Compare(user_key, *sub_compact->end) >= 0;
+  }
+  // Only this thread moves next_split, so checking it needs no lock
+  if (sub_compact->next_split == split_points_.size() ||
+      ucmp->Compare(user_key, split_points_[sub_compact->next_split]) < 0) {
+    return false;
+  }
+  MutexLock l(&split_mutex_);
+  while (sub_compact->next_split < sub_compact->end_split &&
+         ucmp->Compare(user_key, split_points_[sub_compact->next_split]) >=
+             0) {
+    sub_compact->next_split++;
+  }
+  return sub_compact->next_split == sub_compact->end_split &&
+         sub_compact->end_split < split_points_.size() &&
+         ucmp->Compare(user_key, split_points_[sub_compact->end_split]) >= 0;
+}
+
 Status CompactionJob::Run() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_RUN);
@@ -527,20 +638,35 @@ Status CompactionJob::Run() {
   // Launch a thread for each of subcompactions 1...num_threads-1
   std::vector<port::Thread> thread_pool;
   thread_pool.reserve(num_threads - 1);
-  for (size_t i = 1; i < compact_->sub_compact_states.size(); i++) {
-    thread_pool.emplace_back(&CompactionJob::ProcessKeyValueCompaction, this,
+  for (size_t i = 1; i < num_threads; i++) {
+    thread_pool.emplace_back(&CompactionJob::RunSubcompactions, this,
                              &compact_->sub_compact_states[i]);
   }
 
   // Always schedule the first subcompaction (whether or not there are also
   // others) in the current thread to be efficient with resources
-  ProcessKeyValueCompaction(&compact_->sub_compact_states[0]);
+  RunSubcompactions(&compact_->sub_compact_states[0]);
 
   // Wait for all other threads (if there are any) to finish execution
   for (auto& thread : thread_pool) {
     thread.join();
   }
 
+  // Subcompactions taken over by idle threads were added at the end
+  if (compact_->sub_compact_states.size() > num_threads) {
+    std::sort(compact_->sub_compact_states.begin(),
+              compact_->sub_compact_states.end(),
+              [](const SubcompactionState& a, const SubcompactionState& b) {
+                return a.first_split < b.first_split;
+              });
+  }
+  if (compact_->compaction->ShouldFormSubcompactions()) {
+    // Counted once they are done, including the ranges taken over by idle
+    // threads
+    MeasureTime(stats_, NUM_SUBCOMPACTIONS_SCHEDULED,
+                compact_->sub_compact_states.size());
+  }
+
   if (output_directory_) {
     output_directory_->Fsync();
   }
@@ -732,7 +858,6 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   TEST_SYNC_POINT("CompactionJob::Run():Inprogress");
 
   Slice* start = sub_compact->start;
-  Slice* end = sub_compact->end;
   if (start != nullptr) {
     IterKey start_iter;
     start_iter.SetInternalKey(*start, kMaxSequenceNumber, kValueTypeForSeek);
@@ -784,8 +909,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
 
     // If an end key (exclusive) is specified, check if the current key is
     // >= than it and exit if it is because the iterator is out of its range
-    if (end != nullptr &&
-        cfd->user_comparator()->Compare(c_iter->user_key(), *end) >= 0) {
+    if (IsPastSubcompactionEnd(sub_compact, c_iter->user_key())) {
       break;
     }
     if (c_iter_stats.num_input_records % kRecordStatsEvery ==
@@ -893,6 +1017,9 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       const Slice* next_key = nullptr;
       if (c_iter->Valid()) {
         next_key = &c_iter->key();
+      } else {
+        // The file extends to the end of the subcompaction
+        StopSplitting(sub_compact);
       }
       CompactionIterationStats range_del_out_stats;
       status = FinishCompactionOutputFile(input_status, sub_compact,
@@ -939,6 +1066,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     status = c_iter->status();
   }
 
+  StopSplitting(sub_compact);
+
   if (status.ok() && sub_compact->builder == nullptr &&
       sub_compact->outputs.size() == 0 &&
       range_del_agg->ShouldAddTombstones(bottommost_level_)) {
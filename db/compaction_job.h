@@ -97,6 +97,17 @@ class CompactionJob {
   // Call compaction filter. Then iterate through input and compact the
   // kv-pairs
   void ProcessKeyValueCompaction(SubcompactionState* sub_compact);
+  // Runs sub_compact, then the key ranges taken from busier subcompactions
+  void RunSubcompactions(SubcompactionState* sub_compact);
+  // Creates a subcompaction for the upper part of the split points that the
+  // subcompaction with the most data left has not reached yet, which then
+  // ends at the first of them. Returns nullptr if there is none left.
+  SubcompactionState* StealSubcompaction();
+  // Returns true if user_key is at or past the end of the subcompaction
+  bool IsPastSubcompactionEnd(SubcompactionState* sub_compact,
+                              const Slice& user_key);
+  // Keeps the end of sub_compact from moving once no more keys are processed
+  void StopSplitting(SubcompactionState* sub_compact);
 
   Status FinishCompactionOutputFile(
       const Status& input_status, SubcompactionState* sub_compact,
@@ -162,6 +173,15 @@ class CompactionJob {
   std::vector<Slice> boundaries_;
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
+  // The user keys subcompactions may start or end at, in order, if there is
+  // more than one subcompaction. boundaries_ is a subset of them.
+  std::vector<std::string> split_keys_;
+  std::vector<Slice> split_points_;
+  // The approximate size of the input up to each split point, followed by
+  // the size of the whole input
+  std::vector<uint64_t> split_offsets_;
+  // Protects the split point positions of the subcompactions while they run
+  port::Mutex split_mutex_;
 };
 
 }  // namespace rocksdb
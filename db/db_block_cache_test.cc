@@ -344,6 +344,18 @@ class MockCache : public LRUCache {
     }
     return LRUCache::Insert(key, value, charge, deleter, handle, priority);
   }
+
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const TierHelper* helper, size_t charge,
+                                  Handle** handle, Priority priority) override {
+    if (priority == Priority::LOW) {
+      low_pri_insert_count++;
+    } else {
+      high_pri_insert_count++;
+    }
+    return LRUCache::InsertWithHelper(key, value, helper, charge, handle,
+                                      priority);
+  }
 };
 
 uint32_t MockCache::high_pri_insert_count = 0;
@@ -408,6 +420,87 @@ TEST_F(DBBlockCacheTest, IndexAndFilterBlocksCachePriority) {
   }
 }
 
+TEST_F(DBBlockCacheTest, MetadataCache) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  BlockBasedTableOptions table_options;
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  table_options.metadata_cache = NewLRUCache(1 << 20);
+  table_options.metadata_cache_partitions_max_level = 0;
+  table_options.index_type = BlockBasedTableOptions::kTwoLevelIndexSearch;
+  table_options.partition_filters = true;
+  table_options.metadata_block_size = 128;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), DummyString(100)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+
+  // Top-level index and filter blocks went to the metadata cache
+  uint64_t capacity, usage, pinned_usage;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kMetadataCacheCapacity,
+                                  &capacity));
+  ASSERT_EQ(1 << 20, capacity);
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kMetadataCacheUsage, &usage));
+  ASSERT_GT(usage, 0);
+  ASSERT_EQ(0, table_options.block_cache->GetUsage());
+
+  // Partitions of the L0 file are pinned in the metadata cache too
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(DummyString(100), Get(Key(i)));
+  }
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kMetadataCacheUsage, &usage));
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kMetadataCachePinnedUsage,
+                                  &pinned_usage));
+  ASSERT_EQ(usage, pinned_usage);
+  const uint64_t l0_usage = usage;
+  const size_t data_usage = table_options.block_cache->GetUsage();
+  ASSERT_GT(data_usage, 0);
+
+  // Partitions of files below L0 go to the block cache
+  MoveFilesToLevel(2);
+  table_options.metadata_cache = NewLRUCache(1 << 20);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_EQ(1, NumTableFilesAtLevel(2));
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(DummyString(100), Get(Key(i)));
+  }
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kMetadataCacheUsage, &usage));
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kMetadataCachePinnedUsage,
+                                  &pinned_usage));
+  ASSERT_EQ(usage, pinned_usage);
+  ASSERT_GT(usage, 0);
+  ASSERT_LT(usage, l0_usage);
+  ASSERT_GT(table_options.block_cache->GetUsage(), data_usage);
+
+  // Tables whose metadata does not fit keep it in the block cache
+  table_options.block_cache = NewLRUCache(8 << 20);
+  table_options.metadata_cache = NewLRUCache(1, 0);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_EQ(DummyString(100), Get(Key(0)));
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kMetadataCacheUsage, &usage));
+  ASSERT_EQ(0, usage);
+  ASSERT_GT(table_options.block_cache->GetUsage(), 0);
+
+  // No metadata cache, no property
+  options.table_factory.reset(new BlockBasedTableFactory());
+  Reopen(options);
+  ASSERT_FALSE(
+      db_->GetIntProperty(DB::Properties::kMetadataCacheUsage, &usage));
+}
+
 TEST_F(DBBlockCacheTest, ParanoidFileChecks) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
@@ -570,6 +663,154 @@ TEST_F(DBBlockCacheTest, CompressedCache) {
   }
 }
 
+#ifdef LZ4
+TEST_F(DBBlockCacheTest, CompressedTier) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = rocksdb::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 4096;
+  // Room for about half of the data blocks, uncompressed
+  LRUCacheOptions cache_opts;
+  cache_opts.capacity = 64 << 10;
+  cache_opts.num_shard_bits = 0;
+  cache_opts.compressed_tier_ratio = 0.5;
+  table_options.block_cache = NewLRUCache(cache_opts);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'a' + i % 26)));
+  }
+  ASSERT_OK(Flush());
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(std::string(100, 'a' + i % 26), Get(Key(i)));
+  }
+  const uint64_t misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+  ASSERT_GT(misses, 20);
+  ASSERT_LE(table_options.block_cache->GetUsage(), cache_opts.capacity);
+
+  // The evicted blocks are read again from the compressed tier
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(std::string(100, 'a' + i % 26), Get(Key(i)));
+  }
+  ASSERT_EQ(misses, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  ASSERT_LE(table_options.block_cache->GetUsage(), cache_opts.capacity);
+}
+#endif  // LZ4
+
+TEST_F(DBBlockCacheTest, WarmUpFromDumpedKeys) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = rocksdb::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 4096;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'a' + i % 26)));
+  }
+  ASSERT_OK(Flush());
+  // Bring the blocks of the first half of the keys into the cache
+  for (int i = 0; i < kNumKeys / 2; i++) {
+    ASSERT_EQ(std::string(100, 'a' + i % 26), Get(Key(i)));
+  }
+  const std::string warmup_file = dbname_ + "/block_cache_warmup";
+  ASSERT_OK(db_->DumpBlockCacheKeys(warmup_file));
+
+  rocksdb::SyncPoint::GetInstance()->LoadDependency(
+      {{"DBImpl::BGWorkWarmup:end", "DBBlockCacheTest::WarmUpFromDumpedKeys:1"}});
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.block_cache_warmup_file = warmup_file;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+  TEST_SYNC_POINT("DBBlockCacheTest::WarmUpFromDumpedKeys:1");
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+
+  // The warm-up misses the cache on every block it loads
+  const uint64_t warmed_up = TestGetTickerCount(options, BLOCK_CACHE_DATA_ADD);
+  ASSERT_GT(warmed_up, 0);
+  ASSERT_EQ(warmed_up, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  for (int i = 0; i < kNumKeys / 2; i++) {
+    ASSERT_EQ(std::string(100, 'a' + i % 26), Get(Key(i)));
+  }
+  ASSERT_EQ(warmed_up, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  // The other blocks were not loaded
+  for (int i = kNumKeys / 2; i < kNumKeys; i++) {
+    ASSERT_EQ(std::string(100, 'a' + i % 26), Get(Key(i)));
+  }
+  ASSERT_GT(TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS), warmed_up);
+
+  // A damaged file is skipped
+  std::string contents;
+  ASSERT_OK(ReadFileToString(env_, warmup_file, &contents));
+  contents[contents.size() / 2] ^= 0x55;
+  ASSERT_OK(WriteStringToFile(env_, contents, warmup_file));
+  Reopen(options);
+  ASSERT_EQ(std::string(100, 'a'), Get(Key(0)));
+}
+
+TEST_F(DBBlockCacheTest, WarmUpYieldsToQueuedJobs) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int kNumFiles = 3;
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+    ASSERT_OK(Flush());
+  }
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_EQ("value", Get(Key(i)));
+  }
+  const std::string warmup_file = dbname_ + "/block_cache_warmup";
+  ASSERT_OK(db_->DumpBlockCacheKeys(warmup_file));
+
+  int yields = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCallWarmup:Yield", [&](void* arg) { yields++; });
+  rocksdb::SyncPoint::GetInstance()->LoadDependency(
+      {{"DBImpl::BGWorkWarmup:end",
+        "DBBlockCacheTest::WarmUpYieldsToQueuedJobs:1"}});
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  // Hold the only thread of the pool, so that another job gets queued behind
+  // the warm-up job
+  env_->SetBackgroundThreads(1, Env::LOW);
+  test::SleepingBackgroundTask busy_task;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &busy_task,
+                 Env::Priority::LOW);
+  busy_task.WaitUntilSleeping();
+  options.block_cache_warmup_file = warmup_file;
+  Reopen(options);
+  test::SleepingBackgroundTask queued_task;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &queued_task,
+                 Env::Priority::LOW);
+  busy_task.WakeUp();
+  busy_task.WaitUntilDone();
+
+  // The queued job runs before the warm-up job is done
+  queued_task.WaitUntilSleeping();
+  ASSERT_EQ(1, yields);
+  queued_task.WakeUp();
+  queued_task.WaitUntilDone();
+  TEST_SYNC_POINT("DBBlockCacheTest::WarmUpYieldsToQueuedJobs:1");
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(1, yields);
+}
+
 #endif  // ROCKSDB_LITE
 
 }  // namespace rocksdb
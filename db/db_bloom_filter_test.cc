@@ -165,6 +165,118 @@ TEST_F(DBBloomFilterTest, GetFilterByPrefixBloom) {
   }
 }
 
+TEST_F(DBBloomFilterTest, SeparatePrefixFilter) {
+  for (bool partition_filters : {true, false}) {
+    for (int prefix_filter_bits : {0, 20}) {
+      Options options = last_options_;
+      options.prefix_extractor.reset(NewFixedPrefixTransform(3));
+      options.statistics = rocksdb::CreateDBStatistics();
+      BlockBasedTableOptions bbto;
+      bbto.filter_policy.reset(NewBloomFilterPolicy(20, false));
+      bbto.prefix_filter_bits_per_key = prefix_filter_bits;
+      if (partition_filters) {
+        bbto.partition_filters = true;
+        bbto.index_type =
+            BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+      }
+      options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+      DestroyAndReopen(options);
+
+      ASSERT_OK(Put("aaa1", "v1"));
+      ASSERT_OK(Put("aaa2", "v2"));
+      ASSERT_OK(Put("ccc1", "v3"));
+      ASSERT_OK(Flush());
+
+      ASSERT_EQ("v1", Get("aaa1"));
+      ASSERT_EQ("NOT_FOUND", Get("ccc2"));
+      ASSERT_EQ(1, TestGetTickerCount(options, BLOOM_FILTER_USEFUL));
+      // The whole key filter only knows the prefixes if they share it
+      ASSERT_EQ("NOT_FOUND", Get("aaa"));
+      ASSERT_EQ(prefix_filter_bits > 0 ? 2 : 1,
+                TestGetTickerCount(options, BLOOM_FILTER_USEFUL));
+
+      // Prefix seeks are answered either way
+      std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+      iter->Seek("aaa");
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ("aaa1", iter->key().ToString());
+      ASSERT_EQ(0, TestGetTickerCount(options, BLOOM_FILTER_PREFIX_USEFUL));
+      iter->Seek("bbb");
+      ASSERT_FALSE(iter->Valid());
+      ASSERT_EQ(1, TestGetTickerCount(options, BLOOM_FILTER_PREFIX_USEFUL));
+      ASSERT_EQ(2, TestGetTickerCount(options, BLOOM_FILTER_PREFIX_CHECKED));
+    }
+  }
+}
+
+TEST_F(DBBloomFilterTest, Level0FilterSummary) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.disable_auto_compactions = true;
+  options.level0_filter_summary_bits_per_key = 20;
+  DestroyAndReopen(options);
+
+  // The key ranges of all files overlap, so only the summaries tell them
+  // apart
+  const int kNumFiles = 10;
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_OK(Put("a", "v"));
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+    ASSERT_OK(Put("z", "v"));
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(ToString(kNumFiles), FilesPerLevel());
+
+  // The summaries count as table reader memory
+  std::vector<std::vector<FileMetaData>> files;
+  dbfull()->TEST_GetFilesMetaData(db_->DefaultColumnFamily(), &files);
+  size_t summaries_mem = 0;
+  for (const auto& file : files[0]) {
+    ASSERT_NE(nullptr, file.filter_summary);
+    summaries_mem += file.filter_summary->ApproximateMemoryUsage();
+  }
+  uint64_t readers_mem = 0;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kEstimateTableReadersMem,
+                                  &readers_mem));
+  ASSERT_GE(readers_mem, summaries_mem);
+
+  // Each lookup only reads the file that has its key
+  uint64_t skipped = 0;
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+    // Files are checked newest first
+    skipped += kNumFiles - 1 - i;
+  }
+  ASSERT_GE(TestGetTickerCount(options, L0_FILTER_SUMMARY_USEFUL),
+            skipped - 2);
+  ASSERT_EQ("NOT_FOUND", Get(Key(50)));
+  ASSERT_GE(TestGetTickerCount(options, L0_FILTER_SUMMARY_USEFUL),
+            skipped + kNumFiles - 3);
+
+  // Only flushes build summaries, not compactions into level 0. The
+  // summaries of the files from before the reopen are gone.
+  options.compaction_style = kCompactionStyleUniversal;
+  options.num_levels = 1;
+  Reopen(options);
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("1", FilesPerLevel());
+  ASSERT_OK(Put("a", "v"));
+  ASSERT_OK(Put(Key(200), "v"));
+  ASSERT_OK(Put("z", "v"));
+  ASSERT_OK(Flush());
+  uint64_t useful = TestGetTickerCount(options, L0_FILTER_SUMMARY_USEFUL);
+  ASSERT_EQ("v2", Get(Key(2)));
+  ASSERT_EQ("NOT_FOUND", Get(Key(50)));
+  ASSERT_EQ(useful + 2, TestGetTickerCount(options, L0_FILTER_SUMMARY_USEFUL));
+
+  // A range deletion covers keys of older files, its file is always read
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(0), Key(1)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("NOT_FOUND", Get(Key(0)));
+  ASSERT_EQ("v1", Get(Key(1)));
+}
+
 TEST_F(DBBloomFilterTest, WholeKeyFilterProp) {
   for (bool partition_filters : {true, false}) {
     Options options = last_options_;
@@ -1099,6 +1211,80 @@ TEST_F(DBBloomFilterTest, OptimizeFiltersForHits) {
             TestGetTickerCount(options, BLOCK_CACHE_ADD));
 }
 
+TEST_F(DBBloomFilterTest, RangeFilter) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.range_filter_bits_per_key = 20;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Two overlapping L0 files; only the second one has keys starting with "b"
+  ASSERT_OK(Put("a1", "v"));
+  ASSERT_OK(Put("z1", "v"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("b1", "v"));
+  ASSERT_OK(Put("b2", "v"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("2", FilesPerLevel());
+
+  Slice upper_bound("c");
+  ReadOptions ro;
+  ro.iterate_upper_bound = &upper_bound;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+  iter->Seek("b");
+  ASSERT_EQ(2, TestGetTickerCount(options, RANGE_FILTER_CHECKED));
+  ASSERT_EQ(1, TestGetTickerCount(options, RANGE_FILTER_USEFUL));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("b1", iter->key().ToString());
+  iter->Next();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("b2", iter->key().ToString());
+  iter->Next();
+  ASSERT_FALSE(iter->Valid());
+
+  // Turning back positions the skipped table before the current key
+  iter->Seek("b");
+  ASSERT_TRUE(iter->Valid());
+  iter->Prev();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("a1", iter->key().ToString());
+  ASSERT_OK(iter->status());
+
+  // SeekToLast() stops below the bound the caller set last
+  upper_bound = Slice("a0");
+  iter.reset(db_->NewIterator(ro));
+  iter->SeekToLast();
+  ASSERT_FALSE(iter->Valid());
+  upper_bound = Slice("c");
+  iter->SeekToLast();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("b2", iter->key().ToString());
+
+  // Without an upper bound every table is read
+  uint64_t checked = TestGetTickerCount(options, RANGE_FILTER_CHECKED);
+  iter.reset(db_->NewIterator(ReadOptions()));
+  iter->Seek("b");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("b1", iter->key().ToString());
+  ASSERT_EQ(checked, TestGetTickerCount(options, RANGE_FILTER_CHECKED));
+  iter.reset();
+
+  // Range tombstones could hide keys of other tables, no filter then
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "b2",
+                             "b3"));
+  ASSERT_OK(Put("b0", "v"));
+  ASSERT_OK(Flush());
+  iter.reset(db_->NewIterator(ro));
+  iter->Seek("b1");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("b1", iter->key().ToString());
+  iter->Next();
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_EQ(checked + 2, TestGetTickerCount(options, RANGE_FILTER_CHECKED));
+}
+
 #endif  // ROCKSDB_LITE
 
 }  // namespace rocksdb
@@ -295,15 +295,16 @@ TEST_F(DBCompactionTest, TestTableReaderForCompaction) {
       Flush();
       dbfull()->TEST_WaitForCompact();
       // preloading iterator issues one table cache lookup and create
-      // a new table reader.
-      ASSERT_EQ(num_table_cache_lookup, 1);
+      // a new table reader. Pinning the reader of the new file issues
+      // another lookup.
+      ASSERT_EQ(num_table_cache_lookup, 2);
       ASSERT_EQ(num_new_table_reader, 1);
 
       num_table_cache_lookup = 0;
       num_new_table_reader = 0;
       ASSERT_EQ(Key(k), Get(Key(k)));
-      // lookup iterator from table cache and no need to create a new one.
-      ASSERT_EQ(num_table_cache_lookup, 1);
+      // the pinned table reader is used without a table cache lookup.
+      ASSERT_EQ(num_table_cache_lookup, 0);
       ASSERT_EQ(num_new_table_reader, 0);
     }
   }
@@ -313,10 +314,10 @@ TEST_F(DBCompactionTest, TestTableReaderForCompaction) {
   Flush();
   dbfull()->TEST_WaitForCompact();
   // Preloading iterator issues one table cache lookup and creates
-  // a new table reader. One file is created for flush and one for compaction.
-  // Compaction inputs make no table cache look-up for data/range deletion
-  // iterators
-  ASSERT_EQ(num_table_cache_lookup, 2);
+  // a new table reader, and pinning the reader issues another. One file is
+  // created for flush and one for compaction. Compaction inputs make no table
+  // cache look-up for data/range deletion iterators
+  ASSERT_EQ(num_table_cache_lookup, 4);
   // Create new iterator for:
   // (1) 1 for verifying flush results
   // (2) 3 for compaction input files
@@ -326,7 +327,7 @@ TEST_F(DBCompactionTest, TestTableReaderForCompaction) {
   num_table_cache_lookup = 0;
   num_new_table_reader = 0;
   ASSERT_EQ(Key(1), Get(Key(1)));
-  ASSERT_EQ(num_table_cache_lookup, 1);
+  ASSERT_EQ(num_table_cache_lookup, 0);
   ASSERT_EQ(num_new_table_reader, 0);
 
   num_table_cache_lookup = 0;
@@ -337,15 +338,16 @@ TEST_F(DBCompactionTest, TestTableReaderForCompaction) {
   cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
   db_->CompactRange(cro, nullptr, nullptr);
   // Only verifying compaction outputs issues one table cache lookup
-  // for both data block and range deletion block).
-  ASSERT_EQ(num_table_cache_lookup, 1);
+  // for both data block and range deletion block). The reader of the output
+  // is pinned once it is written and again once it is moved to level 2.
+  ASSERT_EQ(num_table_cache_lookup, 3);
   // One for compaction input, one for verifying compaction results.
   ASSERT_EQ(num_new_table_reader, 2);
 
   num_table_cache_lookup = 0;
   num_new_table_reader = 0;
   ASSERT_EQ(Key(1), Get(Key(1)));
-  ASSERT_EQ(num_table_cache_lookup, 1);
+  ASSERT_EQ(num_table_cache_lookup, 0);
   ASSERT_EQ(num_new_table_reader, 0);
 
   rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
@@ -2493,6 +2495,111 @@ TEST_F(DBCompactionTest, SuggestCompactRangeNoTwoLevel0Compactions) {
 }
 
 
+TEST_F(DBCompactionTest, UniversalSubcompactionsStealRanges) {
+  Options options = CurrentOptions();
+  options.compaction_style = kCompactionStyleUniversal;
+  options.num_levels = 4;
+  options.compression = kNoCompression;
+  options.write_buffer_size = 10 << 20;
+  options.target_file_size_base = 64 << 10;
+  options.level0_file_num_compaction_trigger = 100;
+  options.max_subcompactions = 4;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 2000; i++) {
+    values.push_back(RandomString(&rnd, 500));
+  }
+  for (int f = 0; f < 4; f++) {
+    for (int i = f; i < 2000; i += 4) {
+      ASSERT_OK(Put(Key(i), values[i]));
+    }
+    ASSERT_OK(Flush());
+  }
+
+  // The first subcompaction to start finishes its range while the others are
+  // held back until it takes over part of theirs
+  rocksdb::SyncPoint::GetInstance()->LoadDependency(
+      {{"CompactionJob::RunSubcompactions:Steal",
+        "DBCompactionTest::UniversalSubcompactionsStealRanges:HeldBack"}});
+  std::atomic<int> num_started(0);
+  std::atomic<int> num_stolen(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::Run():Inprogress", [&](void* arg) {
+        if (num_started++ > 0) {
+          TEST_SYNC_POINT(
+              "DBCompactionTest::UniversalSubcompactionsStealRanges:HeldBack");
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::RunSubcompactions:Steal",
+      [&](void* arg) { num_stolen++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_GT(NumTableFilesAtLevel(options.num_levels - 1), 1);
+  ASSERT_GT(num_stolen.load(), 0);
+  ASSERT_GT(num_started.load(), num_stolen.load() + 1);
+  for (int i = 0; i < 2000; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+}
+
+TEST_F(DBCompactionTest, LevelSubcompactionsBelowLevel0) {
+  Options options = CurrentOptions();
+  options.compression = kNoCompression;
+  options.write_buffer_size = 10 << 20;
+  options.target_file_size_base = 64 << 10;
+  options.disable_auto_compactions = true;
+  options.max_subcompactions = 4;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 2000; i++) {
+    values.push_back(RandomString(&rnd, 500));
+  }
+  // Every other key in level 2, and the others in level 1
+  for (int i = 0; i < 2000; i += 2) {
+    ASSERT_OK(Put(Key(i), values[i]));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  for (int i = 1; i < 2000; i += 2) {
+    ASSERT_OK(Put(Key(i), values[i]));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  ASSERT_EQ("0,1,1", FilesPerLevel());
+
+  options.statistics = rocksdb::CreateDBStatistics();
+  Reopen(options);
+  std::atomic<int> num_started(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::Run():Inprogress", [&](void* arg) { num_started++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_OK(dbfull()->TEST_CompactRange(1, nullptr, nullptr));
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(0, NumTableFilesAtLevel(1));
+  ASSERT_GT(num_started.load(), 1);
+  // Ranges taken over by idle threads are counted too
+  HistogramData subcompactions;
+  options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                    &subcompactions);
+  ASSERT_EQ(num_started.load(), static_cast<int>(subcompactions.average));
+  for (int i = 0; i < 2000; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+}
+
+
 TEST_P(DBCompactionTestWithParam, ForceBottommostLevelCompaction) {
   int32_t trivial_move = 0;
   int32_t non_trivial_move = 0;
@@ -174,6 +174,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname)
       bg_flush_scheduled_(0),
       num_running_flushes_(0),
       bg_purge_scheduled_(0),
+      bg_warmup_scheduled_(0),
       disable_delete_obsolete_files_(0),
       delete_obsolete_files_last_run_(env_->NowMicros()),
       last_stats_dump_time_microsec_(0),
@@ -259,7 +260,7 @@ DBImpl::~DBImpl() {
 
   // Wait for background work to finish
   while (bg_compaction_scheduled_ || bg_flush_scheduled_ ||
-         bg_purge_scheduled_) {
+         bg_purge_scheduled_ || bg_warmup_scheduled_) {
     TEST_SYNC_POINT("DBImpl::~DBImpl:WaitJob");
     bg_cv_.Wait();
   }
@@ -747,6 +748,170 @@ InternalIterator* DBImpl::NewInternalIterator(
                              range_del_agg);
 }
 
+namespace {
+// The block cache warm-up file written by DumpBlockCacheKeys() is
+//   magic: fixed32
+//   for each SST file: file number: varint64, number of blocks: varint32,
+//                      block handles
+//   masked crc32c of the above: fixed32
+const uint32_t kBlockCacheWarmupMagic = 0xb1cca0e1;
+
+Status DecodeBlockCacheWarmupFile(
+    const std::string& contents,
+    std::unordered_map<uint64_t, std::vector<BlockHandle>>* blocks) {
+  if (contents.size() < 2 * sizeof(uint32_t)) {
+    return Status::Corruption("block cache warm-up file too short");
+  }
+  const size_t body_size = contents.size() - sizeof(uint32_t);
+  const uint32_t crc = crc32c::Unmask(DecodeFixed32(&contents[body_size]));
+  if (crc32c::Value(contents.data(), body_size) != crc) {
+    return Status::Corruption("block cache warm-up file checksum mismatch");
+  }
+  Slice input(contents.data(), body_size);
+  uint32_t magic = 0;
+  if (!GetFixed32(&input, &magic) || magic != kBlockCacheWarmupMagic) {
+    return Status::Corruption("bad block cache warm-up file magic");
+  }
+  while (!input.empty()) {
+    uint64_t file_number = 0;
+    uint32_t count = 0;
+    if (!GetVarint64(&input, &file_number) || !GetVarint32(&input, &count)) {
+      return Status::Corruption("bad block cache warm-up file entry");
+    }
+    auto& handles = (*blocks)[file_number];
+    for (uint32_t i = 0; i < count; i++) {
+      BlockHandle handle;
+      Status s = handle.DecodeFrom(&input);
+      if (!s.ok()) {
+        return s;
+      }
+      handles.push_back(handle);
+    }
+  }
+  return Status::OK();
+}
+}  // namespace
+
+struct DBImpl::WarmupArg {
+  explicit WarmupArg(DBImpl* _db) : db(_db) {}
+
+  DBImpl* db;
+  bool loaded = false;
+  std::unordered_map<uint64_t, std::vector<BlockHandle>> blocks;
+  // The current versions, pinned so that their files stay alive while the
+  // blocks are read without the mutex
+  std::vector<std::pair<ColumnFamilyData*, Version*>> pinned;
+  std::vector<std::pair<ColumnFamilyData*, FileMetaData*>> files;
+  size_t next_file = 0;
+  size_t num_blocks = 0;
+};
+
+void DBImpl::ScheduleBlockCacheWarmup() {
+  mutex_.AssertHeld();
+  assert(opened_successfully_);
+
+  // No tag, so that the compactions unscheduled by ~DBImpl are counted right
+  bg_warmup_scheduled_++;
+  env_->Schedule(&DBImpl::BGWorkWarmup, new WarmupArg(this),
+                 Env::Priority::LOW, nullptr);
+}
+
+void DBImpl::BGWorkWarmup(void* arg) {
+  IOSTATS_SET_THREAD_POOL_ID(Env::Priority::LOW);
+  TEST_SYNC_POINT("DBImpl::BGWorkWarmup:start");
+  WarmupArg* wa = reinterpret_cast<WarmupArg*>(arg);
+  if (wa->db->BackgroundCallWarmup(wa)) {
+    TEST_SYNC_POINT("DBImpl::BGWorkWarmup:end");
+  }
+}
+
+bool DBImpl::BackgroundCallWarmup(WarmupArg* arg) {
+  if (!arg->loaded) {
+    arg->loaded = true;
+    const std::string& fname = immutable_db_options_.block_cache_warmup_file;
+    std::string contents;
+    Status s = ReadFileToString(env_, fname, &contents);
+    if (s.ok()) {
+      s = DecodeBlockCacheWarmupFile(contents, &arg->blocks);
+    }
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Skipping block cache warm-up from %s: %s",
+                     fname.c_str(), s.ToString().c_str());
+    }
+
+    InstrumentedMutexLock l(&mutex_);
+    if (!arg->blocks.empty()) {
+      for (auto cfd : *versions_->GetColumnFamilySet()) {
+        if (cfd->IsDropped()) {
+          continue;
+        }
+        Version* current = cfd->current();
+        cfd->Ref();
+        current->Ref();
+        arg->pinned.emplace_back(cfd, current);
+        auto* vstorage = current->storage_info();
+        for (int level = 0; level < vstorage->num_levels(); level++) {
+          for (FileMetaData* f : vstorage->LevelFiles(level)) {
+            if (arg->blocks.count(f->fd.GetNumber()) > 0) {
+              arg->files.emplace_back(cfd, f);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // The job runs in the compaction pool, so it reads one file at a time and
+  // then lets the jobs queued meanwhile run first
+  size_t num_files = 0;
+  for (; arg->next_file < arg->files.size(); arg->next_file++) {
+    if (shutting_down_.load(std::memory_order_acquire)) {
+      break;
+    }
+    if (num_files > 0 && env_->GetThreadPoolQueueLen(Env::Priority::LOW) > 0) {
+      TEST_SYNC_POINT("DBImpl::BackgroundCallWarmup:Yield");
+      env_->Schedule(&DBImpl::BGWorkWarmup, arg, Env::Priority::LOW, nullptr);
+      return false;
+    }
+    num_files++;
+    const auto& file = arg->files[arg->next_file];
+    ColumnFamilyData* cfd = file.first;
+    const auto& handles = arg->blocks[file.second->fd.GetNumber()];
+    Status s = cfd->table_cache()->WarmUpDataBlocks(
+        env_options_, cfd->internal_comparator(), file.second->fd, handles);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Block cache warm-up of file %" PRIu64 " failed: %s",
+                     file.second->fd.GetNumber(), s.ToString().c_str());
+      continue;
+    }
+    arg->num_blocks += handles.size();
+  }
+  if (!arg->files.empty()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Block cache warm-up loaded %" ROCKSDB_PRIszt
+                   " blocks of %" ROCKSDB_PRIszt " files",
+                   arg->num_blocks, arg->files.size());
+  }
+
+  mutex_.Lock();
+  for (auto& p : arg->pinned) {
+    p.second->Unref();
+    if (p.first->Unref()) {
+      delete p.first;
+    }
+  }
+  delete arg;
+  bg_warmup_scheduled_--;
+
+  bg_cv_.SignalAll();
+  // IMPORTANT: there should be no code after calling SignalAll, see
+  // BackgroundCallPurge()
+  mutex_.Unlock();
+  return true;
+}
+
 void DBImpl::SchedulePurge() {
   mutex_.AssertHeld();
   assert(opened_successfully_);
@@ -1802,6 +1967,65 @@ Status DBImpl::ResetStats() {
   }
   return Status::OK();
 }
+
+Status DBImpl::DumpBlockCacheKeys(const std::string& path) {
+  std::vector<std::pair<ColumnFamilyData*, Version*>> pinned;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped()) {
+        continue;
+      }
+      cfd->Ref();
+      cfd->current()->Ref();
+      pinned.emplace_back(cfd, cfd->current());
+    }
+  }
+
+  Status s;
+  std::string contents;
+  PutFixed32(&contents, kBlockCacheWarmupMagic);
+  std::vector<BlockHandle> handles;
+  for (auto& p : pinned) {
+    if (!s.ok()) {
+      break;
+    }
+    ColumnFamilyData* cfd = p.first;
+    auto* vstorage = p.second->storage_info();
+    for (int level = 0; s.ok() && level < vstorage->num_levels(); level++) {
+      for (FileMetaData* f : vstorage->LevelFiles(level)) {
+        handles.clear();
+        s = cfd->table_cache()->GetCachedDataBlocks(
+            env_options_, cfd->internal_comparator(), f->fd, &handles);
+        if (!s.ok()) {
+          break;
+        }
+        if (handles.empty()) {
+          continue;
+        }
+        PutVarint64(&contents, f->fd.GetNumber());
+        PutVarint32(&contents, static_cast<uint32_t>(handles.size()));
+        for (const auto& handle : handles) {
+          handle.EncodeTo(&contents);
+        }
+      }
+    }
+  }
+  if (s.ok()) {
+    PutFixed32(&contents,
+               crc32c::Mask(crc32c::Value(contents.data(), contents.size())));
+    s = WriteStringToFile(env_, contents, path, true /* should_sync */);
+  }
+
+  InstrumentedMutexLock l(&mutex_);
+  for (auto& p : pinned) {
+    p.second->Unref();
+    if (p.first->Unref()) {
+      delete p.first;
+    }
+  }
+  return s;
+}
 #endif  // ROCKSDB_LITE
 
 bool DBImpl::GetAggregatedIntProperty(const Slice& property,
@@ -219,6 +219,8 @@ class DBImpl : public DB {
 #ifndef ROCKSDB_LITE
   using DB::ResetStats;
   virtual Status ResetStats() override;
+  using DB::DumpBlockCacheKeys;
+  virtual Status DumpBlockCacheKeys(const std::string& path) override;
   virtual Status DisableFileDeletions() override;
   virtual Status EnableFileDeletions(bool force) override;
   virtual int IsFileDeletionsEnabled() const;
@@ -451,6 +453,10 @@ class DBImpl : public DB {
 
   void SchedulePurge();
 
+  // Schedule the job that loads the data blocks listed in
+  // block_cache_warmup_file into the block cache
+  void ScheduleBlockCacheWarmup();
+
   ColumnFamilyHandle* DefaultColumnFamily() const override;
 
   const SnapshotList& snapshots() const { return snapshots_; }
@@ -789,13 +795,19 @@ class DBImpl : public DB {
   void SchedulePendingCompaction(ColumnFamilyData* cfd);
   void SchedulePendingPurge(std::string fname, FileType type, uint64_t number,
                             uint32_t path_id, int job_id);
+  // State of the block cache warm-up job, kept while the job gives its thread
+  // up to the other jobs of the pool. Defined in db_impl.cc.
+  struct WarmupArg;
   static void BGWorkCompaction(void* arg);
   static void BGWorkFlush(void* db);
   static void BGWorkPurge(void* arg);
+  static void BGWorkWarmup(void* arg);
   static void UnscheduleCallback(void* arg);
   void BackgroundCallCompaction(void* arg);
   void BackgroundCallFlush();
   void BackgroundCallPurge();
+  // Returns false if the job was scheduled again to finish later
+  bool BackgroundCallWarmup(WarmupArg* arg);
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
                               LogBuffer* log_buffer, void* m = 0);
   Status BackgroundFlush(bool* madeProgress, JobContext* job_context,
@@ -848,7 +860,8 @@ class DBImpl : public DB {
   // * if AnyManualCompaction, whenever a compaction finishes, even if it hasn't
   // made any progress
   // * whenever a compaction made any progress
-  // * whenever bg_flush_scheduled_ or bg_purge_scheduled_ value decreases
+  // * whenever bg_flush_scheduled_, bg_purge_scheduled_ or
+  // bg_warmup_scheduled_ value decreases
   // (i.e. whenever a flush is done, even if it didn't make any progress)
   // * whenever there is an error in background purge, flush or compaction
   // * whenever num_running_ingest_file_ goes to 0.
@@ -1032,6 +1045,9 @@ class DBImpl : public DB {
   // number of background obsolete file purge jobs, submitted to the HIGH pool
   int bg_purge_scheduled_;
 
+  // number of block cache warm-up jobs, submitted to the LOW pool
+  int bg_warmup_scheduled_;
+
   // Information for a manual compaction
   struct ManualCompaction {
     ColumnFamilyData* cfd;
@@ -867,10 +867,7 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
   // should not be added to the manifest.
   int level = 0;
   if (s.ok() && meta.fd.GetFileSize() > 0) {
-    edit->AddFile(level, meta.fd.GetNumber(), meta.fd.GetPathId(),
-                  meta.fd.GetFileSize(), meta.smallest, meta.largest,
-                  meta.smallest_seqno, meta.largest_seqno,
-                  meta.marked_for_compaction);
+    edit->AddFile(level, meta);
   }
 
   InternalStats::CompactionStats stats(1);
@@ -1049,6 +1046,9 @@ Status DB::Open(const DBOptions& db_options, const std::string& dbname,
     *dbptr = impl;
     impl->opened_successfully_ = true;
     impl->MaybeScheduleFlushOrCompaction();
+    if (!impl->immutable_db_options_.block_cache_warmup_file.empty()) {
+      impl->ScheduleBlockCacheWarmup();
+    }
   }
   impl->mutex_.Unlock();
 
@@ -123,6 +123,7 @@ class DBIter: public Iterator {
         prefix_same_as_start_(read_options.prefix_same_as_start),
         pin_thru_lifetime_(read_options.pin_data),
         total_order_seek_(read_options.total_order_seek),
+        keys_only_(read_options.keys_only),
         range_del_agg_(cf_options.internal_comparator, s,
                        true /* collapse_deletions */) {
     RecordTick(statistics_, NO_ITERATORS);
@@ -165,7 +166,9 @@ class DBIter: public Iterator {
   }
   virtual Slice value() const override {
     assert(valid_);
-    if (current_entry_is_merged_) {
+    if (keys_only_) {
+      return Slice();
+    } else if (current_entry_is_merged_) {
       // If pinned_value_ is set then the result of merge operator is one of
       // the merge operands and we should return it.
       return pinned_value_.data() ? pinned_value_ : saved_value_;
@@ -285,6 +288,9 @@ class DBIter: public Iterator {
   // is not deleted, will be true if ReadOptions::pin_data is true
   const bool pin_thru_lifetime_;
   const bool total_order_seek_;
+  // Means that values are never read nor merged, will be true if
+  // ReadOptions::keys_only is true
+  const bool keys_only_;
   // List of operands for merge operator.
   MergeContext merge_context_;
   RangeDelAggregator range_del_agg_;
@@ -451,6 +457,11 @@ void DBIter::FindNextUserEntryInternal(bool skipping, bool prefix_check) {
               skipping = true;
               num_skipped = 0;
               PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
+            } else if (keys_only_) {
+              // The key exists, no need to look at the operands. iter_ stays
+              // on the current entry like for kTypeValue.
+              valid_ = true;
+              return;
             } else {
               // By now, we are sure the current ikey is going to yield a
               // value
@@ -752,7 +763,7 @@ bool DBIter::FindValueForCurrentKey() {
                 RangeDelAggregator::RangePositioningMode::kBackwardTraversal)) {
           last_key_entry_type = kTypeRangeDeletion;
           PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
-        } else {
+        } else if (!keys_only_) {
           assert(iter_->IsValuePinned());
           pinned_value_ = iter_->value();
         }
@@ -773,7 +784,7 @@ bool DBIter::FindValueForCurrentKey() {
           last_key_entry_type = kTypeRangeDeletion;
           last_not_merge_type = last_key_entry_type;
           PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
-        } else {
+        } else if (!keys_only_) {
           assert(merge_operator_ != nullptr);
           merge_context_.PushOperandBack(
               iter_->value(), iter_->IsValuePinned() /* operand_pinned */);
@@ -800,7 +811,9 @@ bool DBIter::FindValueForCurrentKey() {
       return false;
     case kTypeMerge:
       current_entry_is_merged_ = true;
-      if (last_not_merge_type == kTypeDeletion ||
+      if (keys_only_) {
+        // The key exists, its merged value is never needed
+      } else if (last_not_merge_type == kTypeDeletion ||
           last_not_merge_type == kTypeSingleDeletion ||
           last_not_merge_type == kTypeRangeDeletion) {
         s = MergeHelper::TimedFullMerge(
@@ -852,8 +865,16 @@ bool DBIter::FindValueForCurrentKeyUsingSeek() {
     return false;
   }
   if (ikey.type == kTypeValue) {
-    assert(iter_->IsValuePinned());
-    pinned_value_ = iter_->value();
+    if (!keys_only_) {
+      assert(iter_->IsValuePinned());
+      pinned_value_ = iter_->value();
+    }
+    valid_ = true;
+    return true;
+  }
+  if (keys_only_) {
+    // kTypeMerge. The key exists, its merged value is never needed
+    current_entry_is_merged_ = true;
     valid_ = true;
     return true;
   }
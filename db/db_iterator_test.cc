@@ -1911,6 +1911,232 @@ TEST_F(DBIteratorTest, DBIteratorSkipRecentDuplicatesTest) {
                  NUMBER_OF_RESEEKS_IN_ITERATION));
 }
 
+TEST_F(DBIteratorTest, KeysOnlyIteration) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendTESTOperator();
+  BlockBasedTableOptions table_options;
+  table_options.data_block_layout = BlockBasedTableOptions::kColumnLayout;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("a", "va"));
+  ASSERT_OK(Put("b", "vb"));
+  ASSERT_OK(Merge("c", "c1"));
+  ASSERT_OK(Put("d", "vd"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Merge("c", "c2"));
+  ASSERT_OK(Delete("b"));
+  ASSERT_OK(Delete("d"));
+  ASSERT_OK(Merge("d", "d1"));
+  ASSERT_OK(Merge("e", "e1"));
+
+  const std::vector<std::string> expected = {"a", "c", "d", "e"};
+  ReadOptions ro;
+  ro.keys_only = true;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+
+  perf_context.Reset();
+  size_t i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+    ASSERT_LT(i, expected.size());
+    ASSERT_EQ(expected[i], iter->key().ToString());
+    ASSERT_TRUE(iter->value().empty());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(expected.size(), i);
+
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    ASSERT_GT(i, 0U);
+    i--;
+    ASSERT_EQ(expected[i], iter->key().ToString());
+    ASSERT_TRUE(iter->value().empty());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(0U, i);
+  // No merge operand was ever looked at
+  ASSERT_EQ(0U, perf_context.internal_merge_count);
+
+  // Switching direction on a merged key
+  iter->Seek("c");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("c", iter->key().ToString());
+  iter->Prev();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("a", iter->key().ToString());
+  iter->Next();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("c", iter->key().ToString());
+  iter->Next();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("d", iter->key().ToString());
+
+  // A regular iterator still sees the merged values
+  iter.reset(db_->NewIterator(ReadOptions()));
+  iter->Seek("c");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("c1,c2", iter->value().ToString());
+}
+
+TEST_F(DBIteratorTest, AutoReadahead) {
+  std::vector<size_t> readahead_sizes;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTable::BlockEntryIteratorState::Readahead",
+      [&readahead_sizes](void* arg) {
+        readahead_sizes.push_back(*static_cast<size_t*>(arg));
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  Options options = CurrentOptions();
+  options.compression = kNoCompression;
+  options.write_buffer_size = 4 << 20;
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 5000;
+  Random rnd(301);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 100)));
+  }
+  ASSERT_OK(Flush());
+
+  // A full scan reads ahead with a window that doubles up to 256KB
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, count);
+  ASSERT_GE(readahead_sizes.size(), 6U);
+  ASSERT_EQ(8 * 1024U, readahead_sizes[0]);
+  for (size_t i = 1; i < readahead_sizes.size(); i++) {
+    ASSERT_EQ(std::min<size_t>(2 * readahead_sizes[i - 1], 256 * 1024),
+              readahead_sizes[i]);
+  }
+  ASSERT_EQ(256 * 1024U, readahead_sizes.back());
+
+  // The blocks are now in the block cache, so scanning them again does no
+  // readahead
+  readahead_sizes.clear();
+  count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, count);
+  ASSERT_TRUE(readahead_sizes.empty());
+
+  // Short scans after a seek don't read ahead
+  readahead_sizes.clear();
+  iter->Seek(Key(kNumKeys / 2));
+  for (int i = 0; i < 10 && iter->Valid(); i++) {
+    iter->Next();
+  }
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_TRUE(readahead_sizes.empty());
+
+  // A fixed readahead_size disables the automatic readahead
+  ReadOptions ro;
+  ro.readahead_size = 1 << 20;
+  iter.reset(db_->NewIterator(ro));
+  count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, count);
+  ASSERT_TRUE(readahead_sizes.empty());
+  iter.reset();
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBIteratorTest, AsyncPrefetchBlocks) {
+  std::atomic<int> num_scheduled(0);
+  std::atomic<int> num_loaded(0);
+  std::atomic<int> max_in_flight(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTable::BlockEntryIteratorState::OnForwardBlock:Schedule",
+      [&](void* arg) {
+        int in_flight = ++num_scheduled - num_loaded.load();
+        if (in_flight > max_in_flight.load()) {
+          max_in_flight = in_flight;
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTable::BlockEntryIteratorState::BGWorkPrefetchBlock",
+      [&num_loaded](void* arg) { num_loaded++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  Options options = CurrentOptions();
+  options.env = env_;
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  table_options.flush_block_policy_factory =
+      std::make_shared<FlushBlockEveryKeyPolicyFactory>();
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 100;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+  }
+  ASSERT_OK(Flush());
+
+  ReadOptions ro;
+  ro.async_prefetch_blocks = 2;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), count++) {
+    ASSERT_EQ(Key(count), iter->key().ToString());
+    ASSERT_EQ("v" + ToString(count), iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, count);
+  // Blocks were loaded ahead of the scan, without taking more than half of
+  // the LOW priority threads
+  ASSERT_GT(num_scheduled.load(), 0);
+  ASSERT_LE(num_scheduled.load(), kNumKeys - 1);
+  ASSERT_LE(max_in_flight.load(),
+            std::max(1, env_->GetBackgroundThreads(Env::Priority::LOW) / 2));
+  while (num_loaded.load() < num_scheduled.load()) {
+    env_->SleepForMicroseconds(1000);
+  }
+  iter.reset();
+
+  // All blocks are in the block cache now
+  ro = ReadOptions();
+  ro.read_tier = kBlockCacheTier;
+  iter.reset(db_->NewIterator(ro));
+  count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, count);
+
+  // Nothing past the upper bound is loaded
+  num_scheduled = 0;
+  std::string upper_bound_str = Key(10);
+  Slice upper_bound(upper_bound_str);
+  ro = ReadOptions();
+  ro.async_prefetch_blocks = 4;
+  ro.iterate_upper_bound = &upper_bound;
+  iter.reset(db_->NewIterator(ro));
+  count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(10, count);
+  ASSERT_LE(num_scheduled.load(), 11);
+  // Destroying the iterator waits for or cancels its loads
+  iter.reset();
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -647,6 +647,53 @@ TEST_F(DBSSTTest, OpenDBWithInfiniteMaxOpenFiles) {
   }
 }
 
+TEST_F(DBSSTTest, PinTableReadersWithLimitedMaxOpenFiles) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  // Table cache capacity of 40, of which a quarter may be pinned
+  options.max_open_files = 50;
+  const size_t kMaxPinned = (options.max_open_files - 10) / 4;
+  DestroyAndReopen(options);
+
+  auto count_pinned = [&]() {
+    std::vector<std::vector<FileMetaData>> files;
+    dbfull()->TEST_GetFilesMetaData(db_->DefaultColumnFamily(), &files);
+    size_t pinned = 0;
+    for (const auto& level : files) {
+      for (const auto& file : level) {
+        if (file.table_reader_handle != nullptr) {
+          EXPECT_TRUE(file.fd.table_reader != nullptr);
+          pinned++;
+        }
+      }
+    }
+    return pinned;
+  };
+
+  const int kNumFiles = 20;
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_OK(Put(Key(i), Key(i) + std::string(1000, 'a')));
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(ToString(kNumFiles), FilesPerLevel(0));
+  // Unpinned handles of the files in the LRU list do not stop the pinning
+  size_t pinned = count_pinned();
+  ASSERT_EQ(kMaxPinned, pinned);
+
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_EQ(Key(i) + std::string(1000, 'a'), Get(Key(i)));
+  }
+
+  // Files are not pinned on DB open
+  Reopen(options);
+  ASSERT_EQ(0, count_pinned());
+  ASSERT_OK(Put(Key(0), "new"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, count_pinned());
+  ASSERT_EQ("new", Get(Key(0)));
+}
+
 TEST_F(DBSSTTest, GetTotalSstFilesSize) {
   Options options = CurrentOptions();
   options.disable_auto_compactions = true;
@@ -5087,6 +5087,85 @@ TEST_F(DBTest, RowCache) {
   ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
   ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
 }
+
+TEST_F(DBTest, RowCachePinnedHit) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.row_cache = NewLRUCache(8192);
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(Get("foo"), "bar");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+
+  // The value of a hit points into the row cache entry, which stays
+  // referenced until the value is released
+  PinnableSlice value;
+  ASSERT_OK(db_->Get(ReadOptions(), db_->DefaultColumnFamily(), "foo", &value));
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  ASSERT_EQ("bar", value.ToString());
+  ASSERT_TRUE(value.IsPinned());
+  ASSERT_GT(options.row_cache->GetPinnedUsage(), 0);
+  value.Reset();
+  ASSERT_EQ(0, options.row_cache->GetPinnedUsage());
+}
+
+TEST_F(DBTest, RowCacheAdmissionReads) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.row_cache = NewLRUCache(8192);
+  options.row_cache_admission_reads = 3;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(Get("foo"), "bar");
+    ASSERT_EQ(0, options.row_cache->GetUsage());
+  }
+  // Added on the third read
+  ASSERT_EQ(Get("foo"), "bar");
+  ASSERT_GT(options.row_cache->GetUsage(), 0);
+  ASSERT_EQ(Get("foo"), "bar");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 3);
+}
+
+TEST_F(DBTest, RowCacheBudget) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.row_cache = NewLRUCache(1 << 20);
+  options.row_cache_budget = 4096;
+  DestroyAndReopen(options);
+  CreateAndReopenWithCF({"pikachu"}, options);
+  ColumnFamilyOptions cf_options(options);
+  cf_options.row_cache_budget = 0;
+  ReopenWithColumnFamilies({"default", "pikachu"},
+                           std::vector<Options>{
+                               options, Options(DBOptions(options), cf_options)});
+
+  const int kNumKeys = 100;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(0, Key(i), std::string(100, 'a')));
+    ASSERT_OK(Put(1, Key(i), std::string(100, 'a')));
+  }
+  ASSERT_OK(Flush(0));
+  ASSERT_OK(Flush(1));
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(std::string(100, 'a'), Get(0, Key(i)));
+  }
+  const size_t usage = options.row_cache->GetUsage();
+  ASSERT_GT(usage, 0);
+  ASSERT_LE(usage, options.row_cache_budget);
+
+  // The other column family is not limited
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(std::string(100, 'a'), Get(1, Key(i)));
+  }
+  ASSERT_GT(options.row_cache->GetUsage(), usage + kNumKeys * 100);
+}
 #endif  // ROCKSDB_LITE
 
 TEST_F(DBTest, DeletingOldWalAfterDrop) {
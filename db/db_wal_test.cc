@@ -181,15 +181,21 @@ TEST_F(DBWALTest, RecoverWithTableHandle) {
       total_files += level.size();
     }
     ASSERT_EQ(total_files, 3);
+    // With a limited table cache only the file written during recovery is
+    // pinned
+    size_t pinned_files = 0;
     for (const auto& level : files) {
       for (const auto& file : level) {
-        if (kInfiniteMaxOpenFiles == option_config_) {
-          ASSERT_TRUE(file.table_reader_handle != nullptr);
-        } else {
-          ASSERT_TRUE(file.table_reader_handle == nullptr);
+        if (file.table_reader_handle != nullptr) {
+          pinned_files++;
         }
       }
     }
+    if (kInfiniteMaxOpenFiles == option_config_) {
+      ASSERT_EQ(total_files, pinned_files);
+    } else {
+      ASSERT_EQ(1, pinned_files);
+    }
   } while (ChangeWalOptions());
 }
 
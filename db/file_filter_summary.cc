@@ -0,0 +1,50 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+
+#include "db/file_filter_summary.h"
+
+namespace rocksdb {
+
+namespace {
+// The summaries are full Bloom filters, whatever the filter policy of the
+// tables is
+const FilterPolicy* NewSummaryPolicy(int bits_per_key) {
+  return NewBloomFilterPolicy(bits_per_key,
+                              false /* use_block_based_builder */);
+}
+}  // namespace
+
+FileFilterSummary::Builder::Builder(int bits_per_key) : empty_(true) {
+  std::unique_ptr<const FilterPolicy> policy(NewSummaryPolicy(bits_per_key));
+  bits_builder_.reset(policy->GetFilterBitsBuilder());
+}
+
+void FileFilterSummary::Builder::Add(const Slice& user_key) {
+  // Consecutive versions of a key only add one hash
+  bits_builder_->AddKey(user_key);
+  empty_ = false;
+}
+
+std::shared_ptr<const FileFilterSummary> FileFilterSummary::Builder::Finish() {
+  if (empty_) {
+    return nullptr;
+  }
+  std::unique_ptr<const char[]> data;
+  Slice contents = bits_builder_->Finish(&data);
+  return std::shared_ptr<const FileFilterSummary>(
+      new FileFilterSummary(std::move(data), contents));
+}
+
+FileFilterSummary::FileFilterSummary(std::unique_ptr<const char[]>&& data,
+                                     const Slice& contents)
+    : data_(std::move(data)), contents_(contents) {
+  // The reader takes the number of probes from the filter itself
+  std::unique_ptr<const FilterPolicy> policy(NewSummaryPolicy(10));
+  bits_reader_.reset(policy->GetFilterBitsReader(contents_));
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,61 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+
+#pragma once
+
+#include <memory>
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+// A FileFilterSummary is a Bloom filter of the user keys of one table file,
+// kept in memory in the file's FileMetaData for as long as the file is live.
+// Version::Get() probes it before looking the table up in the table cache, so
+// a lookup skips level-0 files that do not hold its key without any table
+// cache access. It is built while a flush writes the file and not persisted;
+// files written before the DB was opened have no summary.
+class FileFilterSummary {
+ public:
+  class Builder {
+   public:
+    explicit Builder(int bits_per_key);
+
+    // Add the user key of the next entry of the file
+    void Add(const Slice& user_key);
+
+    // Returns the summary of the keys added so far, or nullptr if there are
+    // none. The builder must not be used afterwards.
+    std::shared_ptr<const FileFilterSummary> Finish();
+
+   private:
+    std::unique_ptr<FilterBitsBuilder> bits_builder_;
+    bool empty_;
+  };
+
+  bool KeyMayMatch(const Slice& user_key) const {
+    return bits_reader_->MayMatch(user_key);
+  }
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(FileFilterSummary) + contents_.size();
+  }
+
+ private:
+  FileFilterSummary(std::unique_ptr<const char[]>&& data,
+                    const Slice& contents);
+
+  std::unique_ptr<const char[]> data_;
+  Slice contents_;
+  std::unique_ptr<FilterBitsReader> bits_reader_;
+
+  // No copying allowed
+  FileFilterSummary(const FileFilterSummary&);
+  void operator=(const FileFilterSummary&);
+};
+
+}  // namespace rocksdb
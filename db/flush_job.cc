@@ -336,10 +336,7 @@ Status FlushJob::WriteLevel0Table() {
     // threads could be concurrently producing compacted files for
     // that key range.
     // Add file to L0
-    edit_->AddFile(0 /* level */, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
-                   meta_.fd.GetFileSize(), meta_.smallest, meta_.largest,
-                   meta_.smallest_seqno, meta_.largest_seqno,
-                   meta_.marked_for_compaction);
+    edit_->AddFile(0 /* level */, meta_);
   }
 
   // Note that here we treat flush as level 0 compaction in internal stats
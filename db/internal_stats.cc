@@ -15,6 +15,7 @@
 #endif
 
 #include <inttypes.h>
+#include <string.h>
 #include <string>
 #include <algorithm>
 #include <utility>
@@ -22,6 +23,9 @@
 #include "db/column_family.h"
 
 #include "db/db_impl.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/table.h"
+#include "rocksdb/utilities/sim_cache.h"
 #include "util/string_util.h"
 
 namespace rocksdb {
@@ -245,6 +249,12 @@ static const std::string num_running_flushes = "num-running-flushes";
 static const std::string actual_delayed_write_rate =
     "actual-delayed-write-rate";
 static const std::string is_write_stopped = "is-write-stopped";
+static const std::string metadata_cache_capacity = "metadata-cache-capacity";
+static const std::string metadata_cache_usage = "metadata-cache-usage";
+static const std::string metadata_cache_pinned_usage =
+    "metadata-cache-pinned-usage";
+static const std::string block_cache_miss_ratio_curve =
+    "block-cache-miss-ratio-curve";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
                       rocksdb_prefix + num_files_at_level_prefix;
@@ -318,6 +328,14 @@ const std::string DB::Properties::kActualDelayedWriteRate =
     rocksdb_prefix + actual_delayed_write_rate;
 const std::string DB::Properties::kIsWriteStopped =
     rocksdb_prefix + is_write_stopped;
+const std::string DB::Properties::kMetadataCacheCapacity =
+    rocksdb_prefix + metadata_cache_capacity;
+const std::string DB::Properties::kMetadataCacheUsage =
+    rocksdb_prefix + metadata_cache_usage;
+const std::string DB::Properties::kMetadataCachePinnedUsage =
+    rocksdb_prefix + metadata_cache_pinned_usage;
+const std::string DB::Properties::kBlockCacheMissRatioCurve =
+    rocksdb_prefix + block_cache_miss_ratio_curve;
 
 const std::unordered_map<std::string, DBPropertyInfo>
     InternalStats::ppt_name_to_info = {
@@ -416,6 +434,17 @@ const std::unordered_map<std::string, DBPropertyInfo>
           nullptr}},
         {DB::Properties::kIsWriteStopped,
          {false, nullptr, &InternalStats::HandleIsWriteStopped, nullptr}},
+        {DB::Properties::kMetadataCacheCapacity,
+         {false, nullptr, &InternalStats::HandleMetadataCacheCapacity,
+          nullptr}},
+        {DB::Properties::kMetadataCacheUsage,
+         {false, nullptr, &InternalStats::HandleMetadataCacheUsage, nullptr}},
+        {DB::Properties::kMetadataCachePinnedUsage,
+         {false, nullptr, &InternalStats::HandleMetadataCachePinnedUsage,
+          nullptr}},
+        {DB::Properties::kBlockCacheMissRatioCurve,
+         {false, &InternalStats::HandleBlockCacheMissRatioCurve, nullptr,
+          &InternalStats::HandleBlockCacheMissRatioCurveMap}},
 };
 
 const DBPropertyInfo* GetPropertyInfo(const Slice& property) {
@@ -777,6 +806,88 @@ bool InternalStats::HandleIsWriteStopped(uint64_t* value, DBImpl* db,
   return true;
 }
 
+const BlockBasedTableOptions* InternalStats::GetBlockBasedTableOptions() {
+  TableFactory* table_factory = cfd_->ioptions()->table_factory;
+  if (table_factory == nullptr ||
+      strcmp(table_factory->Name(), "BlockBasedTable") != 0) {
+    return nullptr;
+  }
+  return reinterpret_cast<BlockBasedTableOptions*>(
+      table_factory->GetOptions());
+}
+
+Cache* InternalStats::GetMetadataCache() {
+  auto* table_options = GetBlockBasedTableOptions();
+  return table_options == nullptr ? nullptr
+                                  : table_options->metadata_cache.get();
+}
+
+MissRatioCurveCache* InternalStats::GetMissRatioCurveCache() {
+  auto* table_options = GetBlockBasedTableOptions();
+  if (table_options == nullptr || table_options->block_cache == nullptr ||
+      strcmp(table_options->block_cache->Name(), "MissRatioCurveCache") !=
+          0) {
+    return nullptr;
+  }
+  return static_cast<MissRatioCurveCache*>(table_options->block_cache.get());
+}
+
+bool InternalStats::HandleBlockCacheMissRatioCurve(std::string* value,
+                                                   Slice suffix) {
+  MissRatioCurveCache* mrc_cache = GetMissRatioCurveCache();
+  if (mrc_cache == nullptr) {
+    return false;
+  }
+  *value = mrc_cache->ToString();
+  return true;
+}
+
+bool InternalStats::HandleBlockCacheMissRatioCurveMap(
+    std::map<std::string, double>* curve) {
+  MissRatioCurveCache* mrc_cache = GetMissRatioCurveCache();
+  if (mrc_cache == nullptr) {
+    return false;
+  }
+  std::map<size_t, double> miss_ratios;
+  mrc_cache->GetMissRatioCurve(&miss_ratios);
+  curve->clear();
+  for (const auto& point : miss_ratios) {
+    (*curve)[ToString(point.first)] = point.second;
+  }
+  return true;
+}
+
+bool InternalStats::HandleMetadataCacheCapacity(uint64_t* value, DBImpl* db,
+                                                Version* version) {
+  Cache* metadata_cache = GetMetadataCache();
+  if (metadata_cache == nullptr) {
+    return false;
+  }
+  *value = static_cast<uint64_t>(metadata_cache->GetCapacity());
+  return true;
+}
+
+bool InternalStats::HandleMetadataCacheUsage(uint64_t* value, DBImpl* db,
+                                             Version* version) {
+  Cache* metadata_cache = GetMetadataCache();
+  if (metadata_cache == nullptr) {
+    return false;
+  }
+  *value = static_cast<uint64_t>(metadata_cache->GetUsage());
+  return true;
+}
+
+bool InternalStats::HandleMetadataCachePinnedUsage(uint64_t* value,
+                                                   DBImpl* db,
+                                                   Version* version) {
+  Cache* metadata_cache = GetMetadataCache();
+  if (metadata_cache == nullptr) {
+    return false;
+  }
+  *value = static_cast<uint64_t>(metadata_cache->GetPinnedUsage());
+  return true;
+}
+
 void InternalStats::DumpDBStats(std::string* value) {
   char buf[1000];
   // DB-level stats, only available from default column family
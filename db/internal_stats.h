@@ -21,6 +21,9 @@ class ColumnFamilyData;
 
 namespace rocksdb {
 
+class Cache;
+struct BlockBasedTableOptions;
+class MissRatioCurveCache;
 class MemTableList;
 class DBImpl;
 
@@ -422,6 +425,8 @@ class InternalStats {
   bool HandleLevelStats(std::string* value, Slice suffix);
   bool HandleStats(std::string* value, Slice suffix);
   bool HandleCFMapStats(std::map<std::string, double>* compaction_stats);
+  bool HandleBlockCacheMissRatioCurve(std::string* value, Slice suffix);
+  bool HandleBlockCacheMissRatioCurveMap(std::map<std::string, double>* curve);
   bool HandleCFStats(std::string* value, Slice suffix);
   bool HandleCFStatsNoFileHistogram(std::string* value, Slice suffix);
   bool HandleCFFileHistogram(std::string* value, Slice suffix);
@@ -472,6 +477,19 @@ class InternalStats {
   bool HandleActualDelayedWriteRate(uint64_t* value, DBImpl* db,
                                     Version* version);
   bool HandleIsWriteStopped(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleMetadataCacheCapacity(uint64_t* value, DBImpl* db,
+                                   Version* version);
+  bool HandleMetadataCacheUsage(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleMetadataCachePinnedUsage(uint64_t* value, DBImpl* db,
+                                      Version* version);
+  // The options of the column family's table factory, if it makes
+  // block-based tables
+  const BlockBasedTableOptions* GetBlockBasedTableOptions();
+  // The metadata_cache of the column family's table factory, if any
+  Cache* GetMetadataCache();
+  // The block_cache of the column family's table factory, if it is a
+  // MissRatioCurveCache
+  MissRatioCurveCache* GetMissRatioCurveCache();
 
   // Total number of background errors encountered. Every time a flush task
   // or compaction task fails, this counter is incremented. The failure can
@@ -11,6 +11,8 @@
 
 #include "db/table_cache.h"
 
+#include <algorithm>
+
 #include "db/dbformat.h"
 #include "db/version_edit.h"
 #include "util/filename.h"
@@ -24,6 +26,7 @@
 #include "table/table_reader.h"
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
+#include "util/hash.h"
 #include "util/stop_watch.h"
 #include "util/sync_point.h"
 
@@ -61,17 +64,45 @@ void AppendVarint64(IterKey* key, uint64_t v) {
   key->TrimAppend(key->Size(), buf, ptr - buf);
 }
 
+// Value of a row cache entry
+struct RowCacheEntry {
+  std::string replay_log;
+  size_t charge;
+  // TableCache::row_cache_usage_ of the column family, may be nullptr
+  std::shared_ptr<std::atomic<size_t>> usage;
+};
+
+void DeleteRowCacheEntry(const Slice& key, void* value) {
+  RowCacheEntry* entry = reinterpret_cast<RowCacheEntry*>(value);
+  if (entry->usage != nullptr) {
+    entry->usage->fetch_sub(entry->charge, std::memory_order_relaxed);
+  }
+  delete entry;
+}
+
 #endif  // ROCKSDB_LITE
 
 }  // namespace
 
 TableCache::TableCache(const ImmutableCFOptions& ioptions,
                        const EnvOptions& env_options, Cache* const cache)
-    : ioptions_(ioptions), env_options_(env_options), cache_(cache) {
+    : ioptions_(ioptions),
+      env_options_(env_options),
+      cache_(cache),
+      row_cache_misses_(0) {
   if (ioptions_.row_cache) {
     // If the same cache is shared by multiple instances, we need to
     // disambiguate its entries.
     PutVarint64(&row_cache_id_, ioptions_.row_cache->NewId());
+    if (ioptions_.row_cache_budget > 0) {
+      row_cache_usage_ = std::make_shared<std::atomic<size_t>>(0);
+    }
+    if (ioptions_.row_cache_admission_reads > 1) {
+      row_cache_reads_.reset(new std::atomic<uint8_t>[kRowCacheReadCounters]);
+      for (uint32_t i = 0; i < kRowCacheReadCounters; i++) {
+        row_cache_reads_[i].store(0, std::memory_order_relaxed);
+      }
+    }
   }
 }
 
@@ -262,6 +293,36 @@ InternalIterator* TableCache::NewIterator(
   return result;
 }
 
+const uint32_t TableCache::kRowCacheReadCounters;
+
+bool TableCache::AdmitToRowCache(const Slice& row_cache_key) {
+  if (row_cache_reads_ == nullptr) {
+    return true;
+  }
+  const uint32_t admission_reads =
+      std::min<uint32_t>(ioptions_.row_cache_admission_reads, 255);
+  const uint32_t index =
+      GetSliceHash(row_cache_key) & (kRowCacheReadCounters - 1);
+  auto& reads = row_cache_reads_[index];
+  // Races between readers of the same counter may lose a count, which is
+  // fine for an estimate
+  const uint8_t count = reads.load(std::memory_order_relaxed);
+  if (count + 1u >= admission_reads) {
+    return true;
+  }
+  reads.store(static_cast<uint8_t>(count + 1), std::memory_order_relaxed);
+  if (row_cache_misses_.fetch_add(1, std::memory_order_relaxed) + 1 ==
+      kRowCacheReadCounters) {
+    row_cache_misses_.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < kRowCacheReadCounters; i++) {
+      row_cache_reads_[i].store(
+          row_cache_reads_[i].load(std::memory_order_relaxed) >> 1,
+          std::memory_order_relaxed);
+    }
+  }
+  return false;
+}
+
 Status TableCache::Get(const ReadOptions& options,
                        const InternalKeyComparator& internal_comparator,
                        const FileDescriptor& fd, const Slice& k,
@@ -295,16 +356,24 @@ Status TableCache::Get(const ReadOptions& options,
 
     if (auto row_handle =
             ioptions_.row_cache->Lookup(row_cache_key.GetUserKey())) {
-      auto found_row_cache_entry = static_cast<const std::string*>(
+      auto found_row_cache_entry = static_cast<const RowCacheEntry*>(
           ioptions_.row_cache->Value(row_handle));
-      replayGetContextLog(*found_row_cache_entry, user_key, get_context);
-      ioptions_.row_cache->Release(row_handle);
+      // A found value points into the cache entry, and the cleanup that
+      // releases the entry moves to the PinnableSlice of get_context. If
+      // the value is copied instead, the entry is released right here.
+      Cleanable value_pinner;
+      value_pinner.RegisterCleanup(&UnrefEntry, ioptions_.row_cache.get(),
+                                   row_handle);
+      replayGetContextLog(found_row_cache_entry->replay_log, user_key,
+                          get_context, &value_pinner);
       RecordTick(ioptions_.statistics, ROW_CACHE_HIT);
       done = true;
     } else {
       // Not found, setting up the replay log.
       RecordTick(ioptions_.statistics, ROW_CACHE_MISS);
-      row_cache_entry = &row_cache_entry_buffer;
+      if (AdmitToRowCache(row_cache_key.GetUserKey())) {
+        row_cache_entry = &row_cache_entry_buffer;
+      }
     }
   }
 #endif  // ROCKSDB_LITE
@@ -349,10 +418,20 @@ Status TableCache::Get(const ReadOptions& options,
   // Put the replay log in row cache only if something was found.
   if (!done && s.ok() && row_cache_entry && !row_cache_entry->empty()) {
     size_t charge =
-        row_cache_key.Size() + row_cache_entry->size() + sizeof(std::string);
-    void* row_ptr = new std::string(std::move(*row_cache_entry));
-    ioptions_.row_cache->Insert(row_cache_key.GetUserKey(), row_ptr, charge,
-                                &DeleteEntry<std::string>);
+        row_cache_key.Size() + row_cache_entry->size() + sizeof(RowCacheEntry);
+    if (row_cache_usage_ == nullptr ||
+        row_cache_usage_->load(std::memory_order_relaxed) + charge <=
+            ioptions_.row_cache_budget) {
+      RowCacheEntry* row_ptr = new RowCacheEntry();
+      row_ptr->replay_log = std::move(*row_cache_entry);
+      row_ptr->charge = charge;
+      row_ptr->usage = row_cache_usage_;
+      if (row_cache_usage_ != nullptr) {
+        row_cache_usage_->fetch_add(charge, std::memory_order_relaxed);
+      }
+      ioptions_.row_cache->Insert(row_cache_key.GetUserKey(), row_ptr, charge,
+                                  &DeleteRowCacheEntry);
+    }
   }
 #endif  // ROCKSDB_LITE
 
@@ -387,6 +466,70 @@ Status TableCache::GetTableProperties(
   return s;
 }
 
+Status TableCache::GetCachedDataBlocks(
+    const EnvOptions& env_options,
+    const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
+    std::vector<BlockHandle>* handles) {
+  if (fd.table_reader) {
+    fd.table_reader->GetCachedDataBlocks(handles);
+    return Status::OK();
+  }
+
+  // Do not open the file just to list its blocks
+  Cache::Handle* table_handle = nullptr;
+  Status s = FindTable(env_options, internal_comparator, fd, &table_handle,
+                       true /* no_io */);
+  if (s.IsIncomplete()) {
+    return Status::OK();
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  assert(table_handle);
+  GetTableReaderFromHandle(table_handle)->GetCachedDataBlocks(handles);
+  ReleaseHandle(table_handle);
+  return s;
+}
+
+Status TableCache::GetKeyAnchors(
+    const EnvOptions& env_options,
+    const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
+    size_t max_anchors, std::vector<TableKeyAnchor>* anchors) {
+  if (fd.table_reader) {
+    fd.table_reader->GetKeyAnchors(max_anchors, anchors);
+    return Status::OK();
+  }
+
+  Cache::Handle* table_handle = nullptr;
+  Status s = FindTable(env_options, internal_comparator, fd, &table_handle);
+  if (!s.ok()) {
+    return s;
+  }
+  assert(table_handle);
+  GetTableReaderFromHandle(table_handle)->GetKeyAnchors(max_anchors, anchors);
+  ReleaseHandle(table_handle);
+  return s;
+}
+
+Status TableCache::WarmUpDataBlocks(
+    const EnvOptions& env_options,
+    const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
+    const std::vector<BlockHandle>& handles) {
+  if (fd.table_reader) {
+    return fd.table_reader->WarmUpDataBlocks(handles);
+  }
+
+  Cache::Handle* table_handle = nullptr;
+  Status s = FindTable(env_options, internal_comparator, fd, &table_handle);
+  if (!s.ok()) {
+    return s;
+  }
+  assert(table_handle);
+  s = GetTableReaderFromHandle(table_handle)->WarmUpDataBlocks(handles);
+  ReleaseHandle(table_handle);
+  return s;
+}
+
 size_t TableCache::GetMemoryUsageByTableReader(
     const EnvOptions& env_options,
     const InternalKeyComparator& internal_comparator,
@@ -12,6 +12,8 @@
 // Thread-safe (provides internal synchronization)
 
 #pragma once
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 #include <stdint.h>
@@ -107,6 +109,27 @@ class TableCache {
                             std::shared_ptr<const TableProperties>* properties,
                             bool no_io = false);
 
+  // Append the handles of the data blocks of the file that are in the block
+  // cache to *handles. Appends nothing if the table reader of the file is not
+  // in the table cache, as the file is not opened for this.
+  Status GetCachedDataBlocks(const EnvOptions& toptions,
+                             const InternalKeyComparator& internal_comparator,
+                             const FileDescriptor& fd,
+                             std::vector<BlockHandle>* handles);
+
+  // Append up to about max_anchors keys of the file, spread evenly over its
+  // data, to *anchors. See TableReader::GetKeyAnchors().
+  Status GetKeyAnchors(const EnvOptions& toptions,
+                       const InternalKeyComparator& internal_comparator,
+                       const FileDescriptor& fd, size_t max_anchors,
+                       std::vector<TableKeyAnchor>* anchors);
+
+  // Load the given data blocks of the file into the block cache.
+  Status WarmUpDataBlocks(const EnvOptions& toptions,
+                          const InternalKeyComparator& internal_comparator,
+                          const FileDescriptor& fd,
+                          const std::vector<BlockHandle>& handles);
+
   // Return total memory usage of the table reader of the file.
   // 0 if table reader of the file is not loaded.
   size_t GetMemoryUsageByTableReader(
@@ -117,6 +140,8 @@ class TableCache {
   // Release the handle from a cache
   void ReleaseHandle(Cache::Handle* handle);
 
+  Cache* get_cache() const { return cache_; }
+
   // Capacity of the backing Cache that indicates inifinite TableCache capacity.
   // For example when max_open_files is -1 we set the backing Cache to this.
   static const int kInfiniteCapacity = 0x400000;
@@ -132,10 +157,24 @@ class TableCache {
                         bool skip_filters = false, int level = -1,
                         bool prefetch_index_and_filter_in_cache = true);
 
+  // Count a row cache miss of the key and return true if the row should be
+  // added to the row cache, see row_cache_admission_reads
+  bool AdmitToRowCache(const Slice& row_cache_key);
+
+  // Number of counters in row_cache_reads_. All of them are halved after
+  // this many misses, so that old reads fade away.
+  static const uint32_t kRowCacheReadCounters = 1 << 16;
+
   const ImmutableCFOptions& ioptions_;
   const EnvOptions& env_options_;
   Cache* const cache_;
   std::string row_cache_id_;
+  // Charge of the row cache entries of this column family if it has a
+  // row_cache_budget. Shared with the entries, which may outlive this.
+  std::shared_ptr<std::atomic<size_t>> row_cache_usage_;
+  // Misses per row cache key hash, if row_cache_admission_reads > 1
+  std::unique_ptr<std::atomic<uint8_t>[]> row_cache_reads_;
+  std::atomic<uint32_t> row_cache_misses_;
 };
 
 }  // namespace rocksdb
@@ -325,12 +325,33 @@ class VersionBuilder::Rep {
   void LoadTableHandlers(InternalStats* internal_stats, int max_threads,
                          bool prefetch_index_and_filter_in_cache) {
     assert(table_cache_ != nullptr);
-    // <file metadata, level>
+
+    // The loaded handles stay pinned in the table cache for the lifetime of
+    // the file, so that reads of the file skip the table cache lookup. With
+    // a limited table cache only the new files written by flushes and
+    // compactions, which are read the most, are pinned, and only while
+    // pinned handles take less than a quarter of the cache. This keeps most
+    // of it for LRU; unpinned handles are evicted as needed.
+    size_t max_load = port::kMaxSizet;
+    const size_t capacity = table_cache_->get_cache()->GetCapacity();
+    if (capacity != TableCache::kInfiniteCapacity) {
+      const size_t load_limit = capacity / 4;
+      const size_t pinned = table_cache_->get_cache()->GetPinnedUsage();
+      if (pinned >= load_limit) {
+        return;
+      }
+      max_load = load_limit - pinned;
+    }
+
+    // <file metadata, level>, lower levels first as they are read more often
     std::vector<std::pair<FileMetaData*, int>> files_meta;
     for (int level = 0; level < base_vstorage_->num_levels(); level++) {
       for (auto& file_meta_pair : levels_[level].added_files) {
         auto* file_meta = file_meta_pair.second;
         assert(!file_meta->table_reader_handle);
+        if (files_meta.size() >= max_load) {
+          break;
+        }
         files_meta.emplace_back(file_meta, level);
       }
     }
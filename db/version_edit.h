@@ -17,6 +17,7 @@
 #include <string>
 #include "rocksdb/cache.h"
 #include "db/dbformat.h"
+#include "db/file_filter_summary.h"
 #include "util/arena.h"
 #include "util/autovector.h"
 
@@ -93,6 +94,10 @@ struct FileMetaData {
   bool marked_for_compaction;  // True if client asked us nicely to compact this
                                // file.
 
+  // In-memory filter of the user keys of the file, see
+  // ColumnFamilyOptions::level0_filter_summary_bits_per_key. May be nullptr.
+  std::shared_ptr<const FileFilterSummary> filter_summary;
+
   FileMetaData()
       : refs(0),
         being_compacted(false),
@@ -125,15 +130,21 @@ struct FdWithKeyRange {
   FileDescriptor fd;
   Slice smallest_key;    // slice that contain smallest key
   Slice largest_key;     // slice that contain largest key
+  // FileMetaData::filter_summary of the file, if any
+  const FileFilterSummary* filter_summary;
 
   FdWithKeyRange()
       : fd(),
         smallest_key(),
-        largest_key() {
+        largest_key(),
+        filter_summary(nullptr) {
   }
 
   FdWithKeyRange(FileDescriptor _fd, Slice _smallest_key, Slice _largest_key)
-      : fd(_fd), smallest_key(_smallest_key), largest_key(_largest_key) {}
+      : fd(_fd),
+        smallest_key(_smallest_key),
+        largest_key(_largest_key),
+        filter_summary(nullptr) {}
 };
 
 // Data structure to store an array of FdWithKeyRange in one level
@@ -372,6 +372,7 @@ void DoGenerateLevelFilesBrief(LevelFilesBrief* file_level,
     f.fd = files[i]->fd;
     f.smallest_key = Slice(mem, smallest_size);
     f.largest_key = Slice(mem + smallest_size, largest_size);
+    f.filter_summary = files[i]->filter_summary.get();
   }
 }
 
@@ -535,6 +536,20 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
                *read_options_.iterate_upper_bound) >= 0;
   }
 
+  Slice UpperBoundKey() override {
+    if (read_options_.iterate_upper_bound == nullptr) {
+      return Slice();
+    }
+    // Built from the bound at each call, since the caller may change the
+    // bound between seeks
+    upper_bound_key_.clear();
+    AppendInternalKey(&upper_bound_key_,
+                      ParsedInternalKey(*read_options_.iterate_upper_bound,
+                                        kMaxSequenceNumber,
+                                        kValueTypeForSeek));
+    return upper_bound_key_;
+  }
+
  private:
   TableCache* table_cache_;
   const ReadOptions read_options_;
@@ -545,6 +560,7 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
   bool skip_filters_;
   int level_;
   RangeDelAggregator* range_del_agg_;
+  std::string upper_bound_key_;
 };
 
 // A wrapper of version builder which references the current version in
@@ -714,6 +730,10 @@ size_t Version::GetMemoryUsageByTableReaders() {
       total_usage += cfd_->table_cache()->GetMemoryUsageByTableReader(
           vset_->env_options_, cfd_->internal_comparator(),
           file_level.files[i].fd);
+      if (file_level.files[i].filter_summary != nullptr) {
+        total_usage +=
+            file_level.files[i].filter_summary->ApproximateMemoryUsage();
+      }
     }
   }
   return total_usage;
@@ -968,6 +988,13 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
       user_comparator(), internal_comparator());
   FdWithKeyRange* f = fp.GetNextFile();
   while (f != nullptr) {
+    if (f->filter_summary != nullptr &&
+        !f->filter_summary->KeyMayMatch(user_key)) {
+      // The file does not have the key, no need to find its table
+      RecordTick(db_statistics_, L0_FILTER_SUMMARY_USEFUL);
+      f = fp.GetNextFile();
+      continue;
+    }
     *status = table_cache_->Get(
         read_options, *internal_comparator(), f->fd, ikey, &get_context,
         cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()),
@@ -2400,10 +2427,9 @@ Status VersionSet::LogAndApply(ColumnFamilyData* column_family_data,
     mu->Unlock();
 
     TEST_SYNC_POINT("VersionSet::LogAndApply:WriteManifest");
-    if (!w.edit_list.front()->IsColumnFamilyManipulation() &&
-        this->GetColumnFamilySet()->get_table_cache()->GetCapacity() ==
-            TableCache::kInfiniteCapacity) {
-      // unlimited table cache. Pre-load table handle now.
+    if (!w.edit_list.front()->IsColumnFamilyManipulation()) {
+      // Pre-load table handles of the new files now, as far as the table
+      // cache allows, see VersionBuilder::LoadTableHandlers().
       // Need to do it out of the mutex.
       builder_guard->version_builder()->LoadTableHandlers(
           column_family_data->internal_stats(),
@@ -522,6 +522,36 @@ struct AdvancedColumnFamilyOptions {
   // Default: false
   bool optimize_filters_for_hits = false;
 
+  // If positive, every level-0 file written by a flush gets an in-memory
+  // Bloom filter of its keys with about this many bits per key. It lives as
+  // long as the file and is not persisted. Point lookups probe it before
+  // looking the table up in the table cache, so they skip level-0 files that
+  // do not have the key without a table cache lookup. This helps most when
+  // there are many level-0 files. Flushed files are at most about
+  // write_buffer_size, which bounds the memory of each summary; larger
+  // level-0 files written by compactions get none, and neither do files that
+  // contain range deletions. The memory is counted in
+  // "rocksdb.estimate-table-readers-mem".
+  //
+  // Default: 0 (disabled)
+  int level0_filter_summary_bits_per_key = 0;
+
+  // If positive, the entries of this column family take at most about this
+  // many bytes of DBOptions::row_cache. Rows read while the column family is
+  // over its budget are not added to the cache, until some of its entries
+  // are evicted.
+  //
+  // Default: 0 (no limit)
+  size_t row_cache_budget = 0;
+
+  // A row is added to DBOptions::row_cache only after it was looked up in
+  // the same SST file this many times. The lookups are counted approximately,
+  // in a fixed table of counters that fade over time. Values above 255 are
+  // treated as 255.
+  //
+  // Default: 1 (add every row on its first lookup)
+  uint32_t row_cache_admission_reads = 1;
+
   // After writing every SST file, reopen it and read all the keys.
   // Default: false
   bool paranoid_file_checks = false;
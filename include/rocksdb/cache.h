@@ -46,11 +46,59 @@ extern std::shared_ptr<Cache> NewLRUCache(size_t capacity,
                                           bool strict_capacity_limit = false,
                                           double high_pri_pool_ratio = 0.0);
 
+struct LRUCacheOptions {
+  // Capacity of the cache.
+  size_t capacity = 0;
+
+  // Cache is sharded into 2^num_shard_bits shards, by hash of key. -1 means
+  // it is automatically determined, as in NewLRUCache() above.
+  int num_shard_bits = -1;
+
+  // If true, insert to the cache will fail when cache is full.
+  bool strict_capacity_limit = false;
+
+  // Percentage of the cache reserved for high priority entries.
+  double high_pri_pool_ratio = 0.0;
+
+  // If true, the cache keeps a TinyLFU sketch of how often its keys are looked
+  // up. An insert that would evict an entry is then only admitted if the new
+  // key has been looked up at least as often, recently, as the key of the
+  // entry to be evicted. This keeps scans from flushing frequently used
+  // entries. A rejected entry is dropped, or, if the caller asks for a handle,
+  // handed out through a handle that frees it once released. The sketch
+  // takes a few bytes per 4KB of capacity.
+  bool tiny_lfu_admission = false;
+
+  // If true and RocksDB is built with the NUMA library, the shards are split
+  // into one set per NUMA node of the host, allocated on that node, and
+  // num_shard_bits is the number of shard bits of each set. Entries are
+  // inserted into the set of the node the inserting thread runs on, and
+  // lookups try that node first before the others. Lookups served by another
+  // node are counted in the ticker BLOCK_CACHE_NUMA_REMOTE_HIT of the
+  // statistics passed to Cache::Lookup(). Has no effect on hosts with a
+  // single node.
+  bool numa_aware = false;
+
+  // Fraction of capacity that can hold entries in compressed form. Entries
+  // inserted with Cache::InsertWithHelper() are compressed with LZ4 when
+  // they are evicted, and stay in the cache in that form, charged by their
+  // compressed size, until the compressed entries exceed this fraction of
+  // capacity. Cache::LookupWithHelper() decompresses such an entry and moves
+  // it back. The tier is disabled if RocksDB is built without LZ4.
+  double compressed_tier_ratio = 0.0;
+
+  // If set, admission decisions are counted in the tickers
+  // BLOCK_CACHE_ADMISSION_ACCEPTED and BLOCK_CACHE_ADMISSION_REJECTED.
+  std::shared_ptr<Statistics> statistics = nullptr;
+};
+
+extern std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts);
+
 // Similar to NewLRUCache, but create a cache based on CLOCK algorithm with
-// better concurrent performance in some cases. See util/clock_cache.cc for
-// more detail.
+// better concurrent performance in some cases. Lookups do not take any lock.
+// See cache/clock_cache.cc for more detail.
 //
-// Return nullptr if it is not supported.
+// Return nullptr if it is not supported (in ROCKSDB_LITE).
 extern std::shared_ptr<Cache> NewClockCache(size_t capacity,
                                             int num_shard_bits = -1,
                                             bool strict_capacity_limit = false);
@@ -104,6 +152,53 @@ class Cache {
   // function.
   virtual Handle* Lookup(const Slice& key, Statistics* stats = nullptr) = 0;
 
+  // Returns true if the cache has a mapping for "key". Unlike Lookup(), it
+  // does not count as a use of the entry, so it does not change the order in
+  // which entries are evicted. The default implementation falls back to
+  // Lookup().
+  virtual bool Contains(const Slice& key) {
+    Handle* handle = Lookup(key);
+    if (handle == nullptr) {
+      return false;
+    }
+    Release(handle);
+    return true;
+  }
+
+  // Tells a cache with a compressed tier (see
+  // LRUCacheOptions::compressed_tier_ratio) how to keep an entry in that
+  // tier once it is evicted, and how to make the value again when the entry
+  // is looked up. The cache compresses the serialized form of the value.
+  struct TierHelper {
+    // Size of the serialized form of value
+    size_t (*size)(void* value);
+    // Writes the serialized form of value, size(value) bytes, to out
+    void (*save)(void* value, char* out);
+    // Makes a value, and its charge, from its serialized form
+    Status (*create)(const Slice& data, void** value, size_t* charge);
+    // Deletes the values
+    void (*deleter)(const Slice& key, void* value);
+  };
+
+  // Same as Insert(), but the entry may move to the compressed tier of the
+  // cache when it is evicted, instead of being deleted. helper has to
+  // outlive the cache. A cache without such a tier inserts the entry as
+  // Insert() does, with helper->deleter.
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const TierHelper* helper, size_t charge,
+                                  Handle** handle = nullptr,
+                                  Priority priority = Priority::LOW) {
+    return Insert(key, value, charge, helper->deleter, handle, priority);
+  }
+
+  // Same as Lookup(), but an entry found in the compressed tier of the cache
+  // is made again with helper and moved back into the cache. Lookup() treats
+  // such an entry as a miss.
+  virtual Handle* LookupWithHelper(const Slice& key, const TierHelper* helper,
+                                   Statistics* stats = nullptr) {
+    return Lookup(key, stats);
+  }
+
   // Increments the reference count for the handle if it refers to an entry in
   // the cache. Returns true if refcount was incremented; otherwise, returns
   // false.
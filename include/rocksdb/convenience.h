@@ -213,6 +213,8 @@ Status GetDBOptionsFromMap(
 //     - Pass {"filter_policy", "bloomfilter:4:true"} in
 //       GetBlockBasedTableOptionsFromMap to use a BloomFilter with 4-bits
 //       per key and use_block_based_builder enabled.
+//   - XorFilter: use "xorfilter:[bits_per_key]" to specify an XOR filter,
+//     equivalent to calling NewXorFilterPolicy(bits_per_key).
 //
 // * block_cache / block_cache_compressed:
 //   We currently only support LRU cache in the GetOptions API.  The LRU
@@ -528,7 +528,8 @@ class DB {
 
     //  "rocksdb.estimate-table-readers-mem" - returns estimated memory used for
     //      reading SST tables, excluding memory used in block cache (e.g.,
-    //      filter and index blocks).
+    //      filter and index blocks), including the filter summaries of
+    //      level-0 files (see level0_filter_summary_bits_per_key).
     static const std::string kEstimateTableReadersMem;
 
     //  "rocksdb.is-file-deletions-enabled" - returns 0 if deletion of obsolete
@@ -593,6 +594,25 @@ class DB {
 
     //  "rocksdb.is-write-stopped" - Return 1 if write has been stopped.
     static const std::string kIsWriteStopped;
+
+    //  "rocksdb.metadata-cache-capacity" - returns the capacity of the
+    //      metadata_cache of the column family's block-based tables.
+    static const std::string kMetadataCacheCapacity;
+
+    //  "rocksdb.metadata-cache-usage" - returns the memory used by the index
+    //      and filter blocks in the metadata_cache.
+    static const std::string kMetadataCacheUsage;
+
+    //  "rocksdb.metadata-cache-pinned-usage" - returns the memory used by the
+    //      index and filter blocks pinned in the metadata_cache.
+    static const std::string kMetadataCachePinnedUsage;
+
+    //  "rocksdb.block-cache-miss-ratio-curve" - returns a multi-line string
+    //      with the miss ratios estimated for a range of block cache
+    //      capacities, if the block_cache of the column family's block-based
+    //      tables was created with NewMissRatioCurveCache(). As a map
+    //      property, maps each capacity to its miss ratio.
+    static const std::string kBlockCacheMissRatioCurve;
   };
 #endif /* ROCKSDB_LITE */
 
@@ -643,6 +663,9 @@ class DB {
   //  "rocksdb.num-running-flushes"
   //  "rocksdb.actual-delayed-write-rate"
   //  "rocksdb.is-write-stopped"
+  //  "rocksdb.metadata-cache-capacity"
+  //  "rocksdb.metadata-cache-usage"
+  //  "rocksdb.metadata-cache-pinned-usage"
   virtual bool GetIntProperty(ColumnFamilyHandle* column_family,
                               const Slice& property, uint64_t* value) = 0;
   virtual bool GetIntProperty(const Slice& property, uint64_t* value) {
@@ -656,6 +679,16 @@ class DB {
     return Status::NotSupported("Not implemented");
   }
 
+  // Write to the file at path the list of data blocks of the live SST files
+  // that are currently in the block cache. Pass the file as
+  // DBOptions::block_cache_warmup_file to load these blocks again after the
+  // DB is reopened. The blocks are found with Cache::Contains(), so that
+  // recording them does not change the order in which the cache evicts
+  // them, and the SST files whose table readers are not open are skipped.
+  virtual Status DumpBlockCacheKeys(const std::string& path) {
+    return Status::NotSupported("Not implemented");
+  }
+
   // Same as GetIntProperty(), but this one returns the aggregated int
   // property from all column families.
   virtual bool GetAggregatedIntProperty(const Slice& property,
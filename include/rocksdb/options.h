@@ -887,6 +887,18 @@ struct DBOptions {
   // DEFAULT: false
   // Immutable.
   bool allow_ingest_behind = false;
+
+  // If not empty, DB::Open() schedules a background job that loads the data
+  // blocks listed in this file, written by DB::DumpBlockCacheKeys(), into
+  // the block cache. Blocks that are close to each other in a table file are
+  // read with one large read. Blocks of table files that are no longer live
+  // are skipped. The job runs in the Env::LOW thread pool; it reads one file
+  // at a time, and gives its thread up to the jobs queued meanwhile before it
+  // goes on with the next file, so it does not hold compactions back.
+  //
+  // DEFAULT: ""
+  // Immutable.
+  std::string block_cache_warmup_file = "";
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1033,6 +1045,8 @@ struct ReadOptions {
   // If non-zero, NewIterator will create a new table reader which
   // performs reads of the given size. Using a large size (> 2MB) can
   // improve the performance of forward iteration on spinning disks.
+  // When 0, block-based table iterators read ahead automatically once they
+  // detect a sequential scan, with a window growing from 8KB to 256KB.
   // Default: 0
   size_t readahead_size;
 
@@ -1048,6 +1062,29 @@ struct ReadOptions {
   // Default: 0
   uint64_t max_skippable_internal_keys;
 
+  // If true, iterators only produce keys: Iterator::value() returns an empty
+  // slice and the values are never read from the memtables or the data
+  // blocks. Merge operands are not merged either, a key whose newest visible
+  // entries are merge operands is returned unless it is deleted.
+  // Useful for counting keys, checking existence or exporting keys, in
+  // particular together with BlockBasedTableOptions::kColumnLayout.
+  // Default: false
+  bool keys_only;
+
+  // If non-zero, forward iterators over block-based tables load up to this
+  // many data blocks ahead of the current one into the block cache, so that
+  // reading the next block overlaps with consuming the current one. Only
+  // takes effect with a block cache, fill_cache == true and
+  // read_tier == kReadAllTier.
+  // The loads run on the LOW priority thread pool of the Env, which is
+  // shared with compactions: they wait behind running compactions and hold
+  // threads compactions could use. To bound the latter, an iterator keeps
+  // at most half of the pool's threads, and at least one, busy with loads
+  // at a time. Consider raising the number of LOW priority threads with
+  // Env::SetBackgroundThreads() when using this option.
+  // Default: 0
+  size_t async_prefetch_blocks;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
@@ -221,6 +221,23 @@ enum Tickers : uint32_t {
   // Number of refill intervals where rate limiter's bytes are fully consumed.
   NUMBER_RATE_LIMITER_DRAINS,
 
+  // # of times a range filter was checked on Seek().
+  RANGE_FILTER_CHECKED,
+  // # of times a range filter avoided reading a table on Seek().
+  RANGE_FILTER_USEFUL,
+
+  // # of times the in-memory filter summary of a level-0 file let a point
+  // lookup skip the file.
+  L0_FILTER_SUMMARY_USEFUL,
+
+  // # of inserts into a cache with a TinyLFU admission filter that would evict
+  // entries and were let into the cache, or were kept out of it.
+  BLOCK_CACHE_ADMISSION_ACCEPTED,
+  BLOCK_CACHE_ADMISSION_REJECTED,
+
+  // # of block cache hits served by the shards of another NUMA node.
+  BLOCK_CACHE_NUMA_REMOTE_HIT,
+
   TICKER_ENUM_MAX
 };
 
@@ -324,6 +341,12 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {READ_AMP_ESTIMATE_USEFUL_BYTES, "rocksdb.read.amp.estimate.useful.bytes"},
     {READ_AMP_TOTAL_READ_BYTES, "rocksdb.read.amp.total.read.bytes"},
     {NUMBER_RATE_LIMITER_DRAINS, "rocksdb.number.rate_limiter.drains"},
+    {RANGE_FILTER_CHECKED, "rocksdb.range.filter.checked"},
+    {RANGE_FILTER_USEFUL, "rocksdb.range.filter.useful"},
+    {L0_FILTER_SUMMARY_USEFUL, "rocksdb.l0.filter.summary.useful"},
+    {BLOCK_CACHE_ADMISSION_ACCEPTED, "rocksdb.block.cache.admission.accepted"},
+    {BLOCK_CACHE_ADMISSION_REJECTED, "rocksdb.block.cache.admission.rejected"},
+    {BLOCK_CACHE_NUMA_REMOTE_HIT, "rocksdb.block.cache.numa.remote.hit"},
 };
 
 /**
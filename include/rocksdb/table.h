@@ -46,6 +46,9 @@ enum ChecksumType : char {
   kNoChecksum = 0x0,  // not yet supported. Will fail
   kCRC32c = 0x1,
   kxxHash = 0x2,
+  // Lower 32 bits of the 64-bit xxHash. Faster than kCRC32c and kxxHash on
+  // 64-bit platforms. Not readable by older RocksDB versions.
+  kxxHash64 = 0x3,
 };
 
 // For advanced user only
@@ -92,6 +95,14 @@ struct BlockBasedTableOptions {
     // it is ready to be used in production.
     // A two-level index implementation. Both levels are binary search indexes.
     kTwoLevelIndexSearch,
+
+    // A binary search index block plus a piecewise-linear model of its keys,
+    // which predicts the position of a key within a few entries. Seeks then
+    // only binary search around the prediction. Works best for integer-like
+    // or evenly distributed keys; for other keys, or with a comparator other
+    // than the bytewise one, no model is stored and the index behaves like
+    // kBinarySearch. Older versions cannot read such files.
+    kLearnedIndexSearch,
   };
 
   IndexType index_type = kBinarySearch;
@@ -122,6 +133,23 @@ struct BlockBasedTableOptions {
   // If NULL, rocksdb will not use a compressed block cache.
   std::shared_ptr<Cache> block_cache_compressed = nullptr;
 
+  // If non-NULL and cache_index_and_filter_blocks is true, index and filter
+  // blocks are stored in this cache instead of block_cache, so that they do
+  // not compete with data blocks. The index and filter blocks of every table,
+  // or their top-level blocks if they are partitioned, are pinned in it as
+  // long as the table reader is alive. The capacity of this cache is the
+  // memory budget of the metadata: a table whose blocks do not fit in what
+  // the other tables left of it, as far as known when it is opened, keeps
+  // them in block_cache, unpinned. See DB::Properties::kMetadataCacheUsage.
+  // It may be shared by several column families and DBs.
+  std::shared_ptr<Cache> metadata_cache = nullptr;
+
+  // If metadata_cache is set, the index and filter partitions of files at
+  // this level or lower are stored and pinned in metadata_cache too. The
+  // partitions of the other files go to block_cache. -1 keeps all partitions
+  // in block_cache.
+  int metadata_cache_partitions_max_level = -1;
+
   // Approximate size of user data packed per block.  Note that the
   // block size specified here corresponds to uncompressed data.  The
   // actual size of the unit read from disk may be smaller if
@@ -170,6 +198,23 @@ struct BlockBasedTableOptions {
   // Default: true
   bool use_delta_encoding = true;
 
+  // The layout of the entries inside data blocks.
+  enum DataBlockLayout : char {
+    // Each entry stores its (delta encoded) key immediately followed by its
+    // value.
+    kRowLayout,
+
+    // Keys and values are stored in two separate columns of the block
+    // (PAX-style): all delta encoded keys first, then all values back to
+    // back. Adjacent values of a fixed schema compress considerably better,
+    // and iterating keys only does not have to skip over value bytes.
+    // Blocks in this layout are rejected as corrupted by RocksDB versions
+    // that do not know about it.
+    kColumnLayout,
+  };
+
+  DataBlockLayout data_block_layout = kRowLayout;
+
   // If non-nullptr, use the specified filter policy to reduce disk reads.
   // Many applications will benefit from passing the result of
   // NewBloomFilterPolicy() here.
@@ -179,6 +224,36 @@ struct BlockBasedTableOptions {
   // This must generally be true for gets to be efficient.
   bool whole_key_filtering = true;
 
+  // If positive, and a prefix extractor is configured together with
+  // whole_key_filtering and a full (or partitioned) filter, tables keep the
+  // key prefixes in a Bloom filter of their own with about this many bits per
+  // distinct prefix. filter_policy then sizes a filter of the whole keys only.
+  // Point lookups probe the whole key filter and prefix seeks the prefix
+  // filter, each at the false positive rate chosen for it, instead of sharing
+  // one filter of both.
+  //
+  // Default: 0 (prefixes are added to the filter of filter_policy)
+  int prefix_filter_bits_per_key = 0;
+
+  // If positive, every table gets a range filter with about this many bits
+  // per distinct key prefix. Iterators created with
+  // ReadOptions::iterate_upper_bound use it to skip the tables that have no
+  // key in [seek key, upper bound) on Seek(), without reading any of their
+  // data blocks. The filter holds all prefixes of the user keys up to
+  // range_filter_max_prefix_len bytes long. It works best when the seek key
+  // and the upper bound share a long common prefix.
+  //
+  // Only used with the default bytewise comparator. Not built for tables that
+  // contain range deletions.
+  //
+  // Default: 0 (disabled)
+  int range_filter_bits_per_key = 0;
+
+  // The longest key prefix, in bytes, added to the range filter. Ranges
+  // whose bounds share a longer common prefix are filtered at this length.
+  // At most 255.
+  int range_filter_max_prefix_len = 16;
+
   // Verify that decompressing the compressed block gives back the input. This
   // is a verification mode that we use to detect bugs in compression
   // algorithms.
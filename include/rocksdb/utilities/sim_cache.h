@@ -6,6 +6,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <map>
 #include <memory>
 #include <string>
 #include "rocksdb/cache.h"
@@ -16,6 +17,7 @@
 namespace rocksdb {
 
 class SimCache;
+class MissRatioCurveCache;
 
 // For instrumentation purpose, use NewSimCache instead of NewLRUCache API
 // NewSimCache is a wrapper function returning a SimCache instance that can
@@ -72,4 +74,50 @@ class SimCache : public Cache {
   SimCache& operator=(const SimCache&);
 };
 
+// NewMissRatioCurveCache wraps cache like NewSimCache does, but instead of
+// simulating one more capacity it estimates the miss ratio of an LRU cache
+// of every capacity up to max_sim_capacity from the same lookups. Only the
+// keys whose hash falls in a sampling_rate fraction of the hash space are
+// tracked (spatially hashed sampling, SHARDS), so the memory overhead is
+// about sampling_rate times that of a SimCache of max_sim_capacity, and the
+// other lookups only pay for a hash. Lower sampling rates give noisier
+// estimates; a few thousand tracked keys are usually enough.
+extern std::shared_ptr<MissRatioCurveCache> NewMissRatioCurveCache(
+    std::shared_ptr<Cache> cache, size_t max_sim_capacity,
+    double sampling_rate = 0.01);
+
+class MissRatioCurveCache : public Cache {
+ public:
+  MissRatioCurveCache() {}
+
+  virtual ~MissRatioCurveCache() {}
+
+  virtual const char* Name() const override { return "MissRatioCurveCache"; }
+
+  // returns the largest capacity the curve is estimated for
+  virtual size_t GetMaxSimCapacity() const = 0;
+
+  // Fills curve with the estimated miss ratio, between 0 and 1, of an LRU
+  // cache of each of kCurvePoints capacities evenly spaced up to
+  // GetMaxSimCapacity(), keyed by capacity. The curve is empty before the
+  // first sampled lookup.
+  virtual void GetMissRatioCurve(std::map<size_t, double>* curve) const = 0;
+
+  // returns the number of lookups, sampled or not
+  virtual uint64_t get_lookup_counter() const = 0;
+  // returns the number of lookups of sampled keys
+  virtual uint64_t get_sampled_lookup_counter() const = 0;
+  // reset the lookup counters and the curve. The sampled keys are kept, so
+  // the curve does not start over with cold misses.
+  virtual void reset_counter() = 0;
+  // String representation of the miss ratio curve
+  virtual std::string ToString() const = 0;
+
+  static const int kCurvePoints = 20;
+
+ private:
+  MissRatioCurveCache(const MissRatioCurveCache&);
+  MissRatioCurveCache& operator=(const MissRatioCurveCache&);
+};
+
 }  // namespace rocksdb
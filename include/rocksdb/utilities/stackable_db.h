@@ -338,6 +338,11 @@ class StackableDB : public DB {
   using DB::ResetStats;
   virtual Status ResetStats() override { return db_->ResetStats(); }
 
+  using DB::DumpBlockCacheKeys;
+  virtual Status DumpBlockCacheKeys(const std::string& path) override {
+    return db_->DumpBlockCacheKeys(path);
+  }
+
   using DB::GetPropertiesOfAllTables;
   virtual Status GetPropertiesOfAllTables(
       ColumnFamilyHandle* column_family,
@@ -20,7 +20,11 @@ public enum ChecksumType {
   /**
    * XX Hash
    */
-  kxxHash((byte) 2);
+  kxxHash((byte) 2),
+  /**
+   * XX Hash 64
+   */
+  kxxHash64((byte) 3);
 
   /**
    * Returns the byte value of the enumerations value
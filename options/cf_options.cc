@@ -70,6 +70,10 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
       compaction_readahead_size(db_options.compaction_readahead_size),
       num_levels(cf_options.num_levels),
       optimize_filters_for_hits(cf_options.optimize_filters_for_hits),
+      level0_filter_summary_bits_per_key(
+          cf_options.level0_filter_summary_bits_per_key),
+      row_cache_budget(cf_options.row_cache_budget),
+      row_cache_admission_reads(cf_options.row_cache_admission_reads),
       force_consistency_checks(cf_options.force_consistency_checks),
       allow_ingest_behind(db_options.allow_ingest_behind),
       listeners(db_options.listeners),
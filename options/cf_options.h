@@ -106,6 +106,12 @@ struct ImmutableCFOptions {
 
   bool optimize_filters_for_hits;
 
+  int level0_filter_summary_bits_per_key;
+
+  size_t row_cache_budget;
+
+  uint32_t row_cache_admission_reads;
+
   bool force_consistency_checks;
 
   bool allow_ingest_behind;
@@ -86,7 +86,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       fail_if_options_file_error(options.fail_if_options_file_error),
       dump_malloc_stats(options.dump_malloc_stats),
       avoid_flush_during_recovery(options.avoid_flush_during_recovery),
-      allow_ingest_behind(options.allow_ingest_behind) {
+      allow_ingest_behind(options.allow_ingest_behind),
+      block_cache_warmup_file(options.block_cache_warmup_file) {
 }
 
 void ImmutableDBOptions::Dump(Logger* log) const {
@@ -219,6 +220,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    avoid_flush_during_recovery);
   ROCKS_LOG_HEADER(log, "            Options.allow_ingest_behind: %d",
                    allow_ingest_behind);
+  ROCKS_LOG_HEADER(log, "        Options.block_cache_warmup_file: %s",
+                   block_cache_warmup_file.c_str());
 }
 
 MutableDBOptions::MutableDBOptions()
@@ -79,6 +79,7 @@ struct ImmutableDBOptions {
   bool dump_malloc_stats;
   bool avoid_flush_during_recovery;
   bool allow_ingest_behind;
+  std::string block_cache_warmup_file;
 };
 
 struct MutableDBOptions {
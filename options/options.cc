@@ -85,6 +85,10 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.table_properties_collector_factories),
       max_successive_merges(options.max_successive_merges),
       optimize_filters_for_hits(options.optimize_filters_for_hits),
+      level0_filter_summary_bits_per_key(
+          options.level0_filter_summary_bits_per_key),
+      row_cache_budget(options.row_cache_budget),
+      row_cache_admission_reads(options.row_cache_admission_reads),
       paranoid_file_checks(options.paranoid_file_checks),
       force_consistency_checks(options.force_consistency_checks),
       report_bg_io_stats(options.report_bg_io_stats) {
@@ -193,7 +197,8 @@ DBOptions::DBOptions(const Options& options)
       dump_malloc_stats(options.dump_malloc_stats),
       avoid_flush_during_recovery(options.avoid_flush_during_recovery),
       avoid_flush_during_shutdown(options.avoid_flush_during_shutdown),
-      allow_ingest_behind(options.allow_ingest_behind) {
+      allow_ingest_behind(options.allow_ingest_behind),
+      block_cache_warmup_file(options.block_cache_warmup_file) {
 }
 
 void DBOptions::Dump(Logger* log) const {
@@ -400,6 +405,15 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "               Options.optimize_filters_for_hits: %d",
                      optimize_filters_for_hits);
+    ROCKS_LOG_HEADER(log,
+                     "      Options.level0_filter_summary_bits_per_key: %d",
+                     level0_filter_summary_bits_per_key);
+    ROCKS_LOG_HEADER(
+        log, "                        Options.row_cache_budget: %" ROCKSDB_PRIszt,
+        row_cache_budget);
+    ROCKS_LOG_HEADER(
+        log, "               Options.row_cache_admission_reads: %" PRIu32,
+        row_cache_admission_reads);
     ROCKS_LOG_HEADER(log, "               Options.paranoid_file_checks: %d",
                      paranoid_file_checks);
     ROCKS_LOG_HEADER(log, "               Options.force_consistency_checks: %d",
@@ -615,7 +629,9 @@ ReadOptions::ReadOptions()
       background_purge_on_iterator_cleanup(false),
       readahead_size(0),
       ignore_range_deletions(false),
-      max_skippable_internal_keys(0) {}
+      max_skippable_internal_keys(0),
+      keys_only(false),
+      async_prefetch_blocks(0) {}
 
 ReadOptions::ReadOptions(bool cksum, bool cache)
     : verify_checksums(cksum),
@@ -631,6 +647,8 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       background_purge_on_iterator_cleanup(false),
       readahead_size(0),
       ignore_range_deletions(false),
-      max_skippable_internal_keys(0) {}
+      max_skippable_internal_keys(0),
+      keys_only(false),
+      async_prefetch_blocks(0) {}
 
 }  // namespace rocksdb
@@ -122,6 +122,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       mutable_db_options.avoid_flush_during_shutdown;
   options.allow_ingest_behind =
       immutable_db_options.allow_ingest_behind;
+  options.block_cache_warmup_file =
+      immutable_db_options.block_cache_warmup_file;
 
   return options;
 }
@@ -363,6 +365,11 @@ bool ParseOptionHelper(char* opt_address, const OptionType& opt_type,
       return ParseEnum<BlockBasedTableOptions::IndexType>(
           block_base_table_index_type_string_map, value,
           reinterpret_cast<BlockBasedTableOptions::IndexType*>(opt_address));
+    case OptionType::kBlockBasedTableDataBlockLayout:
+      return ParseEnum<BlockBasedTableOptions::DataBlockLayout>(
+          block_base_table_data_block_layout_string_map, value,
+          reinterpret_cast<BlockBasedTableOptions::DataBlockLayout*>(
+              opt_address));
     case OptionType::kEncodingType:
       return ParseEnum<EncodingType>(
           encoding_type_string_map, value,
@@ -520,6 +527,12 @@ bool SerializeSingleOptionHelper(const char* opt_address,
           *reinterpret_cast<const BlockBasedTableOptions::IndexType*>(
               opt_address),
           value);
+    case OptionType::kBlockBasedTableDataBlockLayout:
+      return SerializeEnum<BlockBasedTableOptions::DataBlockLayout>(
+          block_base_table_data_block_layout_string_map,
+          *reinterpret_cast<const BlockBasedTableOptions::DataBlockLayout*>(
+              opt_address),
+          value);
     case OptionType::kFlushBlockPolicyFactory: {
       const auto* ptr =
           reinterpret_cast<const std::shared_ptr<FlushBlockPolicyFactory>*>(
@@ -1020,9 +1033,19 @@ std::string ParseBlockBasedTableOption(const std::string& name,
     } else if (name == "block_cache_compressed") {
       new_options->block_cache_compressed = NewLRUCache(ParseSizeT(value));
       return "";
+    } else if (name == "metadata_cache") {
+      new_options->metadata_cache = NewLRUCache(ParseSizeT(value));
+      return "";
     } else if (name == "filter_policy") {
       // Expect the following format
       // bloomfilter:int:bool
+      // xorfilter:int
+      const std::string kXorName = "xorfilter:";
+      if (value.compare(0, kXorName.size(), kXorName) == 0) {
+        int bits_per_key = ParseInt(trim(value.substr(kXorName.size())));
+        new_options->filter_policy.reset(NewXorFilterPolicy(bits_per_key));
+        return "";
+      }
       const std::string kName = "bloomfilter:";
       if (value.compare(0, kName.size(), kName) != 0) {
         return "Invalid filter policy name";
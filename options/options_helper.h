@@ -84,6 +84,7 @@ enum class OptionType {
   kMergeOperator,
   kMemTableRepFactory,
   kBlockBasedTableIndexType,
+  kBlockBasedTableDataBlockLayout,
   kFilterPolicy,
   kFlushBlockPolicyFactory,
   kChecksumType,
@@ -346,7 +347,11 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"allow_ingest_behind",
      {offsetof(struct DBOptions, allow_ingest_behind),
       OptionType::kBoolean, OptionVerificationType::kNormal, false,
-      offsetof(struct ImmutableDBOptions, allow_ingest_behind)}}};
+      offsetof(struct ImmutableDBOptions, allow_ingest_behind)}},
+    {"block_cache_warmup_file",
+     {offsetof(struct DBOptions, block_cache_warmup_file),
+      OptionType::kString, OptionVerificationType::kNormal, false,
+      offsetof(struct ImmutableDBOptions, block_cache_warmup_file)}}};
 
 // offset_of is used to get the offset of a class data member
 // ex: offset_of(&ColumnFamilyOptions::num_levels)
@@ -397,6 +402,15 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
     {"optimize_filters_for_hits",
      {offset_of(&ColumnFamilyOptions::optimize_filters_for_hits),
       OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+    {"level0_filter_summary_bits_per_key",
+     {offset_of(&ColumnFamilyOptions::level0_filter_summary_bits_per_key),
+      OptionType::kInt, OptionVerificationType::kNormal, false, 0}},
+    {"row_cache_budget",
+     {offset_of(&ColumnFamilyOptions::row_cache_budget), OptionType::kSizeT,
+      OptionVerificationType::kNormal, false, 0}},
+    {"row_cache_admission_reads",
+     {offset_of(&ColumnFamilyOptions::row_cache_admission_reads),
+      OptionType::kUInt32T, OptionVerificationType::kNormal, false, 0}},
     {"paranoid_file_checks",
      {offset_of(&ColumnFamilyOptions::paranoid_file_checks),
       OptionType::kBoolean, OptionVerificationType::kNormal, true,
@@ -574,6 +588,7 @@ static std::unordered_map<std::string, OptionTypeInfo>
         /* currently not supported
           std::shared_ptr<Cache> block_cache = nullptr;
           std::shared_ptr<Cache> block_cache_compressed = nullptr;
+          std::shared_ptr<Cache> metadata_cache = nullptr;
          */
         {"flush_block_policy_factory",
          {offsetof(struct BlockBasedTableOptions, flush_block_policy_factory),
@@ -595,6 +610,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, index_type),
           OptionType::kBlockBasedTableIndexType,
           OptionVerificationType::kNormal, false, 0}},
+        {"data_block_layout",
+         {offsetof(struct BlockBasedTableOptions, data_block_layout),
+          OptionType::kBlockBasedTableDataBlockLayout,
+          OptionVerificationType::kNormal, false, 0}},
         {"hash_index_allow_collision",
          {offsetof(struct BlockBasedTableOptions, hash_index_allow_collision),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
@@ -633,6 +652,19 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"whole_key_filtering",
          {offsetof(struct BlockBasedTableOptions, whole_key_filtering),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"metadata_cache_partitions_max_level",
+         {offsetof(struct BlockBasedTableOptions,
+                   metadata_cache_partitions_max_level),
+          OptionType::kInt, OptionVerificationType::kNormal, false, 0}},
+        {"prefix_filter_bits_per_key",
+         {offsetof(struct BlockBasedTableOptions, prefix_filter_bits_per_key),
+          OptionType::kInt, OptionVerificationType::kNormal, false, 0}},
+        {"range_filter_bits_per_key",
+         {offsetof(struct BlockBasedTableOptions, range_filter_bits_per_key),
+          OptionType::kInt, OptionVerificationType::kNormal, false, 0}},
+        {"range_filter_max_prefix_len",
+         {offsetof(struct BlockBasedTableOptions, range_filter_max_prefix_len),
+          OptionType::kInt, OptionVerificationType::kNormal, false, 0}},
         {"skip_table_builder_flush",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated, false,
           0}},
@@ -690,13 +722,24 @@ static std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
         {"kBinarySearch", BlockBasedTableOptions::IndexType::kBinarySearch},
         {"kHashSearch", BlockBasedTableOptions::IndexType::kHashSearch},
         {"kTwoLevelIndexSearch",
-         BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch}};
+         BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch},
+        {"kLearnedIndexSearch",
+         BlockBasedTableOptions::IndexType::kLearnedIndexSearch}};
+
+static std::unordered_map<std::string, BlockBasedTableOptions::DataBlockLayout>
+    block_base_table_data_block_layout_string_map = {
+        {"kRowLayout", BlockBasedTableOptions::DataBlockLayout::kRowLayout},
+        {"kColumnLayout",
+         BlockBasedTableOptions::DataBlockLayout::kColumnLayout}};
 
 static std::unordered_map<std::string, EncodingType> encoding_type_string_map =
     {{"kPlain", kPlain}, {"kPrefix", kPrefix}};
 
 static std::unordered_map<std::string, ChecksumType> checksum_type_string_map =
-    {{"kNoChecksum", kNoChecksum}, {"kCRC32c", kCRC32c}, {"kxxHash", kxxHash}};
+    {{"kNoChecksum", kNoChecksum},
+     {"kCRC32c", kCRC32c},
+     {"kxxHash", kxxHash},
+     {"kxxHash64", kxxHash64}};
 
 static std::unordered_map<std::string, CompactionStyle>
     compaction_style_string_map = {
@@ -571,6 +571,12 @@ bool AreEqualOptions(
           *reinterpret_cast<const BlockBasedTableOptions::IndexType*>(
               offset1) ==
           *reinterpret_cast<const BlockBasedTableOptions::IndexType*>(offset2));
+    case OptionType::kBlockBasedTableDataBlockLayout:
+      return (
+          *reinterpret_cast<const BlockBasedTableOptions::DataBlockLayout*>(
+              offset1) ==
+          *reinterpret_cast<const BlockBasedTableOptions::DataBlockLayout*>(
+              offset2));
     case OptionType::kWALRecoveryMode:
       return (*reinterpret_cast<const WALRecoveryMode*>(offset1) ==
               *reinterpret_cast<const WALRecoveryMode*>(offset2));
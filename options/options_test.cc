@@ -498,6 +498,12 @@ TEST_F(OptionsTest, GetBlockBasedTableOptionsFromString) {
   ASSERT_EQ(table_opt.cache_index_and_filter_blocks,
             new_opt.cache_index_and_filter_blocks);
   ASSERT_EQ(table_opt.filter_policy, new_opt.filter_policy);
+
+  // xor filter
+  ASSERT_OK(GetBlockBasedTableOptionsFromString(table_opt,
+            "filter_policy=xorfilter:8", &new_opt));
+  ASSERT_TRUE(new_opt.filter_policy != nullptr);
+  ASSERT_TRUE(new_opt.filter_policy != table_opt.filter_policy);
 }
 #endif  // !ROCKSDB_LITE
 
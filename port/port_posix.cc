@@ -23,7 +23,12 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstdlib>
+#include <vector>
+#ifdef NUMA
+#include <numa.h>
+#endif
 #include "util/logging.h"
 
 namespace rocksdb {
@@ -161,6 +166,47 @@ int PhysicalCoreID() {
 #endif
 }
 
+#ifdef NUMA
+namespace {
+// The NUMA node of each CPU, empty if the host does not support NUMA. Looked
+// up once, since the cache asks for the node of the current core on every
+// access.
+const std::vector<int>& CpuNodes() {
+  static const std::vector<int> cpu_nodes = [] {
+    std::vector<int> nodes;
+    if (numa_available() != -1) {
+      nodes.resize(numa_num_configured_cpus());
+      for (size_t cpu = 0; cpu < nodes.size(); cpu++) {
+        nodes[cpu] = std::max(numa_node_of_cpu(static_cast<int>(cpu)), 0);
+      }
+    }
+    return nodes;
+  }();
+  return cpu_nodes;
+}
+}  // namespace
+#endif
+
+int NumaNodeCount() {
+#ifdef NUMA
+  if (!CpuNodes().empty() && numa_num_configured_nodes() > 1) {
+    return numa_num_configured_nodes();
+  }
+#endif
+  return 1;
+}
+
+int NumaNodeOfCurrentCore() {
+#ifdef NUMA
+  const std::vector<int>& cpu_nodes = CpuNodes();
+  int cpuno = PhysicalCoreID();
+  if (cpuno >= 0 && static_cast<size_t>(cpuno) < cpu_nodes.size()) {
+    return cpu_nodes[cpuno];
+  }
+#endif
+  return 0;
+}
+
 void InitOnce(OnceType* once, void (*initializer)()) {
   PthreadCall("once", pthread_once(once, initializer));
 }
@@ -181,6 +181,13 @@ static inline void AsmVolatilePause() {
 // Returns -1 if not available on this platform
 extern int PhysicalCoreID();
 
+// Returns the number of NUMA nodes of the host, 1 if RocksDB is built without
+// the NUMA library or the host does not support it
+extern int NumaNodeCount();
+
+// Returns the NUMA node of the core the calling thread runs on, 0 if unknown
+extern int NumaNodeOfCurrentCore();
+
 typedef pthread_once_t OnceType;
 #define LEVELDB_ONCE_INIT PTHREAD_ONCE_INIT
 extern void InitOnce(OnceType* once, void (*initializer)());
@@ -104,6 +104,11 @@ void CondVar::SignalAll() { cv_.notify_all(); }
 
 int PhysicalCoreID() { return GetCurrentProcessorNumber(); }
 
+// NUMA aware sharding is not supported on Windows yet
+int NumaNodeCount() { return 1; }
+
+int NumaNodeOfCurrentCore() { return 0; }
+
 void InitOnce(OnceType* once, void (*initializer)()) {
   std::call_once(once->flag_, initializer);
 }
@@ -250,6 +250,10 @@ static inline void AsmVolatilePause() {
 
 extern int PhysicalCoreID();
 
+extern int NumaNodeCount();
+
+extern int NumaNodeOfCurrentCore();
+
 // For Thread Local Storage abstraction
 typedef DWORD pthread_key_t;
 
@@ -58,6 +58,43 @@ static inline const char* DecodeEntry(const char* p, const char* limit,
   return p;
 }
 
+// Same as DecodeEntry(), but for the key column of a block in
+// BlockBasedTableOptions::kColumnLayout: the value is not stored after the
+// key delta, so only the key delta is checked against "limit".
+static inline const char* DecodeKeyEntry(const char* p, const char* limit,
+                                         uint32_t* shared,
+                                         uint32_t* non_shared,
+                                         uint32_t* value_length) {
+  if (limit - p < 3) return nullptr;
+  *shared = reinterpret_cast<const unsigned char*>(p)[0];
+  *non_shared = reinterpret_cast<const unsigned char*>(p)[1];
+  *value_length = reinterpret_cast<const unsigned char*>(p)[2];
+  if ((*shared | *non_shared | *value_length) < 128) {
+    // Fast path: all three values are encoded in one byte each
+    p += 3;
+  } else {
+    if ((p = GetVarint32Ptr(p, limit, shared)) == nullptr) return nullptr;
+    if ((p = GetVarint32Ptr(p, limit, non_shared)) == nullptr) return nullptr;
+    if ((p = GetVarint32Ptr(p, limit, value_length)) == nullptr) return nullptr;
+  }
+
+  if (static_cast<uint32_t>(limit - p) < *non_shared) {
+    return nullptr;
+  }
+  return p;
+}
+
+const char* BlockIter::DecodeEntryAt(uint32_t offset, uint32_t* shared,
+                                     uint32_t* non_shared,
+                                     uint32_t* value_length) {
+  if (column_layout_) {
+    return DecodeKeyEntry(data_ + offset, data_ + keys_end_, shared,
+                          non_shared, value_length);
+  }
+  return DecodeEntry(data_ + offset, data_ + keys_end_, shared, non_shared,
+                     value_length);
+}
+
 void BlockIter::Next() {
   assert(Valid());
   ParseNextKey();
@@ -88,6 +125,9 @@ void BlockIter::Prev() {
     }
     const Slice current_key(key_ptr, current_prev_entry.key_size);
 
+    // Cached entries are consecutive, the entry we are leaving is the one
+    // right after the restored one.
+    next_entry_offset_ = current_;
     current_ = current_prev_entry.offset;
     key_.SetInternalKey(current_key, false /* copy */);
     value_ = current_prev_entry.value;
@@ -146,6 +186,11 @@ void BlockIter::Seek(const Slice& target) {
   bool ok = false;
   if (prefix_index_) {
     ok = PrefixSeek(target, &index);
+  } else if (learned_index_) {
+    uint32_t left, right;
+    learned_index_->GetRestartRange(target, &left, &right);
+    right = std::min(right, num_restarts_ - 1);
+    ok = BinarySeek(target, std::min(left, right), right, &index);
   } else {
     ok = BinarySeek(target, 0, num_restarts_ - 1, &index);
   }
@@ -202,7 +247,7 @@ void BlockIter::SeekToLast() {
     return;
   }
   SeekToRestartPoint(num_restarts_ - 1);
-  while (ParseNextKey() && NextEntryOffset() < restarts_) {
+  while (ParseNextKey() && NextEntryOffset() < keys_end_) {
     // Keep skipping
   }
 }
@@ -218,7 +263,7 @@ void BlockIter::CorruptionError() {
 bool BlockIter::ParseNextKey() {
   current_ = NextEntryOffset();
   const char* p = data_ + current_;
-  const char* limit = data_ + restarts_;  // Restarts come right after data
+  const char* limit = data_ + keys_end_;  // Restarts (or values) come next
   if (p >= limit) {
     // No more entries to return.  Mark as invalid.
     current_ = restarts_;
@@ -228,7 +273,20 @@ bool BlockIter::ParseNextKey() {
 
   // Decode next entry
   uint32_t shared, non_shared, value_length;
-  p = DecodeEntry(p, limit, &shared, &non_shared, &value_length);
+  p = DecodeEntryAt(current_, &shared, &non_shared, &value_length);
+  const char* value_ptr = nullptr;
+  if (p != nullptr) {
+    if (column_layout_) {
+      // The value follows the previous one in the value column
+      value_ptr = value_.data() + value_.size();
+      if (static_cast<uint32_t>(data_ + value_restarts_ - value_ptr) <
+          value_length) {
+        p = nullptr;
+      }
+    } else {
+      value_ptr = p + non_shared;
+    }
+  }
   if (p == nullptr || key_.Size() < shared) {
     CorruptionError();
     return false;
@@ -264,7 +322,10 @@ bool BlockIter::ParseNextKey() {
       key_.UpdateInternalKey(global_seqno_, ValueType::kTypeValue);
     }
 
-    value_ = Slice(p + non_shared, value_length);
+    value_ = Slice(value_ptr, value_length);
+    if (column_layout_) {
+      next_entry_offset_ = static_cast<uint32_t>(p + non_shared - data_);
+    }
     while (restart_index_ + 1 < num_restarts_ &&
            GetRestartPoint(restart_index_ + 1) < current_) {
       ++restart_index_;
@@ -285,8 +346,8 @@ bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
     uint32_t mid = (left + right + 1) / 2;
     uint32_t region_offset = GetRestartPoint(mid);
     uint32_t shared, non_shared, value_length;
-    const char* key_ptr = DecodeEntry(data_ + region_offset, data_ + restarts_,
-                                      &shared, &non_shared, &value_length);
+    const char* key_ptr =
+        DecodeEntryAt(region_offset, &shared, &non_shared, &value_length);
     if (key_ptr == nullptr || (shared != 0)) {
       CorruptionError();
       return false;
@@ -315,8 +376,8 @@ bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
 int BlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
   uint32_t region_offset = GetRestartPoint(block_index);
   uint32_t shared, non_shared, value_length;
-  const char* key_ptr = DecodeEntry(data_ + region_offset, data_ + restarts_,
-                                    &shared, &non_shared, &value_length);
+  const char* key_ptr =
+      DecodeEntryAt(region_offset, &shared, &non_shared, &value_length);
   if (key_ptr == nullptr || (shared != 0)) {
     CorruptionError();
     return 1;  // Return target is smaller
@@ -392,7 +453,8 @@ bool BlockIter::PrefixSeek(const Slice& target, uint32_t* index) {
 
 uint32_t Block::NumRestarts() const {
   assert(size_ >= 2*sizeof(uint32_t));
-  return DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  return DecodeFixed32(data_ + size_ - sizeof(uint32_t)) &
+         ~kColumnLayoutRestartsFlag;
 }
 
 Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
@@ -400,9 +462,30 @@ Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
     : contents_(std::move(contents)),
       data_(contents_.data.data()),
       size_(contents_.data.size()),
+      column_layout_(false),
+      values_offset_(0),
+      value_restart_offset_(0),
       global_seqno_(_global_seqno) {
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
+  } else if (DecodeFixed32(data_ + size_ - sizeof(uint32_t)) &
+             kColumnLayoutRestartsFlag) {
+    column_layout_ = true;
+    // value_restarts[n], restarts[n], values_offset and num_restarts
+    const uint64_t trailer_size =
+        (2 * static_cast<uint64_t>(NumRestarts()) + 2) * sizeof(uint32_t);
+    if (trailer_size > size_) {
+      size_ = 0;
+    } else {
+      restart_offset_ = static_cast<uint32_t>(
+          size_ - (NumRestarts() + 2) * sizeof(uint32_t));
+      value_restart_offset_ = static_cast<uint32_t>(size_ - trailer_size);
+      values_offset_ =
+          DecodeFixed32(data_ + size_ - 2 * sizeof(uint32_t));
+      if (values_offset_ > value_restart_offset_) {
+        size_ = 0;
+      }
+    }
   } else {
     restart_offset_ =
         static_cast<uint32_t>(size_) - (1 + NumRestarts()) * sizeof(uint32_t);
@@ -414,7 +497,8 @@ Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
   }
   if (read_amp_bytes_per_bit != 0 && statistics && size_ != 0) {
     read_amp_bitmap_.reset(new BlockReadAmpBitmap(
-        restart_offset_, read_amp_bytes_per_bit, statistics));
+        column_layout_ ? value_restart_offset_ : restart_offset_,
+        read_amp_bytes_per_bit, statistics));
   }
 }
 
@@ -442,12 +526,15 @@ InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
 
     if (iter != nullptr) {
       iter->Initialize(cmp, data_, restart_offset_, num_restarts,
-                       prefix_index_ptr, global_seqno_, read_amp_bitmap_.get());
+                       prefix_index_ptr, global_seqno_, read_amp_bitmap_.get(),
+                       column_layout_, values_offset_, value_restart_offset_);
     } else {
       iter = new BlockIter(cmp, data_, restart_offset_, num_restarts,
                            prefix_index_ptr, global_seqno_,
-                           read_amp_bitmap_.get());
+                           read_amp_bitmap_.get(), column_layout_,
+                           values_offset_, value_restart_offset_);
     }
+    iter->SetLearnedIndex(learned_index_.get());
 
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
@@ -464,11 +551,18 @@ void Block::SetBlockPrefixIndex(BlockPrefixIndex* prefix_index) {
   prefix_index_.reset(prefix_index);
 }
 
+void Block::SetBlockLearnedIndex(BlockLearnedIndex* learned_index) {
+  learned_index_.reset(learned_index);
+}
+
 size_t Block::ApproximateMemoryUsage() const {
   size_t usage = usable_size();
   if (prefix_index_) {
     usage += prefix_index_->ApproximateMemoryUsage();
   }
+  if (learned_index_) {
+    usage += learned_index_->ApproximateMemoryUsage();
+  }
   return usage;
 }
 
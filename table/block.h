@@ -27,6 +27,7 @@
 #include "rocksdb/iterator.h"
 #include "rocksdb/options.h"
 #include "rocksdb/statistics.h"
+#include "table/block_learned_index.h"
 #include "table/block_prefix_index.h"
 #include "table/internal_iterator.h"
 #include "util/random.h"
@@ -176,6 +177,10 @@ class Block {
                                 bool total_order_seek = true,
                                 Statistics* stats = nullptr);
   void SetBlockPrefixIndex(BlockPrefixIndex* prefix_index);
+  // Index blocks of tables with BlockBasedTableOptions::kLearnedIndexSearch
+  // narrow down their seeks with the model of their keys. Unlike the prefix
+  // index, it is also used for total order seeks.
+  void SetBlockLearnedIndex(BlockLearnedIndex* learned_index);
 
   // Report an approximation of how much memory has been used.
   size_t ApproximateMemoryUsage() const;
@@ -187,7 +192,15 @@ class Block {
   const char* data_;            // contents_.data.data()
   size_t size_;                 // contents_.data.size()
   uint32_t restart_offset_;     // Offset in data_ of restart array
+  // Blocks in BlockBasedTableOptions::kColumnLayout keep values apart from
+  // keys. values_offset_ is the start of the value column and
+  // value_restart_offset_ the start of its restart array; both are unused
+  // for row layout blocks.
+  bool column_layout_;
+  uint32_t values_offset_;
+  uint32_t value_restart_offset_;
   std::unique_ptr<BlockPrefixIndex> prefix_index_;
+  std::unique_ptr<BlockLearnedIndex> learned_index_;
   std::unique_ptr<BlockReadAmpBitmap> read_amp_bitmap_;
   // All keys in the block will have seqno = global_seqno_, regardless of
   // the encoded value (kDisableGlobalSequenceNumber means disabled)
@@ -209,30 +222,48 @@ class BlockIter : public InternalIterator {
         restart_index_(0),
         status_(Status::OK()),
         prefix_index_(nullptr),
+        learned_index_(nullptr),
         key_pinned_(false),
         global_seqno_(kDisableGlobalSequenceNumber),
         read_amp_bitmap_(nullptr),
-        last_bitmap_offset_(0) {}
+        last_bitmap_offset_(0),
+        column_layout_(false),
+        keys_end_(0),
+        value_restarts_(0),
+        next_entry_offset_(0) {}
 
   BlockIter(const Comparator* comparator, const char* data, uint32_t restarts,
             uint32_t num_restarts, BlockPrefixIndex* prefix_index,
-            SequenceNumber global_seqno, BlockReadAmpBitmap* read_amp_bitmap)
+            SequenceNumber global_seqno, BlockReadAmpBitmap* read_amp_bitmap,
+            bool column_layout = false, uint32_t values_offset = 0,
+            uint32_t value_restarts = 0)
       : BlockIter() {
     Initialize(comparator, data, restarts, num_restarts, prefix_index,
-               global_seqno, read_amp_bitmap);
+               global_seqno, read_amp_bitmap, column_layout, values_offset,
+               value_restarts);
   }
 
+  // For blocks in BlockBasedTableOptions::kColumnLayout, `values_offset` is
+  // the offset of the value column and `value_restarts` the offset of its
+  // restart array.
   void Initialize(const Comparator* comparator, const char* data,
                   uint32_t restarts, uint32_t num_restarts,
                   BlockPrefixIndex* prefix_index, SequenceNumber global_seqno,
-                  BlockReadAmpBitmap* read_amp_bitmap) {
+                  BlockReadAmpBitmap* read_amp_bitmap,
+                  bool column_layout = false, uint32_t values_offset = 0,
+                  uint32_t value_restarts = 0) {
     assert(data_ == nullptr);           // Ensure it is called only once
     assert(num_restarts > 0);           // Ensure the param is valid
+    assert(!column_layout ||
+           (values_offset <= value_restarts && value_restarts < restarts));
 
     comparator_ = comparator;
     data_ = data;
     restarts_ = restarts;
     num_restarts_ = num_restarts;
+    column_layout_ = column_layout;
+    keys_end_ = column_layout ? values_offset : restarts;
+    value_restarts_ = value_restarts;
     current_ = restarts_;
     restart_index_ = num_restarts_;
     prefix_index_ = prefix_index;
@@ -245,6 +276,10 @@ class BlockIter : public InternalIterator {
     status_ = s;
   }
 
+  void SetLearnedIndex(const BlockLearnedIndex* learned_index) {
+    learned_index_ = learned_index;
+  }
+
   virtual bool Valid() const override { return current_ < restarts_; }
   virtual Status status() const override { return status_; }
   virtual Slice key() const override {
@@ -257,6 +292,11 @@ class BlockIter : public InternalIterator {
         current_ != last_bitmap_offset_) {
       read_amp_bitmap_->Mark(current_ /* current entry offset */,
                              NextEntryOffset() - 1);
+      if (column_layout_ && !value_.empty()) {
+        read_amp_bitmap_->Mark(ValueOffset(),
+                               ValueOffset() +
+                                   static_cast<uint32_t>(value_.size()) - 1);
+      }
       last_bitmap_offset_ = current_;
     }
     return value_;
@@ -310,6 +350,7 @@ class BlockIter : public InternalIterator {
   Slice value_;
   Status status_;
   BlockPrefixIndex* prefix_index_;
+  const BlockLearnedIndex* learned_index_;
   bool key_pinned_;
   SequenceNumber global_seqno_;
 
@@ -318,6 +359,19 @@ class BlockIter : public InternalIterator {
   // last `current_` value we report to read-amp bitmp
   mutable uint32_t last_bitmap_offset_;
 
+  // True if the block keeps keys and values in separate columns
+  // (BlockBasedTableOptions::kColumnLayout).
+  bool column_layout_;
+  // Offset in data_ just past the last key entry. Equal to restarts_ for row
+  // layout blocks; the start of the value column for column layout blocks.
+  uint32_t keys_end_;
+  // Offset of the value column restart array (list of fixed32).
+  // Only used for column layout blocks.
+  uint32_t value_restarts_;
+  // Offset in data_ just past the current key entry.
+  // Only used for column layout blocks.
+  uint32_t next_entry_offset_;
+
   struct CachedPrevEntry {
     explicit CachedPrevEntry(uint32_t _offset, const char* _key_ptr,
                              size_t _key_offset, size_t _key_size, Slice _value)
@@ -348,6 +402,9 @@ class BlockIter : public InternalIterator {
 
   // Return the offset in data_ just past the end of the current entry.
   inline uint32_t NextEntryOffset() const {
+    if (column_layout_) {
+      return next_entry_offset_;
+    }
     // NOTE: We don't support blocks bigger than 2GB
     return static_cast<uint32_t>((value_.data() + value_.size()) - data_);
   }
@@ -364,9 +421,25 @@ class BlockIter : public InternalIterator {
 
     // ParseNextKey() starts at the end of value_, so set value_ accordingly
     uint32_t offset = GetRestartPoint(index);
-    value_ = Slice(data_ + offset, 0);
+    if (column_layout_) {
+      // The next key entry is at `offset` and its value is the first one of
+      // the restart interval in the value column.
+      next_entry_offset_ = offset;
+      value_ = Slice(data_ + keys_end_ + GetValueRestartPoint(index), 0);
+    } else {
+      value_ = Slice(data_ + offset, 0);
+    }
+  }
+
+  uint32_t GetValueRestartPoint(uint32_t index) {
+    assert(column_layout_ && index < num_restarts_);
+    return DecodeFixed32(data_ + value_restarts_ + index * sizeof(uint32_t));
   }
 
+  // Decode the entry header at `offset`, see DecodeEntry() in block.cc.
+  const char* DecodeEntryAt(uint32_t offset, uint32_t* shared,
+                            uint32_t* non_shared, uint32_t* value_length);
+
   void CorruptionError();
 
   bool ParseNextKey();
@@ -15,6 +15,7 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <memory>
@@ -41,6 +42,7 @@
 #include "table/format.h"
 #include "table/full_filter_block.h"
 #include "table/meta_blocks.h"
+#include "table/range_filter_block.h"
 #include "table/table_builder.h"
 
 #include "util/string_util.h"
@@ -63,28 +65,57 @@ typedef BlockBasedTableOptions::IndexType IndexType;
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
 namespace {
 
+// Whether the options ask for the prefixes to go to a filter of their own,
+// sized by prefix_filter_bits_per_key, rather than to the whole key filter.
+// Only full and partitioned filters can leave them out.
+bool WantSeparatePrefixFilter(const ImmutableCFOptions& opt,
+                              const BlockBasedTableOptions& table_opt) {
+  return table_opt.prefix_filter_bits_per_key > 0 &&
+         opt.prefix_extractor != nullptr && table_opt.whole_key_filtering;
+}
+
 // Create a filter block builder based on its type.
+// *separate_prefix_filter is set if the table keeps the prefixes in a
+// separate prefix filter, in which case full and partitioned filters do not
+// add them.
 FilterBlockBuilder* CreateFilterBlockBuilder(
     const ImmutableCFOptions& opt, const BlockBasedTableOptions& table_opt,
-    PartitionedIndexBuilder* const p_index_builder) {
+    PartitionedIndexBuilder* const p_index_builder, const int level,
+    bool* separate_prefix_filter) {
+  *separate_prefix_filter = false;
   if (table_opt.filter_policy == nullptr) return nullptr;
 
+  // The policy may want a different filter for this level, or none
   FilterBitsBuilder* filter_bits_builder =
-      table_opt.filter_policy->GetFilterBitsBuilder();
+      level >= 0 ? table_opt.filter_policy->GetFilterBitsBuilderForLevel(
+                       level, opt.num_levels)
+                 : table_opt.filter_policy->GetFilterBitsBuilder();
   if (filter_bits_builder == nullptr) {
-    return new BlockBasedFilterBlockBuilder(opt.prefix_extractor, table_opt);
-  } else {
-    if (table_opt.partition_filters) {
-      assert(p_index_builder != nullptr);
-      return new PartitionedFilterBlockBuilder(
-          opt.prefix_extractor, table_opt.whole_key_filtering,
-          filter_bits_builder, table_opt.index_block_restart_interval,
-          p_index_builder);
-    } else {
-      return new FullFilterBlockBuilder(opt.prefix_extractor,
-                                        table_opt.whole_key_filtering,
-                                        filter_bits_builder);
+    // Either the policy only builds block-based filters, or it builds full
+    // filters but none for this level. Only the latter gives a builder here.
+    std::unique_ptr<FilterBitsBuilder> full_filter_bits_builder(
+        level >= 0 ? table_opt.filter_policy->GetFilterBitsBuilder()
+                   : nullptr);
+    if (full_filter_bits_builder == nullptr) {
+      // Block-based filters always hold both keys and prefixes
+      return new BlockBasedFilterBlockBuilder(opt.prefix_extractor, table_opt);
     }
+    *separate_prefix_filter = WantSeparatePrefixFilter(opt, table_opt);
+    return nullptr;
+  }
+
+  *separate_prefix_filter = WantSeparatePrefixFilter(opt, table_opt);
+  const SliceTransform* prefix_extractor =
+      *separate_prefix_filter ? nullptr : opt.prefix_extractor;
+  if (table_opt.partition_filters) {
+    assert(p_index_builder != nullptr);
+    return new PartitionedFilterBlockBuilder(
+        prefix_extractor, table_opt.whole_key_filtering, filter_bits_builder,
+        table_opt.index_block_restart_interval, p_index_builder);
+  } else {
+    return new FullFilterBlockBuilder(prefix_extractor,
+                                      table_opt.whole_key_filtering,
+                                      filter_bits_builder);
   }
 }
 
@@ -259,6 +290,8 @@ struct BlockBasedTableBuilder::Rep {
 
   bool closed = false;  // Either Finish() or Abandon() has been called.
   std::unique_ptr<FilterBlockBuilder> filter_builder;
+  std::unique_ptr<FilterBlockBuilder> prefix_filter_builder;
+  std::unique_ptr<RangeFilterBlockBuilder> range_filter_builder;
   char compressed_cache_key_prefix[BlockBasedTable::kMaxCacheKeyPrefixSize];
   size_t compressed_cache_key_prefix_size;
 
@@ -280,13 +313,14 @@ struct BlockBasedTableBuilder::Rep {
       const CompressionType _compression_type,
       const CompressionOptions& _compression_opts,
       const std::string* _compression_dict, const bool skip_filters,
-      const std::string& _column_family_name)
+      const std::string& _column_family_name, const int level)
       : ioptions(_ioptions),
         table_options(table_opt),
         internal_comparator(icomparator),
         file(f),
         data_block(table_options.block_restart_interval,
-                   table_options.use_delta_encoding),
+                   table_options.use_delta_encoding,
+                   table_options.data_block_layout),
         range_del_block(1),  // TODO(andrewkr): restart_interval unnecessary
         internal_prefix_transform(_ioptions.prefix_extractor),
         compression_type(_compression_type),
@@ -308,11 +342,29 @@ struct BlockBasedTableBuilder::Rep {
           table_options.index_type, &internal_comparator,
           &this->internal_prefix_transform, table_options));
     }
+    bool separate_prefix_filter = false;
     if (skip_filters) {
       filter_builder = nullptr;
     } else {
-      filter_builder.reset(
-          CreateFilterBlockBuilder(_ioptions, table_options, p_index_builder));
+      filter_builder.reset(CreateFilterBlockBuilder(
+          _ioptions, table_options, p_index_builder, level,
+          &separate_prefix_filter));
+    }
+    if (separate_prefix_filter) {
+      std::unique_ptr<const FilterPolicy> prefix_filter_policy(
+          NewBloomFilterPolicy(table_options.prefix_filter_bits_per_key,
+                               false /* use_block_based_builder */));
+      prefix_filter_builder.reset(new FullFilterBlockBuilder(
+          _ioptions.prefix_extractor, false /* whole_key_filtering */,
+          prefix_filter_policy->GetFilterBitsBuilder()));
+    }
+    // The range filter relies on user keys being ordered bytewise
+    if (!skip_filters && table_options.range_filter_bits_per_key > 0 &&
+        internal_comparator.user_comparator() == BytewiseComparator()) {
+      range_filter_builder.reset(new RangeFilterBlockBuilder(
+          table_options.range_filter_bits_per_key,
+          static_cast<size_t>(
+              std::max(table_options.range_filter_max_prefix_len, 0))));
     }
 
     for (auto& collector_factories : *int_tbl_prop_collector_factories) {
@@ -322,7 +374,7 @@ struct BlockBasedTableBuilder::Rep {
     table_properties_collectors.emplace_back(
         new BlockBasedTablePropertiesCollector(
             table_options.index_type, table_options.whole_key_filtering,
-            _ioptions.prefix_extractor != nullptr));
+            _ioptions.prefix_extractor != nullptr && !separate_prefix_filter));
   }
 };
 
@@ -336,7 +388,7 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
     const CompressionType compression_type,
     const CompressionOptions& compression_opts,
     const std::string* compression_dict, const bool skip_filters,
-    const std::string& column_family_name) {
+    const std::string& column_family_name, const int level) {
   BlockBasedTableOptions sanitized_table_options(table_options);
   if (sanitized_table_options.format_version == 0 &&
       sanitized_table_options.checksum != kCRC32c) {
@@ -352,7 +404,7 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
   rep_ = new Rep(ioptions, sanitized_table_options, internal_comparator,
                  int_tbl_prop_collector_factories, column_family_id, file,
                  compression_type, compression_opts, compression_dict,
-                 skip_filters, column_family_name);
+                 skip_filters, column_family_name, level);
 
   if (rep_->filter_builder != nullptr) {
     rep_->filter_builder->StartBlock(0);
@@ -403,6 +455,12 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
     if (r->filter_builder != nullptr) {
       r->filter_builder->Add(ExtractUserKey(key));
     }
+    if (r->prefix_filter_builder != nullptr) {
+      r->prefix_filter_builder->Add(ExtractUserKey(key));
+    }
+    if (r->range_filter_builder != nullptr) {
+      r->range_filter_builder->Add(ExtractUserKey(key));
+    }
 
     r->last_key.assign(key.data(), key.size());
     r->data_block.Add(key, value);
@@ -559,6 +617,15 @@ void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
         EncodeFixed32(trailer_without_type, XXH32_digest(xxh));
         break;
       }
+      case kxxHash64: {
+        XXH64_state_t xxh;
+        XXH64_reset(&xxh, 0);
+        XXH64_update(&xxh, block_contents.data(), block_contents.size());
+        XXH64_update(&xxh, trailer, 1);  // Extend  to cover block type
+        EncodeFixed32(trailer_without_type,
+                      static_cast<uint32_t>(XXH64_digest(&xxh)));
+        break;
+      }
     }
 
     r->status = r->file->Append(Slice(trailer, kBlockTrailerSize));
@@ -635,7 +702,8 @@ Status BlockBasedTableBuilder::Finish() {
   }
 
   BlockHandle filter_block_handle, metaindex_block_handle, index_block_handle,
-      compression_dict_block_handle, range_del_block_handle;
+      compression_dict_block_handle, range_del_block_handle,
+      prefix_filter_block_handle, range_filter_block_handle;
   // Write filter block
   if (ok() && r->filter_builder != nullptr) {
     Status s = Status::Incomplete();
@@ -663,7 +731,9 @@ Status BlockBasedTableBuilder::Finish() {
   //    2. [meta block: properties]
   //    3. [meta block: compression dictionary]
   //    4. [meta block: range deletion tombstone]
-  //    5. [metaindex block]
+  //    5. [meta block: prefix filter]
+  //    6. [meta block: range filter]
+  //    7. [metaindex block]
   // write meta blocks
   MetaIndexBuilder meta_index_builder;
   for (const auto& item : index_blocks.meta_blocks) {
@@ -752,6 +822,31 @@ Status BlockBasedTableBuilder::Finish() {
                     &range_del_block_handle);
       meta_index_builder.Add(kRangeDelBlock, range_del_block_handle);
     }  // range deletion tombstone meta block
+
+    if (ok() && r->prefix_filter_builder != nullptr) {
+      Status s;
+      Slice prefix_filter = r->prefix_filter_builder->Finish(
+          prefix_filter_block_handle, &s);
+      assert(s.ok());
+      // Empty if no key is in the domain of the prefix extractor
+      if (!prefix_filter.empty()) {
+        r->props.filter_size += prefix_filter.size();
+        WriteRawBlock(prefix_filter, kNoCompression,
+                      &prefix_filter_block_handle);
+        meta_index_builder.Add(BlockBasedTable::kPrefixFilterBlock,
+                               prefix_filter_block_handle);
+      }
+    }  // prefix filter meta block
+
+    // A range filter does not know which keys range tombstones cover, and
+    // skipping the table would hide them; no filter for such tables.
+    if (ok() && r->range_filter_builder != nullptr &&
+        !r->range_filter_builder->empty() && r->range_del_block.empty()) {
+      WriteRawBlock(r->range_filter_builder->Finish(), kNoCompression,
+                    &range_filter_block_handle);
+      meta_index_builder.Add(BlockBasedTable::kRangeFilterBlock,
+                             range_filter_block_handle);
+    }  // range filter meta block
   }    // meta blocks
 
   // Write index block
@@ -844,4 +939,6 @@ const std::string BlockBasedTable::kFilterBlockPrefix = "filter.";
 const std::string BlockBasedTable::kFullFilterBlockPrefix = "fullfilter.";
 const std::string BlockBasedTable::kPartitionedFilterBlockPrefix =
     "partitionedfilter.";
+const std::string BlockBasedTable::kPrefixFilterBlock = "rocksdb.prefix_filter";
+const std::string BlockBasedTable::kRangeFilterBlock = "rocksdb.range_filter";
 }  // namespace rocksdb
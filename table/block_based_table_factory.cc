@@ -72,7 +72,8 @@ TableBuilder* BlockBasedTableFactory::NewTableBuilder(
       table_builder_options.compression_opts,
       table_builder_options.compression_dict,
       table_builder_options.skip_filters,
-      table_builder_options.column_family_name);
+      table_builder_options.column_family_name,
+      table_builder_options.level);
 
   return table_builder;
 }
@@ -96,6 +97,11 @@ Status BlockBasedTableFactory::SanitizeOptions(
         "Enable pin_l0_filter_and_index_blocks_in_cache, "
         ", but block cache is disabled");
   }
+  if (table_options_.metadata_cache != nullptr &&
+      table_options_.no_block_cache) {
+    return Status::InvalidArgument(
+        "Enable metadata_cache, but block cache is disabled");
+  }
   if (!BlockBasedTableSupportedVersion(table_options_.format_version)) {
     return Status::InvalidArgument(
         "Unsupported BlockBasedTable format_version. Please check "
@@ -128,6 +134,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  index_type: %d\n",
            table_options_.index_type);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_layout: %d\n",
+           table_options_.data_block_layout);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  hash_index_allow_collision: %d\n",
            table_options_.hash_index_allow_collision);
   ret.append(buffer);
@@ -172,6 +181,16 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
     ret.append(buffer);
     ret.append(table_options_.persistent_cache->GetPrintableOptions());
   }
+  snprintf(buffer, kBufferSize, "  metadata_cache: %p\n",
+           static_cast<void*>(table_options_.metadata_cache.get()));
+  ret.append(buffer);
+  if (table_options_.metadata_cache) {
+    ret.append("  metadata_cache_options:\n");
+    ret.append(table_options_.metadata_cache->GetPrintableOptions());
+  }
+  snprintf(buffer, kBufferSize, "  metadata_cache_partitions_max_level: %d\n",
+           table_options_.metadata_cache_partitions_max_level);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  block_size: %" ROCKSDB_PRIszt "\n",
            table_options_.block_size);
   ret.append(buffer);
@@ -191,6 +210,15 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  whole_key_filtering: %d\n",
            table_options_.whole_key_filtering);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  prefix_filter_bits_per_key: %d\n",
+           table_options_.prefix_filter_bits_per_key);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  range_filter_bits_per_key: %d\n",
+           table_options_.range_filter_bits_per_key);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  range_filter_max_prefix_len: %d\n",
+           table_options_.range_filter_max_prefix_len);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  format_version: %d\n",
            table_options_.format_version);
   ret.append(buffer);
@@ -215,6 +243,7 @@ const std::string BlockBasedTablePropertyNames::kPrefixFiltering =
 const std::string kHashIndexPrefixesBlock = "rocksdb.hashindex.prefixes";
 const std::string kHashIndexPrefixesMetadataBlock =
     "rocksdb.hashindex.metadata";
+const std::string kLearnedIndexBlock = "rocksdb.learnedindex";
 const std::string kPropTrue = "1";
 const std::string kPropFalse = "0";
 
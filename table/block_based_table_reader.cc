@@ -10,6 +10,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "table/block_based_table_reader.h"
 
+#include <inttypes.h>
 #include <algorithm>
 #include <limits>
 #include <string>
@@ -41,6 +42,7 @@
 #include "table/meta_blocks.h"
 #include "table/partitioned_filter_block.h"
 #include "table/persistent_cache_helper.h"
+#include "table/range_filter_block.h"
 #include "table/sst_file_writer_collectors.h"
 #include "table/two_level_iterator.h"
 
@@ -56,6 +58,7 @@ namespace rocksdb {
 extern const uint64_t kBlockBasedTableMagicNumber;
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
+extern const std::string kLearnedIndexBlock;
 using std::unique_ptr;
 
 typedef BlockBasedTable::IndexReader IndexReader;
@@ -79,10 +82,12 @@ Status ReadBlockFromFile(RandomAccessFileReader* file, const Footer& footer,
                          const Slice& compression_dict,
                          const PersistentCacheOptions& cache_options,
                          SequenceNumber global_seqno,
-                         size_t read_amp_bytes_per_bit) {
+                         size_t read_amp_bytes_per_bit,
+                         FilePrefetchBuffer* prefetch_buffer = nullptr) {
   BlockContents contents;
   Status s = ReadBlockContents(file, footer, options, handle, &contents, ioptions,
-                               do_uncompress, compression_dict, cache_options);
+                               do_uncompress, compression_dict, cache_options,
+                               prefetch_buffer);
   if (s.ok()) {
     result->reset(new Block(std::move(contents), global_seqno,
                             read_amp_bytes_per_bit, ioptions.statistics));
@@ -107,6 +112,38 @@ void DeleteCachedEntry(const Slice& key, void* value) {
 void DeleteCachedFilterEntry(const Slice& key, void* value);
 void DeleteCachedIndexEntry(const Slice& key, void* value);
 
+// Lets a block cache with a compressed tier keep the data blocks it evicts.
+// A block is saved as its contents followed by its global sequence number.
+// The blocks made again do not track read amplification.
+size_t DataBlockSize(void* value) {
+  return reinterpret_cast<Block*>(value)->size() + sizeof(uint64_t);
+}
+
+void SaveDataBlock(void* value, char* out) {
+  auto block = reinterpret_cast<Block*>(value);
+  memcpy(out, block->data(), block->size());
+  EncodeFixed64(out + block->size(), block->global_seqno());
+}
+
+Status CreateDataBlock(const Slice& data, void** value, size_t* charge) {
+  if (data.size() < sizeof(uint64_t)) {
+    return Status::Corruption("bad data block from the block cache");
+  }
+  const size_t size = data.size() - sizeof(uint64_t);
+  std::unique_ptr<char[]> buf(new char[size]);
+  memcpy(buf.get(), data.data(), size);
+  auto block = new Block(
+      BlockContents(std::move(buf), size, true /* cachable */, kNoCompression),
+      DecodeFixed64(data.data() + size));
+  *value = block;
+  *charge = block->usable_size();
+  return Status::OK();
+}
+
+const Cache::TierHelper kDataBlockHelper = {
+    &DataBlockSize, &SaveDataBlock, &CreateDataBlock,
+    &DeleteCachedEntry<Block>};
+
 // Release the cached entry and decrement its ref count.
 void ReleaseCachedEntry(void* arg, void* h) {
   Cache* cache = reinterpret_cast<Cache*>(arg);
@@ -128,8 +165,11 @@ Slice GetCacheKeyFromOffset(const char* cache_key_prefix,
 Cache::Handle* GetEntryFromCache(Cache* block_cache, const Slice& key,
                                  Tickers block_cache_miss_ticker,
                                  Tickers block_cache_hit_ticker,
-                                 Statistics* statistics) {
-  auto cache_handle = block_cache->Lookup(key, statistics);
+                                 Statistics* statistics,
+                                 const Cache::TierHelper* helper = nullptr) {
+  auto cache_handle =
+      helper != nullptr ? block_cache->LookupWithHelper(key, helper, statistics)
+                        : block_cache->Lookup(key, statistics);
   if (cache_handle != nullptr) {
     PERF_COUNTER_ADD(block_cache_hit_count, 1);
     // overall cache hit
@@ -149,6 +189,12 @@ Cache::Handle* GetEntryFromCache(Cache* block_cache, const Slice& key,
   return cache_handle;
 }
 
+// Decode the handle of the data block the index iterator is positioned at
+bool GetBlockHandle(InternalIterator* index_iter, BlockHandle* handle) {
+  Slice input = index_iter->value();
+  return handle->DecodeFrom(&input).ok();
+}
+
 }  // namespace
 
 // Index that allows binary search lookup in a two-level index structure.
@@ -188,8 +234,9 @@ class PartitionIndexReader : public IndexReader, public Cleanable {
     const bool is_index = true;
     Cleanable* block_cache_cleaner = nullptr;
     const bool pin_cached_indexes =
-        level_ == 0 &&
-        table_->rep_->table_options.pin_l0_filter_and_index_blocks_in_cache;
+        (level_ == 0 &&
+         table_->rep_->table_options.pin_l0_filter_and_index_blocks_in_cache) ||
+        table_->rep_->partitions_in_metadata_cache();
     if (pin_cached_indexes) {
       // Keep partition indexes into the cache as long as the partition index
       // reader object is alive
@@ -393,6 +440,84 @@ class HashIndexReader : public IndexReader {
   BlockContents prefixes_contents_;
 };
 
+// Binary search index whose seeks are narrowed down by a learned model of its
+// keys, if the table has one.
+class LearnedIndexReader : public IndexReader {
+ public:
+  static Status Create(const Footer& footer, RandomAccessFileReader* file,
+                       const ImmutableCFOptions& ioptions,
+                       const InternalKeyComparator* icomparator,
+                       const BlockHandle& index_handle,
+                       InternalIterator* meta_index_iter,
+                       IndexReader** index_reader,
+                       const PersistentCacheOptions& cache_options) {
+    std::unique_ptr<Block> index_block;
+    auto s = ReadBlockFromFile(
+        file, footer, ReadOptions(), index_handle, &index_block, ioptions,
+        true /* decompress */, Slice() /*compression dict*/, cache_options,
+        kDisableGlobalSequenceNumber, 0 /* read_amp_bytes_per_bit */);
+    if (!s.ok()) {
+      return s;
+    }
+
+    // Without the model the index block still works as a binary search index,
+    // so Create succeeds regardless from this point on.
+    auto new_index_reader = new LearnedIndexReader(
+        icomparator, std::move(index_block), ioptions.statistics);
+    *index_reader = new_index_reader;
+
+    BlockHandle model_handle;
+    s = FindMetaBlock(meta_index_iter, kLearnedIndexBlock, &model_handle);
+    if (!s.ok()) {
+      // The keys did not fit a model
+      return Status::OK();
+    }
+    BlockContents model_contents;
+    s = ReadBlockContents(file, footer, ReadOptions(), model_handle,
+                          &model_contents, ioptions, true /* decompress */,
+                          Slice() /*compression dict*/, cache_options);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(ioptions.info_log,
+                     "Unable to read the learned index block: %s",
+                     s.ToString().c_str());
+      return Status::OK();
+    }
+    BlockLearnedIndex* learned_index = nullptr;
+    s = BlockLearnedIndex::Create(model_contents.data, &learned_index);
+    if (s.ok()) {
+      new_index_reader->index_block_->SetBlockLearnedIndex(learned_index);
+    } else {
+      ROCKS_LOG_WARN(ioptions.info_log, "Invalid learned index block: %s",
+                     s.ToString().c_str());
+    }
+    return Status::OK();
+  }
+
+  virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
+                                        bool dont_care = true) override {
+    return index_block_->NewIterator(icomparator_, iter, true);
+  }
+
+  virtual size_t size() const override { return index_block_->size(); }
+  virtual size_t usable_size() const override {
+    return index_block_->usable_size();
+  }
+
+  virtual size_t ApproximateMemoryUsage() const override {
+    assert(index_block_);
+    return index_block_->ApproximateMemoryUsage();
+  }
+
+ private:
+  LearnedIndexReader(const InternalKeyComparator* icomparator,
+                     std::unique_ptr<Block>&& index_block, Statistics* stats)
+      : IndexReader(icomparator, stats), index_block_(std::move(index_block)) {
+    assert(index_block_ != nullptr);
+  }
+
+  std::unique_ptr<Block> index_block_;
+};
+
 // Helper function to setup the cache key's prefix for the Table.
 void BlockBasedTable::SetupCacheKeyPrefix(Rep* rep, uint64_t file_size) {
   assert(kMaxCacheKeyPrefixSize >= 10);
@@ -403,8 +528,12 @@ void BlockBasedTable::SetupCacheKeyPrefix(Rep* rep, uint64_t file_size) {
                         &rep->cache_key_prefix[0], &rep->cache_key_prefix_size);
     // Create dummy offset of index reader which is beyond the file size.
     rep->dummy_index_reader_offset =
-        file_size + rep->table_options.block_cache->NewId();
+        file_size + rep->index_and_filter_cache()->NewId();
   }
+  // Until SetupMetadataCache() admits the table to metadata_cache
+  memcpy(rep->metadata_cache_key_prefix, rep->cache_key_prefix,
+         rep->cache_key_prefix_size);
+  rep->metadata_cache_key_prefix_size = rep->cache_key_prefix_size;
   if (rep->table_options.persistent_cache != nullptr) {
     GenerateCachePrefix(/*cache=*/nullptr, rep->file->file(),
                         &rep->persistent_cache_key_prefix[0],
@@ -417,6 +546,37 @@ void BlockBasedTable::SetupCacheKeyPrefix(Rep* rep, uint64_t file_size) {
   }
 }
 
+void BlockBasedTable::SetupMetadataCache(Rep* rep) {
+  Cache* metadata_cache = rep->table_options.metadata_cache.get();
+  if (metadata_cache == nullptr) {
+    return;
+  }
+  // The blocks stay pinned as long as the table reader is alive, so the
+  // pinned usage is what the other tables take of the budget. Tables opened
+  // at the same time may overshoot it a little.
+  uint64_t metadata_size =
+      rep->footer.index_handle().size() + rep->filter_handle.size();
+  if (rep->level >= 0 &&
+      rep->level <= rep->table_options.metadata_cache_partitions_max_level &&
+      rep->table_properties != nullptr) {
+    // With the partitions
+    metadata_size = std::max(metadata_size,
+                             rep->table_properties->index_size +
+                                 rep->table_properties->filter_size);
+  }
+  if (metadata_cache->GetPinnedUsage() + metadata_size >
+      metadata_cache->GetCapacity()) {
+    ROCKS_LOG_DEBUG(rep->ioptions.info_log,
+                    "metadata_cache is full, keeping the index and filter "
+                    "blocks of a table in block_cache");
+    return;
+  }
+  rep->metadata_cache = metadata_cache;
+  GenerateCachePrefix(metadata_cache, rep->file->file(),
+                      &rep->metadata_cache_key_prefix[0],
+                      &rep->metadata_cache_key_prefix_size);
+}
+
 void BlockBasedTable::GenerateCachePrefix(Cache* cc,
     RandomAccessFile* file, char* buffer, size_t* size) {
 
@@ -512,6 +672,16 @@ SequenceNumber GetGlobalSequenceNumber(const TableProperties& table_properties,
 }
 }  // namespace
 
+Slice BlockBasedTable::Rep::GetPartitionCacheKey(const BlockHandle& handle,
+                                                 char* cache_key) const {
+  if (partitions_in_metadata_cache()) {
+    return GetCacheKey(metadata_cache_key_prefix,
+                       metadata_cache_key_prefix_size, handle, cache_key);
+  }
+  return GetCacheKey(cache_key_prefix, cache_key_prefix_size, handle,
+                     cache_key);
+}
+
 Slice BlockBasedTable::GetCacheKey(const char* cache_key_prefix,
                                    size_t cache_key_prefix_size,
                                    const BlockHandle& handle, char* cache_key) {
@@ -562,6 +732,7 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
   rep->footer = footer;
   rep->index_type = table_options.index_type;
   rep->hash_index_allow_collision = table_options.hash_index_allow_collision;
+  rep->level = level;
   // We need to wrap data with internal_prefix_transform to make sure it can
   // handle prefix correctly.
   rep->internal_prefix_transform.reset(
@@ -672,6 +843,51 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
     }
   }
 
+  // Read the prefix filter meta block
+  BlockHandle prefix_filter_handle;
+  if (!skip_filters && rep->ioptions.prefix_extractor != nullptr &&
+      FindMetaBlock(meta_iter.get(), kPrefixFilterBlock, &prefix_filter_handle)
+          .ok()) {
+    BlockContents prefix_filter_contents;
+    s = ReadBlockContents(rep->file.get(), rep->footer, ReadOptions(),
+                          prefix_filter_handle, &prefix_filter_contents,
+                          rep->ioptions, false /* decompress */);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(rep->ioptions.info_log,
+                     "Encountered error while reading prefix filter block %s",
+                     s.ToString().c_str());
+    } else {
+      // A full Bloom filter, whatever the filter policy of the table
+      std::unique_ptr<const FilterPolicy> bloom_policy(
+          NewBloomFilterPolicy(10, false /* use_block_based_builder */));
+      auto filter_bits_reader =
+          bloom_policy->GetFilterBitsReader(prefix_filter_contents.data);
+      rep->prefix_filter.reset(new FullFilterBlockReader(
+          rep->ioptions.prefix_extractor, false /* whole_key_filtering */,
+          std::move(prefix_filter_contents), filter_bits_reader,
+          rep->ioptions.statistics));
+    }
+  }
+
+  // Read the range filter meta block
+  BlockHandle range_filter_handle;
+  if (!skip_filters &&
+      FindMetaBlock(meta_iter.get(), kRangeFilterBlock, &range_filter_handle)
+          .ok()) {
+    BlockContents range_filter_contents;
+    s = ReadBlockContents(rep->file.get(), rep->footer, ReadOptions(),
+                          range_filter_handle, &range_filter_contents,
+                          rep->ioptions, false /* decompress */);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(rep->ioptions.info_log,
+                     "Encountered error while reading range filter block %s",
+                     s.ToString().c_str());
+    } else {
+      rep->range_filter.reset(
+          new RangeFilterBlockReader(std::move(range_filter_contents)));
+    }
+  }
+
   // Read the range del meta block
   bool found_range_del_block;
   s = SeekToRangeDelBlock(meta_iter.get(), &found_range_del_block,
@@ -710,22 +926,25 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
                                                 rep->ioptions.info_log);
   }
 
+  SetupMetadataCache(rep);
+
     // pre-fetching of blocks is turned on
   // Will use block cache for index/filter blocks access
-  // Always prefetch index and filter for level 0
+  // Always prefetch index and filter for level 0, and when they are pinned
   if (table_options.cache_index_and_filter_blocks) {
-    if (prefetch_index_and_filter_in_cache || level == 0) {
+    if (prefetch_index_and_filter_in_cache || level == 0 ||
+        rep->pin_index_and_filter()) {
       assert(table_options.block_cache != nullptr);
       // Hack: Call NewIndexIterator() to implicitly add index to the
       // block_cache
 
-      // if pin_l0_filter_and_index_blocks_in_cache is true and this is
-      // a level0 file, then we will pass in this pointer to rep->index
+      // if the index and filter are pinned, i.e. pin_l0_filter_and_index_
+      // blocks_in_cache is true and this is a level0 file, or there is a
+      // metadata_cache, then we will pass in this pointer to rep->index
       // to NewIndexIterator(), which will save the index block in there
       // else it's a nullptr and nothing special happens
       CachableEntry<IndexReader>* index_entry = nullptr;
-      if (rep->table_options.pin_l0_filter_and_index_blocks_in_cache &&
-          level == 0) {
+      if (rep->pin_index_and_filter()) {
         index_entry = &rep->index_entry;
       }
       unique_ptr<InternalIterator> iter(
@@ -735,18 +954,16 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
       if (s.ok()) {
         // Hack: Call GetFilter() to implicitly add filter to the block_cache
         auto filter_entry = new_table->GetFilter();
-        // if pin_l0_filter_and_index_blocks_in_cache is true, and this is
-        // a level0 file, then save it in rep_->filter_entry; it will be
-        // released in the destructor only, hence it will be pinned in the
-        // cache while this reader is alive
-        if (rep->table_options.pin_l0_filter_and_index_blocks_in_cache &&
-            level == 0) {
+        // if the index and filter are pinned, then save it in
+        // rep_->filter_entry; it will be released in the destructor only,
+        // hence it will be pinned in the cache while this reader is alive
+        if (rep->pin_index_and_filter()) {
           rep->filter_entry = filter_entry;
           if (rep->filter_entry.value != nullptr) {
             rep->filter_entry.value->SetLevel(level);
           }
         } else {
-          filter_entry.Release(table_options.block_cache.get());
+          filter_entry.Release(rep->index_and_filter_cache());
         }
       }
     }
@@ -812,6 +1029,12 @@ size_t BlockBasedTable::ApproximateMemoryUsage() const {
   if (rep_->index_reader) {
     usage += rep_->index_reader->ApproximateMemoryUsage();
   }
+  if (rep_->prefix_filter) {
+    usage += rep_->prefix_filter->ApproximateMemoryUsage();
+  }
+  if (rep_->range_filter) {
+    usage += rep_->range_filter->ApproximateMemoryUsage();
+  }
   return usage;
 }
 
@@ -862,7 +1085,8 @@ Status BlockBasedTable::GetDataBlockFromCache(
     block->cache_handle = GetEntryFromCache(
         block_cache, block_cache_key,
         is_index ? BLOCK_CACHE_INDEX_MISS : BLOCK_CACHE_DATA_MISS,
-        is_index ? BLOCK_CACHE_INDEX_HIT : BLOCK_CACHE_DATA_HIT, statistics);
+        is_index ? BLOCK_CACHE_INDEX_HIT : BLOCK_CACHE_DATA_HIT, statistics,
+        is_index ? nullptr : &kDataBlockHelper);
     if (block->cache_handle != nullptr) {
       block->value =
           reinterpret_cast<Block*>(block_cache->Value(block->cache_handle));
@@ -909,9 +1133,13 @@ Status BlockBasedTable::GetDataBlockFromCache(
     assert(block->value->compression_type() == kNoCompression);
     if (block_cache != nullptr && block->value->cachable() &&
         read_options.fill_cache) {
-      s = block_cache->Insert(
-          block_cache_key, block->value, block->value->usable_size(),
-          &DeleteCachedEntry<Block>, &(block->cache_handle));
+      s = is_index ? block_cache->Insert(block_cache_key, block->value,
+                                         block->value->usable_size(),
+                                         &DeleteCachedEntry<Block>,
+                                         &(block->cache_handle))
+                   : block_cache->InsertWithHelper(
+                         block_cache_key, block->value, &kDataBlockHelper,
+                         block->value->usable_size(), &(block->cache_handle));
       block_cache->TEST_mark_as_data_block(block_cache_key,
                                            block->value->usable_size());
       if (s.ok()) {
@@ -992,9 +1220,14 @@ Status BlockBasedTable::PutDataBlockToCache(
   // insert into uncompressed block cache
   assert((block->value->compression_type() == kNoCompression));
   if (block_cache != nullptr && block->value->cachable()) {
-    s = block_cache->Insert(
-        block_cache_key, block->value, block->value->usable_size(),
-        &DeleteCachedEntry<Block>, &(block->cache_handle), priority);
+    s = is_index ? block_cache->Insert(block_cache_key, block->value,
+                                       block->value->usable_size(),
+                                       &DeleteCachedEntry<Block>,
+                                       &(block->cache_handle), priority)
+                 : block_cache->InsertWithHelper(
+                       block_cache_key, block->value, &kDataBlockHelper,
+                       block->value->usable_size(), &(block->cache_handle),
+                       priority);
     block_cache->TEST_mark_as_data_block(block_cache_key,
                                          block->value->usable_size());
     if (s.ok()) {
@@ -1100,7 +1333,8 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     return {rep_->filter.get(), nullptr /* cache handle */};
   }
 
-  Cache* block_cache = rep_->table_options.block_cache.get();
+  Cache* block_cache = is_a_filter_partition ? rep_->partition_cache()
+                                             : rep_->index_and_filter_cache();
   if (rep_->filter_policy == nullptr /* do not use filter */ ||
       block_cache == nullptr /* no block cache at all */) {
     return {nullptr /* filter */, nullptr /* cache handle */};
@@ -1114,8 +1348,11 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
 
   // Fetching from the cache
   char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
-  auto key = GetCacheKey(rep_->cache_key_prefix, rep_->cache_key_prefix_size,
-                         filter_blk_handle, cache_key);
+  auto key = is_a_filter_partition
+                 ? rep_->GetPartitionCacheKey(filter_blk_handle, cache_key)
+                 : GetCacheKey(rep_->metadata_cache_key_prefix,
+                               rep_->metadata_cache_key_prefix_size,
+                               filter_blk_handle, cache_key);
 
   Statistics* statistics = rep_->ioptions.statistics;
   auto cache_handle =
@@ -1171,11 +1408,11 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
   PERF_TIMER_GUARD(read_index_block_nanos);
 
   const bool no_io = read_options.read_tier == kBlockCacheTier;
-  Cache* block_cache = rep_->table_options.block_cache.get();
+  Cache* block_cache = rep_->index_and_filter_cache();
   char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
-  auto key =
-      GetCacheKeyFromOffset(rep_->cache_key_prefix, rep_->cache_key_prefix_size,
-                            rep_->dummy_index_reader_offset, cache_key);
+  auto key = GetCacheKeyFromOffset(rep_->metadata_cache_key_prefix,
+                                   rep_->metadata_cache_key_prefix_size,
+                                   rep_->dummy_index_reader_offset, cache_key);
   Statistics* statistics = rep_->ioptions.statistics;
   auto cache_handle =
       GetEntryFromCache(block_cache, key, BLOCK_CACHE_INDEX_MISS,
@@ -1266,11 +1503,14 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
 // If input_iter is not null, update this iter and return it
 InternalIterator* BlockBasedTable::NewDataBlockIterator(
     Rep* rep, const ReadOptions& ro, const BlockHandle& handle,
-    BlockIter* input_iter, bool is_index, Status s) {
+    BlockIter* input_iter, bool is_index, Status s,
+    FilePrefetchBuffer* prefetch_buffer,
+    BlockEntryIteratorState* readahead_state) {
   PERF_TIMER_GUARD(new_table_block_iter_nanos);
 
   const bool no_io = (ro.read_tier == kBlockCacheTier);
-  Cache* block_cache = rep->table_options.block_cache.get();
+  Cache* block_cache = is_index ? rep->partition_cache()
+                                : rep->table_options.block_cache.get();
   CachableEntry<Block> block;
   Slice compression_dict;
   if (s.ok()) {
@@ -1278,7 +1518,7 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
       compression_dict = rep->compression_dict_block->data;
     }
     s = MaybeLoadDataBlockToCache(rep, ro, handle, compression_dict, &block,
-                                  is_index);
+                                  is_index, prefetch_buffer, readahead_state);
   }
 
   // Didn't get any data from block caches.
@@ -1292,11 +1532,15 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
         return NewErrorInternalIterator(Status::Incomplete("no blocking io"));
       }
     }
+    if (readahead_state != nullptr) {
+      prefetch_buffer = readahead_state->MaybeReadahead(handle);
+    }
     std::unique_ptr<Block> block_value;
     s = ReadBlockFromFile(
         rep->file.get(), rep->footer, ro, handle, &block_value, rep->ioptions,
         true /* compress */, compression_dict, rep->persistent_cache_options,
-        rep->global_seqno, rep->table_options.read_amp_bytes_per_bit);
+        rep->global_seqno, rep->table_options.read_amp_bytes_per_bit,
+        prefetch_buffer);
     if (s.ok()) {
       block.value = block_value.release();
     }
@@ -1327,9 +1571,12 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
 
 Status BlockBasedTable::MaybeLoadDataBlockToCache(
     Rep* rep, const ReadOptions& ro, const BlockHandle& handle,
-    Slice compression_dict, CachableEntry<Block>* block_entry, bool is_index) {
+    Slice compression_dict, CachableEntry<Block>* block_entry, bool is_index,
+    FilePrefetchBuffer* prefetch_buffer,
+    BlockEntryIteratorState* readahead_state) {
   const bool no_io = (ro.read_tier == kBlockCacheTier);
-  Cache* block_cache = rep->table_options.block_cache.get();
+  Cache* block_cache = is_index ? rep->partition_cache()
+                                : rep->table_options.block_cache.get();
   Cache* block_cache_compressed =
       rep->table_options.block_cache_compressed.get();
 
@@ -1344,8 +1591,10 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
 
     // create key for block cache
     if (block_cache != nullptr) {
-      key = GetCacheKey(rep->cache_key_prefix, rep->cache_key_prefix_size,
-                        handle, cache_key);
+      key = is_index ? rep->GetPartitionCacheKey(handle, cache_key)
+                     : GetCacheKey(rep->cache_key_prefix,
+                                   rep->cache_key_prefix_size, handle,
+                                   cache_key);
     }
 
     if (block_cache_compressed != nullptr) {
@@ -1360,6 +1609,9 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
         rep->table_options.read_amp_bytes_per_bit, is_index);
 
     if (block_entry->value == nullptr && !no_io && ro.fill_cache) {
+      if (readahead_state != nullptr) {
+        prefetch_buffer = readahead_state->MaybeReadahead(handle);
+      }
       std::unique_ptr<Block> raw_block;
       {
         StopWatch sw(rep->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
@@ -1367,7 +1619,7 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
             rep->file.get(), rep->footer, ro, handle, &raw_block, rep->ioptions,
             block_cache_compressed == nullptr, compression_dict,
             rep->persistent_cache_options, rep->global_seqno,
-            rep->table_options.read_amp_bytes_per_bit);
+            rep->table_options.read_amp_bytes_per_bit, prefetch_buffer);
       }
 
       if (s.ok()) {
@@ -1387,6 +1639,11 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
   return s;
 }
 
+const int
+    BlockBasedTable::BlockEntryIteratorState::kMinSequentialReadsForReadahead;
+const size_t BlockBasedTable::BlockEntryIteratorState::kInitReadaheadSize;
+const size_t BlockBasedTable::BlockEntryIteratorState::kMaxReadaheadSize;
+
 BlockBasedTable::BlockEntryIteratorState::BlockEntryIteratorState(
     BlockBasedTable* table, const ReadOptions& read_options,
     const InternalKeyComparator* icomparator, bool skip_filters, bool is_index,
@@ -1397,7 +1654,203 @@ BlockBasedTable::BlockEntryIteratorState::BlockEntryIteratorState(
       icomparator_(icomparator),
       skip_filters_(skip_filters),
       is_index_(is_index),
-      block_cache_cleaner_(block_cache_cleaner) {}
+      block_cache_cleaner_(block_cache_cleaner),
+      next_block_offset_(0),
+      num_sequential_reads_(0),
+      readahead_size_(kInitReadaheadSize),
+      readahead_limit_(0),
+      current_block_offset_(0),
+      prefetch_reached_upper_bound_(false),
+      prefetch_cv_(&prefetch_mu_),
+      pending_prefetches_(0),
+      max_pending_prefetches_(0) {
+  notify_forward_blocks =
+      !is_index && read_options.async_prefetch_blocks > 0 &&
+      read_options.fill_cache && read_options.read_tier == kReadAllTier &&
+      table->rep_->table_options.block_cache != nullptr;
+  if (notify_forward_blocks) {
+    // The loads share the LOW priority pool with compactions, leave them
+    // at least half of it
+    max_pending_prefetches_ = std::max(
+        1, table->rep_->ioptions.env->GetBackgroundThreads(Env::Priority::LOW) /
+               2);
+  }
+  check_range_may_match = !is_index && !skip_filters &&
+                          read_options.iterate_upper_bound != nullptr &&
+                          table->rep_->range_filter != nullptr;
+}
+
+BlockBasedTable::BlockEntryIteratorState::~BlockEntryIteratorState() {
+  if (notify_forward_blocks) {
+    // Drop the loads that did not start yet and wait for the running ones,
+    // which still use table_
+    table_->rep_->ioptions.env->UnSchedule(this, Env::Priority::LOW);
+    MutexLock l(&prefetch_mu_);
+    while (pending_prefetches_ > 0) {
+      prefetch_cv_.Wait();
+    }
+  }
+}
+
+struct BlockBasedTable::BlockEntryIteratorState::PrefetchBlockArg {
+  BlockEntryIteratorState* state;
+  BlockHandle handle;
+};
+
+void BlockBasedTable::BlockEntryIteratorState::BGWorkPrefetchBlock(
+    void* arg) {
+  PrefetchBlockArg* prefetch_arg = reinterpret_cast<PrefetchBlockArg*>(arg);
+  BlockEntryIteratorState* state = prefetch_arg->state;
+  Rep* rep = state->table_->rep_;
+  Slice compression_dict;
+  if (rep->compression_dict_block) {
+    compression_dict = rep->compression_dict_block->data;
+  }
+  CachableEntry<Block> block;
+  MaybeLoadDataBlockToCache(rep, state->read_options_, prefetch_arg->handle,
+                            compression_dict, &block);
+  if (block.cache_handle != nullptr) {
+    block.Release(rep->table_options.block_cache.get());
+  } else {
+    delete block.value;
+  }
+  TEST_SYNC_POINT_CALLBACK(
+      "BlockBasedTable::BlockEntryIteratorState::BGWorkPrefetchBlock",
+      &prefetch_arg->handle);
+  delete prefetch_arg;
+  state->PrefetchBlockDone();
+}
+
+void BlockBasedTable::BlockEntryIteratorState::UnschedulePrefetchBlock(
+    void* arg) {
+  PrefetchBlockArg* prefetch_arg = reinterpret_cast<PrefetchBlockArg*>(arg);
+  BlockEntryIteratorState* state = prefetch_arg->state;
+  delete prefetch_arg;
+  state->PrefetchBlockDone();
+}
+
+void BlockBasedTable::BlockEntryIteratorState::PrefetchBlockDone() {
+  MutexLock l(&prefetch_mu_);
+  if (--pending_prefetches_ == 0) {
+    prefetch_cv_.SignalAll();
+  }
+}
+
+void BlockBasedTable::BlockEntryIteratorState::OnForwardBlock(
+    const Slice& key, const Slice& index_value) {
+  BlockHandle handle;
+  Slice input = index_value;
+  if (!handle.DecodeFrom(&input).ok() ||
+      (prefetch_index_iter_ && handle.offset() == current_block_offset_)) {
+    return;
+  }
+  current_block_offset_ = handle.offset();
+  BlockHandle next_handle;
+  if (!prefetched_offsets_.empty() &&
+      prefetched_offsets_.front() == handle.offset()) {
+    // The scan reached the first block we loaded for it, keep going
+    prefetched_offsets_.pop_front();
+  } else if (prefetched_offsets_.empty() && prefetch_index_iter_ &&
+             !prefetch_reached_upper_bound_ && prefetch_index_iter_->Valid() &&
+             GetBlockHandle(prefetch_index_iter_.get(), &next_handle) &&
+             next_handle.offset() == handle.offset()) {
+    // The scan reached the block the loads were held back at by
+    // max_pending_prefetches_, continue after it
+    prefetch_index_iter_->Next();
+  } else {
+    if (!prefetch_index_iter_) {
+      ReadOptions ro = read_options_;
+      ro.total_order_seek = true;
+      prefetch_index_iter_.reset(table_->NewIndexIterator(ro));
+    }
+    prefetched_offsets_.clear();
+    prefetch_reached_upper_bound_ = KeyReachedUpperBound(key);
+    prefetch_index_iter_->Seek(key);
+    if (prefetch_index_iter_->Valid()) {
+      prefetch_index_iter_->Next();
+    }
+  }
+
+  Env* env = table_->rep_->ioptions.env;
+  while (!prefetch_reached_upper_bound_ && prefetch_index_iter_->Valid() &&
+         prefetched_offsets_.size() < read_options_.async_prefetch_blocks) {
+    {
+      MutexLock l(&prefetch_mu_);
+      if (pending_prefetches_ >= max_pending_prefetches_) {
+        break;
+      }
+      pending_prefetches_++;
+    }
+    PrefetchBlockArg* arg = new PrefetchBlockArg();
+    if (!GetBlockHandle(prefetch_index_iter_.get(), &arg->handle)) {
+      delete arg;
+      PrefetchBlockDone();
+      break;
+    }
+    arg->state = this;
+    TEST_SYNC_POINT_CALLBACK(
+        "BlockBasedTable::BlockEntryIteratorState::OnForwardBlock:Schedule",
+        &arg->handle);
+    prefetched_offsets_.push_back(arg->handle.offset());
+    env->Schedule(&BGWorkPrefetchBlock, arg, Env::Priority::LOW, this,
+                  &UnschedulePrefetchBlock);
+    // No need to load anything past the block holding the upper bound
+    prefetch_reached_upper_bound_ =
+        KeyReachedUpperBound(prefetch_index_iter_->key());
+    prefetch_index_iter_->Next();
+  }
+}
+
+void BlockBasedTable::BlockEntryIteratorState::TrackSequentialRead(
+    const BlockHandle& handle) {
+  if (handle.offset() != next_block_offset_) {
+    // Not a sequential scan (any more), start over with a small window
+    num_sequential_reads_ = 0;
+    readahead_size_ = kInitReadaheadSize;
+    readahead_limit_ = 0;
+  }
+  next_block_offset_ = handle.offset() + handle.size() + kBlockTrailerSize;
+  num_sequential_reads_++;
+}
+
+FilePrefetchBuffer* BlockBasedTable::BlockEntryIteratorState::MaybeReadahead(
+    const BlockHandle& handle) {
+  // The first blocks after a seek are read one by one, since short range
+  // scans would not use a readahead window.
+  const uint64_t block_end = handle.offset() + handle.size() + kBlockTrailerSize;
+  if (num_sequential_reads_ <= kMinSequentialReadsForReadahead ||
+      block_end <= readahead_limit_) {
+    return prefetch_buffer_.get();
+  }
+  size_t n = std::max(readahead_size_,
+                      static_cast<size_t>(block_end - handle.offset()));
+  TEST_SYNC_POINT_CALLBACK("BlockBasedTable::BlockEntryIteratorState::Readahead",
+                           &n);
+  RandomAccessFileReader* file = table_->rep_->file.get();
+  Status s;
+  if (file->use_direct_io()) {
+    // Prefetch() is a no-op with direct I/O, buffer the window ourselves
+    if (!prefetch_buffer_) {
+      prefetch_buffer_.reset(new FilePrefetchBuffer(file));
+    }
+    s = prefetch_buffer_->Prefetch(handle.offset(), n);
+  } else {
+    // The OS reads the window in the background while we consume the
+    // current block
+    s = file->Prefetch(handle.offset(), n);
+  }
+  if (!s.ok()) {
+    // The block is then read on its own. The window is still skipped, so
+    // that a failing file is not asked again for every block.
+    ROCKS_LOG_WARN(table_->rep_->ioptions.info_log,
+                   "Readahead of %" ROCKSDB_PRIszt " bytes at offset %" PRIu64
+                   " failed: %s",
+                   n, handle.offset(), s.ToString().c_str());
+  }
+  readahead_limit_ = handle.offset() + n;
+  readahead_size_ = std::min(kMaxReadaheadSize, readahead_size_ * 2);
+  return prefetch_buffer_.get();
+}
 
 InternalIterator*
 BlockBasedTable::BlockEntryIteratorState::NewSecondaryIterator(
@@ -1406,8 +1859,15 @@ BlockBasedTable::BlockEntryIteratorState::NewSecondaryIterator(
   BlockHandle handle;
   Slice input = index_value;
   Status s = handle.DecodeFrom(&input);
+  const bool readahead = s.ok() && !is_index_ &&
+                         read_options_.readahead_size == 0 &&
+                         read_options_.read_tier != kBlockCacheTier;
+  if (readahead) {
+    TrackSequentialRead(handle);
+  }
   auto iter = NewDataBlockIterator(table_->rep_, read_options_, handle, nullptr,
-                                   is_index_, s);
+                                   is_index_, s, prefetch_buffer_.get(),
+                                   readahead ? this : nullptr);
   if (block_cache_cleaner_) {
     uint64_t offset = handle.offset();
     {
@@ -1433,6 +1893,26 @@ bool BlockBasedTable::BlockEntryIteratorState::PrefixMayMatch(
   return table_->PrefixMayMatch(internal_key);
 }
 
+bool BlockBasedTable::BlockEntryIteratorState::RangeMayMatch(
+    const Slice& internal_key) {
+  assert(read_options_.iterate_upper_bound != nullptr);
+  return table_->RangeMayMatch(internal_key,
+                               *read_options_.iterate_upper_bound);
+}
+
+Slice BlockBasedTable::BlockEntryIteratorState::UpperBoundKey() {
+  if (!check_range_may_match) {
+    return Slice();
+  }
+  // Built from the bound at each call, since the caller may change the
+  // bound between seeks
+  upper_bound_key_.clear();
+  AppendInternalKey(&upper_bound_key_,
+                    ParsedInternalKey(*read_options_.iterate_upper_bound,
+                                      kMaxSequenceNumber, kValueTypeForSeek));
+  return upper_bound_key_;
+}
+
 bool BlockBasedTable::BlockEntryIteratorState::KeyReachedUpperBound(
     const Slice& internal_key) {
   bool reached_upper_bound = read_options_.iterate_upper_bound != nullptr &&
@@ -1459,7 +1939,7 @@ bool BlockBasedTable::BlockEntryIteratorState::KeyReachedUpperBound(
 //
 // REQUIRES: this method shouldn't be called while the DB lock is held.
 bool BlockBasedTable::PrefixMayMatch(const Slice& internal_key) {
-  if (!rep_->filter_policy) {
+  if (!rep_->filter_policy && !rep_->prefix_filter) {
     return true;
   }
 
@@ -1475,6 +1955,18 @@ bool BlockBasedTable::PrefixMayMatch(const Slice& internal_key) {
   bool may_match = true;
   Status s;
 
+  Statistics* statistics = rep_->ioptions.statistics;
+  if (rep_->prefix_filter) {
+    // The table keeps the prefixes in a filter of their own; the whole key
+    // filter does not know them
+    may_match = rep_->prefix_filter->PrefixMayMatch(prefix);
+    RecordTick(statistics, BLOOM_FILTER_PREFIX_CHECKED);
+    if (!may_match) {
+      RecordTick(statistics, BLOOM_FILTER_PREFIX_USEFUL);
+    }
+    return may_match;
+  }
+
   // First, try check with full filter
   auto filter_entry = GetFilter();
   FilterBlockReader* filter = filter_entry.value;
@@ -1531,7 +2023,6 @@ bool BlockBasedTable::PrefixMayMatch(const Slice& internal_key) {
     }
   }
 
-  Statistics* statistics = rep_->ioptions.statistics;
   RecordTick(statistics, BLOOM_FILTER_PREFIX_CHECKED);
   if (!may_match) {
     RecordTick(statistics, BLOOM_FILTER_PREFIX_USEFUL);
@@ -1541,12 +2032,27 @@ bool BlockBasedTable::PrefixMayMatch(const Slice& internal_key) {
   // don't call, in this case we have a local copy in rep_->filter_entry,
   // it's pinned to the cache and will be released in the destructor
   if (!rep_->filter_entry.IsSet()) {
-    filter_entry.Release(rep_->table_options.block_cache.get());
+    filter_entry.Release(rep_->index_and_filter_cache());
   }
 
   return may_match;
 }
 
+bool BlockBasedTable::RangeMayMatch(const Slice& internal_key,
+                                    const Slice& upper_bound) {
+  if (rep_->range_filter == nullptr) {
+    return true;
+  }
+  bool may_match = rep_->range_filter->RangeMayMatch(
+      ExtractUserKey(internal_key), upper_bound);
+  Statistics* statistics = rep_->ioptions.statistics;
+  RecordTick(statistics, RANGE_FILTER_CHECKED);
+  if (!may_match) {
+    RecordTick(statistics, RANGE_FILTER_USEFUL);
+  }
+  return may_match;
+}
+
 InternalIterator* BlockBasedTable::NewIterator(
     const ReadOptions& read_options, Arena* arena,
     const InternalKeyComparator* icomp, bool skip_filters) {
@@ -1692,7 +2198,7 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
   // don't call, in this case we have a local copy in rep_->filter_entry,
   // it's pinned to the cache and will be released in the destructor
   if (!rep_->filter_entry.IsSet()) {
-    filter_entry.Release(rep_->table_options.block_cache.get());
+    filter_entry.Release(rep_->index_and_filter_cache());
   }
   return s;
 }
@@ -1747,6 +2253,139 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
   return Status::OK();
 }
 
+const size_t BlockBasedTable::kMaxWarmUpReadSize;
+const size_t BlockBasedTable::kMaxWarmUpGap;
+
+void BlockBasedTable::GetCachedDataBlocks(std::vector<BlockHandle>* handles) {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  if (block_cache == nullptr) {
+    return;
+  }
+
+  BlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(ReadOptions(), &iiter_on_stack);
+  std::unique_ptr<InternalIterator> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr = std::unique_ptr<InternalIterator>(iiter);
+  }
+
+  char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  for (iiter->SeekToFirst(); iiter->Valid(); iiter->Next()) {
+    BlockHandle handle;
+    Slice input = iiter->value();
+    if (!handle.DecodeFrom(&input).ok()) {
+      break;
+    }
+    Slice key = GetCacheKey(rep_->cache_key_prefix, rep_->cache_key_prefix_size,
+                            handle, cache_key);
+    // Probe without a lookup, so that listing the blocks does not make
+    // them more recently used
+    if (block_cache->Contains(key)) {
+      handles->push_back(handle);
+    }
+  }
+}
+
+void BlockBasedTable::GetKeyAnchors(size_t max_anchors,
+                                    std::vector<TableKeyAnchor>* anchors) {
+  if (max_anchors == 0 || rep_->table_properties == nullptr) {
+    return;
+  }
+  const uint64_t step =
+      std::max<uint64_t>(rep_->table_properties->data_size / max_anchors, 1);
+
+  BlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(ReadOptions(), &iiter_on_stack);
+  std::unique_ptr<InternalIterator> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr = std::unique_ptr<InternalIterator>(iiter);
+  }
+
+  // The data up to the end of the last anchored block
+  uint64_t anchored_size = 0;
+  uint64_t block_end = 0;
+  std::string last_key;
+  for (iiter->SeekToFirst(); iiter->Valid(); iiter->Next()) {
+    BlockHandle handle;
+    Slice input = iiter->value();
+    if (!handle.DecodeFrom(&input).ok()) {
+      return;
+    }
+    block_end = handle.offset() + handle.size() + kBlockTrailerSize;
+    if (block_end - anchored_size >= step) {
+      anchors->emplace_back(iiter->key(), block_end - anchored_size);
+      anchored_size = block_end;
+    } else {
+      last_key.assign(iiter->key().data(), iiter->key().size());
+    }
+  }
+  if (iiter->status().ok() && block_end > anchored_size) {
+    anchors->emplace_back(last_key, block_end - anchored_size);
+  }
+}
+
+Status BlockBasedTable::WarmUpDataBlocks(
+    const std::vector<BlockHandle>& handles) {
+  if (rep_->table_options.block_cache == nullptr &&
+      rep_->table_options.block_cache_compressed == nullptr) {
+    return Status::OK();
+  }
+
+  std::vector<BlockHandle> sorted(handles);
+  std::sort(sorted.begin(), sorted.end(),
+            [](const BlockHandle& a, const BlockHandle& b) {
+              return a.offset() < b.offset();
+            });
+  // Data blocks precede all meta blocks, so a handle past the metaindex block
+  // does not belong to this file
+  const uint64_t data_end = rep_->footer.metaindex_handle().offset();
+
+  Slice compression_dict;
+  if (rep_->compression_dict_block) {
+    compression_dict = rep_->compression_dict_block->data;
+  }
+  FilePrefetchBuffer prefetch_buffer(rep_->file.get());
+  ReadOptions ro;
+  size_t i = 0;
+  while (i < sorted.size()) {
+    const uint64_t begin = sorted[i].offset();
+    uint64_t end = begin + sorted[i].size() + kBlockTrailerSize;
+    if (end > data_end) {
+      return Status::Corruption("block handle past the data blocks");
+    }
+    // Coalesce the following blocks as long as the gaps are small
+    size_t j = i + 1;
+    while (j < sorted.size()) {
+      const uint64_t next_end =
+          sorted[j].offset() + sorted[j].size() + kBlockTrailerSize;
+      if (sorted[j].offset() > end + kMaxWarmUpGap ||
+          next_end - begin > kMaxWarmUpReadSize || next_end > data_end) {
+        break;
+      }
+      end = std::max(end, next_end);
+      j++;
+    }
+    Status s = prefetch_buffer.Prefetch(begin, static_cast<size_t>(end - begin));
+    if (!s.ok()) {
+      return s;
+    }
+    for (; i < j; i++) {
+      CachableEntry<Block> block;
+      s = MaybeLoadDataBlockToCache(rep_, ro, sorted[i], compression_dict,
+                                    &block, false, &prefetch_buffer);
+      if (block.cache_handle != nullptr) {
+        block.Release(rep_->table_options.block_cache.get());
+      } else {
+        delete block.value;
+      }
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+  return Status::OK();
+}
+
 bool BlockBasedTable::TEST_KeyInCache(const ReadOptions& options,
                                       const Slice& key) {
   std::unique_ptr<InternalIterator> iiter(NewIndexIterator(options));
@@ -1849,6 +2488,27 @@ Status BlockBasedTable::CreateIndexReader(
           icomparator, footer.index_handle(), meta_index_iter, index_reader,
           rep_->hash_index_allow_collision, rep_->persistent_cache_options);
     }
+    case BlockBasedTableOptions::kLearnedIndexSearch: {
+      std::unique_ptr<Block> meta_guard;
+      std::unique_ptr<InternalIterator> meta_iter_guard;
+      auto meta_index_iter = preloaded_meta_index_iter;
+      if (meta_index_iter == nullptr) {
+        auto s = ReadMetaBlock(rep_, &meta_guard, &meta_iter_guard);
+        if (!s.ok()) {
+          ROCKS_LOG_WARN(rep_->ioptions.info_log,
+                         "Unable to read the metaindex block."
+                         " Fall back to binary search index.");
+          return BinarySearchIndexReader::Create(
+              file, footer, footer.index_handle(), rep_->ioptions, icomparator,
+              index_reader, rep_->persistent_cache_options);
+        }
+        meta_index_iter = meta_iter_guard.get();
+      }
+
+      return LearnedIndexReader::Create(
+          footer, file, rep_->ioptions, icomparator, footer.index_handle(),
+          meta_index_iter, index_reader, rep_->persistent_cache_options);
+    }
     default: {
       std::string error_message =
           "Unrecognized index type: " + ToString(rep_->index_type);
@@ -2084,21 +2744,22 @@ Status BlockBasedTable::DumpTable(WritableFile* out_file) {
 }
 
 void BlockBasedTable::Close() {
-  rep_->filter_entry.Release(rep_->table_options.block_cache.get());
-  rep_->index_entry.Release(rep_->table_options.block_cache.get());
+  rep_->filter_entry.Release(rep_->index_and_filter_cache());
+  rep_->index_entry.Release(rep_->index_and_filter_cache());
   rep_->range_del_entry.Release(rep_->table_options.block_cache.get());
   // cleanup index and filter blocks to avoid accessing dangling pointer
   if (!rep_->table_options.no_block_cache) {
     char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
     // Get the filter block key
-    auto key = GetCacheKey(rep_->cache_key_prefix, rep_->cache_key_prefix_size,
+    auto key = GetCacheKey(rep_->metadata_cache_key_prefix,
+                           rep_->metadata_cache_key_prefix_size,
                            rep_->filter_handle, cache_key);
-    rep_->table_options.block_cache.get()->Erase(key);
+    rep_->index_and_filter_cache()->Erase(key);
     // Get the index block key
-    key = GetCacheKeyFromOffset(rep_->cache_key_prefix,
-                                rep_->cache_key_prefix_size,
+    key = GetCacheKeyFromOffset(rep_->metadata_cache_key_prefix,
+                                rep_->metadata_cache_key_prefix_size,
                                 rep_->dummy_index_reader_offset, cache_key);
-    rep_->table_options.block_cache.get()->Erase(key);
+    rep_->index_and_filter_cache()->Erase(key);
   }
 }
 
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <deque>
 #include <memory>
 #include <set>
 #include <string>
@@ -27,6 +28,7 @@
 #include "table/filter_block.h"
 #include "table/format.h"
 #include "table/persistent_cache_helper.h"
+#include "table/range_filter_block.h"
 #include "table/table_properties_internal.h"
 #include "table/table_reader.h"
 #include "table/two_level_iterator.h"
@@ -67,6 +69,8 @@ class BlockBasedTable : public TableReader {
   static const std::string kFilterBlockPrefix;
   static const std::string kFullFilterBlockPrefix;
   static const std::string kPartitionedFilterBlockPrefix;
+  static const std::string kPrefixFilterBlock;
+  static const std::string kRangeFilterBlock;
   // The longest prefix of the cache key used to identify blocks.
   // For Posix files the unique ID is three varints.
   static const size_t kMaxCacheKeyPrefixSize = kMaxVarint64Length * 3 + 1;
@@ -98,6 +102,10 @@ class BlockBasedTable : public TableReader {
 
   bool PrefixMayMatch(const Slice& internal_key);
 
+  // Returns false if the range filter of the table shows that it has no user
+  // key in [ExtractUserKey(internal_key), upper_bound).
+  bool RangeMayMatch(const Slice& internal_key, const Slice& upper_bound);
+
   // Returns a new iterator over the table contents.
   // The result of NewIterator() is initially invalid (caller must
   // call one of the Seek methods on the iterator before using it).
@@ -119,6 +127,18 @@ class BlockBasedTable : public TableReader {
   // IO or iteration error.
   Status Prefetch(const Slice* begin, const Slice* end) override;
 
+  // Append the handles of the data blocks that are in the block cache.
+  void GetCachedDataBlocks(std::vector<BlockHandle>* handles) override;
+
+  // Append the keys of evenly spaced index entries, which separate data
+  // blocks.
+  void GetKeyAnchors(size_t max_anchors,
+                     std::vector<TableKeyAnchor>* anchors) override;
+
+  // Load the given data blocks into the block cache. Blocks that lie close
+  // to each other in the file are fetched with one read.
+  Status WarmUpDataBlocks(const std::vector<BlockHandle>& handles) override;
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file).  The returned value is in terms of file
@@ -209,6 +229,11 @@ class BlockBasedTable : public TableReader {
   explicit BlockBasedTable(Rep* rep) : rep_(rep) {}
 
  private:
+  // WarmUpDataBlocks() reads at most kMaxWarmUpReadSize bytes at once and
+  // reads through gaps of up to kMaxWarmUpGap bytes between two blocks
+  static const size_t kMaxWarmUpReadSize = 2 * 1024 * 1024;
+  static const size_t kMaxWarmUpGap = 64 * 1024;
+
   // input_iter: if it is not null, update this one and return it as Iterator
   static InternalIterator* NewDataBlockIterator(Rep* rep, const ReadOptions& ro,
                                                 const Slice& index_value,
@@ -218,7 +243,11 @@ class BlockBasedTable : public TableReader {
                                                 const BlockHandle& block_hanlde,
                                                 BlockIter* input_iter = nullptr,
                                                 bool is_index = false,
-                                                Status s = Status());
+                                                Status s = Status(),
+                                                FilePrefetchBuffer*
+                                                    prefetch_buffer = nullptr,
+                                                BlockEntryIteratorState*
+                                                    readahead_state = nullptr);
   // If block cache enabled (compressed or uncompressed), looks for the block
   // identified by handle in (1) uncompressed cache, (2) compressed cache, and
   // then (3) file. If found, inserts into the cache(s) that were searched
@@ -228,11 +257,17 @@ class BlockBasedTable : public TableReader {
   // @param block_entry value is set to the uncompressed block if found. If
   //    in uncompressed block cache, also sets cache_handle to reference that
   //    block.
+  // @param readahead_state if not null, is given the chance to read ahead
+  //    when the block has to be read from the file.
   static Status MaybeLoadDataBlockToCache(Rep* rep, const ReadOptions& ro,
                                           const BlockHandle& handle,
                                           Slice compression_dict,
                                           CachableEntry<Block>* block_entry,
-                                          bool is_index = false);
+                                          bool is_index = false,
+                                          FilePrefetchBuffer*
+                                              prefetch_buffer = nullptr,
+                                          BlockEntryIteratorState*
+                                              readahead_state = nullptr);
 
   // For the following two functions:
   // if `no_io == true`, we will not try to read filter/index from sst file
@@ -318,6 +353,10 @@ class BlockBasedTable : public TableReader {
                                 const bool is_a_filter_partition) const;
 
   static void SetupCacheKeyPrefix(Rep* rep, uint64_t file_size);
+  // Stores the index and filter blocks of the table in metadata_cache if
+  // they fit in what is left of its capacity. Call it once the meta blocks
+  // are found, before any index or filter block is read.
+  static void SetupMetadataCache(Rep* rep);
 
   // Generate a cache key prefix from the file
   static void GenerateCachePrefix(Cache* cc,
@@ -347,9 +386,18 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
                           const InternalKeyComparator* icomparator,
                           bool skip_filters, bool is_index = false,
                           Cleanable* block_cache_cleaner = nullptr);
+  ~BlockEntryIteratorState();
   InternalIterator* NewSecondaryIterator(const Slice& index_value) override;
   bool PrefixMayMatch(const Slice& internal_key) override;
+  bool RangeMayMatch(const Slice& internal_key) override;
   bool KeyReachedUpperBound(const Slice& internal_key) override;
+  Slice UpperBoundKey() override;
+  void OnForwardBlock(const Slice& key, const Slice& handle) override;
+
+  // Issues the readahead window if the scan is due one. Only called when
+  // the data block at handle is not cached, so that scans over cached
+  // blocks do no I/O. Returns the buffer holding the window with direct I/O.
+  FilePrefetchBuffer* MaybeReadahead(const BlockHandle& handle);
 
  private:
   // Don't own table_
@@ -362,6 +410,45 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
   Cleanable* block_cache_cleaner_;
   std::set<uint64_t> cleaner_set;
   port::RWMutex cleaner_mu;
+  // Buffer of UpperBoundKey()
+  std::string upper_bound_key_;
+
+  // Automatic readahead for scans that read data blocks in file order. Once
+  // more than kMinSequentialReadsForReadahead consecutive blocks were read,
+  // a readahead window starting at kInitReadaheadSize is issued and doubled
+  // every time the scan reaches its end, up to kMaxReadaheadSize. Disabled
+  // when the user asked for a fixed ReadOptions::readahead_size.
+  static const int kMinSequentialReadsForReadahead = 2;
+  static const size_t kInitReadaheadSize = 8 * 1024;
+  static const size_t kMaxReadaheadSize = 256 * 1024;
+  // Called for every data block the scan moves to, cached or not
+  void TrackSequentialRead(const BlockHandle& handle);
+  uint64_t next_block_offset_;
+  int num_sequential_reads_;
+  size_t readahead_size_;
+  uint64_t readahead_limit_;
+  // Only used with direct I/O
+  std::unique_ptr<FilePrefetchBuffer> prefetch_buffer_;
+
+  // Background loading of the data blocks that follow the current one into
+  // the block cache, see ReadOptions::async_prefetch_blocks.
+  // prefetch_index_iter_ is a private index iterator kept positioned right
+  // after the last block scheduled; prefetched_offsets_ lists the scheduled
+  // blocks the scan has not reached yet.
+  struct PrefetchBlockArg;
+  static void BGWorkPrefetchBlock(void* arg);
+  static void UnschedulePrefetchBlock(void* arg);
+  void PrefetchBlockDone();
+  std::unique_ptr<InternalIterator> prefetch_index_iter_;
+  std::deque<uint64_t> prefetched_offsets_;
+  uint64_t current_block_offset_;
+  bool prefetch_reached_upper_bound_;
+  port::Mutex prefetch_mu_;
+  port::CondVar prefetch_cv_;
+  int pending_prefetches_;
+  // At most half of the LOW priority threads, and at least one, load
+  // blocks for this iterator at a time
+  int max_pending_prefetches_;
 };
 
 // CachableEntry represents the entries that *may* be fetched from block cache.
@@ -415,8 +502,12 @@ struct BlockBasedTable::Rep {
   size_t persistent_cache_key_prefix_size = 0;
   char compressed_cache_key_prefix[kMaxCacheKeyPrefixSize];
   size_t compressed_cache_key_prefix_size = 0;
+  // Prefix of the keys in metadata_cache; the same as cache_key_prefix if
+  // the table does not use metadata_cache
+  char metadata_cache_key_prefix[kMaxCacheKeyPrefixSize];
+  size_t metadata_cache_key_prefix_size = 0;
   uint64_t dummy_index_reader_offset =
-      0;  // ID that is unique for the block cache.
+      0;  // ID that is unique for the index and filter cache.
   PersistentCacheOptions persistent_cache_options;
 
   // Footer contains the fixed table information
@@ -442,6 +533,11 @@ struct BlockBasedTable::Rep {
   // is easier because the Slice member depends on the continued existence of
   // another member ("allocation").
   std::unique_ptr<const BlockContents> compression_dict_block;
+  // Filter of the key prefixes, if the table keeps them apart from the whole
+  // keys. Always held in memory.
+  std::unique_ptr<FilterBlockReader> prefix_filter;
+  // Range filter of the table, if it has one. Always held in memory.
+  std::unique_ptr<const RangeFilterBlockReader> range_filter;
   BlockBasedTableOptions::IndexType index_type;
   bool hash_index_allow_collision;
   bool whole_key_filtering;
@@ -470,6 +566,37 @@ struct BlockBasedTable::Rep {
   // A value of kDisableGlobalSequenceNumber means that this feature is disabled
   // and every key have it's own seqno.
   SequenceNumber global_seqno;
+  // Level of the file in the LSM tree, or -1 if unknown
+  int level = -1;
+  // table_options.metadata_cache if the index and filter blocks of this
+  // table are stored there, else null. See SetupMetadataCache().
+  Cache* metadata_cache = nullptr;
+
+  // The cache that holds the index and filter blocks, or their top-level
+  // blocks if they are partitioned
+  Cache* index_and_filter_cache() const {
+    return metadata_cache != nullptr ? metadata_cache
+                                     : table_options.block_cache.get();
+  }
+  // Whether the index and filter blocks are pinned in the cache as long as
+  // the table reader is alive
+  bool pin_index_and_filter() const {
+    return metadata_cache != nullptr ||
+           (level == 0 && table_options.pin_l0_filter_and_index_blocks_in_cache);
+  }
+  // Whether the index and filter partitions are stored, and pinned, in
+  // metadata_cache rather than block_cache
+  bool partitions_in_metadata_cache() const {
+    return metadata_cache != nullptr && level >= 0 &&
+           level <= table_options.metadata_cache_partitions_max_level;
+  }
+  // The cache that holds the index and filter partitions
+  Cache* partition_cache() const {
+    return partitions_in_metadata_cache() ? metadata_cache
+                                          : table_options.block_cache.get();
+  }
+  // Builds the key of a partition in partition_cache()
+  Slice GetPartitionCacheKey(const BlockHandle& handle, char* cache_key) const;
 };
 
 }  // namespace rocksdb
@@ -32,6 +32,21 @@
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+//
+// With BlockBasedTableOptions::kColumnLayout the keys and values are kept in
+// two separate columns. The key column is made of entries of the same form
+// as above minus the trailing value, and is followed by all the values
+// concatenated in key order:
+//     key entries: {shared_bytes, unshared_bytes, value_length, key_delta}*
+//     values: char[sum of value_length]
+// and the trailer becomes:
+//     value_restarts: uint32[num_restarts]
+//     restarts: uint32[num_restarts]
+//     values_offset: uint32
+//     num_restarts | kColumnLayoutRestartsFlag: uint32
+// value_restarts[i] is the offset within the value column of the value of
+// the ith restart point, and values_offset is the offset of the value column
+// within the block.
 
 #include "table/block_builder.h"
 
@@ -39,19 +54,26 @@
 #include <assert.h>
 #include "rocksdb/comparator.h"
 #include "db/dbformat.h"
+#include "table/format.h"
 #include "util/coding.h"
 
 namespace rocksdb {
 
-BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding)
+BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding,
+                           BlockBasedTableOptions::DataBlockLayout layout)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
+      use_column_layout_(layout == BlockBasedTableOptions::kColumnLayout),
       restarts_(),
       counter_(0),
       finished_(false) {
   assert(block_restart_interval_ >= 1);
   restarts_.push_back(0);       // First restart point is at offset 0
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
+  if (use_column_layout_) {
+    value_restarts_.push_back(0);
+    estimate_ += sizeof(uint32_t) + sizeof(uint32_t);
+  }
 }
 
 void BlockBuilder::Reset() {
@@ -59,6 +81,12 @@ void BlockBuilder::Reset() {
   restarts_.clear();
   restarts_.push_back(0);       // First restart point is at offset 0
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
+  if (use_column_layout_) {
+    values_.clear();
+    value_restarts_.clear();
+    value_restarts_.push_back(0);
+    estimate_ += sizeof(uint32_t) + sizeof(uint32_t);
+  }
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
@@ -70,6 +98,9 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key, const Slice& value)
   estimate += key.size() + value.size();
   if (counter_ >= block_restart_interval_) {
     estimate += sizeof(uint32_t); // a new restart entry.
+    if (use_column_layout_) {
+      estimate += sizeof(uint32_t); // a new value restart entry.
+    }
   }
 
   estimate += sizeof(int32_t); // varint for shared prefix length.
@@ -80,11 +111,25 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key, const Slice& value)
 }
 
 Slice BlockBuilder::Finish() {
+  uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
+  uint32_t values_offset = 0;
+  if (use_column_layout_) {
+    // Append the value column and its restart array
+    values_offset = static_cast<uint32_t>(buffer_.size());
+    buffer_.append(values_);
+    for (size_t i = 0; i < value_restarts_.size(); i++) {
+      PutFixed32(&buffer_, value_restarts_[i]);
+    }
+    num_restarts |= kColumnLayoutRestartsFlag;
+  }
   // Append restart array
   for (size_t i = 0; i < restarts_.size(); i++) {
     PutFixed32(&buffer_, restarts_[i]);
   }
-  PutFixed32(&buffer_, static_cast<uint32_t>(restarts_.size()));
+  if (use_column_layout_) {
+    PutFixed32(&buffer_, values_offset);
+  }
+  PutFixed32(&buffer_, num_restarts);
   finished_ = true;
   return Slice(buffer_);
 }
@@ -97,6 +142,10 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
     // Restart compression
     restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
     estimate_ += sizeof(uint32_t);
+    if (use_column_layout_) {
+      value_restarts_.push_back(static_cast<uint32_t>(values_.size()));
+      estimate_ += sizeof(uint32_t);
+    }
     counter_ = 0;
 
     if (use_delta_encoding_) {
@@ -124,7 +173,12 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
 
   // Add string delta to buffer_ followed by value
   buffer_.append(key.data() + shared, non_shared);
-  buffer_.append(value.data(), value.size());
+  if (use_column_layout_) {
+    values_.append(value.data(), value.size());
+    estimate_ += value.size();
+  } else {
+    buffer_.append(value.data(), value.size());
+  }
 
   counter_++;
   estimate_ += buffer_.size() - curr_size;
@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include "rocksdb/slice.h"
+#include "rocksdb/table.h"
 
 namespace rocksdb {
 
@@ -23,7 +24,9 @@ class BlockBuilder {
   void operator=(const BlockBuilder&) = delete;
 
   explicit BlockBuilder(int block_restart_interval,
-                        bool use_delta_encoding = true);
+                        bool use_delta_encoding = true,
+                        BlockBasedTableOptions::DataBlockLayout layout =
+                            BlockBasedTableOptions::kRowLayout);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
@@ -52,9 +55,13 @@ class BlockBuilder {
  private:
   const int          block_restart_interval_;
   const bool         use_delta_encoding_;
+  const bool         use_column_layout_;
 
   std::string           buffer_;    // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
+  // Only used by kColumnLayout
+  std::string           values_;          // Value column
+  std::vector<uint32_t> value_restarts_;  // Value column restart points
   size_t                estimate_;
   int                   counter_;   // Number of entries emitted since restart
   bool                  finished_;  // Has Finish() been called?
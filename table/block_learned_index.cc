@@ -0,0 +1,213 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+
+#include "table/block_learned_index.h"
+
+#include <string.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include "db/dbformat.h"
+#include "util/coding.h"
+
+namespace rocksdb {
+
+const uint32_t BlockLearnedIndex::kMaxRun;
+
+uint64_t BlockLearnedIndex::KeyToNumber(const Slice& user_key,
+                                        const Slice& prefix) {
+  // Keys without the prefix sort before or after all keys that have it
+  const size_t n = std::min(user_key.size(), prefix.size());
+  const int cmp = memcmp(user_key.data(), prefix.data(), n);
+  if (cmp < 0 || (cmp == 0 && user_key.size() < prefix.size())) {
+    return 0;
+  }
+  if (cmp > 0) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  uint64_t number = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    const size_t pos = prefix.size() + i;
+    number <<= 8;
+    if (pos < user_key.size()) {
+      number |= static_cast<unsigned char>(user_key[pos]);
+    }
+  }
+  return number;
+}
+
+BlockLearnedIndex::Builder::Builder(uint32_t restart_interval,
+                                    uint32_t max_error)
+    : restart_interval_(std::max(restart_interval, 1u)),
+      max_error_(max_error) {}
+
+void BlockLearnedIndex::Builder::Add(const Slice& user_key) {
+  keys_.emplace_back(user_key.data(), user_key.size());
+}
+
+bool BlockLearnedIndex::Builder::Finish(const Slice& last_user_key,
+                                        std::string* contents) {
+  if (keys_.size() < 2) {
+    return false;
+  }
+  // All keys but the last one lie between the first key and last_user_key,
+  // so they share the prefix of these two
+  const Slice first(keys_.front());
+  size_t prefix_len = 0;
+  const size_t limit = std::min(first.size(), last_user_key.size());
+  while (prefix_len < limit && first[prefix_len] == last_user_key[prefix_len]) {
+    prefix_len++;
+  }
+  const Slice prefix(first.data(), prefix_len);
+
+  // The distinct numbers, each with the first entry it maps to
+  std::vector<uint64_t> numbers;
+  std::vector<uint32_t> entries;
+  uint32_t max_run = 0;
+  uint32_t run = 0;
+  for (size_t i = 0; i < keys_.size(); i++) {
+    const uint64_t number = KeyToNumber(keys_[i], prefix);
+    if (!numbers.empty() && number == numbers.back()) {
+      run++;
+    } else {
+      numbers.push_back(number);
+      entries.push_back(static_cast<uint32_t>(i));
+      run = 1;
+    }
+    max_run = std::max(max_run, run);
+  }
+  if (max_run > kMaxRun) {
+    // Too many keys look alike to tell their entries apart
+    return false;
+  }
+
+  // Greedily grow each segment while some line through its first point stays
+  // within max_error of all of its points. [min_slope, max_slope] is the cone
+  // of such lines.
+  std::vector<uint64_t> starts;
+  std::vector<uint32_t> first_entries;
+  std::vector<double> slopes;
+  const double max_error = static_cast<double>(max_error_);
+  double min_slope = 0;
+  double max_slope = std::numeric_limits<double>::infinity();
+  starts.push_back(numbers[0]);
+  first_entries.push_back(entries[0]);
+  for (size_t i = 1; i < numbers.size(); i++) {
+    const double dx = static_cast<double>(numbers[i] - starts.back());
+    const double dy = static_cast<double>(entries[i] - first_entries.back());
+    const double lo = std::max(min_slope, (dy - max_error) / dx);
+    const double hi = std::min(max_slope, (dy + max_error) / dx);
+    if (lo <= hi) {
+      min_slope = lo;
+      max_slope = hi;
+      continue;
+    }
+    // A segment always has at least two points, so max_slope is finite
+    slopes.push_back((min_slope + max_slope) / 2);
+    starts.push_back(numbers[i]);
+    first_entries.push_back(entries[i]);
+    min_slope = 0;
+    max_slope = std::numeric_limits<double>::infinity();
+  }
+  slopes.push_back(
+      max_slope == std::numeric_limits<double>::infinity()
+          ? 0
+          : (min_slope + max_slope) / 2);
+  if (starts.size() * 4 > numbers.size()) {
+    // The model would not be much smaller than the keys
+    return false;
+  }
+
+  PutVarint32(contents, static_cast<uint32_t>(keys_.size()));
+  PutVarint32(contents, restart_interval_);
+  PutVarint32(contents, max_error_);
+  PutVarint32(contents, max_run);
+  PutLengthPrefixedSlice(contents, prefix);
+  PutVarint32(contents, static_cast<uint32_t>(starts.size()));
+  for (size_t i = 0; i < starts.size(); i++) {
+    uint64_t slope_bits;
+    static_assert(sizeof(slope_bits) == sizeof(double), "");
+    memcpy(&slope_bits, &slopes[i], sizeof(slope_bits));
+    PutFixed64(contents, starts[i]);
+    PutFixed32(contents, first_entries[i]);
+    PutFixed64(contents, slope_bits);
+  }
+  return true;
+}
+
+Status BlockLearnedIndex::Create(const Slice& contents,
+                                 BlockLearnedIndex** learned_index) {
+  Slice input = contents;
+  std::unique_ptr<BlockLearnedIndex> index(new BlockLearnedIndex());
+  Slice prefix;
+  uint32_t num_segments = 0;
+  if (!GetVarint32(&input, &index->num_entries_) ||
+      !GetVarint32(&input, &index->restart_interval_) ||
+      !GetVarint32(&input, &index->max_error_) ||
+      !GetVarint32(&input, &index->max_run_) ||
+      !GetLengthPrefixedSlice(&input, &prefix) ||
+      !GetVarint32(&input, &num_segments) || num_segments == 0 ||
+      index->num_entries_ == 0 || index->restart_interval_ == 0) {
+    return Status::Corruption("bad learned index header");
+  }
+  index->prefix_.assign(prefix.data(), prefix.size());
+  index->starts_.resize(num_segments);
+  index->first_entries_.resize(num_segments);
+  index->slopes_.resize(num_segments);
+  for (uint32_t i = 0; i < num_segments; i++) {
+    uint64_t slope_bits;
+    if (!GetFixed64(&input, &index->starts_[i]) ||
+        !GetFixed32(&input, &index->first_entries_[i]) ||
+        !GetFixed64(&input, &slope_bits)) {
+      return Status::Corruption("bad learned index segment");
+    }
+    memcpy(&index->slopes_[i], &slope_bits, sizeof(slope_bits));
+    if (index->first_entries_[i] >= index->num_entries_ ||
+        (i > 0 && (index->starts_[i] <= index->starts_[i - 1] ||
+                   index->first_entries_[i] <= index->first_entries_[i - 1]))) {
+      return Status::Corruption("bad learned index segment");
+    }
+  }
+  *learned_index = index.release();
+  return Status::OK();
+}
+
+void BlockLearnedIndex::GetRestartRange(const Slice& internal_key,
+                                        uint32_t* left,
+                                        uint32_t* right) const {
+  const uint64_t number = KeyToNumber(ExtractUserKey(internal_key), prefix_);
+  auto it = std::upper_bound(starts_.begin(), starts_.end(), number);
+  if (it == starts_.begin()) {
+    // Before the first entry
+    *left = *right = 0;
+    return;
+  }
+  const size_t segment = (it - starts_.begin()) - 1;
+  const uint32_t first_entry = first_entries_[segment];
+  const uint32_t end_entry = segment + 1 < first_entries_.size()
+                                 ? first_entries_[segment + 1]
+                                 : num_entries_;
+  double predicted =
+      first_entry +
+      slopes_[segment] * static_cast<double>(number - starts_[segment]);
+  if (!(predicted < end_entry)) {
+    predicted = end_entry;
+  }
+  // One more entry on both sides absorbs the rounding of the prediction
+  const uint64_t entry = static_cast<uint64_t>(predicted);
+  const uint64_t lo =
+      std::max<uint64_t>(first_entry, entry > max_error_ + 1
+                                          ? entry - max_error_ - 1
+                                          : 0);
+  const uint64_t hi = std::min<uint64_t>(
+      num_entries_ - 1, entry + max_error_ + max_run_ + 1);
+  *left = static_cast<uint32_t>(std::min(lo, hi) / restart_interval_);
+  *right = static_cast<uint32_t>(hi / restart_interval_);
+}
+
+}  // namespace rocksdb
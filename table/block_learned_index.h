@@ -0,0 +1,93 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// A learned index speeds up the lookup in an "index block" whose keys are
+// ordered bytewise. Each user key is mapped to a number: the 8 bytes that
+// follow the prefix shared by all keys of the table, read big-endian. A
+// piecewise-linear model then maps that number to the position of the first
+// index entry whose key is not smaller, off by at most max_error entries.
+// A lookup evaluates one segment of the model and binary searches the few
+// restart points around the prediction, instead of the whole block.
+//
+// The format of the learned index block is:
+//   num_entries: varint32
+//   restart_interval: varint32
+//   max_error: varint32
+//   max_run: varint32 (largest number of entries that map to one number)
+//   prefix: varint32 length + bytes
+//   num_segments: varint32
+//   segments: num_segments * (start: fixed64, first_entry: fixed32,
+//                             slope: fixed64 holding a double)
+class BlockLearnedIndex {
+ public:
+  class Builder {
+   public:
+    // restart_interval is the restart interval of the index block; the
+    // model may be off by max_error entries
+    Builder(uint32_t restart_interval, uint32_t max_error);
+
+    // Adds the user key of the next index entry.
+    // REQUIRES: keys are added in bytewise order
+    void Add(const Slice& user_key);
+
+    // Builds the model. last_user_key is the largest user key of the table,
+    // which bounds the key of the last index entry from below. Returns false
+    // if the keys are not a good fit for a compact model, in which case
+    // contents is not touched and the table should not store a model.
+    bool Finish(const Slice& last_user_key, std::string* contents);
+
+   private:
+    uint32_t restart_interval_;
+    uint32_t max_error_;
+    std::vector<std::string> keys_;
+  };
+
+  // Returns the range [*left, *right] of restart points of the index block
+  // that holds the first entry whose key is at or past internal_key.
+  void GetRestartRange(const Slice& internal_key, uint32_t* left,
+                       uint32_t* right) const;
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(BlockLearnedIndex) + prefix_.size() +
+           starts_.capacity() * sizeof(uint64_t) +
+           first_entries_.capacity() * sizeof(uint32_t) +
+           slopes_.capacity() * sizeof(double);
+  }
+
+  // Create the learned index from the contents of its meta block
+  static Status Create(const Slice& contents,
+                       BlockLearnedIndex** learned_index);
+
+  // Maps user_key to the number the model is built on
+  static uint64_t KeyToNumber(const Slice& user_key, const Slice& prefix);
+
+  // Upper bound of the number of index entries sharing one number
+  static const uint32_t kMaxRun = 8;
+
+ private:
+  BlockLearnedIndex() {}
+
+  uint32_t num_entries_ = 0;
+  uint32_t restart_interval_ = 1;
+  uint32_t max_error_ = 0;
+  uint32_t max_run_ = 0;
+  std::string prefix_;
+  std::vector<uint64_t> starts_;
+  std::vector<uint32_t> first_entries_;
+  std::vector<double> slopes_;
+};
+
+}  // namespace rocksdb
@@ -0,0 +1,187 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+
+#include "table/block_learned_index.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "util/coding.h"
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
+
+namespace rocksdb {
+
+namespace {
+// "user" followed by the big-endian encoding of n
+std::string NumberKey(uint64_t n) {
+  std::string key = "user";
+  for (int i = 7; i >= 0; i--) {
+    key.push_back(static_cast<char>((n >> (i * 8)) & 0xff));
+  }
+  return key;
+}
+}  // namespace
+
+class BlockLearnedIndexTest : public testing::Test {
+ public:
+  // Builds a model over keys, which must be sorted
+  bool Build(const std::vector<std::string>& keys, uint32_t restart_interval,
+             uint32_t max_error) {
+    BlockLearnedIndex::Builder builder(restart_interval, max_error);
+    for (const auto& key : keys) {
+      builder.Add(key);
+    }
+    std::string contents;
+    if (!builder.Finish(keys.back(), &contents)) {
+      return false;
+    }
+    BlockLearnedIndex* learned_index = nullptr;
+    EXPECT_OK(BlockLearnedIndex::Create(contents, &learned_index));
+    learned_index_.reset(learned_index);
+    return true;
+  }
+
+  // Checks that the restart range of target holds the first key at or past
+  // it
+  void CheckSeek(const std::vector<std::string>& keys,
+                 uint32_t restart_interval, const std::string& target) {
+    uint32_t left, right;
+    learned_index_->GetRestartRange(
+        InternalKey(target, kMaxSequenceNumber, kValueTypeForSeek).Encode(),
+        &left, &right);
+    ASSERT_LE(left, right);
+    const size_t num_restarts =
+        (keys.size() + restart_interval - 1) / restart_interval;
+    ASSERT_LT(right, num_restarts);
+    auto it = std::lower_bound(keys.begin(), keys.end(), target);
+    if (it == keys.end()) {
+      // Seek scans past the range to the end
+      return;
+    }
+    const size_t restart = (it - keys.begin()) / restart_interval;
+    ASSERT_LE(left, restart);
+    ASSERT_GE(right, restart);
+  }
+
+ protected:
+  std::unique_ptr<BlockLearnedIndex> learned_index_;
+};
+
+TEST_F(BlockLearnedIndexTest, KeyToNumber) {
+  ASSERT_EQ(0u, BlockLearnedIndex::KeyToNumber("abc", "user"));
+  ASSERT_EQ(0u, BlockLearnedIndex::KeyToNumber("use", "user"));
+  ASSERT_EQ(port::kMaxUint64, BlockLearnedIndex::KeyToNumber("v", "user"));
+  ASSERT_EQ(0u, BlockLearnedIndex::KeyToNumber("user", "user"));
+  ASSERT_EQ(258u, BlockLearnedIndex::KeyToNumber(NumberKey(258), "user"));
+  // Short keys are padded with zeros
+  ASSERT_EQ(static_cast<uint64_t>('a') << 56,
+            BlockLearnedIndex::KeyToNumber("usera", "user"));
+}
+
+TEST_F(BlockLearnedIndexTest, RandomKeys) {
+  Random64 rnd(301);
+  for (uint32_t restart_interval : {1u, 4u, 16u}) {
+    std::set<uint64_t> numbers;
+    while (numbers.size() < 10000) {
+      numbers.insert(rnd.Next() >> 20);
+    }
+    std::vector<std::string> keys;
+    for (uint64_t n : numbers) {
+      keys.push_back(NumberKey(n));
+    }
+    ASSERT_TRUE(Build(keys, restart_interval, 4));
+
+    for (const auto& key : keys) {
+      CheckSeek(keys, restart_interval, key);
+    }
+    for (int i = 0; i < 10000; i++) {
+      CheckSeek(keys, restart_interval, NumberKey(rnd.Next() >> 20));
+    }
+    // Outside of the keys of the table
+    CheckSeek(keys, restart_interval, "");
+    CheckSeek(keys, restart_interval, "abc");
+    CheckSeek(keys, restart_interval, "zzz");
+    CheckSeek(keys, restart_interval, NumberKey(0));
+    CheckSeek(keys, restart_interval, NumberKey(port::kMaxUint64));
+  }
+}
+
+TEST_F(BlockLearnedIndexTest, LongKeys) {
+  // Keys only differ past the 8 bytes of the number
+  Random rnd(301);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; i++) {
+    keys.push_back("user" + test::RandomKey(&rnd, 20));
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  ASSERT_TRUE(Build(keys, 1, 4));
+  for (const auto& key : keys) {
+    CheckSeek(keys, 1, key);
+    CheckSeek(keys, 1, key + "0");
+  }
+}
+
+TEST_F(BlockLearnedIndexTest, BadFit) {
+  std::vector<std::string> keys;
+  // Too few keys
+  keys.push_back(NumberKey(1));
+  ASSERT_FALSE(Build(keys, 1, 4));
+
+  // Too many keys share their first 8 bytes past the prefix
+  keys.clear();
+  for (int i = 0; i < 20; i++) {
+    keys.push_back("a12345678" + ToString(i + 10));
+  }
+  keys.push_back("b");
+  ASSERT_FALSE(Build(keys, 1, 4));
+
+  // Every key needs its own segment
+  keys.clear();
+  for (int i = 0; i < 100; i++) {
+    keys.push_back(NumberKey(uint64_t{1} << (i % 64)) + ToString(i / 64));
+  }
+  std::sort(keys.begin(), keys.end());
+  ASSERT_FALSE(Build(keys, 1, 0));
+}
+
+TEST_F(BlockLearnedIndexTest, Corruption) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < 100; i++) {
+    keys.push_back(NumberKey(i * 10));
+  }
+  BlockLearnedIndex::Builder builder(1, 4);
+  for (const auto& key : keys) {
+    builder.Add(key);
+  }
+  std::string contents;
+  ASSERT_TRUE(builder.Finish(keys.back(), &contents));
+
+  BlockLearnedIndex* learned_index = nullptr;
+  ASSERT_TRUE(BlockLearnedIndex::Create(Slice(contents.data(), 3),
+                                        &learned_index)
+                  .IsCorruption());
+  ASSERT_TRUE(BlockLearnedIndex::Create(
+                  Slice(contents.data(), contents.size() - 1), &learned_index)
+                  .IsCorruption());
+  ASSERT_TRUE(learned_index == nullptr);
+  ASSERT_OK(BlockLearnedIndex::Create(contents, &learned_index));
+  delete learned_index;
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
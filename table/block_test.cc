@@ -131,6 +131,71 @@ TEST_F(BlockTest, SimpleTest) {
   delete iter;
 }
 
+TEST_F(BlockTest, ColumnLayout) {
+  Random rnd(301);
+  Options options = Options();
+
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  BlockBuilder builder(16, true /* use_delta_encoding */,
+                       BlockBasedTableOptions::kColumnLayout);
+  int num_records = 10000;
+
+  GenerateRandomKVs(&keys, &values, 0, num_records);
+  for (int i = 0; i < num_records; i++) {
+    // Exercise empty values in the value column too
+    if (i % 7 == 0) {
+      values[i].clear();
+    }
+    builder.Add(keys[i], values[i]);
+  }
+  Slice rawblock = builder.Finish();
+  ASSERT_LE(rawblock.size(), builder.CurrentSizeEstimate());
+
+  BlockContents contents;
+  contents.data = rawblock;
+  contents.cachable = false;
+  Block reader(std::move(contents), kDisableGlobalSequenceNumber);
+
+  // Forward scan
+  int count = 0;
+  std::unique_ptr<InternalIterator> iter(
+      reader.NewIterator(options.comparator));
+  for (iter->SeekToFirst(); iter->Valid(); count++, iter->Next()) {
+    ASSERT_EQ(iter->key().ToString(), keys[count]);
+    ASSERT_EQ(iter->value().ToString(), values[count]);
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(count, num_records);
+
+  // Backward scan, including entries served from the prev cache
+  count = num_records - 1;
+  for (iter->SeekToLast(); iter->Valid(); count--, iter->Prev()) {
+    ASSERT_EQ(iter->key().ToString(), keys[count]);
+    ASSERT_EQ(iter->value().ToString(), values[count]);
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(count, -1);
+
+  // Random seeks, followed by a change of direction
+  for (int i = 0; i < num_records; i++) {
+    int index = rnd.Uniform(num_records);
+    iter->Seek(keys[index]);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(iter->value().ToString(), values[index]);
+    if (index > 0) {
+      iter->Prev();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(iter->key().ToString(), keys[index - 1]);
+      ASSERT_EQ(iter->value().ToString(), values[index - 1]);
+      iter->Next();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(iter->key().ToString(), keys[index]);
+      ASSERT_EQ(iter->value().ToString(), values[index]);
+    }
+  }
+}
+
 // return the block contents
 BlockContents GetBlockContents(std::unique_ptr<BlockBuilder> *builder,
                                const std::vector<std::string> &keys,
@@ -97,6 +97,21 @@ class FilterBlockReader {
   virtual bool KeyMayMatch(const Slice& key, uint64_t block_offset = kNotValid,
                            const bool no_io = false,
                            const Slice* const const_ikey_ptr = nullptr) = 0;
+  /**
+   * Batched KeyMayMatch(): may_match[i] is set to the result for keys[i].
+   * const_ikeys, if not null, holds the internal key of each of keys.
+   * Readers that can overlap the lookups of several keys override this.
+   */
+  virtual void KeysMayMatch(int num_keys, const Slice* keys, bool* may_match,
+                            uint64_t block_offset = kNotValid,
+                            const bool no_io = false,
+                            const Slice* const const_ikeys = nullptr) {
+    for (int i = 0; i < num_keys; i++) {
+      may_match[i] =
+          KeyMayMatch(keys[i], block_offset, no_io,
+                      const_ikeys == nullptr ? nullptr : &const_ikeys[i]);
+    }
+  }
   /**
    * no_io and const_ikey_ptr here means the same as in KeyMayMatch
    */
@@ -259,17 +259,26 @@ namespace {
 // According to the implementation of file->Read, contents may not point to buf
 Status ReadBlock(RandomAccessFileReader* file, const Footer& footer,
                  const ReadOptions& options, const BlockHandle& handle,
-                 Slice* contents, /* result of reading */ char* buf) {
+                 Slice* contents, /* result of reading */ char* buf,
+                 FilePrefetchBuffer* prefetch_buffer) {
   size_t n = static_cast<size_t>(handle.size());
   Status s;
 
-  {
-    PERF_TIMER_GUARD(block_read_time);
-    s = file->Read(handle.offset(), n + kBlockTrailerSize, contents, buf);
-  }
+  if (prefetch_buffer != nullptr &&
+      prefetch_buffer->TryReadFromCache(handle.offset(), n + kBlockTrailerSize,
+                                        contents)) {
+    // The prefetch buffer is reused for later reads, so keep our own copy
+    memcpy(buf, contents->data(), n + kBlockTrailerSize);
+    *contents = Slice(buf, n + kBlockTrailerSize);
+  } else {
+    {
+      PERF_TIMER_GUARD(block_read_time);
+      s = file->Read(handle.offset(), n + kBlockTrailerSize, contents, buf);
+    }
 
-  PERF_COUNTER_ADD(block_read_count, 1);
-  PERF_COUNTER_ADD(block_read_byte, n + kBlockTrailerSize);
+    PERF_COUNTER_ADD(block_read_count, 1);
+    PERF_COUNTER_ADD(block_read_byte, n + kBlockTrailerSize);
+  }
 
   if (!s.ok()) {
     return s;
@@ -292,6 +301,9 @@ Status ReadBlock(RandomAccessFileReader* file, const Footer& footer,
       case kxxHash:
         actual = XXH32(data, static_cast<int>(n) + 1, 0);
         break;
+      case kxxHash64:
+        actual = static_cast<uint32_t>(XXH64(data, n + 1, 0));
+        break;
       default:
         s = Status::Corruption("unknown checksum type");
     }
@@ -313,7 +325,8 @@ Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
                          const ImmutableCFOptions &ioptions,
                          bool decompression_requested,
                          const Slice& compression_dict,
-                         const PersistentCacheOptions& cache_options) {
+                         const PersistentCacheOptions& cache_options,
+                         FilePrefetchBuffer* prefetch_buffer) {
   Status status;
   Slice slice;
   size_t n = static_cast<size_t>(handle.size());
@@ -371,7 +384,8 @@ Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
       used_buf = heap_buf.get();
     }
 
-    status = ReadBlock(file, footer, read_options, handle, &slice, used_buf);
+    status = ReadBlock(file, footer, read_options, handle, &slice, used_buf,
+                       prefetch_buffer);
     if (status.ok() && read_options.fill_cache &&
         cache_options.persistent_cache &&
         cache_options.persistent_cache->IsCompressed()) {
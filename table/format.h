@@ -24,6 +24,7 @@
 namespace rocksdb {
 
 class Block;
+class FilePrefetchBuffer;
 class RandomAccessFile;
 struct ReadOptions;
 
@@ -182,6 +183,11 @@ Status ReadFooterFromFile(RandomAccessFileReader* file, uint64_t file_size,
 // 1-byte type + 32-bit crc
 static const size_t kBlockTrailerSize = 5;
 
+// The high bit of the restart count at the end of a block marks a block
+// written in BlockBasedTableOptions::kColumnLayout. Readers unaware of the
+// layout see an implausible number of restarts and reject the block.
+static const uint32_t kColumnLayoutRestartsFlag = 1u << 31;
+
 struct BlockContents {
   Slice data;           // Actual contents of data
   bool cachable;        // True iff data can be cached
@@ -214,12 +220,15 @@ struct BlockContents {
 
 // Read the block identified by "handle" from "file".  On failure
 // return non-OK.  On success fill *result and return OK.
+// If prefetch_buffer is not null and already holds the block, the block is
+// taken from it instead of being read from "file".
 extern Status ReadBlockContents(
     RandomAccessFileReader* file, const Footer& footer,
     const ReadOptions& options, const BlockHandle& handle,
     BlockContents* contents, const ImmutableCFOptions &ioptions,
     bool do_uncompress = true, const Slice& compression_dict = Slice(),
-    const PersistentCacheOptions& cache_options = PersistentCacheOptions());
+    const PersistentCacheOptions& cache_options = PersistentCacheOptions(),
+    FilePrefetchBuffer* prefetch_buffer = nullptr);
 
 // The 'data' points to the raw block contents read in from file.
 // This method allocates a new heap buffer and the raw block
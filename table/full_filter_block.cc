@@ -7,6 +7,8 @@
 
 #include "table/full_filter_block.h"
 
+#include <algorithm>
+
 #include "monitoring/perf_context_imp.h"
 #include "port/port.h"
 #include "rocksdb/filter_policy.h"
@@ -85,6 +87,23 @@ bool FullFilterBlockReader::KeyMayMatch(const Slice& key, uint64_t block_offset,
   return MayMatch(key);
 }
 
+void FullFilterBlockReader::KeysMayMatch(int num_keys, const Slice* keys,
+                                         bool* may_match,
+                                         uint64_t block_offset,
+                                         const bool no_io,
+                                         const Slice* const const_ikeys) {
+  assert(block_offset == kNotValid);
+  if (!whole_key_filtering_ || contents_.size() == 0) {
+    std::fill(may_match, may_match + num_keys, true);
+    return;
+  }
+  filter_bits_reader_->MayMatchBatch(num_keys, keys, may_match);
+  int num_hits = static_cast<int>(std::count(may_match, may_match + num_keys,
+                                             true));
+  PERF_COUNTER_ADD(bloom_sst_hit_count, num_hits);
+  PERF_COUNTER_ADD(bloom_sst_miss_count, num_keys - num_hits);
+}
+
 bool FullFilterBlockReader::PrefixMayMatch(const Slice& prefix,
                                            uint64_t block_offset,
                                            const bool no_io,
@@ -97,6 +97,10 @@ class FullFilterBlockReader : public FilterBlockReader {
       const Slice& key, uint64_t block_offset = kNotValid,
       const bool no_io = false,
       const Slice* const const_ikey_ptr = nullptr) override;
+  virtual void KeysMayMatch(int num_keys, const Slice* keys, bool* may_match,
+                            uint64_t block_offset = kNotValid,
+                            const bool no_io = false,
+                            const Slice* const const_ikeys = nullptr) override;
   virtual bool PrefixMayMatch(
       const Slice& prefix, uint64_t block_offset = kNotValid,
       const bool no_io = false,
@@ -183,6 +183,37 @@ TEST_F(FullFilterBlockTest, SingleChunk) {
   ASSERT_TRUE(!reader.KeyMayMatch("other"));
 }
 
+TEST_F(FullFilterBlockTest, KeysMayMatch) {
+  FullFilterBlockBuilder builder(
+      nullptr, true, table_options_.filter_policy->GetFilterBitsBuilder());
+  builder.Add("foo");
+  builder.Add("bar");
+  builder.Add("box");
+  builder.Add("hello");
+  Slice block = builder.Finish();
+  FullFilterBlockReader reader(
+      nullptr, true, block,
+      table_options_.filter_policy->GetFilterBitsReader(block), nullptr);
+  const Slice keys[] = {"foo", "missing", "bar", "box", "other", "hello"};
+  bool may_match[6];
+  reader.KeysMayMatch(6, keys, may_match);
+  ASSERT_TRUE(may_match[0]);
+  ASSERT_TRUE(!may_match[1]);
+  ASSERT_TRUE(may_match[2]);
+  ASSERT_TRUE(may_match[3]);
+  ASSERT_TRUE(!may_match[4]);
+  ASSERT_TRUE(may_match[5]);
+
+  // Without whole key filtering every key may match
+  FullFilterBlockReader prefix_reader(
+      nullptr, false, block,
+      table_options_.filter_policy->GetFilterBitsReader(block), nullptr);
+  prefix_reader.KeysMayMatch(6, keys, may_match);
+  for (bool b : may_match) {
+    ASSERT_TRUE(b);
+  }
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
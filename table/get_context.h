@@ -84,7 +84,10 @@ class GetContext {
   PinnedIteratorsManager* pinned_iters_mgr_;
 };
 
+// If value_pinner is set, the values in replay_log are pinned with the
+// cleanups registered on it instead of being copied out
 void replayGetContextLog(const Slice& replay_log, const Slice& user_key,
-                         GetContext* get_context);
+                         GetContext* get_context,
+                         Cleanable* value_pinner = nullptr);
 
 }  // namespace rocksdb
@@ -42,6 +42,10 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
     case BlockBasedTableOptions::kTwoLevelIndexSearch: {
       return PartitionedIndexBuilder::CreateIndexBuilder(comparator, table_opt);
     }
+    case BlockBasedTableOptions::kLearnedIndexSearch: {
+      return new LearnedIndexBuilder(comparator,
+                                     table_opt.index_block_restart_interval);
+    }
     default: {
       assert(!"Do not recognize the index type ");
       return nullptr;
@@ -52,6 +56,8 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
   return nullptr;
 }
 
+const uint32_t LearnedIndexBuilder::kMaxError;
+
 PartitionedIndexBuilder* PartitionedIndexBuilder::CreateIndexBuilder(
     const InternalKeyComparator* comparator,
     const BlockBasedTableOptions& table_opt) {
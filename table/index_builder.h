@@ -21,6 +21,7 @@
 #include "rocksdb/comparator.h"
 #include "table/block_based_table_factory.h"
 #include "table/block_builder.h"
+#include "table/block_learned_index.h"
 #include "table/format.h"
 
 namespace rocksdb {
@@ -270,6 +271,60 @@ class HashIndexBuilder : public IndexBuilder {
   uint64_t current_restart_index_ = 0;
 };
 
+// LearnedIndexBuilder builds a binary search index block and, as a meta
+// block, a BlockLearnedIndex model of its keys. The model is left out when
+// the keys do not fit it well, or when they are not ordered bytewise.
+class LearnedIndexBuilder : public IndexBuilder {
+ public:
+  explicit LearnedIndexBuilder(const InternalKeyComparator* comparator,
+                               int index_block_restart_interval)
+      : IndexBuilder(comparator),
+        primary_index_builder_(comparator, index_block_restart_interval),
+        model_builder_(static_cast<uint32_t>(index_block_restart_interval),
+                       kMaxError),
+        use_model_(comparator->user_comparator() == BytewiseComparator()) {}
+
+  virtual void AddIndexEntry(std::string* last_key_in_current_block,
+                             const Slice* first_key_in_next_block,
+                             const BlockHandle& block_handle) override {
+    if (first_key_in_next_block == nullptr) {
+      last_user_key_ = ExtractUserKey(*last_key_in_current_block).ToString();
+    }
+    primary_index_builder_.AddIndexEntry(last_key_in_current_block,
+                                         first_key_in_next_block, block_handle);
+    if (use_model_) {
+      model_builder_.Add(ExtractUserKey(*last_key_in_current_block));
+    }
+  }
+
+  virtual Status Finish(
+      IndexBlocks* index_blocks,
+      const BlockHandle& last_partition_block_handle) override {
+    primary_index_builder_.Finish(index_blocks, last_partition_block_handle);
+    if (use_model_ && model_builder_.Finish(last_user_key_, &model_block_)) {
+      index_blocks->meta_blocks.insert(
+          {kLearnedIndexBlock.c_str(), model_block_});
+    }
+    return Status::OK();
+  }
+
+  virtual size_t EstimatedSize() const override {
+    return primary_index_builder_.EstimatedSize();
+  }
+
+  // Largest distance, in entries, between the predicted and actual position
+  // of a key
+  static const uint32_t kMaxError = 4;
+
+ private:
+  ShortenedIndexBuilder primary_index_builder_;
+  BlockLearnedIndex::Builder model_builder_;
+  // The model relies on user keys ordered bytewise
+  const bool use_model_;
+  std::string last_user_key_;
+  std::string model_block_;
+};
+
 /**
  * IndexBuilder for two-level indexing. Internally it creates a new index for
  * each partition and Finish then in order when Finish is called on it
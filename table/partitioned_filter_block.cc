@@ -92,16 +92,14 @@ PartitionedFilterBlockReader::~PartitionedFilterBlockReader() {
   {
     ReadLock rl(&mu_);
     for (auto it = handle_list_.begin(); it != handle_list_.end(); ++it) {
-      table_->rep_->table_options.block_cache.get()->Release(*it);
+      table_->rep_->partition_cache()->Release(*it);
     }
   }
   char cache_key[BlockBasedTable::kMaxCacheKeyPrefixSize + kMaxVarint64Length];
   for (auto it = filter_block_set_.begin(); it != filter_block_set_.end();
        ++it) {
-    auto key = BlockBasedTable::GetCacheKey(table_->rep_->cache_key_prefix,
-                                            table_->rep_->cache_key_prefix_size,
-                                            *it, cache_key);
-    table_->rep_->table_options.block_cache.get()->Erase(key);
+    auto key = table_->rep_->GetPartitionCacheKey(*it, cache_key);
+    table_->rep_->partition_cache()->Erase(key);
   }
 }
 
@@ -130,7 +128,7 @@ bool PartitionedFilterBlockReader::KeyMayMatch(
     return res;
   }
   if (LIKELY(filter_partition.IsSet())) {
-    filter_partition.Release(table_->rep_->table_options.block_cache.get());
+    filter_partition.Release(table_->rep_->partition_cache());
   } else {
     delete filter_partition.value;
   }
@@ -162,7 +160,7 @@ bool PartitionedFilterBlockReader::PrefixMayMatch(
     return res;
   }
   if (LIKELY(filter_partition.IsSet())) {
-    filter_partition.Release(table_->rep_->table_options.block_cache.get());
+    filter_partition.Release(table_->rep_->partition_cache());
   } else {
     delete filter_partition.value;
   }
@@ -190,11 +188,12 @@ PartitionedFilterBlockReader::GetFilterPartition(Slice* handle_value,
   auto s = fltr_blk_handle.DecodeFrom(handle_value);
   assert(s.ok());
   const bool is_a_filter_partition = true;
-  auto block_cache = table_->rep_->table_options.block_cache.get();
+  auto block_cache = table_->rep_->partition_cache();
   if (LIKELY(block_cache != nullptr)) {
     bool pin_cached_filters =
-        GetLevel() == 0 &&
-        table_->rep_->table_options.pin_l0_filter_and_index_blocks_in_cache;
+        (GetLevel() == 0 &&
+         table_->rep_->table_options.pin_l0_filter_and_index_blocks_in_cache) ||
+        table_->rep_->partitions_in_metadata_cache();
     if (pin_cached_filters) {
       ReadLock rl(&mu_);
       auto iter = filter_cache_.find(fltr_blk_handle.offset());
@@ -0,0 +1,126 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+
+#include "table/range_filter_block.h"
+
+#include <algorithm>
+
+#include "rocksdb/filter_policy.h"
+
+namespace rocksdb {
+
+const size_t RangeFilterBlockBuilder::kMaxPrefixLength;
+const int RangeFilterBlockReader::kMaxRangeProbes;
+
+RangeFilterBlockBuilder::RangeFilterBlockBuilder(int bits_per_key,
+                                                 size_t max_prefix_len)
+    : policy_(NewBloomFilterPolicy(bits_per_key,
+                                   false /* use_block_based_builder */)),
+      filter_bits_builder_(policy_->GetFilterBitsBuilder()),
+      max_prefix_len_(std::min(std::max(max_prefix_len, size_t{1}),
+                               kMaxPrefixLength)),
+      num_added_(0) {
+  assert(filter_bits_builder_ != nullptr);
+}
+
+RangeFilterBlockBuilder::~RangeFilterBlockBuilder() {}
+
+void RangeFilterBlockBuilder::Add(const Slice& user_key) {
+  const size_t len = std::min(user_key.size(), max_prefix_len_);
+  // Keys come in order, so the prefixes shared with the previous key are
+  // already in the filter; only the longer ones are new
+  size_t shared = 0;
+  const size_t limit = std::min(len, last_prefix_.size());
+  while (shared < limit && user_key[shared] == last_prefix_[shared]) {
+    shared++;
+  }
+  for (size_t i = shared + 1; i <= len; i++) {
+    filter_bits_builder_->AddKey(Slice(user_key.data(), i));
+    num_added_++;
+  }
+  last_prefix_.assign(user_key.data(), len);
+}
+
+Slice RangeFilterBlockBuilder::Finish() {
+  Slice filter = filter_bits_builder_->Finish(&filter_data_);
+  result_.assign(filter.data(), filter.size());
+  result_.push_back(static_cast<char>(max_prefix_len_));
+  return Slice(result_);
+}
+
+RangeFilterBlockReader::RangeFilterBlockReader(BlockContents&& contents)
+    : contents_(std::move(contents)), max_prefix_len_(0) {
+  if (contents_.data.size() > 1) {
+    const size_t filter_size = contents_.data.size() - 1;
+    max_prefix_len_ = static_cast<unsigned char>(contents_.data[filter_size]);
+    std::unique_ptr<const FilterPolicy> policy(NewBloomFilterPolicy(
+        10 /* bits_per_key, unused */, false /* use_block_based_builder */));
+    filter_bits_reader_.reset(policy->GetFilterBitsReader(
+        Slice(contents_.data.data(), filter_size)));
+  }
+}
+
+RangeFilterBlockReader::~RangeFilterBlockReader() {}
+
+// Every key in [lo, hi) starts with the common prefix c of lo and hi, and
+// its next byte lies between the bytes of lo and hi that follow c. The filter
+// is probed for c and, if the range spans only a few of those bytes, for
+// each of the prefixes c + b.
+bool RangeFilterBlockReader::RangeMayMatch(const Slice& lo,
+                                           const Slice& hi) const {
+  if (filter_bits_reader_ == nullptr || max_prefix_len_ == 0) {
+    return true;
+  }
+  if (lo.compare(hi) >= 0) {
+    // Empty range
+    return false;
+  }
+  size_t common = 0;
+  const size_t limit = std::min(lo.size(), hi.size());
+  while (common < limit && lo[common] == hi[common]) {
+    common++;
+  }
+  if (common >= max_prefix_len_) {
+    return filter_bits_reader_->MayMatch(Slice(lo.data(), max_prefix_len_));
+  }
+  if (common > 0 &&
+      !filter_bits_reader_->MayMatch(Slice(lo.data(), common))) {
+    return false;
+  }
+  if (common == lo.size()) {
+    // lo itself is the common prefix, which may be a key on its own
+    return true;
+  }
+  // lo < hi and lo is longer than the common prefix, so hi is too
+  const int first = static_cast<unsigned char>(lo[common]);
+  int last = static_cast<unsigned char>(hi[common]);
+  if (hi.size() == common + 1) {
+    // Keys continuing with hi[common] are >= hi
+    last--;
+  }
+  const int num_probes = last - first + 1;
+  if (num_probes > kMaxRangeProbes) {
+    return true;
+  }
+  std::string prefixes[kMaxRangeProbes];
+  Slice probes[kMaxRangeProbes];
+  bool may_match[kMaxRangeProbes];
+  for (int i = 0; i < num_probes; i++) {
+    prefixes[i].assign(lo.data(), common);
+    prefixes[i].push_back(static_cast<char>(first + i));
+    probes[i] = prefixes[i];
+  }
+  filter_bits_reader_->MayMatchBatch(num_probes, probes, may_match);
+  return std::any_of(may_match, may_match + num_probes,
+                     [](bool m) { return m; });
+}
+
+size_t RangeFilterBlockReader::ApproximateMemoryUsage() const {
+  return contents_.data.size() + sizeof(*this);
+}
+
+}  // namespace rocksdb
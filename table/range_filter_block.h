@@ -0,0 +1,90 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include "rocksdb/slice.h"
+#include "table/format.h"
+
+namespace rocksdb {
+
+class FilterPolicy;
+class FilterBitsBuilder;
+class FilterBitsReader;
+
+// A range filter tells whether a table may contain a user key in a range
+// [lo, hi), so that short range scans can skip tables that cannot contribute
+// any key. It is a multi-granularity prefix Bloom filter: every prefix of
+// every user key, up to max_prefix_len bytes, is added to one full Bloom
+// filter. A range is answered by probing the few prefixes that all of its
+// keys must start with.
+//
+// Only valid for tables whose user keys are ordered bytewise.
+//
+// The format of the range filter block is:
+// +----------------------------------------------------------------+
+// |         full filter for all key prefixes in the sst file       |
+// +----------------------------------------------------------------+
+// | max_prefix_len (1 byte)                                        |
+// +----------------------------------------------------------------+
+class RangeFilterBlockBuilder {
+ public:
+  // max_prefix_len is capped at kMaxPrefixLength
+  RangeFilterBlockBuilder(int bits_per_key, size_t max_prefix_len);
+  ~RangeFilterBlockBuilder();
+
+  // REQUIRES: user keys are added in bytewise order
+  void Add(const Slice& user_key);
+  bool empty() const { return num_added_ == 0; }
+  Slice Finish();
+
+  static const size_t kMaxPrefixLength = 255;
+
+ private:
+  std::unique_ptr<const FilterPolicy> policy_;
+  std::unique_ptr<FilterBitsBuilder> filter_bits_builder_;
+  size_t max_prefix_len_;
+  // Prefixes of the last key that are already in the filter
+  std::string last_prefix_;
+  uint32_t num_added_;
+  std::unique_ptr<const char[]> filter_data_;
+  std::string result_;
+
+  // No copying allowed
+  RangeFilterBlockBuilder(const RangeFilterBlockBuilder&);
+  void operator=(const RangeFilterBlockBuilder&);
+};
+
+class RangeFilterBlockReader {
+ public:
+  // contents is the content of a block built by RangeFilterBlockBuilder
+  explicit RangeFilterBlockReader(BlockContents&& contents);
+  ~RangeFilterBlockReader();
+
+  // Returns false if the table cannot contain any user key k with
+  // lo <= k < hi.
+  bool RangeMayMatch(const Slice& lo, const Slice& hi) const;
+  size_t ApproximateMemoryUsage() const;
+
+  // Upper bound of the number of prefixes probed for one range
+  static const int kMaxRangeProbes = 16;
+
+ private:
+  BlockContents contents_;
+  std::unique_ptr<FilterBitsReader> filter_bits_reader_;
+  size_t max_prefix_len_;
+
+  // No copying allowed
+  RangeFilterBlockReader(const RangeFilterBlockReader&);
+  void operator=(const RangeFilterBlockReader&);
+};
+
+}  // namespace rocksdb
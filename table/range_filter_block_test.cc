@@ -0,0 +1,136 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+
+#include "table/range_filter_block.h"
+
+#include <set>
+#include <string>
+
+#include "util/random.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
+
+namespace rocksdb {
+
+class RangeFilterBlockTest : public testing::Test {
+ public:
+  // Builds a filter over keys, which must be sorted
+  void Build(const std::vector<std::string>& keys, int bits_per_key,
+             size_t max_prefix_len) {
+    builder_.reset(new RangeFilterBlockBuilder(bits_per_key, max_prefix_len));
+    for (const auto& key : keys) {
+      builder_->Add(key);
+    }
+    Slice block = builder_->Finish();
+    reader_.reset(new RangeFilterBlockReader(
+        BlockContents(block, false /* cachable */, kNoCompression)));
+  }
+
+  bool RangeMayMatch(const std::string& lo, const std::string& hi) {
+    return reader_->RangeMayMatch(lo, hi);
+  }
+
+ protected:
+  std::unique_ptr<RangeFilterBlockBuilder> builder_;
+  std::unique_ptr<RangeFilterBlockReader> reader_;
+};
+
+TEST_F(RangeFilterBlockTest, EmptyBuilder) {
+  RangeFilterBlockBuilder builder(10, 16);
+  ASSERT_TRUE(builder.empty());
+  builder.Add("foo");
+  ASSERT_FALSE(builder.empty());
+}
+
+TEST_F(RangeFilterBlockTest, SingleChunk) {
+  Build({"apple", "apricot", "banana", "cherry", "user123:a", "user123:b"},
+        20, 16);
+  ASSERT_TRUE(RangeMayMatch("ap", "aq"));
+  ASSERT_TRUE(RangeMayMatch("b", "c"));
+  ASSERT_TRUE(RangeMayMatch("ba", "bb"));
+  ASSERT_TRUE(RangeMayMatch("user123:", "user123;"));
+  ASSERT_TRUE(RangeMayMatch("user123:b", "user123:c"));
+  // Lower bound is a prefix of the upper bound
+  ASSERT_TRUE(RangeMayMatch("apple", "applesauce"));
+
+  ASSERT_FALSE(RangeMayMatch("bb", "bk"));
+  ASSERT_FALSE(RangeMayMatch("d", "e"));
+  ASSERT_FALSE(RangeMayMatch("user124:", "user124;"));
+  ASSERT_FALSE(RangeMayMatch("user123:c", "user123:k"));
+  // Empty ranges
+  ASSERT_FALSE(RangeMayMatch("b", "b"));
+  ASSERT_FALSE(RangeMayMatch("c", "b"));
+
+  // Too many prefixes to probe
+  ASSERT_TRUE(RangeMayMatch("d", "z"));
+}
+
+TEST_F(RangeFilterBlockTest, MaxPrefixLength) {
+  Build({"user123:a", "user123:b", "zzzz1"}, 20, 4);
+  // The bounds share more than 4 bytes, so only "user" is probed
+  ASSERT_TRUE(RangeMayMatch("user123:a", "user123:b"));
+  ASSERT_TRUE(RangeMayMatch("user999:a", "user999:b"));
+  ASSERT_FALSE(RangeMayMatch("uses123:a", "uses123:b"));
+  ASSERT_FALSE(RangeMayMatch("zzz1", "zzz2"));
+}
+
+TEST_F(RangeFilterBlockTest, NoFalseNegatives) {
+  Random rnd(301);
+  std::set<std::string> key_set;
+  for (int i = 0; i < 2000; i++) {
+    // Short keys over a small alphabet, so that ranges often hit keys
+    std::string key;
+    int len = 1 + rnd.Uniform(8);
+    for (int j = 0; j < len; j++) {
+      key.push_back(static_cast<char>('a' + rnd.Uniform(6)));
+    }
+    key_set.insert(key);
+  }
+  std::vector<std::string> keys(key_set.begin(), key_set.end());
+  Build(keys, 10, 6);
+
+  int num_empty = 0;
+  int num_filtered = 0;
+  for (int i = 0; i < 10000; i++) {
+    std::string lo = keys[rnd.Uniform(static_cast<int>(keys.size()))];
+    if (rnd.OneIn(2)) {
+      // Also try ranges that do not start at a key
+      lo.push_back(static_cast<char>('a' + rnd.Uniform(6)));
+    }
+    std::string hi = lo;
+    if (rnd.OneIn(2)) {
+      hi.back() = static_cast<char>(hi.back() + 1 + rnd.Uniform(2));
+    } else {
+      hi.push_back(static_cast<char>('a' + rnd.Uniform(6)));
+    }
+    bool has_key = false;
+    auto it = key_set.lower_bound(lo);
+    if (it != key_set.end() && *it < hi) {
+      has_key = true;
+    }
+    bool may_match = RangeMayMatch(lo, hi);
+    if (has_key) {
+      ASSERT_TRUE(may_match) << lo << " " << hi;
+    } else {
+      num_empty++;
+      if (!may_match) {
+        num_filtered++;
+      }
+    }
+  }
+  // Many of the empty ranges are recognized. Those whose lower bound is a
+  // prefix of the upper bound are not.
+  ASSERT_GT(num_empty, 0);
+  ASSERT_GT(num_filtered, num_empty / 4);
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -11,10 +11,14 @@
 
 #pragma once
 #include <memory>
+#include <string>
+#include <vector>
+#include "rocksdb/slice.h"
 #include "table/internal_iterator.h"
 
 namespace rocksdb {
 
+class BlockHandle;
 class Iterator;
 struct ParsedInternalKey;
 class Slice;
@@ -24,6 +28,17 @@ struct TableProperties;
 class GetContext;
 class InternalIterator;
 
+// A key of a table and the approximate number of bytes of the table's data
+// between the previous anchor and this key
+struct TableKeyAnchor {
+  std::string internal_key;
+  uint64_t range_size;
+
+  TableKeyAnchor(const Slice& _internal_key, uint64_t _range_size)
+      : internal_key(_internal_key.data(), _internal_key.size()),
+        range_size(_range_size) {}
+};
+
 // A Table is a sorted map from strings to strings.  Tables are
 // immutable and persistent.  A Table may be safely accessed from
 // multiple threads without external synchronization.
@@ -96,6 +111,27 @@ class TableReader {
     return Status::OK();
   }
 
+  // Append the handles of the data blocks of the table that are in the
+  // block cache to *handles
+  virtual void GetCachedDataBlocks(std::vector<BlockHandle>* handles) {
+    (void) handles;
+  }
+
+  // Append up to about max_anchors keys of the table, spread evenly over
+  // its data, to *anchors in order. The last one is at or past the largest
+  // key of the table. Appends nothing if the table cannot tell.
+  virtual void GetKeyAnchors(size_t max_anchors,
+                             std::vector<TableKeyAnchor>* anchors) {
+    (void) max_anchors;
+    (void) anchors;
+  }
+
+  // Load the given data blocks into the block cache
+  virtual Status WarmUpDataBlocks(const std::vector<BlockHandle>& handles) {
+    (void) handles;
+    return Status::OK();
+  }
+
   // convert db file to a human readable form
   virtual Status DumpTable(WritableFile* out_file) {
     return Status::NotSupported("DumpTable() not supported");
@@ -1657,6 +1657,92 @@ TEST_F(TableTest, HashIndexTest) {
   IndexTest(table_options);
 }
 
+TEST_F(TableTest, LearnedIndexTest) {
+  BlockBasedTableOptions table_options;
+  table_options.index_type = BlockBasedTableOptions::kLearnedIndexSearch;
+  IndexTest(table_options);
+}
+
+TEST_F(BlockBasedTableTest, LearnedIndexSeek) {
+  Options options;
+  BlockBasedTableOptions table_options;
+  table_options.index_type = BlockBasedTableOptions::kLearnedIndexSearch;
+  table_options.block_size = 64;  // small block size to get big index block
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+
+  TableConstructor c(BytewiseComparator());
+  Random rnd(301);
+  for (int i = 0; i < 10000; i++) {
+    char buf[16];
+    // Evenly spread keys, which fit a model
+    snprintf(buf, sizeof(buf), "%08d", i * 16 + rnd.Uniform(16));
+    InternalKey k(std::string("key") + buf, 0, kTypeValue);
+    c.Add(k.Encode().ToString(), RandomString(&rnd, 20));
+  }
+
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  std::unique_ptr<InternalKeyComparator> comparator(
+      new InternalKeyComparator(BytewiseComparator()));
+  const ImmutableCFOptions ioptions(options);
+  c.Finish(options, ioptions, table_options, *comparator, &keys, &kvmap);
+  auto reader = c.GetTableReader();
+
+  auto props = reader->GetTableProperties();
+  ASSERT_GT(props->num_data_blocks, 1000u);
+
+  // The model is kept in memory next to the index block
+  {
+    Options binary_options;
+    BlockBasedTableOptions binary_table_options = table_options;
+    binary_table_options.index_type = BlockBasedTableOptions::kBinarySearch;
+    binary_options.table_factory.reset(
+        new BlockBasedTableFactory(binary_table_options));
+    TableConstructor binary_c(BytewiseComparator());
+    for (auto& kv : kvmap) {
+      binary_c.Add(kv.first, kv.second);
+    }
+    std::vector<std::string> binary_keys;
+    stl_wrappers::KVMap binary_kvmap;
+    const ImmutableCFOptions binary_ioptions(binary_options);
+    binary_c.Finish(binary_options, binary_ioptions, binary_table_options,
+                    *comparator, &binary_keys, &binary_kvmap);
+    ASSERT_GT(reader->ApproximateMemoryUsage(),
+              binary_c.GetTableReader()->ApproximateMemoryUsage());
+  }
+
+  std::unique_ptr<InternalIterator> db_iter(reader->NewIterator(ReadOptions()));
+
+  // Existing keys
+  for (auto& kv : kvmap) {
+    db_iter->Seek(kv.first);
+    ASSERT_TRUE(db_iter->Valid());
+    ASSERT_OK(db_iter->status());
+    ASSERT_EQ(db_iter->key(), kv.first);
+    ASSERT_EQ(db_iter->value(), kv.second);
+  }
+
+  // Keys between and outside of the existing ones
+  for (int i = -16; i < 10000 * 16 + 16; i += 7) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%08d", i);
+    // kvmap orders the internal keys bytewise, which agrees with the
+    // internal key order for these keys
+    InternalKey ikey(std::string("key") + buf, 0, kTypeValue);
+    std::string target = ikey.Encode().ToString();
+    auto expected = kvmap.lower_bound(target);
+    db_iter->Seek(target);
+    ASSERT_OK(db_iter->status());
+    if (expected == kvmap.end()) {
+      ASSERT_FALSE(db_iter->Valid());
+    } else {
+      ASSERT_TRUE(db_iter->Valid());
+      ASSERT_EQ(db_iter->key(), expected->first);
+    }
+  }
+  c.ResetTableReader();
+}
+
 TEST_F(TableTest, PartitionIndexTest) {
   const int max_index_keys = 5;
   const int est_max_index_key_value_size = 32;
@@ -2146,6 +2232,13 @@ class MockCache : public LRUCache {
     return ShardedCache::Insert(key, value, charge, &MockDeleter, handle,
                                 priority);
   }
+  // Data blocks are tracked the same way, without a compressed tier
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const TierHelper* helper, size_t charge,
+                                  Handle** handle = nullptr,
+                                  Priority priority = Priority::LOW) override {
+    return Insert(key, value, charge, helper->deleter, handle, priority);
+  }
   // This is called by the application right after inserting a data block
   virtual void TEST_mark_as_data_block(const Slice& key,
                                        size_t charge) override {
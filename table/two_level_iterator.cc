@@ -93,6 +93,7 @@ class TwoLevelIterator : public InternalIterator {
   void SkipEmptyDataBlocksBackward();
   void SetSecondLevelIterator(InternalIterator* iter);
   void InitDataBlock();
+  void NotifyForwardBlock();
 
   TwoLevelIteratorState* state_;
   IteratorWrapper first_level_iter_;
@@ -119,9 +120,14 @@ void TwoLevelIterator::Seek(const Slice& target) {
     SetSecondLevelIterator(nullptr);
     return;
   }
+  if (state_->check_range_may_match && !state_->RangeMayMatch(target)) {
+    SetSecondLevelIterator(nullptr);
+    return;
+  }
   first_level_iter_.Seek(target);
 
   InitDataBlock();
+  NotifyForwardBlock();
   if (second_level_iter_.iter() != nullptr) {
     second_level_iter_.Seek(target);
   }
@@ -153,6 +159,7 @@ void TwoLevelIterator::SeekForPrev(const Slice& target) {
 void TwoLevelIterator::SeekToFirst() {
   first_level_iter_.SeekToFirst();
   InitDataBlock();
+  NotifyForwardBlock();
   if (second_level_iter_.iter() != nullptr) {
     second_level_iter_.SeekToFirst();
   }
@@ -160,10 +167,22 @@ void TwoLevelIterator::SeekToFirst() {
 }
 
 void TwoLevelIterator::SeekToLast() {
-  first_level_iter_.SeekToLast();
+  const Slice upper_bound_key = state_->UpperBoundKey();
+  if (upper_bound_key.empty()) {
+    first_level_iter_.SeekToLast();
+  } else {
+    first_level_iter_.Seek(upper_bound_key);
+    if (!first_level_iter_.Valid()) {
+      first_level_iter_.SeekToLast();
+    }
+  }
   InitDataBlock();
   if (second_level_iter_.iter() != nullptr) {
-    second_level_iter_.SeekToLast();
+    if (!upper_bound_key.empty() && state_->check_range_may_match) {
+      second_level_iter_.SeekForPrev(upper_bound_key);
+    } else {
+      second_level_iter_.SeekToLast();
+    }
   }
   SkipEmptyDataBlocksBackward();
 }
@@ -192,6 +211,7 @@ void TwoLevelIterator::SkipEmptyDataBlocksForward() {
     }
     first_level_iter_.Next();
     InitDataBlock();
+    NotifyForwardBlock();
     if (second_level_iter_.iter() != nullptr) {
       second_level_iter_.SeekToFirst();
     }
@@ -215,6 +235,12 @@ void TwoLevelIterator::SkipEmptyDataBlocksBackward() {
   }
 }
 
+void TwoLevelIterator::NotifyForwardBlock() {
+  if (state_->notify_forward_blocks && first_level_iter_.Valid()) {
+    state_->OnForwardBlock(first_level_iter_.key(), first_level_iter_.value());
+  }
+}
+
 void TwoLevelIterator::SetSecondLevelIterator(InternalIterator* iter) {
   if (second_level_iter_.iter() != nullptr) {
     SaveError(second_level_iter_.status());
@@ -27,10 +27,31 @@ struct TwoLevelIteratorState {
   virtual ~TwoLevelIteratorState() {}
   virtual InternalIterator* NewSecondaryIterator(const Slice& handle) = 0;
   virtual bool PrefixMayMatch(const Slice& internal_key) = 0;
+  // Returns false if no key in [internal_key, iterate_upper_bound) can be
+  // found under the first level. Seek() then leaves the iterator invalid,
+  // which is fine for callers that stop at the upper bound anyway.
+  virtual bool RangeMayMatch(const Slice& /*internal_key*/) { return true; }
   virtual bool KeyReachedUpperBound(const Slice& internal_key) = 0;
+  // Returns the internal key that sorts before all entries at or past
+  // iterate_upper_bound, or an empty slice. If not empty, SeekToLast()
+  // starts at the first level entry that covers it, since nothing past the
+  // upper bound is visible. With check_range_may_match, it also positions
+  // the second level before it. A Seek() that RangeMayMatch() cut short
+  // leaves the iterator invalid even if it has entries past the target, and
+  // callers like MergingIterator::Prev() then expect SeekToLast() to land
+  // before the target.
+  virtual Slice UpperBoundKey() { return Slice(); }
+  // Called when the iterator, moving forward, lands on the second level
+  // iterator created from the first level entry (key, handle). Only called if
+  // notify_forward_blocks is set.
+  virtual void OnForwardBlock(const Slice& /*key*/, const Slice& /*handle*/) {}
 
   // If call PrefixMayMatch()
   bool check_prefix_may_match;
+  // If call RangeMayMatch()
+  bool check_range_may_match = false;
+  // If call OnForwardBlock()
+  bool notify_forward_blocks = false;
 };
 
 
@@ -231,6 +231,10 @@ DEFINE_bool(reverse_iterator, false,
             "When true use Prev rather than Next for iterators that do "
             "Seek and then Next");
 
+DEFINE_int64(max_scan_distance, 0, "If non-zero, seekrandom sets "
+             "ReadOptions::iterate_upper_bound to the key that is this many "
+             "keys after the seek key. Ignored with --reverse_iterator.");
+
 DEFINE_bool(use_uint64_comparator, false, "use Uint64 user comparator");
 
 DEFINE_bool(pin_slice, true, "use pinnable slice for point lookup");
@@ -373,16 +377,47 @@ DEFINE_double(cache_high_pri_pool_ratio, 0.0,
 DEFINE_bool(use_clock_cache, false,
             "Replace default LRU block cache with clock cache.");
 
+DEFINE_bool(cache_tiny_lfu_admission, false,
+            "Only admit blocks into the LRU block cache that are looked up "
+            "at least as often as the blocks they would evict, as estimated "
+            "by a TinyLFU sketch.");
+
+DEFINE_bool(cache_numa_aware, false,
+            "Split the LRU block cache into one set of shards per NUMA node, "
+            "with --cache_numshardbits shard bits each. Blocks are cached on "
+            "the node of the thread that reads them.");
+
+DEFINE_double(cache_compressed_tier_ratio, 0.0,
+              "Fraction of the LRU block cache that keeps evicted data blocks "
+              "compressed with LZ4, until they are read again.");
+
 DEFINE_int64(simcache_size, -1,
              "Number of bytes to use as a simcache of "
              "uncompressed data. Nagative value disables simcache.");
 
+DEFINE_int64(mrc_cache_max_size, -1,
+             "Largest block cache capacity, in bytes, to estimate the miss "
+             "ratio of. A positive value wraps the block cache in a "
+             "MissRatioCurveCache and prints the miss ratio curve at the "
+             "end.");
+
+DEFINE_double(mrc_sampling_rate, 0.01,
+              "Fraction of the keys the MissRatioCurveCache tracks.");
+
 DEFINE_bool(cache_index_and_filter_blocks, false,
             "Cache index/filter blocks in block cache.");
 
 DEFINE_bool(pin_l0_filter_and_index_blocks_in_cache, false,
             "Pin index/filter blocks of L0 files in block cache.");
 
+DEFINE_int64(metadata_cache_size, -1,
+             "Number of bytes to use as a cache of index/filter blocks, "
+             "separate from the block cache. Negative value disables it.");
+
+DEFINE_int32(metadata_cache_partitions_max_level, -1,
+             "Also keep the index/filter partitions of files at this level or "
+             "lower in the metadata cache.");
+
 DEFINE_int32(block_size,
              static_cast<int32_t>(rocksdb::BlockBasedTableOptions().block_size),
              "Number of bytes in a block.");
@@ -397,6 +432,25 @@ DEFINE_int32(index_block_restart_interval,
              "Number of keys between restart points "
              "for delta encoding of keys in index block.");
 
+DEFINE_bool(data_block_column_layout, false,
+            "Store keys and values of data blocks in separate columns "
+            "(BlockBasedTableOptions::kColumnLayout).");
+
+DEFINE_int32(prefix_filter_bits,
+             rocksdb::BlockBasedTableOptions().prefix_filter_bits_per_key,
+             "Bits per key prefix of a prefix filter kept apart from the "
+             "--bloom_bits filter of the whole keys, 0 to add the prefixes "
+             "to that filter. Needs --prefix_size.");
+
+DEFINE_int32(range_filter_bits,
+             rocksdb::BlockBasedTableOptions().range_filter_bits_per_key,
+             "Bits per key prefix of the range filter of each table, 0 for "
+             "none. Used by seeks with --max_scan_distance.");
+
+DEFINE_int32(range_filter_max_prefix_len,
+             rocksdb::BlockBasedTableOptions().range_filter_max_prefix_len,
+             "Longest key prefix added to the range filter");
+
 DEFINE_int32(read_amp_bytes_per_bit,
              rocksdb::BlockBasedTableOptions().read_amp_bytes_per_bit,
              "Number of bytes per bit to be used in block read-amp bitmap");
@@ -554,6 +608,11 @@ DEFINE_int32(deletepercent, 2, "Percentage of deletes out of reads/writes/"
              "deletepercent), so deletepercent must be smaller than (100 - "
              "FLAGS_readwritepercent)");
 
+DEFINE_int32(l0_filter_summary_bits,
+             rocksdb::Options().level0_filter_summary_bits_per_key,
+             "Bits per key of the in-memory filter summary of each level-0 "
+             "file, 0 for none");
+
 DEFINE_bool(optimize_filters_for_hits, false,
             "Optimizes bloom filters for workloads for most lookups return "
             "a value. For now this doesn't create bloom filters for the max "
@@ -928,6 +987,14 @@ DEFINE_double(cuckoo_hash_ratio, 0.9, "Hash ratio for Cuckoo SST table.");
 DEFINE_bool(use_hash_search, false, "if use kHashSearch "
             "instead of kBinarySearch. "
             "This is valid if only we use BlockTable");
+DEFINE_bool(use_learned_index, false, "if use kLearnedIndexSearch "
+            "instead of kBinarySearch. "
+            "This is valid if only we use BlockTable");
+DEFINE_bool(use_xor_filter, false, "Use an XOR filter with --bloom_bits "
+            "bits per key instead of a Bloom filter");
+DEFINE_bool(use_level_aware_filter, false, "Use full Bloom filters with "
+            "--bloom_bits bits per key on average, spread over the levels "
+            "by their size (--max_bytes_for_level_multiplier)");
 DEFINE_bool(use_block_based_filter, false, "if use kBlockBasedFilter "
             "instead of kFullFilter for filter block. "
             "This is valid if only we use BlockTable");
@@ -1779,10 +1846,25 @@ class Duration {
   uint64_t start_at_;
 };
 
+static const FilterPolicy* NewFilterPolicy() {
+  if (FLAGS_bloom_bits < 0) {
+    return nullptr;
+  }
+  if (FLAGS_use_xor_filter) {
+    return NewXorFilterPolicy(FLAGS_bloom_bits);
+  }
+  if (FLAGS_use_level_aware_filter) {
+    return NewLevelAwareBloomFilterPolicy(
+        FLAGS_bloom_bits, FLAGS_max_bytes_for_level_multiplier);
+  }
+  return NewBloomFilterPolicy(FLAGS_bloom_bits, FLAGS_use_block_based_filter);
+}
+
 class Benchmark {
  private:
   std::shared_ptr<Cache> cache_;
   std::shared_ptr<Cache> compressed_cache_;
+  std::shared_ptr<Cache> metadata_cache_;
   std::shared_ptr<const FilterPolicy> filter_policy_;
   const SliceTransform* prefix_extractor_;
   DBWithColumnFamilies db_;
@@ -2036,9 +2118,15 @@ class Benchmark {
       }
       return cache;
     } else {
-      return NewLRUCache((size_t)capacity, FLAGS_cache_numshardbits,
-                         false /*strict_capacity_limit*/,
-                         FLAGS_cache_high_pri_pool_ratio);
+      LRUCacheOptions cache_opts;
+      cache_opts.capacity = (size_t)capacity;
+      cache_opts.num_shard_bits = FLAGS_cache_numshardbits;
+      cache_opts.high_pri_pool_ratio = FLAGS_cache_high_pri_pool_ratio;
+      cache_opts.tiny_lfu_admission = FLAGS_cache_tiny_lfu_admission;
+      cache_opts.numa_aware = FLAGS_cache_numa_aware;
+      cache_opts.compressed_tier_ratio = FLAGS_cache_compressed_tier_ratio;
+      cache_opts.statistics = dbstats;
+      return NewLRUCache(cache_opts);
     }
   }
 
@@ -2046,10 +2134,8 @@ class Benchmark {
   Benchmark()
       : cache_(NewCache(FLAGS_cache_size)),
         compressed_cache_(NewCache(FLAGS_compressed_cache_size)),
-        filter_policy_(FLAGS_bloom_bits >= 0
-                           ? NewBloomFilterPolicy(FLAGS_bloom_bits,
-                                                  FLAGS_use_block_based_filter)
-                           : nullptr),
+        metadata_cache_(NewCache(FLAGS_metadata_cache_size)),
+        filter_policy_(NewFilterPolicy()),
         prefix_extractor_(NewFixedPrefixTransform(FLAGS_prefix_size)),
         num_(FLAGS_num),
         value_size_(FLAGS_value_size),
@@ -2080,6 +2166,21 @@ class Benchmark {
         cache_ = NewSimCache(cache_, FLAGS_simcache_size, 0);
       }
     }
+    if (FLAGS_mrc_cache_max_size > 0) {
+      if (cache_ == nullptr || FLAGS_simcache_size >= 0) {
+        fprintf(stderr,
+                "--mrc_cache_max_size requires a block cache and cannot be "
+                "used with --simcache_size\n");
+        exit(1);
+      }
+      cache_ = NewMissRatioCurveCache(cache_, FLAGS_mrc_cache_max_size,
+                                      FLAGS_mrc_sampling_rate);
+      if (cache_ == nullptr) {
+        fprintf(stderr, "Invalid --mrc_sampling_rate %f\n",
+                FLAGS_mrc_sampling_rate);
+        exit(1);
+      }
+    }
 
     if (report_file_operations_) {
       if (!FLAGS_hdfs.empty()) {
@@ -2519,6 +2620,12 @@ void VerifyDBFromDB(std::string& truth_db_name) {
       fprintf(stdout, "SIMULATOR CACHE STATISTICS:\n%s\n",
               std::dynamic_pointer_cast<SimCache>(cache_)->ToString().c_str());
     }
+    if (FLAGS_mrc_cache_max_size > 0) {
+      fprintf(stdout, "MISS RATIO CURVE:\n%s\n",
+              std::dynamic_pointer_cast<MissRatioCurveCache>(cache_)
+                  ->ToString()
+                  .c_str());
+    }
   }
 
  private:
@@ -2959,6 +3066,9 @@ void VerifyDBFromDB(std::string& truth_db_name) {
           exit(1);
         }
         block_based_options.index_type = BlockBasedTableOptions::kHashSearch;
+      } else if (FLAGS_use_learned_index) {
+        block_based_options.index_type =
+            BlockBasedTableOptions::kLearnedIndexSearch;
       } else {
         block_based_options.index_type = BlockBasedTableOptions::kBinarySearch;
       }
@@ -2975,13 +3085,24 @@ void VerifyDBFromDB(std::string& truth_db_name) {
       }
       block_based_options.block_cache = cache_;
       block_based_options.block_cache_compressed = compressed_cache_;
+      block_based_options.metadata_cache = metadata_cache_;
+      block_based_options.metadata_cache_partitions_max_level =
+          FLAGS_metadata_cache_partitions_max_level;
       block_based_options.block_size = FLAGS_block_size;
       block_based_options.block_restart_interval = FLAGS_block_restart_interval;
       block_based_options.index_block_restart_interval =
           FLAGS_index_block_restart_interval;
+      if (FLAGS_data_block_column_layout) {
+        block_based_options.data_block_layout =
+            BlockBasedTableOptions::kColumnLayout;
+      }
       block_based_options.filter_policy = filter_policy_;
       block_based_options.format_version = 2;
       block_based_options.read_amp_bytes_per_bit = FLAGS_read_amp_bytes_per_bit;
+      block_based_options.prefix_filter_bits_per_key = FLAGS_prefix_filter_bits;
+      block_based_options.range_filter_bits_per_key = FLAGS_range_filter_bits;
+      block_based_options.range_filter_max_prefix_len =
+          FLAGS_range_filter_max_prefix_len;
       if (FLAGS_read_cache_path != "") {
 #ifndef ROCKSDB_LITE
         Status rc_status;
@@ -3076,6 +3197,7 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     options.max_compaction_bytes = FLAGS_max_compaction_bytes;
     options.disable_auto_compactions = FLAGS_disable_auto_compactions;
     options.optimize_filters_for_hits = FLAGS_optimize_filters_for_hits;
+    options.level0_filter_summary_bits_per_key = FLAGS_l0_filter_summary_bits;
 
     // fill storage options
     options.advise_random_on_open = FLAGS_advise_random_on_open;
@@ -4075,6 +4197,12 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     ReadOptions options(FLAGS_verify_checksum, true);
     options.tailing = FLAGS_use_tailing_iterator;
 
+    std::unique_ptr<const char[]> upper_bound_guard;
+    Slice upper_bound = AllocateKey(&upper_bound_guard);
+    if (FLAGS_max_scan_distance != 0 && !FLAGS_reverse_iterator) {
+      options.iterate_upper_bound = &upper_bound;
+    }
+
     Iterator* single_iter = nullptr;
     std::vector<Iterator*> multi_iters;
     if (db_.db != nullptr) {
@@ -4111,7 +4239,14 @@ void VerifyDBFromDB(std::string& truth_db_name) {
         iter_to_use = multi_iters[thread->rand.Next() % multi_iters.size()];
       }
 
-      GenerateKeyFromInt(thread->rand.Next() % FLAGS_num, FLAGS_num, &key);
+      int64_t seek_pos = thread->rand.Next() % FLAGS_num;
+      GenerateKeyFromInt(seek_pos, FLAGS_num, &key);
+      if (options.iterate_upper_bound != nullptr) {
+        // The iterators read the bound through the pointer on every use
+        GenerateKeyFromInt(
+            std::min(FLAGS_num, seek_pos + FLAGS_max_scan_distance),
+            FLAGS_num, &upper_bound);
+      }
       iter_to_use->Seek(key);
       read++;
       if (iter_to_use->Valid() && iter_to_use->key().compare(key) == 0) {
@@ -11,11 +11,16 @@
 
 #include "rocksdb/filter_policy.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "rocksdb/slice.h"
 #include "table/block_based_filter_block.h"
 #include "table/full_filter_block.h"
 #include "util/hash.h"
 #include "util/coding.h"
+#include "util/xxhash.h"
 
 namespace rocksdb {
 
@@ -23,6 +28,11 @@ class BlockBasedFilterBlockBuilder;
 class FullFilterBlockBuilder;
 
 namespace {
+
+// Number of keys whose hashes are computed and whose memory is prefetched
+// together by MayMatchBatch(), before any of them is probed
+const int kMayMatchBatchSize = 64;
+
 class FullFilterBitsBuilder : public FilterBitsBuilder {
  public:
   explicit FullFilterBitsBuilder(const size_t bits_per_key,
@@ -180,6 +190,32 @@ class FullFilterBitsReader : public FilterBitsReader {
                         num_probes_, num_lines_);
   }
 
+  virtual void MayMatchBatch(int num_entries, const Slice* entries,
+                             bool* may_match) override {
+    if (data_len_ <= 5 || num_probes_ == 0 || num_lines_ == 0) {
+      // Same answers as MayMatch()
+      std::fill(may_match, may_match + num_entries, data_len_ > 5);
+      return;
+    }
+    const uint32_t cache_line_size = (data_len_ - 5) / num_lines_;
+    uint32_t hashes[kMayMatchBatchSize];
+    const char* lines[kMayMatchBatchSize];
+    for (int start = 0; start < num_entries; start += kMayMatchBatchSize) {
+      const int n = std::min(kMayMatchBatchSize, num_entries - start);
+      // All probes of a key hit the same cache line, so one prefetch per key
+      // has all of them in flight together
+      for (int i = 0; i < n; i++) {
+        hashes[i] = BloomHash(entries[start + i]);
+        lines[i] = data_ + (hashes[i] % num_lines_) * cache_line_size;
+        PREFETCH(lines[i], 0 /* rw */, 1 /* locality */);
+      }
+      for (int i = 0; i < n; i++) {
+        may_match[start + i] =
+            LineMayMatch(hashes[i], lines[i], cache_line_size, num_probes_);
+      }
+    }
+  }
+
  private:
   // Filter meta data
   char* data_;
@@ -207,6 +243,10 @@ class FullFilterBitsReader : public FilterBitsReader {
   bool HashMayMatch(const uint32_t& hash, const Slice& filter,
       const size_t& num_probes, const uint32_t& num_lines);
 
+  // Probe the bits of hash in the cache line of the filter starting at line
+  static bool LineMayMatch(uint32_t hash, const char* line,
+                           uint32_t cache_line_size, size_t num_probes);
+
   // No Copy allowed
   FullFilterBitsReader(const FullFilterBitsReader&);
   void operator=(const FullFilterBitsReader&);
@@ -238,15 +278,22 @@ bool FullFilterBitsReader::HashMayMatch(const uint32_t& hash,
   uint32_t cache_line_size = (len - 5) / num_lines;
   const char* data = filter.data();
 
+  return LineMayMatch(hash, data + (hash % num_lines) * cache_line_size,
+                      cache_line_size, num_probes);
+}
+
+inline bool FullFilterBitsReader::LineMayMatch(uint32_t hash,
+                                               const char* line,
+                                               uint32_t cache_line_size,
+                                               size_t num_probes) {
   uint32_t h = hash;
   const uint32_t delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
-  uint32_t b = (h % num_lines) * (cache_line_size * 8);
 
   for (uint32_t i = 0; i < num_probes; ++i) {
     // Since CACHE_LINE_SIZE is defined as 2^n, this line will be optimized
     //  to a simple and operation by compiler.
-    const uint32_t bitpos = b + (h % (cache_line_size * 8));
-    if (((data[bitpos / 8]) & (1 << (bitpos % 8))) == 0) {
+    const uint32_t bitpos = h % (cache_line_size * 8);
+    if (((line[bitpos / 8]) & (1 << (bitpos % 8))) == 0) {
       return false;
     }
 
@@ -256,6 +303,317 @@ bool FullFilterBitsReader::HashMayMatch(const uint32_t& hash,
   return true;
 }
 
+// Static XOR filter (Graf & Lemire, "Xor Filters: Faster and Smaller Than
+// Bloom and Cuckoo Filters"). Every key owns one slot in each of three
+// segments of a fingerprint array, chosen such that the three fingerprints
+// xor to the fingerprint of the key. It takes ~1.23 * fp_bits bits per key
+// for a false positive rate of 2^-fp_bits, about 30% less space than a Bloom
+// filter with the same false positive rate.
+//
+// The filter ends with the same 5 metadata bytes as the full Bloom filter,
+// set to num_probes = kNewImplMarker and num_lines = 0. Readers that predate
+// the XOR filter treat num_lines == 0 as "may match", so they fall back to
+// reading the data blocks instead of returning wrong answers. This also
+// holds for the block based filter reader, which reads no probes from the
+// trailing zero byte.
+// +----------------------------------------------------------------------+
+// | fingerprints: 3 * segment_length fields of fp_bits bits, 8 pad bytes |
+// +----------------------------------------------------------------------+
+// | seed : 4 bytes | segment_length : 4 bytes | fp_bits : 1 byte         |
+// +----------------------------------------------------------------------+
+// | kXorFilterMarker : 1 byte | kNewImplMarker : 1 byte | 0 : 4 bytes    |
+// +----------------------------------------------------------------------+
+const char kNewImplMarker = static_cast<char>(0xFF);
+const char kXorFilterMarker = 1;
+const size_t kXorFilterMetadataLen = 15;
+const size_t kXorFilterPadding = 8;
+
+inline uint64_t XorFilterHash(const Slice& key) {
+  return XXH64(key.data(), key.size(), 0);
+}
+
+// Derive the hash that the filter built with `seed` uses from the key hash
+inline uint64_t XorFilterRemix(uint64_t h, uint32_t seed) {
+  h += seed * 0x9E3779B97F4A7C15ULL;
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Map 32 bits of `h` to [0, n) without a division
+inline uint32_t XorFilterReduce(uint64_t h, uint32_t n) {
+  return static_cast<uint32_t>(((h & 0xFFFFFFFFULL) * n) >> 32);
+}
+
+inline void XorFilterSlots(uint64_t h, uint32_t segment_length,
+                           uint32_t* slots) {
+  slots[0] = XorFilterReduce(h, segment_length);
+  slots[1] = segment_length +
+             XorFilterReduce((h << 21) | (h >> 43), segment_length);
+  slots[2] = 2 * segment_length +
+             XorFilterReduce((h << 42) | (h >> 22), segment_length);
+}
+
+inline uint32_t XorFilterFingerprint(uint64_t h, uint32_t fp_mask) {
+  return static_cast<uint32_t>(h ^ (h >> 32)) & fp_mask;
+}
+
+// fp_bits <= 32 and a field starts at most 7 bits into its first byte, so
+// any field fits in the 8 bytes loaded here.
+inline uint32_t XorFilterGetField(const char* data, uint64_t bitpos,
+                                  uint32_t fp_mask) {
+  return static_cast<uint32_t>(DecodeFixed64(data + bitpos / 8) >>
+                               (bitpos % 8)) &
+         fp_mask;
+}
+
+inline void XorFilterSetField(char* data, uint64_t bitpos, uint32_t fp_mask,
+                              uint32_t value) {
+  uint64_t word = DecodeFixed64(data + bitpos / 8);
+  word &= ~(static_cast<uint64_t>(fp_mask) << (bitpos % 8));
+  word |= static_cast<uint64_t>(value & fp_mask) << (bitpos % 8);
+  EncodeFixed64(data + bitpos / 8, word);
+}
+
+bool IsXorFilter(const Slice& filter) {
+  const size_t len = filter.size();
+  return len >= kXorFilterMetadataLen &&
+         filter.data()[len - 5] == kNewImplMarker &&
+         filter.data()[len - 6] == kXorFilterMarker &&
+         DecodeFixed32(filter.data() + len - 4) == 0;
+}
+
+class XorFilterBitsBuilder : public FilterBitsBuilder {
+ public:
+  explicit XorFilterBitsBuilder(const uint32_t fp_bits) : fp_bits_(fp_bits) {
+    assert(fp_bits_ >= 1 && fp_bits_ <= 32);
+  }
+
+  ~XorFilterBitsBuilder() {}
+
+  virtual void AddKey(const Slice& key) override {
+    hash_entries_.push_back(XorFilterHash(key));
+  }
+
+  virtual Slice Finish(std::unique_ptr<const char[]>* buf) override;
+
+ private:
+  // Find a slot assignment for hash_entries_ with the hashes derived from
+  // `seed`. On success, `order` holds (hash, slot) pairs in the reverse order
+  // their fingerprints have to be assigned in.
+  bool Peel(uint32_t seed, uint32_t segment_length,
+            std::vector<std::pair<uint64_t, uint32_t>>* order);
+
+  uint32_t fp_bits_;
+  std::vector<uint64_t> hash_entries_;
+
+  // No Copy allowed
+  XorFilterBitsBuilder(const XorFilterBitsBuilder&);
+  void operator=(const XorFilterBitsBuilder&);
+};
+
+bool XorFilterBitsBuilder::Peel(
+    uint32_t seed, uint32_t segment_length,
+    std::vector<std::pair<uint64_t, uint32_t>>* order) {
+  const uint32_t num_slots = 3 * segment_length;
+  std::vector<uint64_t> xor_hashes(num_slots, 0);
+  std::vector<uint32_t> counts(num_slots, 0);
+  uint32_t slots[3];
+  for (uint64_t key_hash : hash_entries_) {
+    uint64_t h = XorFilterRemix(key_hash, seed);
+    XorFilterSlots(h, segment_length, slots);
+    for (uint32_t slot : slots) {
+      xor_hashes[slot] ^= h;
+      counts[slot]++;
+    }
+  }
+
+  // Repeatedly take out a key that is alone in one of its slots
+  std::vector<uint32_t> singles;
+  for (uint32_t i = 0; i < num_slots; i++) {
+    if (counts[i] == 1) {
+      singles.push_back(i);
+    }
+  }
+  order->clear();
+  while (!singles.empty()) {
+    uint32_t single = singles.back();
+    singles.pop_back();
+    if (counts[single] != 1) {
+      continue;
+    }
+    uint64_t h = xor_hashes[single];
+    order->emplace_back(h, single);
+    XorFilterSlots(h, segment_length, slots);
+    for (uint32_t slot : slots) {
+      xor_hashes[slot] ^= h;
+      if (--counts[slot] == 1) {
+        singles.push_back(slot);
+      }
+    }
+  }
+  return order->size() == hash_entries_.size();
+}
+
+Slice XorFilterBitsBuilder::Finish(std::unique_ptr<const char[]>* buf) {
+  // Identical hashes would share all their slots and never peel
+  std::sort(hash_entries_.begin(), hash_entries_.end());
+  hash_entries_.erase(std::unique(hash_entries_.begin(), hash_entries_.end()),
+                      hash_entries_.end());
+
+  const uint32_t fp_mask =
+      static_cast<uint32_t>((static_cast<uint64_t>(1) << fp_bits_) - 1);
+  uint32_t segment_length = 0;
+  if (!hash_entries_.empty()) {
+    segment_length = static_cast<uint32_t>(
+        (32 + 1.23 * hash_entries_.size() + 2) / 3);
+  }
+
+  uint32_t seed = 0;
+  std::vector<std::pair<uint64_t, uint32_t>> order;
+  while (segment_length > 0 && !Peel(seed, segment_length, &order)) {
+    // Very unlikely to fail more than a few times; grow the table a little
+    // in case we are unlucky with the keys.
+    seed++;
+    if (seed % 16 == 0) {
+      segment_length += segment_length / 16 + 1;
+    }
+  }
+
+  const size_t array_len =
+      (static_cast<uint64_t>(3) * segment_length * fp_bits_ + 7) / 8 +
+      kXorFilterPadding;
+  const size_t len = array_len + kXorFilterMetadataLen;
+  char* data = new char[len];
+  memset(data, 0, len);
+
+  uint32_t slots[3];
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    const uint64_t h = it->first;
+    XorFilterSlots(h, segment_length, slots);
+    uint32_t fp = XorFilterFingerprint(h, fp_mask);
+    for (uint32_t slot : slots) {
+      if (slot != it->second) {
+        fp ^= XorFilterGetField(data, static_cast<uint64_t>(slot) * fp_bits_,
+                                fp_mask);
+      }
+    }
+    XorFilterSetField(data, static_cast<uint64_t>(it->second) * fp_bits_,
+                      fp_mask, fp);
+  }
+
+  char* meta = data + array_len;
+  EncodeFixed32(meta, seed);
+  EncodeFixed32(meta + 4, segment_length);
+  meta[8] = static_cast<char>(fp_bits_);
+  meta[9] = kXorFilterMarker;
+  meta[10] = kNewImplMarker;
+  EncodeFixed32(meta + 11, 0);
+
+  const char* const_data = data;
+  buf->reset(const_data);
+  hash_entries_.clear();
+
+  return Slice(data, len);
+}
+
+class XorFilterBitsReader : public FilterBitsReader {
+ public:
+  explicit XorFilterBitsReader(const Slice& contents)
+      : data_(contents.data()), seed_(0), segment_length_(0), fp_mask_(0) {
+    assert(IsXorFilter(contents));
+    const char* meta = data_ + contents.size() - kXorFilterMetadataLen;
+    const uint32_t fp_bits = static_cast<unsigned char>(meta[8]);
+    const uint32_t segment_length = DecodeFixed32(meta + 4);
+    // Sanitize broken parameter, a broken filter matches everything
+    if (fp_bits >= 1 && fp_bits <= 32 &&
+        (static_cast<uint64_t>(3) * segment_length * fp_bits + 7) / 8 +
+                kXorFilterPadding + kXorFilterMetadataLen ==
+            contents.size()) {
+      fp_bits_ = fp_bits;
+      fp_mask_ = static_cast<uint32_t>((static_cast<uint64_t>(1) << fp_bits) -
+                                       1);
+      seed_ = DecodeFixed32(meta);
+      segment_length_ = segment_length;
+    } else {
+      fp_bits_ = 0;
+    }
+  }
+
+  ~XorFilterBitsReader() {}
+
+  virtual bool MayMatch(const Slice& entry) override {
+    if (fp_bits_ == 0) {
+      return true;
+    }
+    if (segment_length_ == 0) {
+      // Empty filter
+      return false;
+    }
+    const uint64_t h = XorFilterRemix(XorFilterHash(entry), seed_);
+    uint32_t slots[3];
+    XorFilterSlots(h, segment_length_, slots);
+    return HashMayMatch(h, slots);
+  }
+
+  virtual void MayMatchBatch(int num_entries, const Slice* entries,
+                             bool* may_match) override {
+    if (fp_bits_ == 0 || segment_length_ == 0) {
+      // Same answers as MayMatch()
+      std::fill(may_match, may_match + num_entries, fp_bits_ == 0);
+      return;
+    }
+    uint64_t hashes[kMayMatchBatchSize];
+    uint32_t slots[kMayMatchBatchSize][3];
+    for (int start = 0; start < num_entries; start += kMayMatchBatchSize) {
+      const int n = std::min(kMayMatchBatchSize, num_entries - start);
+      for (int i = 0; i < n; i++) {
+        hashes[i] = XorFilterRemix(XorFilterHash(entries[start + i]), seed_);
+        XorFilterSlots(hashes[i], segment_length_, slots[i]);
+        for (uint32_t slot : slots[i]) {
+          PREFETCH(data_ + static_cast<uint64_t>(slot) * fp_bits_ / 8,
+                   0 /* rw */, 1 /* locality */);
+        }
+      }
+      for (int i = 0; i < n; i++) {
+        may_match[start + i] = HashMayMatch(hashes[i], slots[i]);
+      }
+    }
+  }
+
+ private:
+  const char* data_;
+  uint32_t seed_;
+  uint32_t segment_length_;
+  uint32_t fp_bits_;
+  uint32_t fp_mask_;
+
+  bool HashMayMatch(uint64_t h, const uint32_t* slots) const {
+    uint32_t fp = XorFilterFingerprint(h, fp_mask_);
+    for (int i = 0; i < 3; i++) {
+      fp ^= XorFilterGetField(data_, static_cast<uint64_t>(slots[i]) * fp_bits_,
+                              fp_mask_);
+    }
+    return fp == 0;
+  }
+
+  // No Copy allowed
+  XorFilterBitsReader(const XorFilterBitsReader&);
+  void operator=(const XorFilterBitsReader&);
+};
+
+// Pick the reader from the filter metadata, so that every built-in policy
+// can read filters built by any other one
+FilterBitsReader* NewBuiltinFilterBitsReader(const Slice& contents) {
+  if (IsXorFilter(contents)) {
+    return new XorFilterBitsReader(contents);
+  }
+  return new FullFilterBitsReader(contents);
+}
+
 // An implementation of filter policy
 class BloomFilterPolicy : public FilterPolicy {
  public:
@@ -305,6 +663,9 @@ class BloomFilterPolicy : public FilterPolicy {
                            const Slice& bloom_filter) const override {
     const size_t len = bloom_filter.size();
     if (len < 2) return false;
+    if (IsXorFilter(bloom_filter)) {
+      return XorFilterBitsReader(bloom_filter).MayMatch(key);
+    }
 
     const char* array = bloom_filter.data();
     const size_t bits = (len - 1) * 8;
@@ -338,7 +699,7 @@ class BloomFilterPolicy : public FilterPolicy {
 
   virtual FilterBitsReader* GetFilterBitsReader(const Slice& contents)
       const override {
-    return new FullFilterBitsReader(contents);
+    return NewBuiltinFilterBitsReader(contents);
   }
 
   // If choose to use block based builder
@@ -359,6 +720,163 @@ class BloomFilterPolicy : public FilterPolicy {
   }
 };
 
+// Builds XOR filters. It shares its name with BloomFilterPolicy, so tables
+// built with either policy keep using their filters when a DB switches
+// between them; the filter metadata tells the readers apart.
+class XorFilterPolicy : public FilterPolicy {
+ public:
+  explicit XorFilterPolicy(int bits_per_key)
+      : bloom_policy_(bits_per_key, true /* use_block_based_builder */) {
+    // ~1.23 bits of space per fingerprint bit
+    int fp_bits = static_cast<int>(bits_per_key / 1.23 + 0.5);
+    fp_bits_ = static_cast<uint32_t>(std::min(std::max(fp_bits, 1), 32));
+  }
+
+  virtual const char* Name() const override {
+    return "rocksdb.BuiltinBloomFilter";
+  }
+
+  virtual void CreateFilter(const Slice* keys, int n,
+                            std::string* dst) const override {
+    XorFilterBitsBuilder builder(fp_bits_);
+    for (int i = 0; i < n; i++) {
+      builder.AddKey(keys[i]);
+    }
+    std::unique_ptr<const char[]> buf;
+    Slice filter = builder.Finish(&buf);
+    dst->append(filter.data(), filter.size());
+  }
+
+  virtual bool KeyMayMatch(const Slice& key,
+                           const Slice& filter) const override {
+    // Also handles the block based Bloom filters of older tables
+    return bloom_policy_.KeyMayMatch(key, filter);
+  }
+
+  virtual FilterBitsBuilder* GetFilterBitsBuilder() const override {
+    return new XorFilterBitsBuilder(fp_bits_);
+  }
+
+  virtual FilterBitsReader* GetFilterBitsReader(const Slice& contents)
+      const override {
+    return NewBuiltinFilterBitsReader(contents);
+  }
+
+ private:
+  uint32_t fp_bits_;
+  BloomFilterPolicy bloom_policy_;
+};
+
+// Full Bloom filters whose bits per key depend on the level of the table
+// file. Shares its name with BloomFilterPolicy since the filters it builds
+// are ordinary full filters.
+class LevelAwareBloomFilterPolicy : public FilterPolicy {
+ public:
+  // Keeps the filters of the small upper levels within a sane size
+  static const int kMaxBitsPerKey = 40;
+
+  LevelAwareBloomFilterPolicy(double bits_per_key, double level_multiplier)
+      : bits_per_key_(bits_per_key),
+        level_multiplier_(std::max(level_multiplier, 2.0)),
+        bloom_policy_(RoundBits(bits_per_key),
+                      true /* use_block_based_builder */) {}
+
+  virtual const char* Name() const override {
+    return "rocksdb.BuiltinBloomFilter";
+  }
+
+  virtual void CreateFilter(const Slice* keys, int n,
+                            std::string* dst) const override {
+    bloom_policy_.CreateFilter(keys, n, dst);
+  }
+
+  virtual bool KeyMayMatch(const Slice& key,
+                           const Slice& filter) const override {
+    return bloom_policy_.KeyMayMatch(key, filter);
+  }
+
+  virtual FilterBitsBuilder* GetFilterBitsBuilder() const override {
+    return NewBuilder(RoundBits(bits_per_key_));
+  }
+
+  virtual FilterBitsBuilder* GetFilterBitsBuilderForLevel(
+      int level, int num_levels) const override {
+    if (level >= num_levels) {
+      return GetFilterBitsBuilder();
+    }
+    std::vector<double> bits;
+    AllocateBits(num_levels, &bits);
+    if (bits[level] <= 0) {
+      return nullptr;
+    }
+    return NewBuilder(RoundBits(bits[level]));
+  }
+
+  virtual FilterBitsReader* GetFilterBitsReader(const Slice& contents)
+      const override {
+    return NewBuiltinFilterBitsReader(contents);
+  }
+
+  // Fills bits with the bits per key of each level; 0 means no filter.
+  // Level 0 is taken to be as large as level 1, and level i > 0 to be
+  // level_multiplier times larger than level i - 1. Giving level i
+  // ln(size_last / size_i) / ln(2)^2 more bits than the last level makes
+  // false positive rates proportional to level sizes, which minimizes their
+  // sum for a given memory budget.
+  void AllocateBits(int num_levels, std::vector<double>* bits) const {
+    bits->assign(num_levels, 0);
+    std::vector<double> sizes(num_levels, 1);
+    double total_size = 0;
+    for (int i = 0; i < num_levels; i++) {
+      if (i > 1) {
+        sizes[i] = sizes[i - 1] * level_multiplier_;
+      }
+      total_size += sizes[i];
+    }
+    const double total_bits = bits_per_key_ * total_size;
+    const double ln2 = std::log(2.0);
+    const double bits_per_level =
+        std::log(level_multiplier_) / (ln2 * ln2);
+
+    for (int last = num_levels - 1; last >= 0; last--) {
+      double size = 0;
+      double extra_bits = 0;
+      for (int i = 0; i <= last; i++) {
+        size += sizes[i];
+        extra_bits += sizes[i] * bits_per_level * (last - std::max(i, 1));
+      }
+      const double last_bits = (total_bits - extra_bits) / size;
+      if (last_bits >= 1) {
+        for (int i = 0; i <= last; i++) {
+          (*bits)[i] = last_bits + bits_per_level * (last - std::max(i, 1));
+        }
+        return;
+      }
+      // Filtering the last level is not worth its cost; spend the bits on
+      // the levels above it instead
+    }
+  }
+
+ private:
+  static int RoundBits(double bits) {
+    int rounded = static_cast<int>(bits + 0.5);
+    return std::min(std::max(rounded, 1), kMaxBitsPerKey);
+  }
+
+  static FilterBitsBuilder* NewBuilder(int bits) {
+    // We intentionally round down to reduce probing cost a little bit
+    int num_probes = static_cast<int>(bits * 0.69);  // 0.69 =~ ln(2)
+    num_probes = std::min(std::max(num_probes, 1), 30);
+    return new FullFilterBitsBuilder(bits, num_probes);
+  }
+
+  const double bits_per_key_;
+  const double level_multiplier_;
+  BloomFilterPolicy bloom_policy_;
+};
+
+const int LevelAwareBloomFilterPolicy::kMaxBitsPerKey;
+
 }  // namespace
 
 const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
@@ -366,4 +884,13 @@ const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
   return new BloomFilterPolicy(bits_per_key, use_block_based_builder);
 }
 
+const FilterPolicy* NewXorFilterPolicy(int bits_per_key) {
+  return new XorFilterPolicy(bits_per_key);
+}
+
+const FilterPolicy* NewLevelAwareBloomFilterPolicy(double bits_per_key,
+                                                   double level_multiplier) {
+  return new LevelAwareBloomFilterPolicy(bits_per_key, level_multiplier);
+}
+
 }  // namespace rocksdb
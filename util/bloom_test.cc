@@ -293,6 +293,153 @@ TEST_F(FullBloomTest, FullVaryingLengths) {
   ASSERT_LE(mediocre_filters, good_filters/5);
 }
 
+TEST(XorFilterTest, VaryingLengths) {
+  char buffer[sizeof(int)];
+  std::unique_ptr<const FilterPolicy> policy(NewXorFilterPolicy(10));
+  std::unique_ptr<const FilterPolicy> bloom_policy(
+      NewBloomFilterPolicy(10, false));
+
+  for (int length = 0; length <= 10000; length = NextLength(length)) {
+    std::unique_ptr<FilterBitsBuilder> builder(policy->GetFilterBitsBuilder());
+    for (int i = 0; i < length; i++) {
+      builder->AddKey(Key(i, buffer));
+    }
+    std::unique_ptr<const char[]> buf;
+    Slice filter = builder->Finish(&buf);
+    // ~1.23 bytes per key plus a fixed overhead
+    ASSERT_LE(filter.size(), (size_t)(length * 1.25 + 64)) << length;
+
+    // Any built-in policy reads the filter
+    std::unique_ptr<FilterBitsReader> reader(
+        bloom_policy->GetFilterBitsReader(filter));
+    for (int i = 0; i < length; i++) {
+      ASSERT_TRUE(reader->MayMatch(Key(i, buffer)))
+          << "Length " << length << "; key " << i;
+    }
+    int false_positives = 0;
+    for (int i = 0; i < 10000; i++) {
+      if (reader->MayMatch(Key(i + 1000000000, buffer))) {
+        false_positives++;
+      }
+    }
+    // 8 bit fingerprints, ~0.4% expected
+    ASSERT_LE(false_positives, length == 0 ? 0 : 80) << length;
+  }
+}
+
+TEST(FilterBitsReaderTest, MayMatchBatch) {
+  char buffer[sizeof(int)];
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < 1000; i++) {
+    key_strs.push_back(Key(i, buffer).ToString());
+  }
+  // Half of the keys queried were added, in batches that are not a multiple
+  // of the internal batch size
+  std::vector<std::string> query_strs;
+  for (int i = 0; i < 2001; i++) {
+    query_strs.push_back(Key(i * 7 % 2000, buffer).ToString());
+  }
+  std::vector<Slice> queries(query_strs.begin(), query_strs.end());
+
+  for (bool use_xor : {false, true}) {
+    std::unique_ptr<const FilterPolicy> policy(
+        use_xor ? NewXorFilterPolicy(FLAGS_bits_per_key)
+                : NewBloomFilterPolicy(FLAGS_bits_per_key, false));
+    std::unique_ptr<FilterBitsBuilder> builder(policy->GetFilterBitsBuilder());
+    for (const std::string& key : key_strs) {
+      builder->AddKey(key);
+    }
+    std::unique_ptr<const char[]> buf;
+    Slice filter = builder->Finish(&buf);
+    std::unique_ptr<FilterBitsReader> reader(
+        policy->GetFilterBitsReader(filter));
+
+    std::unique_ptr<bool[]> may_match(new bool[queries.size()]);
+    reader->MayMatchBatch(static_cast<int>(queries.size()), &queries[0],
+                          may_match.get());
+    for (size_t i = 0; i < queries.size(); i++) {
+      ASSERT_EQ(reader->MayMatch(queries[i]), may_match[i]) << i;
+    }
+  }
+}
+
+TEST(XorFilterTest, BlockBasedFilter) {
+  char buffer[sizeof(int)];
+  std::unique_ptr<const FilterPolicy> policy(NewXorFilterPolicy(10));
+  std::unique_ptr<const FilterPolicy> bloom_policy(NewBloomFilterPolicy(10));
+
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < 1000; i++) {
+    key_strs.push_back(Key(i, buffer).ToString());
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+
+  std::string xor_filter;
+  policy->CreateFilter(&keys[0], static_cast<int>(keys.size()), &xor_filter);
+  std::string bloom_filter;
+  bloom_policy->CreateFilter(&keys[0], static_cast<int>(keys.size()),
+                             &bloom_filter);
+  // Each policy reads the filters of the other one
+  for (const Slice& key : keys) {
+    ASSERT_TRUE(policy->KeyMayMatch(key, xor_filter));
+    ASSERT_TRUE(bloom_policy->KeyMayMatch(key, xor_filter));
+    ASSERT_TRUE(policy->KeyMayMatch(key, bloom_filter));
+  }
+  int false_positives = 0;
+  for (int i = 0; i < 10000; i++) {
+    if (policy->KeyMayMatch(Key(i + 1000000000, buffer), xor_filter)) {
+      false_positives++;
+    }
+  }
+  ASSERT_LE(false_positives, 80);
+}
+
+TEST(LevelAwareBloomTest, BitsPerLevel) {
+  char buffer[sizeof(int)];
+  const int kNumLevels = 7;
+  const int kNumKeys = 1000;
+  std::unique_ptr<const FilterPolicy> policy(
+      NewLevelAwareBloomFilterPolicy(10, 10));
+
+  // Returns the filter size of level, or 0 if it gets no filter
+  auto filter_size = [&](const FilterPolicy* p, int level) -> size_t {
+    std::unique_ptr<FilterBitsBuilder> builder(
+        p->GetFilterBitsBuilderForLevel(level, kNumLevels));
+    if (builder == nullptr) {
+      return 0;
+    }
+    for (int i = 0; i < kNumKeys; i++) {
+      builder->AddKey(Key(i, buffer));
+    }
+    std::unique_ptr<const char[]> buf;
+    Slice filter = builder->Finish(&buf);
+    std::unique_ptr<FilterBitsReader> reader(p->GetFilterBitsReader(filter));
+    for (int i = 0; i < kNumKeys; i++) {
+      EXPECT_TRUE(reader->MayMatch(Key(i, buffer)));
+    }
+    return filter.size();
+  };
+
+  std::vector<size_t> sizes;
+  for (int level = 0; level < kNumLevels; level++) {
+    sizes.push_back(filter_size(policy.get(), level));
+  }
+  for (int level = 2; level < kNumLevels; level++) {
+    ASSERT_LT(sizes[level], sizes[level - 1]);
+  }
+  ASSERT_EQ(sizes[0], sizes[1]);
+  // The last level holds most keys, so it gets a bit less than the average
+  ASSERT_GT(sizes[kNumLevels - 1], 0);
+  ASSERT_LE(sizes[kNumLevels - 1], filter_size(policy.get(), kNumLevels));
+  ASSERT_GE(sizes[kNumLevels - 1] * 10 / 9,
+            filter_size(policy.get(), kNumLevels));
+
+  // A small budget is better spent on the upper levels only
+  policy.reset(NewLevelAwareBloomFilterPolicy(1, 10));
+  ASSERT_EQ(0U, filter_size(policy.get(), kNumLevels - 1));
+  ASSERT_GT(filter_size(policy.get(), kNumLevels - 2), 0U);
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -10,7 +10,10 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "util/crc32c.h"
+#include <algorithm>
+#include "util/random.h"
 #include "util/testharness.h"
+#include "util/testutil.h"
 
 namespace rocksdb {
 namespace crc32c {
@@ -63,6 +66,24 @@ TEST(CRC, Extend) {
             Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, ExtendLarge) {
+  // Large buffers take the interleaved path when it is available; it must
+  // agree with extending the CRC a small piece at a time.
+  std::string buf;
+  Random rnd(301);
+  test::RandomString(&rnd, 100000, &buf);
+  for (size_t len : {767, 768, 769, 24575, 24576, 24577, 99999}) {
+    for (size_t offset : {0, 1, 3}) {
+      uint32_t expected = 0;
+      for (size_t i = 0; i < len; i += 100) {
+        expected = Extend(expected, buf.data() + offset + i,
+                          std::min<size_t>(100, len - i));
+      }
+      ASSERT_EQ(expected, Value(buf.data() + offset, len));
+    }
+  }
+}
+
 TEST(CRC, Mask) {
   uint32_t crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
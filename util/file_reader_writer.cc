@@ -109,6 +109,35 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+Status FilePrefetchBuffer::Prefetch(uint64_t offset, size_t n) {
+  if (n > capacity_) {
+    buffer_.reset(new char[n]);
+    capacity_ = n;
+  }
+  Slice result;
+  Status s = file_reader_->Read(offset, n, &result, buffer_.get());
+  if (s.ok()) {
+    if (result.data() != buffer_.get()) {
+      // Some files (e.g. mmap-ed ones) return their own memory
+      memcpy(buffer_.get(), result.data(), result.size());
+    }
+    buffer_offset_ = offset;
+    buffer_len_ = result.size();
+  } else {
+    buffer_len_ = 0;
+  }
+  return s;
+}
+
+bool FilePrefetchBuffer::TryReadFromCache(uint64_t offset, size_t n,
+                                          Slice* result) const {
+  if (offset < buffer_offset_ || offset + n > buffer_offset_ + buffer_len_) {
+    return false;
+  }
+  *result = Slice(buffer_.get() + (offset - buffer_offset_), n);
+  return true;
+}
+
 Status WritableFileWriter::Append(const Slice& data) {
   const char* src = data.data();
   size_t left = data.size();
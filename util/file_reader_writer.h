@@ -109,6 +109,31 @@ class RandomAccessFileReader {
                     char* scratch) const;
 };
 
+// FilePrefetchBuffer holds a contiguous range of a file that was read ahead
+// of its consumer. It is used on top of files opened with direct I/O, where
+// RandomAccessFile::Prefetch() is a no-op, so that a sequential reader can
+// turn many small block reads into a few large ones. Not thread safe.
+class FilePrefetchBuffer {
+ public:
+  explicit FilePrefetchBuffer(RandomAccessFileReader* file_reader)
+      : file_reader_(file_reader), capacity_(0), buffer_offset_(0),
+        buffer_len_(0) {}
+
+  // Read [offset, offset + n) into the buffer, replacing its content.
+  Status Prefetch(uint64_t offset, size_t n);
+
+  // If [offset, offset + n) lies entirely in the buffer, point *result at it
+  // and return true. *result stays valid until the next Prefetch().
+  bool TryReadFromCache(uint64_t offset, size_t n, Slice* result) const;
+
+ private:
+  RandomAccessFileReader* file_reader_;
+  std::unique_ptr<char[]> buffer_;
+  size_t capacity_;
+  uint64_t buffer_offset_;
+  size_t buffer_len_;
+};
+
 // Use posix write to write data to a file.
 class WritableFileWriter {
  private:
@@ -11,8 +11,17 @@
 
 #include "rocksdb/filter_policy.h"
 
+#include "rocksdb/slice.h"
+
 namespace rocksdb {
 
+void FilterBitsReader::MayMatchBatch(int num_entries, const Slice* entries,
+                                     bool* may_match) {
+  for (int i = 0; i < num_entries; i++) {
+    may_match[i] = MayMatch(entries[i]);
+  }
+}
+
 FilterPolicy::~FilterPolicy() { }
 
 }  // namespace rocksdb
@@ -59,6 +59,8 @@ It depends on successfully passing SMHasher test set.
 
 #pragma once
 
+#include <stddef.h>
+
 #if defined (__cplusplus)
 namespace rocksdb {
 #endif
@@ -148,6 +150,40 @@ To free memory context, use XXH32_digest(), or free().
 
 
 
+//****************************
+// 64-bits Hash Functions
+//****************************
+
+unsigned long long XXH64 (const void* input, size_t len, unsigned long long seed);
+/*
+XXH64() :
+    Calculate the 64-bits hash of sequence of length "len" stored at memory address "input".
+    It is faster than XXH32() on 64-bits systems, and is not limited to 2^31-1 bytes.
+*/
+
+typedef struct
+{
+    unsigned long long total_len;
+    unsigned long long seed;
+    unsigned long long v1;
+    unsigned long long v2;
+    unsigned long long v3;
+    unsigned long long v4;
+    unsigned long long mem64[4];
+    unsigned int memsize;
+} XXH64_state_t;
+
+XXH_errorcode      XXH64_reset  (XXH64_state_t* state, unsigned long long seed);
+XXH_errorcode      XXH64_update (XXH64_state_t* state, const void* input, size_t len);
+unsigned long long XXH64_digest (const XXH64_state_t* state);
+/*
+Streaming version of XXH64(). The state is allocated by the caller (it can
+live on the stack), initialized with XXH64_reset(), fed with XXH64_update()
+as many times as necessary, and XXH64_digest() returns the hash of all the
+data fed so far without altering the state.
+*/
+
+
 //****************************
 // Deprecated function names
 //****************************
@@ -26,8 +26,6 @@ namespace rocksdb {
 Status BlockCacheTier::Open() {
   Status status;
 
-  WriteLock _(&lock_);
-
   assert(!size_);
 
   // Check the validity of the options
@@ -49,8 +47,20 @@ Status BlockCacheTier::Open() {
   // Create base/<cache dir> directory
   status = opt_.env->CreateDir(GetCachePath());
   if (!status.ok()) {
-    // directory already exists, clean it up
-    status = CleanupCacheFolder(GetCachePath());
+    // directory already exists, restore the files of the index checkpoint
+    // and clean up the rest
+    std::set<std::string> restored;
+    if (opt_.index_checkpoint) {
+      status = LoadIndex(&restored);
+      if (!status.ok() && !status.IsNotFound()) {
+        Warn(opt_.log, "Unable to restore index of %s. %s", opt_.path.c_str(),
+             status.ToString().c_str());
+      }
+    } else {
+      // cache ids are reused from now on, which makes any checkpoint stale
+      opt_.env->DeleteFile(GetIndexPath());
+    }
+    status = CleanupCacheFolder(GetCachePath(), restored);
     assert(status.ok());
     if (!status.ok()) {
       Error(opt_.log, "Error creating directory %s. %s", opt_.path.c_str(),
@@ -59,22 +69,34 @@ Status BlockCacheTier::Open() {
     }
   }
 
-  // create a new file
-  assert(!cache_file_);
-  status = NewCacheFile();
-  if (!status.ok()) {
-    Error(opt_.log, "Error creating new file %s. %s", opt_.path.c_str(),
-          status.ToString().c_str());
-    return status;
+  // create a new file for every lane
+  for (auto& lane : lanes_) {
+    MutexLock _(&lane->lock_);
+    assert(!lane->cache_file_);
+    status = NewCacheFile(lane.get());
+    if (!status.ok()) {
+      Error(opt_.log, "Error creating new file %s. %s", opt_.path.c_str(),
+            status.ToString().c_str());
+      return status;
+    }
+    assert(lane->cache_file_);
   }
 
-  assert(cache_file_);
-
   if (opt_.pipeline_writes) {
-    assert(!insert_th_.joinable());
-    insert_th_ = port::Thread(&BlockCacheTier::InsertMain, this);
+    for (auto& lane : lanes_) {
+      assert(!lane->insert_th_.joinable());
+      lane->insert_th_ =
+          port::Thread(&BlockCacheTier::InsertMain, this, lane.get());
+    }
+  }
+
+  if (opt_.index_checkpoint && opt_.index_checkpoint_period_sec) {
+    assert(!checkpoint_th_.joinable());
+    checkpoint_stop_ = false;
+    checkpoint_th_ = port::Thread(&BlockCacheTier::CheckpointMain, this);
   }
 
+  open_ = true;
   return Status::OK();
 }
 
@@ -91,7 +113,8 @@ bool IsCacheFile(const std::string& file) {
   return suffix == ".rc";
 }
 
-Status BlockCacheTier::CleanupCacheFolder(const std::string& folder) {
+Status BlockCacheTier::CleanupCacheFolder(const std::string& folder,
+                                          const std::set<std::string>& keep) {
   std::vector<std::string> files;
   Status status = opt_.env->GetChildren(folder, &files);
   if (!status.ok()) {
@@ -102,7 +125,7 @@ Status BlockCacheTier::CleanupCacheFolder(const std::string& folder) {
 
   // cleanup files with the patter :digi:.rc
   for (auto file : files) {
-    if (IsCacheFile(file)) {
+    if (IsCacheFile(file) && !keep.count(file)) {
       // cache file
       Info(opt_.log, "Removing file %s.", file.c_str());
       status = opt_.env->DeleteFile(folder + "/" + file);
@@ -119,18 +142,40 @@ Status BlockCacheTier::CleanupCacheFolder(const std::string& folder) {
 }
 
 Status BlockCacheTier::Close() {
-  // stop the insert thread
-  if (opt_.pipeline_writes && insert_th_.joinable()) {
-    InsertOp op(/*quit=*/true);
-    insert_ops_.Push(std::move(op));
-    insert_th_.join();
+  // stop the checkpoint thread
+  if (checkpoint_th_.joinable()) {
+    {
+      MutexLock _(&checkpoint_lock_);
+      checkpoint_stop_ = true;
+      checkpoint_cv_.SignalAll();
+    }
+    checkpoint_th_.join();
+  }
+
+  // stop the insert threads
+  for (auto& lane : lanes_) {
+    if (opt_.pipeline_writes && lane->insert_th_.joinable()) {
+      InsertOp op(/*quit=*/true);
+      lane->insert_ops_.Push(std::move(op));
+      lane->insert_th_.join();
+    }
   }
 
   // stop the writer before
   writer_.Stop();
 
+  // save the index of the files that made it to disk
+  if (opt_.index_checkpoint && open_) {
+    Status s = SaveIndex();
+    if (!s.ok()) {
+      Error(opt_.log, "Error saving index of %s. %s", opt_.path.c_str(),
+            s.ToString().c_str());
+    }
+  }
+  open_ = false;
+
   // clear all metadata
-  WriteLock _(&lock_);
+  MutexLock _(&reserve_lock_);
   metadata_.Clear();
   return Status::OK();
 }
@@ -178,20 +223,21 @@ Status BlockCacheTier::Insert(const Slice& key, const char* data,
   // update stats
   stats_.bytes_pipelined_.Add(size);
 
+  WriteLane* const lane = GetLane(key);
   if (opt_.pipeline_writes) {
-    // off load the write to the write thread
-    insert_ops_.Push(
+    // off load the write to the write thread of the lane
+    lane->insert_ops_.Push(
         InsertOp(key.ToString(), std::move(std::string(data, size))));
     return Status::OK();
   }
 
   assert(!opt_.pipeline_writes);
-  return InsertImpl(key, Slice(data, size));
+  return InsertImpl(lane, key, Slice(data, size));
 }
 
-void BlockCacheTier::InsertMain() {
+void BlockCacheTier::InsertMain(WriteLane* lane) {
   while (true) {
-    InsertOp op(insert_ops_.Pop());
+    InsertOp op(lane->insert_ops_.Pop());
 
     if (op.signal_) {
       // that is a secret signal to exit
@@ -200,7 +246,8 @@ void BlockCacheTier::InsertMain() {
 
     size_t retry = 0;
     Status s;
-    while ((s = InsertImpl(Slice(op.key_), Slice(op.data_))).IsTryAgain()) {
+    while ((s = InsertImpl(lane, Slice(op.key_), Slice(op.data_)))
+                .IsTryAgain()) {
       if (retry > kMaxRetry) {
         break;
       }
@@ -218,15 +265,19 @@ void BlockCacheTier::InsertMain() {
   }
 }
 
-Status BlockCacheTier::InsertImpl(const Slice& key, const Slice& data) {
+Status BlockCacheTier::InsertImpl(WriteLane* lane, const Slice& key,
+                                  const Slice& data) {
   // pre-condition
   assert(key.size());
   assert(data.size());
-  assert(cache_file_);
+  assert(lane == GetLane(key));
 
   StopWatchNano timer(opt_.env, /*auto_start=*/ true);
 
-  WriteLock _(&lock_);
+  // A key is always written through the same lane, so the lane lock makes
+  // the duplicate check and the index insert atomic
+  MutexLock _(&lane->lock_);
+  assert(lane->cache_file_);
 
   LBA lba;
   if (metadata_.Lookup(key, &lba)) {
@@ -234,30 +285,39 @@ Status BlockCacheTier::InsertImpl(const Slice& key, const Slice& data) {
     return Status::OK();
   }
 
-  while (!cache_file_->Append(key, data, &lba)) {
-    if (!cache_file_->Eof()) {
+  WriteableCacheFile* file = lane->cache_file_;
+  // Pin the file, the writer can close it as soon as the record is appended,
+  // and it should not be evicted before the record is indexed
+  ++file->refs_;
+  while (!file->Append(key, data, &lba)) {
+    --file->refs_;
+    if (!file->Eof()) {
       ROCKS_LOG_DEBUG(opt_.log, "Error inserting to cache file %d",
-                      cache_file_->cacheid());
+                      file->cacheid());
       stats_.write_latency_.Add(timer.ElapsedNanos() / 1000);
       return Status::TryAgain();
     }
 
-    assert(cache_file_->Eof());
-    Status status = NewCacheFile();
+    assert(file->Eof());
+    Status status = NewCacheFile(lane);
     if (!status.ok()) {
       return status;
     }
+    file = lane->cache_file_;
+    ++file->refs_;
   }
 
   // Insert into lookup index
   BlockInfo* info = metadata_.Insert(key, lba);
   assert(info);
   if (!info) {
+    --file->refs_;
     return Status::IOError("Unexpected error inserting to index");
   }
 
   // insert to cache file reverse mapping
-  cache_file_->Add(info);
+  file->Add(info);
+  --file->refs_;
 
   // update stats
   stats_.bytes_written_.Add(data.size());
@@ -295,15 +355,16 @@ Status BlockCacheTier::Lookup(const Slice& key, unique_ptr<char[]>* val,
 
   status = file->Read(lba, &blk_key, &blk_val, scratch.get());
   --file->refs_;
-  if (!status) {
+  if (!status || blk_key != key) {
+    // The record failed its checksum, which can happen to files restored
+    // from an index checkpoint. Don't look for it again
+    Erase(key);
     stats_.cache_misses_++;
     stats_.cache_errors_++;
     stats_.read_miss_latency_.Add(timer.ElapsedNanos() / 1000);
     return Status::NotFound("blockcache: error reading data");
   }
 
-  assert(blk_key == key);
-
   val->reset(new char[blk_val.size()]);
   memcpy(val->get(), blk_val.data(), blk_val.size());
   *size = blk_val.size();
@@ -316,22 +377,38 @@ Status BlockCacheTier::Lookup(const Slice& key, unique_ptr<char[]>* val,
 }
 
 bool BlockCacheTier::Erase(const Slice& key) {
-  WriteLock _(&lock_);
+  MutexLock _(&GetLane(key)->lock_);
+  LBA lba;
+  if (!metadata_.Lookup(key, &lba)) {
+    return false;
+  }
+
+  // Pin the file, so that it is not evicted while the block is unlinked
+  BlockCacheFile* const file = metadata_.Lookup(lba.cache_id_);
+  if (!file) {
+    // the file is being evicted along with its blocks
+    return false;
+  }
+
   BlockInfo* info = metadata_.Remove(key);
-  assert(info);
-  delete info;
-  return true;
+  if (info) {
+    file->Remove(info);
+    delete info;
+  }
+  --file->refs_;
+  return info != nullptr;
 }
 
-Status BlockCacheTier::NewCacheFile() {
-  lock_.AssertHeld();
+Status BlockCacheTier::NewCacheFile(WriteLane* lane) {
+  lane->lock_.AssertHeld();
 
   TEST_SYNC_POINT_CALLBACK("BlockCacheTier::NewCacheFile:DeleteDir",
                            (void*)(GetCachePath().c_str()));
 
+  const uint32_t cache_id = writer_cache_id_++;
   std::unique_ptr<WriteableCacheFile> f(
     new WriteableCacheFile(opt_.env, &buffer_allocator_, &writer_,
-                           GetCachePath(), writer_cache_id_,
+                           GetCachePath(), cache_id,
                            opt_.cache_file_size, opt_.log));
 
   bool status = f->Create(opt_.enable_direct_writes, opt_.enable_direct_reads);
@@ -339,13 +416,12 @@ Status BlockCacheTier::NewCacheFile() {
     return Status::IOError("Error creating file");
   }
 
-  Info(opt_.log, "Created cache file %d", writer_cache_id_);
+  Info(opt_.log, "Created cache file %d", cache_id);
 
-  writer_cache_id_++;
-  cache_file_ = f.release();
+  lane->cache_file_ = f.release();
 
   // insert to cache files tree
-  status = metadata_.Insert(cache_file_);
+  status = metadata_.Insert(lane->cache_file_);
   assert(status);
   if (!status) {
     Error(opt_.log, "Error inserting to metadata");
@@ -356,7 +432,7 @@ Status BlockCacheTier::NewCacheFile() {
 }
 
 bool BlockCacheTier::Reserve(const size_t size) {
-  WriteLock _(&lock_);
+  MutexLock _(&reserve_lock_);
   assert(size_ <= opt_.cache_size);
 
   if (size + size_ <= opt_.cache_size) {
@@ -392,6 +468,168 @@ bool BlockCacheTier::Reserve(const size_t size) {
   return true;
 }
 
+//
+// Index checkpoint
+//
+// The index checkpoint lists the sealed cache files and the blocks they hold
+//
+// +-------+-------------+---------+-----------------------+-------+
+// | magic | next cache  | # files | file 0 .. file n-1    | crc   |
+// |       | id (var32)  | (var32) |                       |       |
+// +-------+-------------+---------+-----------------------+-------+
+//
+// file = cache id (var32), # blocks (var32),
+//        # blocks * (key (length prefixed), offset (var32), size (var32))
+//
+Status BlockCacheTier::SaveIndex() {
+  std::string files;
+  uint32_t nfiles = 0;
+  std::vector<BlockInfo> infos;
+  metadata_.ApplyToCacheFiles([&](BlockCacheFile* file) {
+    if (!file->IsSealed()) {
+      // part of the file is still in the write buffers
+      return;
+    }
+    infos.clear();
+    file->GetBlockInfos(&infos);
+    PutVarint32(&files, file->cacheid());
+    PutVarint32(&files, static_cast<uint32_t>(infos.size()));
+    for (const auto& info : infos) {
+      PutLengthPrefixedSlice(&files, info.key_);
+      PutVarint32(&files, info.lba_.off_);
+      PutVarint32(&files, info.lba_.size_);
+    }
+    nfiles++;
+  });
+
+  std::string data;
+  PutFixed32(&data, kIndexMagic);
+  PutVarint32(&data, writer_cache_id_);
+  PutVarint32(&data, nfiles);
+  data.append(files);
+  PutFixed32(&data, crc32c::Mask(crc32c::Value(data.data(), data.size())));
+
+  // write a temporary file and rename it, so that a crash leaves either the
+  // previous or the new checkpoint
+  const std::string tmp_path = GetIndexPath() + ".tmp";
+  std::unique_ptr<WritableFile> file;
+  Status s = opt_.env->NewWritableFile(tmp_path, &file, EnvOptions());
+  if (s.ok()) {
+    s = file->Append(data);
+  }
+  if (s.ok()) {
+    s = file->Sync();
+  }
+  if (s.ok()) {
+    s = file->Close();
+  }
+  if (s.ok()) {
+    s = opt_.env->RenameFile(tmp_path, GetIndexPath());
+  }
+
+  if (s.ok()) {
+    Info(opt_.log, "Saved index of %d cache files", nfiles);
+  }
+  return s;
+}
+
+Status BlockCacheTier::LoadIndex(std::set<std::string>* restored) {
+  assert(!size_);
+
+  std::string data;
+  Status s = ReadFileToString(opt_.env, GetIndexPath(), &data);
+  if (!s.ok()) {
+    return s;
+  }
+
+  if (data.size() < 2 * sizeof(uint32_t)) {
+    return Status::Corruption("index checkpoint is too short");
+  }
+  const size_t payload_size = data.size() - sizeof(uint32_t);
+  const uint32_t crc = crc32c::Unmask(DecodeFixed32(data.data() + payload_size));
+  if (crc != crc32c::Value(data.data(), payload_size)) {
+    return Status::Corruption("index checkpoint checksum mismatch");
+  }
+
+  Slice input(data.data(), payload_size);
+  uint32_t magic = 0;
+  uint32_t next_cache_id = 0;
+  uint32_t nfiles = 0;
+  if (!GetFixed32(&input, &magic) || magic != kIndexMagic ||
+      !GetVarint32(&input, &next_cache_id) || !GetVarint32(&input, &nfiles)) {
+    return Status::Corruption("bad index checkpoint header");
+  }
+
+  // parse the whole checkpoint before touching the metadata
+  std::vector<std::pair<uint32_t, std::vector<BlockInfo>>> files(nfiles);
+  for (auto& file : files) {
+    uint32_t nblocks = 0;
+    if (!GetVarint32(&input, &file.first) || file.first >= next_cache_id ||
+        !GetVarint32(&input, &nblocks)) {
+      return Status::Corruption("bad index checkpoint file entry");
+    }
+    for (uint32_t i = 0; i < nblocks; ++i) {
+      Slice key;
+      LBA lba;
+      lba.cache_id_ = file.first;
+      if (!GetLengthPrefixedSlice(&input, &key) ||
+          !GetVarint32(&input, &lba.off_) || !GetVarint32(&input, &lba.size_)) {
+        return Status::Corruption("bad index checkpoint block entry");
+      }
+      file.second.emplace_back(key, lba);
+    }
+  }
+
+  for (const auto& entry : files) {
+    std::unique_ptr<RandomAccessCacheFile> file(new RandomAccessCacheFile(
+        opt_.env, GetCachePath(), entry.first, opt_.log));
+    uint64_t file_size = 0;
+    if (!opt_.env->GetFileSize(file->Path(), &file_size).ok() ||
+        size_ + file_size > opt_.cache_size ||
+        !file->Open(opt_.enable_direct_reads) ||
+        !metadata_.Insert(file.get())) {
+      // the file is gone or does not fit anymore
+      continue;
+    }
+
+    RandomAccessCacheFile* const f = file.release();
+    for (const auto& block : entry.second) {
+      if (static_cast<uint64_t>(block.lba_.off_) + block.lba_.size_ >
+          file_size) {
+        continue;
+      }
+      BlockInfo* info = metadata_.Insert(block.key_, block.lba_);
+      if (info) {
+        f->Add(info);
+      }
+    }
+    size_ += file_size;
+    restored->insert(std::to_string(entry.first) + ".rc");
+  }
+
+  writer_cache_id_ = next_cache_id;
+  Info(opt_.log, "Restored %d of %d cache files from the index checkpoint",
+       static_cast<int>(restored->size()), nfiles);
+  return Status::OK();
+}
+
+void BlockCacheTier::CheckpointMain() {
+  MutexLock _(&checkpoint_lock_);
+  while (!checkpoint_stop_) {
+    checkpoint_cv_.TimedWait(opt_.env->NowMicros() +
+                             opt_.index_checkpoint_period_sec * 1000000);
+    if (checkpoint_stop_) {
+      break;
+    }
+
+    Status s = SaveIndex();
+    if (!s.ok()) {
+      Error(opt_.log, "Error saving index of %s. %s", opt_.path.c_str(),
+            s.ToString().c_str());
+    }
+  }
+}
+
 Status NewPersistentCache(Env* const env, const std::string& path,
                           const uint64_t size,
                           const std::shared_ptr<Logger>& log,
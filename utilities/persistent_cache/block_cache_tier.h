@@ -12,6 +12,7 @@
 #include <unistd.h>
 #endif // ! OS_WIN
 
+#include <algorithm>
 #include <atomic>
 #include <list>
 #include <memory>
@@ -20,6 +21,7 @@
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "rocksdb/cache.h"
 #include "rocksdb/comparator.h"
@@ -35,6 +37,7 @@
 #include "util/arena.h"
 #include "util/coding.h"
 #include "util/crc32c.h"
+#include "util/hash.h"
 #include "util/mutexlock.h"
 
 namespace rocksdb {
@@ -45,18 +48,27 @@ namespace rocksdb {
 class BlockCacheTier : public PersistentCacheTier {
  public:
   explicit BlockCacheTier(const PersistentCacheConfig& opt)
-      : opt_(opt),
-        insert_ops_(opt_.max_write_pipeline_backlog_size),
+      : checkpoint_cv_(&checkpoint_lock_),
+        opt_(opt),
         buffer_allocator_(opt.write_buffer_size, opt.write_buffer_count()),
         writer_(this, opt_.writer_qdepth, opt_.writer_dispatch_size) {
     Info(opt_.log, "Initializing allocator. size=%d B count=%d",
          opt_.write_buffer_size, opt_.write_buffer_count());
+    for (uint32_t i = 0; i < std::max(opt_.write_lanes, 1u); ++i) {
+      lanes_.emplace_back(
+          new WriteLane(opt_.max_write_pipeline_backlog_size));
+    }
   }
 
   virtual ~BlockCacheTier() {
     // Close is re-entrant so we can call close even if it is already closed
     Close();
-    assert(!insert_th_.joinable());
+#ifndef NDEBUG
+    for (auto& lane : lanes_) {
+      assert(!lane->insert_th_.joinable());
+    }
+#endif
+    assert(!checkpoint_th_.joinable());
   }
 
   Status Insert(const Slice& key, const char* data, const size_t size) override;
@@ -74,15 +86,19 @@ class BlockCacheTier : public PersistentCacheTier {
   PersistentCache::StatsType Stats() override;
 
   void TEST_Flush() override {
-    while (insert_ops_.Size()) {
-      /* sleep override */
-      Env::Default()->SleepForMicroseconds(1000000);
+    for (auto& lane : lanes_) {
+      while (lane->insert_ops_.Size()) {
+        /* sleep override */
+        Env::Default()->SleepForMicroseconds(1000000);
+      }
     }
   }
 
  private:
   // Percentage of cache to be evicted when the cache is full
   static const size_t kEvictPct = 10;
+  // Magic number of the index checkpoint file
+  static const uint32_t kIndexMagic = 0xbcf1de01;
   // Max attempts to insert key, value to cache in pipelined mode
   static const size_t kMaxRetry = 3;
 
@@ -105,16 +121,45 @@ class BlockCacheTier : public PersistentCacheTier {
     const bool signal_ = false;  // signal to request processing thread to exit
   };
 
+  // Write lane
+  //
+  // A lane owns the cache file that its keys are appended to. The lane lock
+  // only serializes inserts that hash to the lane; the block and cache file
+  // indexes do their own (striped) locking
+  struct WriteLane {
+    explicit WriteLane(const uint64_t max_backlog)
+        : insert_ops_(max_backlog) {}
+
+    port::Mutex lock_;                          // Synchronization
+    BoundedQueue<InsertOp> insert_ops_;         // Ops waiting for insert
+    port::Thread insert_th_;                    // Insert thread
+    WriteableCacheFile* cache_file_ = nullptr;  // Current cache file reference
+  };
+
+  // lane the given key is written through
+  WriteLane* GetLane(const Slice& key) {
+    return lanes_[GetSliceHash(key) % lanes_.size()].get();
+  }
   // entry point for insert thread
-  void InsertMain();
+  void InsertMain(WriteLane* lane);
   // insert implementation
-  Status InsertImpl(const Slice& key, const Slice& data);
-  // Create a new cache file
-  Status NewCacheFile();
+  Status InsertImpl(WriteLane* lane, const Slice& key, const Slice& data);
+  // Create a new cache file for the lane
+  Status NewCacheFile(WriteLane* lane);
   // Get cache directory path
   std::string GetCachePath() const { return opt_.path + "/cache"; }
-  // Cleanup folder
-  Status CleanupCacheFolder(const std::string& folder);
+  // Get index checkpoint path
+  std::string GetIndexPath() const { return GetCachePath() + "/INDEX"; }
+  // Cleanup folder, except for the files in keep
+  Status CleanupCacheFolder(
+      const std::string& folder,
+      const std::set<std::string>& keep = std::set<std::string>());
+  // Save the index of the sealed cache files
+  Status SaveIndex();
+  // Restore the index checkpoint, and return the names of the restored files
+  Status LoadIndex(std::set<std::string>* restored);
+  // entry point for the periodic index checkpoint thread
+  void CheckpointMain();
 
   // Statistics
   struct Statistics {
@@ -140,12 +185,15 @@ class BlockCacheTier : public PersistentCacheTier {
     }
   };
 
-  port::RWMutex lock_;                          // Synchronization
+  port::Mutex reserve_lock_;                    // Serializes space reservation
+  port::Mutex checkpoint_lock_;                 // Checkpoint thread control
+  port::CondVar checkpoint_cv_;                 // Wakes up checkpoint thread
+  port::Thread checkpoint_th_;                  // Checkpoint thread
+  bool checkpoint_stop_ = false;                // Checkpoint thread should exit
+  bool open_ = false;                           // Is the cache open
   const PersistentCacheConfig opt_;             // BlockCache options
-  BoundedQueue<InsertOp> insert_ops_;           // Ops waiting for insert
-  rocksdb::port::Thread insert_th_;                       // Insert thread
-  uint32_t writer_cache_id_ = 0;                // Current cache file identifier
-  WriteableCacheFile* cache_file_ = nullptr;    // Current cache file reference
+  std::vector<std::unique_ptr<WriteLane>> lanes_;  // Write lanes
+  std::atomic<uint32_t> writer_cache_id_{0};    // Next cache file identifier
   CacheWriteBufferAllocator buffer_allocator_;  // Buffer provider
   ThreadedWriter writer_;                       // Writer threads
   BlockCacheTierMetadata metadata_;             // Cache meta data manager
@@ -18,6 +18,7 @@
 #include "port/port.h"
 #include "util/crc32c.h"
 #include "util/logging.h"
+#include "utilities/persistent_cache/block_cache_tier_metadata.h"
 
 namespace rocksdb {
 
@@ -45,6 +46,13 @@ Status NewRandomAccessCacheFile(Env* const env, const std::string& filepath,
 //
 // BlockCacheFile
 //
+void BlockCacheFile::GetBlockInfos(std::vector<BlockInfo>* infos) {
+  ReadLock _(&rwlock_);
+  for (BlockInfo* binfo : block_infos_) {
+    infos->push_back(*binfo);
+  }
+}
+
 Status BlockCacheFile::Delete(uint64_t* size) {
   Status status = env_->GetFileSize(Path(), size);
   if (!status.ok()) {
@@ -161,34 +169,22 @@ bool CacheRecord::Append(std::vector<CacheWriteBuffer*>* bufs, size_t* woff,
 }
 
 bool CacheRecord::Deserialize(const Slice& data) {
-  assert(data.size() >= sizeof(CacheRecordHeader));
+  // Records of cache files that were restored from an index checkpoint are
+  // only validated here, so a mismatch is an error but not a bug
   if (data.size() < sizeof(CacheRecordHeader)) {
     return false;
   }
 
   memcpy(&hdr_, data.data(), sizeof(hdr_));
 
-  assert(hdr_.key_size_ + hdr_.val_size_ + sizeof(hdr_) == data.size());
-  if (hdr_.key_size_ + hdr_.val_size_ + sizeof(hdr_) != data.size()) {
+  if (static_cast<uint64_t>(hdr_.key_size_) + hdr_.val_size_ + sizeof(hdr_) !=
+      data.size()) {
     return false;
   }
 
   key_ = Slice(data.data_ + sizeof(hdr_), hdr_.key_size_);
   val_ = Slice(key_.data_ + hdr_.key_size_, hdr_.val_size_);
 
-  if (!(hdr_.magic_ == MAGIC && ComputeCRC() == hdr_.crc_)) {
-    fprintf(stderr, "** magic %d ** \n", hdr_.magic_);
-    fprintf(stderr, "** key_size %d ** \n", hdr_.key_size_);
-    fprintf(stderr, "** val_size %d ** \n", hdr_.val_size_);
-    fprintf(stderr, "** key %s ** \n", key_.ToString().c_str());
-    fprintf(stderr, "** val %s ** \n", val_.ToString().c_str());
-    for (size_t i = 0; i < hdr_.val_size_; ++i) {
-      fprintf(stderr, "%d.", (uint8_t)val_.data()[i]);
-    }
-    fprintf(stderr, "\n** cksum %d != %d **", hdr_.crc_, ComputeCRC());
-  }
-
-  assert(hdr_.magic_ == MAGIC && ComputeCRC() == hdr_.crc_);
   return hdr_.magic_ == MAGIC && ComputeCRC() == hdr_.crc_;
 }
 
@@ -237,6 +233,11 @@ bool RandomAccessCacheFile::Read(const LBA& lba, Slice* key, Slice* val,
     return false;
   }
 
+  if (result.size() != lba.size_) {
+    Error(log_, "Short read from file %s off %d", Path().c_str(), lba.off_);
+    return false;
+  }
+
   assert(result.data() == scratch);
 
   return ParseRec(lba, key, val, scratch);
@@ -248,7 +249,6 @@ bool RandomAccessCacheFile::ParseRec(const LBA& lba, Slice* key, Slice* val,
 
   CacheRecord rec;
   if (!rec.Deserialize(data)) {
-    assert(!"Error deserializing data");
     Error(log_, "Error de-serializing record from file %s off %d",
           Path().c_str(), lba.off_);
     return false;
@@ -294,7 +294,13 @@ bool WriteableCacheFile::Create(const bool enable_direct_writes,
                    s.ToString().c_str());
   }
 
-  s = NewWritableCacheFile(env_, Path(), &file_);
+  s = NewWritableCacheFile(env_, Path(), &file_, enable_direct_writes);
+  if (!s.ok() && enable_direct_writes) {
+    // not every file system supports direct IO, fall back to buffered writes
+    ROCKS_LOG_WARN(log_, "Unable to create file %s for direct IO. %s",
+                   Path().c_str(), s.ToString().c_str());
+    s = NewWritableCacheFile(env_, Path(), &file_);
+  }
   if (!s.ok()) {
     ROCKS_LOG_WARN(log_, "Unable to create file %s. %s", Path().c_str(),
                    s.ToString().c_str());
@@ -128,8 +128,17 @@ class BlockCacheFile : public LRUElement<BlockCacheFile> {
     WriteLock _(&rwlock_);
     block_infos_.push_back(binfo);
   }
+  // Remove block information that was added to the file
+  virtual void Remove(BlockInfo* binfo) {
+    WriteLock _(&rwlock_);
+    block_infos_.remove(binfo);
+  }
   // get block information
   std::list<BlockInfo*>& block_infos() { return block_infos_; }
+  // Copy the key and LBA of every block of the file
+  void GetBlockInfos(std::vector<BlockInfo>* infos);
+  // Is all the data of the file on disk (no more appends)
+  virtual bool IsSealed() { return true; }
   // delete file and return the size of the file
   virtual Status Delete(uint64_t* size);
 
@@ -206,6 +215,11 @@ class WriteableCacheFile : public RandomAccessCacheFile {
   bool Append(const Slice&, const Slice&, LBA* const) override;
   // End-of-file
   bool Eof() const { return eof_; }
+  // the file is sealed once it is full and its buffers are on disk
+  bool IsSealed() override {
+    ReadLock _(&rwlock_);
+    return eof_ && bufs_.empty();
+  }
 
  private:
   friend class ThreadedWriter;
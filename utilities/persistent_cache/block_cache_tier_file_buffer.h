@@ -11,6 +11,7 @@
 #include <string>
 
 #include "include/rocksdb/comparator.h"
+#include "util/aligned_buffer.h"
 #include "util/arena.h"
 #include "util/mutexlock.h"
 
@@ -20,11 +21,12 @@ namespace rocksdb {
 // CacheWriteBuffer
 //
 // Buffer abstraction that can be manipulated via append
-// (not thread safe)
+// (not thread safe). The buffer is aligned for direct IO
 class CacheWriteBuffer {
  public:
   explicit CacheWriteBuffer(const size_t size) : size_(size), pos_(0) {
-    buf_.reset(new char[size_]);
+    buf_.Alignment(kAlignment);
+    buf_.AllocateNewBuffer(size_);
     assert(!pos_);
     assert(size_);
   }
@@ -33,14 +35,14 @@ class CacheWriteBuffer {
 
   void Append(const char* buf, const size_t size) {
     assert(pos_ + size <= size_);
-    memcpy(buf_.get() + pos_, buf, size);
+    memcpy(buf_.BufferStart() + pos_, buf, size);
     pos_ += size;
     assert(pos_ <= size_);
   }
 
   void FillTrailingZeros() {
     assert(pos_ <= size_);
-    memset(buf_.get() + pos_, '0', size_ - pos_);
+    memset(buf_.BufferStart() + pos_, '0', size_ - pos_);
     pos_ = size_;
   }
 
@@ -48,10 +50,12 @@ class CacheWriteBuffer {
   size_t Free() const { return size_ - pos_; }
   size_t Capacity() const { return size_; }
   size_t Used() const { return pos_; }
-  char* Data() const { return buf_.get(); }
+  char* Data() { return buf_.BufferStart(); }
 
  private:
-  std::unique_ptr<char[]> buf_;
+  static const size_t kAlignment = 4 * 1024;  // direct IO alignment
+
+  AlignedBuffer buf_;
   const size_t size_;
   size_t pos_;
 };
@@ -33,6 +33,11 @@ BlockCacheFile* BlockCacheTierMetadata::Evict() {
   return cache_file_index_.Evict(fn);
 }
 
+void BlockCacheTierMetadata::ApplyToCacheFiles(
+    const std::function<void(BlockCacheFile*)>& fn) {
+  cache_file_index_.Apply(fn);
+}
+
 void BlockCacheTierMetadata::Clear() {
   cache_file_index_.Clear([](BlockCacheFile* arg){ delete arg; });
   block_index_.Clear([](BlockInfo* arg){ delete arg; });
@@ -65,8 +70,9 @@ bool BlockCacheTierMetadata::Lookup(const Slice& key, LBA* lba) {
 BlockInfo* BlockCacheTierMetadata::Remove(const Slice& key) {
   BlockInfo lookup_key(key);
   BlockInfo* binfo = nullptr;
-  bool ok __attribute__((__unused__)) = block_index_.Erase(&lookup_key, &binfo);
-  assert(ok);
+  if (!block_index_.Erase(&lookup_key, &binfo)) {
+    return nullptr;
+  }
   return binfo;
 }
 
@@ -68,12 +68,15 @@ class BlockCacheTierMetadata {
   // Lookup block information from block index
   bool Lookup(const Slice& key, LBA* lba);
 
-  // Remove a given from the block index
+  // Remove a given key from the block index, nullptr if it is not there
   BlockInfo* Remove(const Slice& key);
 
   // Find and evict a cache file using LRU policy
   BlockCacheFile* Evict();
 
+  // Apply fn to every cache file
+  void ApplyToCacheFiles(const std::function<void(BlockCacheFile*)>& fn);
+
   // Clear the metadata contents
   virtual void Clear();
 
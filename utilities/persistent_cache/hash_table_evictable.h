@@ -110,6 +110,20 @@ class EvictableHashTable : private HashTable<T*, Hash, Equal> {
     return t;
   }
 
+  //
+  // Apply fn to every record. The bucket of the record is read locked while
+  // fn runs, so the record cannot be evicted under it
+  //
+  void Apply(const std::function<void(T*)>& fn) {
+    for (uint32_t i = 0; i < hash_table::nbuckets_; ++i) {
+      const uint32_t lock_idx = i % hash_table::nlocks_;
+      ReadLock _(&hash_table::locks_[lock_idx]);
+      for (auto* t : hash_table::buckets_[i].list_) {
+        fn(t);
+      }
+    }
+  }
+
   void Clear(void (*fn)(T*)) {
     for (uint32_t i = 0; i < hash_table::nbuckets_; ++i) {
       const uint32_t lock_idx = i % hash_table::nlocks_;
@@ -39,6 +39,7 @@ DEFINE_uint64(cache_size, std::numeric_limits<uint64_t>::max(), "Cache size");
 DEFINE_int32(iosize, 4 * 1024, "Read IO size");
 DEFINE_int32(writer_iosize, 4 * 1024, "File writer IO size");
 DEFINE_int32(writer_qdepth, 1, "File writer qdepth");
+DEFINE_int32(write_lanes, 1, "Number of cache files written concurrently");
 DEFINE_bool(enable_pipelined_writes, false, "Enable async writes");
 DEFINE_string(cache_type, "block_cache",
               "Cache type. (block_cache, volatile, tiered)");
@@ -64,6 +65,7 @@ std::unique_ptr<PersistentCacheTier> NewBlockCache() {
   PersistentCacheConfig opt(Env::Default(), FLAGS_path, FLAGS_cache_size, log);
   opt.writer_dispatch_size = FLAGS_writer_iosize;
   opt.writer_qdepth = FLAGS_writer_qdepth;
+  opt.write_lanes = FLAGS_write_lanes;
   opt.pipeline_writes = FLAGS_enable_pipelined_writes;
   opt.max_write_pipeline_backlog_size = std::numeric_limits<uint64_t>::max();
   std::unique_ptr<PersistentCacheTier> cache(new BlockCacheTier(opt));
@@ -102,6 +104,7 @@ std::unique_ptr<PersistentTieredCache> NewTieredCache() {
                             (1 - pct) * FLAGS_cache_size, log);
   opt.writer_dispatch_size = FLAGS_writer_iosize;
   opt.writer_qdepth = FLAGS_writer_qdepth;
+  opt.write_lanes = FLAGS_write_lanes;
   opt.pipeline_writes = FLAGS_enable_pipelined_writes;
   opt.max_write_pipeline_backlog_size = std::numeric_limits<uint64_t>::max();
   return NewTieredCache(FLAGS_cache_size * pct, opt);
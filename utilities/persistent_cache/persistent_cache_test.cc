@@ -105,13 +105,16 @@ std::unique_ptr<PersistentTieredCache> NewTieredCache(
 std::unique_ptr<PersistentCacheTier> NewBlockCache(
     Env* env, const std::string& path,
     const uint64_t max_size = std::numeric_limits<uint64_t>::max(),
-    const bool enable_direct_writes = false) {
+    const bool enable_direct_writes = false, const uint32_t write_lanes = 1,
+    const bool index_checkpoint = false) {
   const uint32_t max_file_size = static_cast<uint32_t>(12 * 1024 * 1024 * kStressFactor);
   auto log = std::make_shared<ConsoleLogger>();
   PersistentCacheConfig opt(env, path, max_size, log);
   opt.cache_file_size = max_file_size;
   opt.max_write_pipeline_backlog_size = std::numeric_limits<uint64_t>::max();
   opt.enable_direct_writes = enable_direct_writes;
+  opt.write_lanes = write_lanes;
+  opt.index_checkpoint = index_checkpoint;
   std::unique_ptr<PersistentCacheTier> scache(new BlockCacheTier(opt));
   Status s = scache->Open();
   assert(s.ok());
@@ -223,6 +226,66 @@ TEST_F(PersistentCacheTierTest, BlockCacheInsertWithEviction) {
   }
 }
 
+TEST_F(PersistentCacheTierTest, BlockCacheInsertWithWriteLanes) {
+  for (auto direct_writes : {true, false}) {
+    for (auto nthreads : {1, 5}) {
+      cache_ = NewBlockCache(Env::Default(), path_,
+                             /*size=*/std::numeric_limits<uint64_t>::max(),
+                             direct_writes, /*write_lanes=*/4);
+      RunInsertTest(nthreads,
+                    static_cast<size_t>(1 * 1024 * 1024 * kStressFactor));
+    }
+  }
+  for (auto nthreads : {1, 5}) {
+    cache_ = NewBlockCache(
+        Env::Default(), path_,
+        /*max_size=*/static_cast<size_t>(200 * 1024 * 1024 * kStressFactor),
+        /*direct_writes=*/false, /*write_lanes=*/4);
+    RunInsertTestWithEviction(
+        nthreads, static_cast<size_t>(1 * 1024 * 1024 * kStressFactor));
+  }
+}
+
+TEST_F(PersistentCacheTierTest, BlockCacheIndexCheckpoint) {
+  const size_t max_keys = static_cast<size_t>(10 * 1024 * kStressFactor);
+  auto new_cache = [&](const bool index_checkpoint) {
+    return NewBlockCache(Env::Default(), path_,
+                         /*size=*/std::numeric_limits<uint64_t>::max(),
+                         /*direct_writes=*/false, /*write_lanes=*/1,
+                         index_checkpoint);
+  };
+
+  cache_ = new_cache(/*index_checkpoint=*/true);
+  Insert(/*nthreads=*/1, max_keys);
+  ASSERT_OK(cache_->Close());
+
+  // the sealed cache files are restored, the rest of the data is lost
+  cache_ = new_cache(/*index_checkpoint=*/true);
+  Verify(/*nthreads=*/1, /*eviction_enabled=*/true);
+  ASSERT_EQ(stats_verify_hits_ + stats_verify_missed_, max_keys);
+  ASSERT_GT(stats_verify_hits_, max_keys / 2);
+  const size_t hits = stats_verify_hits_;
+  ASSERT_OK(cache_->Close());
+
+  // corrupt the first record, it is dropped when it is read
+  std::unique_ptr<RandomRWFile> file;
+  ASSERT_OK(Env::Default()->NewRandomRWFile(path_ + "/cache/0.rc", &file,
+                                            EnvOptions()));
+  ASSERT_OK(file->Write(/*offset=*/0, std::string(16, 'x')));
+  ASSERT_OK(file->Close());
+  cache_ = new_cache(/*index_checkpoint=*/true);
+  Verify(/*nthreads=*/1, /*eviction_enabled=*/true);
+  ASSERT_EQ(stats_verify_hits_, hits - 1);
+  ASSERT_OK(cache_->Close());
+
+  // without the option the cache starts cold
+  cache_ = new_cache(/*index_checkpoint=*/false);
+  Verify(/*nthreads=*/1, /*eviction_enabled=*/true);
+  ASSERT_EQ(stats_verify_hits_, 0);
+  ASSERT_OK(cache_->Close());
+  cache_.reset();
+}
+
 // Tiered cache tests
 TEST_F(PersistentCacheTierTest, TieredCacheInsert) {
   for (auto nthreads : {1, 5}) {
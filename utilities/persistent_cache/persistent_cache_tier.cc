@@ -42,6 +42,8 @@ std::string PersistentCacheConfig::ToString() const {
   snprintf(buffer, kBufferSize, "    writer_qdepth: %" PRIu32 "\n",
            writer_qdepth);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    write_lanes: %" PRIu32 "\n", write_lanes);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "    pipeline_writes: %d\n", pipeline_writes);
   ret.append(buffer);
   snprintf(buffer, kBufferSize,
@@ -56,6 +58,12 @@ std::string PersistentCacheConfig::ToString() const {
   ret.append(buffer);
   snprintf(buffer, kBufferSize, "    is_compressed: %d\n", is_compressed);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    index_checkpoint: %d\n", index_checkpoint);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize,
+           "    index_checkpoint_period_sec: %" PRIu64 "\n",
+           index_checkpoint_period_sec);
+  ret.append(buffer);
 
   return ret;
 }
@@ -114,10 +114,11 @@ struct PersistentCacheConfig {
     }
 
     // (2) check writer settings
-    // - Queue depth cannot be 0
+    // - Queue depth and number of write lanes cannot be 0
     // - writer_dispatch_size cannot be greater than writer_buffer_size
     // - dispatch size and buffer size need to be aligned
-    if (!writer_qdepth || writer_dispatch_size > write_buffer_size ||
+    if (!writer_qdepth || !write_lanes ||
+        writer_dispatch_size > write_buffer_size ||
         write_buffer_size % writer_dispatch_size) {
       return Status::InvalidArgument("invalid writer settings");
     }
@@ -172,6 +173,16 @@ struct PersistentCacheConfig {
   // default :1
   uint32_t writer_qdepth = 1;
 
+  // write-lanes
+  //
+  // Number of cache files that are written concurrently. Keys are spread
+  // across the lanes by hash, and each lane has its own insert thread, lock
+  // and active cache file, so inserts to different lanes do not serialize and
+  // the writer threads have more than one file to flush
+  //
+  // default: 1
+  uint32_t write_lanes = 1;
+
   // pipeline-writes
   //
   // The write optionally follow pipelined architecture. This helps
@@ -202,8 +213,8 @@ struct PersistentCacheConfig {
   // file size in order to avoid dead lock.
   size_t write_buffer_count() const {
     assert(write_buffer_size);
-    return static_cast<size_t>((writer_qdepth + 1.2) * cache_file_size /
-                               write_buffer_size);
+    return static_cast<size_t>((writer_qdepth + write_lanes + 0.2) *
+                               cache_file_size / write_buffer_size);
   }
 
   // writer-dispatch-size
@@ -219,6 +230,23 @@ struct PersistentCacheConfig {
   // uncompressed mode
   bool is_compressed = true;
 
+  // index-checkpoint
+  //
+  // If true, the index of the cache (cache files, block keys and their
+  // location) is saved in the cache directory on Close() and periodically.
+  // Open() reloads it, so that the cache stays warm across restarts. Blocks
+  // of the reloaded files are checked against their checksum when read
+  //
+  // default: false
+  bool index_checkpoint = false;
+
+  // index-checkpoint-period-sec
+  //
+  // Seconds between two index checkpoints. 0 only saves the index on Close()
+  //
+  // default: 600
+  uint64_t index_checkpoint_period_sec = 600;
+
   PersistentCacheConfig MakePersistentCacheConfig(
       const std::string& path, const uint64_t size,
       const std::shared_ptr<Logger>& log);
@@ -0,0 +1,385 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//  This source code is also licensed under the GPLv2 license found in the
+//  COPYING file in the root directory of this source tree.
+
+#include "rocksdb/utilities/sim_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "util/hash.h"
+
+namespace rocksdb {
+
+const int MissRatioCurveCache::kCurvePoints;
+
+namespace {
+
+// MissRatioCurveCacheImpl definition
+//
+// The sampled keys are kept in LRU order: each one owns a slot, and an
+// access moves it to the next free slot. A Fenwick tree over the slots sums
+// the charges of the keys accessed after a given one, which is how many
+// bytes an LRU cache needs besides the key itself to still hold it (its
+// stack distance). Scaled by 1 / sampling_rate, this gives the smallest
+// capacity at which the lookup hits.
+class MissRatioCurveCacheImpl : public MissRatioCurveCache {
+ public:
+  MissRatioCurveCacheImpl(std::shared_ptr<Cache> cache,
+                          size_t max_sim_capacity, double sampling_rate)
+      : cache_(cache),
+        max_sim_capacity_(max_sim_capacity),
+        sampling_rate_(sampling_rate),
+        sampling_threshold_(
+            static_cast<uint64_t>(sampling_rate * (uint64_t{1} << 32))),
+        max_sampled_charge_(
+            static_cast<uint64_t>(max_sim_capacity * sampling_rate)),
+        lookups_(0),
+        sampled_lookups_(0),
+        hits_(kCurvePoints, 0),
+        sampled_charge_(0),
+        next_slot_(0),
+        oldest_slot_(0) {}
+
+  virtual ~MissRatioCurveCacheImpl() {}
+
+  virtual void SetCapacity(size_t capacity) override {
+    cache_->SetCapacity(capacity);
+  }
+
+  virtual void SetStrictCapacityLimit(bool strict_capacity_limit) override {
+    cache_->SetStrictCapacityLimit(strict_capacity_limit);
+  }
+
+  virtual Status Insert(const Slice& key, void* value, size_t charge,
+                        void (*deleter)(const Slice& key, void* value),
+                        Handle** handle, Priority priority) override {
+    if (IsSampled(key)) {
+      SampledInsert(key, charge);
+    }
+    return cache_->Insert(key, value, charge, deleter, handle, priority);
+  }
+
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const TierHelper* helper, size_t charge,
+                                  Handle** handle,
+                                  Priority priority) override {
+    if (IsSampled(key)) {
+      SampledInsert(key, charge);
+    }
+    return cache_->InsertWithHelper(key, value, helper, charge, handle,
+                                    priority);
+  }
+
+  virtual Handle* Lookup(const Slice& key, Statistics* stats) override {
+    Handle* h = cache_->Lookup(key, stats);
+    CountLookup(key, h);
+    return h;
+  }
+
+  virtual Handle* LookupWithHelper(const Slice& key, const TierHelper* helper,
+                                   Statistics* stats) override {
+    Handle* h = cache_->LookupWithHelper(key, helper, stats);
+    CountLookup(key, h);
+    return h;
+  }
+
+  virtual bool Contains(const Slice& key) override {
+    return cache_->Contains(key);
+  }
+
+  virtual bool Ref(Handle* handle) override { return cache_->Ref(handle); }
+
+  virtual bool Release(Handle* handle, bool force_erase = false) override {
+    return cache_->Release(handle, force_erase);
+  }
+
+  virtual void Erase(const Slice& key) override {
+    cache_->Erase(key);
+    if (IsSampled(key)) {
+      std::lock_guard<std::mutex> l(mutex_);
+      auto it = keys_.find(key.ToString());
+      if (it != keys_.end()) {
+        RemoveFromSlot(it);
+        keys_.erase(it);
+      }
+    }
+  }
+
+  virtual void* Value(Handle* handle) override { return cache_->Value(handle); }
+
+  virtual uint64_t NewId() override { return cache_->NewId(); }
+
+  virtual size_t GetCapacity() const override { return cache_->GetCapacity(); }
+
+  virtual bool HasStrictCapacityLimit() const override {
+    return cache_->HasStrictCapacityLimit();
+  }
+
+  virtual size_t GetUsage() const override { return cache_->GetUsage(); }
+
+  virtual size_t GetUsage(Handle* handle) const override {
+    return cache_->GetUsage(handle);
+  }
+
+  virtual size_t GetPinnedUsage() const override {
+    return cache_->GetPinnedUsage();
+  }
+
+  virtual void DisownData() override { cache_->DisownData(); }
+
+  virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
+                                      bool thread_safe) override {
+    cache_->ApplyToAllCacheEntries(callback, thread_safe);
+  }
+
+  virtual void EraseUnRefEntries() override { cache_->EraseUnRefEntries(); }
+
+  virtual size_t GetMaxSimCapacity() const override {
+    return max_sim_capacity_;
+  }
+
+  virtual void GetMissRatioCurve(
+      std::map<size_t, double>* curve) const override {
+    curve->clear();
+    const double expected_lookups = get_lookup_counter() * sampling_rate_;
+    std::lock_guard<std::mutex> l(mutex_);
+    if (sampled_lookups_ == 0) {
+      return;
+    }
+    // A few hot keys make the number of sampled lookups stray from the
+    // expected one. The difference is counted as hits at the smallest
+    // capacity (SHARDS-adj), since it is mostly made of hot keys.
+    double hits = expected_lookups - static_cast<double>(sampled_lookups_);
+    for (int i = 0; i < kCurvePoints; i++) {
+      hits += hits_[i];
+      const size_t capacity = static_cast<size_t>(
+          static_cast<double>(max_sim_capacity_) * (i + 1) / kCurvePoints);
+      const double miss_ratio = 1.0 - hits / expected_lookups;
+      (*curve)[capacity] = std::min(std::max(miss_ratio, 0.0), 1.0);
+    }
+  }
+
+  virtual uint64_t get_lookup_counter() const override {
+    return lookups_.load(std::memory_order_relaxed);
+  }
+
+  virtual uint64_t get_sampled_lookup_counter() const override {
+    std::lock_guard<std::mutex> l(mutex_);
+    return sampled_lookups_;
+  }
+
+  virtual void reset_counter() override {
+    lookups_.store(0, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> l(mutex_);
+    sampled_lookups_ = 0;
+    std::fill(hits_.begin(), hits_.end(), 0);
+  }
+
+  virtual std::string ToString() const override {
+    std::string res;
+    res.append("MissRatioCurveCache LOOKUPs: " +
+               std::to_string(get_lookup_counter()) + " (sampled: " +
+               std::to_string(get_sampled_lookup_counter()) + ")\n");
+    std::map<size_t, double> curve;
+    GetMissRatioCurve(&curve);
+    char buff[100];
+    for (const auto& point : curve) {
+      snprintf(buff, sizeof(buff),
+               "MissRatioCurveCache capacity %" ROCKSDB_PRIszt
+               ": MISSRATE %.2f%%\n",
+               point.first, point.second * 100.0);
+      res.append(buff);
+    }
+    return res;
+  }
+
+  virtual std::string GetPrintableOptions() const override {
+    std::string ret;
+    ret.reserve(20000);
+    ret.append("    cache_options:\n");
+    ret.append(cache_->GetPrintableOptions());
+    char buff[200];
+    snprintf(buff, sizeof(buff),
+             "    miss_ratio_curve_options:\n"
+             "    max_sim_capacity : %" ROCKSDB_PRIszt
+             "\n"
+             "    sampling_rate : %lf\n",
+             max_sim_capacity_, sampling_rate_);
+    ret.append(buff);
+    return ret;
+  }
+
+ private:
+  struct SampledKey {
+    size_t slot;
+    size_t charge;
+  };
+  typedef std::unordered_map<std::string, SampledKey> KeyMap;
+
+  // Slots are only reused once the live keys are packed together
+  static const size_t kMinSlots = 1024;
+  static const uint32_t kSamplingSeed = 0x3b5f2a91;
+
+  bool IsSampled(const Slice& key) const {
+    return Hash(key.data(), key.size(), kSamplingSeed) < sampling_threshold_;
+  }
+
+  void CountLookup(const Slice& key, Handle* h) {
+    lookups_.fetch_add(1, std::memory_order_relaxed);
+    if (IsSampled(key)) {
+      // A key that is already cached when it is first sampled is added
+      // with the charge the cache knows of
+      SampledLookup(key, h == nullptr ? 0 : cache_->GetUsage(h));
+    }
+  }
+
+  void SampledLookup(const Slice& key, size_t charge) {
+    std::lock_guard<std::mutex> l(mutex_);
+    sampled_lookups_++;
+    auto it = keys_.find(key.ToString());
+    if (it != keys_.end()) {
+      const SampledKey& sampled = it->second;
+      const uint64_t distance =
+          sampled_charge_ - PrefixCharge(sampled.slot) + sampled.charge;
+      const double capacity = distance / sampling_rate_;
+      if (capacity <= max_sim_capacity_) {
+        const double point =
+            std::ceil(capacity * kCurvePoints / max_sim_capacity_);
+        hits_[std::max(static_cast<int>(point), 1) - 1]++;
+      }
+      RemoveFromSlot(it);
+      AddToSlot(it);
+    } else if (charge > 0) {
+      it = keys_.emplace(key.ToString(), SampledKey{0, charge}).first;
+      AddToSlot(it);
+      EvictOldest();
+    }
+  }
+
+  void SampledInsert(const Slice& key, size_t charge) {
+    std::lock_guard<std::mutex> l(mutex_);
+    auto it = keys_.find(key.ToString());
+    if (it != keys_.end()) {
+      RemoveFromSlot(it);
+      it->second.charge = charge;
+    } else {
+      it = keys_.emplace(key.ToString(), SampledKey{0, charge}).first;
+    }
+    AddToSlot(it);
+    EvictOldest();
+  }
+
+  // Fenwick tree over the slots
+  void AddCharge(size_t slot, int64_t charge) {
+    for (size_t i = slot + 1; i < tree_.size(); i += i & (~i + 1)) {
+      tree_[i] += charge;
+    }
+  }
+
+  // Sum of the charges of the slots up to and including slot
+  uint64_t PrefixCharge(size_t slot) const {
+    int64_t sum = 0;
+    for (size_t i = slot + 1; i > 0; i -= i & (~i + 1)) {
+      sum += tree_[i];
+    }
+    return static_cast<uint64_t>(sum);
+  }
+
+  void AddToSlot(KeyMap::iterator it) {
+    if (next_slot_ == slots_.size()) {
+      PackSlots();
+    }
+    it->second.slot = next_slot_++;
+    slots_[it->second.slot] = &it->first;
+    AddCharge(it->second.slot, static_cast<int64_t>(it->second.charge));
+    sampled_charge_ += it->second.charge;
+  }
+
+  void RemoveFromSlot(KeyMap::iterator it) {
+    slots_[it->second.slot] = nullptr;
+    AddCharge(it->second.slot, -static_cast<int64_t>(it->second.charge));
+    sampled_charge_ -= it->second.charge;
+  }
+
+  // Moves the live keys to the first slots, keeping their order, and makes
+  // room for as many more
+  void PackSlots() {
+    std::vector<const std::string*> live;
+    live.reserve(keys_.size());
+    for (size_t i = oldest_slot_; i < next_slot_; i++) {
+      if (slots_[i] != nullptr) {
+        live.push_back(slots_[i]);
+      }
+    }
+    const size_t num_slots = std::max(kMinSlots, live.size() * 2);
+    slots_.assign(num_slots, nullptr);
+    tree_.assign(num_slots + 1, 0);
+    oldest_slot_ = 0;
+    next_slot_ = 0;
+    for (const std::string* key : live) {
+      SampledKey& sampled = keys_.find(*key)->second;
+      sampled.slot = next_slot_++;
+      slots_[sampled.slot] = key;
+      AddCharge(sampled.slot, static_cast<int64_t>(sampled.charge));
+    }
+  }
+
+  // Stops tracking the least recently used keys once they are too far down
+  // the stack to hit in any capacity of the curve
+  void EvictOldest() {
+    while (sampled_charge_ > max_sampled_charge_ && !keys_.empty()) {
+      while (slots_[oldest_slot_] == nullptr) {
+        oldest_slot_++;
+      }
+      auto it = keys_.find(*slots_[oldest_slot_]);
+      RemoveFromSlot(it);
+      keys_.erase(it);
+    }
+  }
+
+  std::shared_ptr<Cache> cache_;
+  const size_t max_sim_capacity_;
+  const double sampling_rate_;
+  const uint64_t sampling_threshold_;
+  const uint64_t max_sampled_charge_;
+  std::atomic<uint64_t> lookups_;
+
+  mutable std::mutex mutex_;
+  // The members below are protected by mutex_
+  uint64_t sampled_lookups_;
+  // hits_[i] counts the sampled lookups that hit at capacity
+  // max_sim_capacity_ * (i + 1) / kCurvePoints, but not at the one before
+  std::vector<uint64_t> hits_;
+  KeyMap keys_;
+  std::vector<const std::string*> slots_;
+  std::vector<int64_t> tree_;
+  uint64_t sampled_charge_;
+  size_t next_slot_;
+  size_t oldest_slot_;
+};
+
+const size_t MissRatioCurveCacheImpl::kMinSlots;
+const uint32_t MissRatioCurveCacheImpl::kSamplingSeed;
+
+}  // end anonymous namespace
+
+std::shared_ptr<MissRatioCurveCache> NewMissRatioCurveCache(
+    std::shared_ptr<Cache> cache, size_t max_sim_capacity,
+    double sampling_rate) {
+  if (max_sim_capacity == 0 || !(sampling_rate > 0 && sampling_rate <= 1)) {
+    return nullptr;
+  }
+  return std::make_shared<MissRatioCurveCacheImpl>(cache, max_sim_capacity,
+                                                   sampling_rate);
+}
+
+}  // end namespace rocksdb
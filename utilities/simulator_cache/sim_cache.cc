@@ -66,6 +66,10 @@ class SimCacheImpl : public SimCache {
     return cache_->Lookup(key, stats);
   }
 
+  virtual bool Contains(const Slice& key) override {
+    return cache_->Contains(key);
+  }
+
   virtual bool Ref(Handle* handle) override { return cache_->Ref(handle); }
 
   virtual bool Release(Handle* handle, bool force_erase = false) override {
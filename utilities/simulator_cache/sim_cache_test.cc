@@ -140,6 +140,93 @@ TEST_F(SimCacheTest, SimCache) {
   ASSERT_EQ(6, simCache->get_hit_counter());
 }
 
+TEST_F(SimCacheTest, MissRatioCurve) {
+  ASSERT_EQ(nullptr, NewMissRatioCurveCache(NewLRUCache(100), 0, 0.5));
+  ASSERT_EQ(nullptr, NewMissRatioCurveCache(NewLRUCache(100), 100, 0));
+  ASSERT_EQ(nullptr, NewMissRatioCurveCache(NewLRUCache(100), 100, 1.5));
+
+  // Track all keys
+  std::shared_ptr<MissRatioCurveCache> mrc_cache =
+      NewMissRatioCurveCache(NewLRUCache(1000, 0), 100, 1.0);
+  std::map<size_t, double> curve;
+  mrc_cache->GetMissRatioCurve(&curve);
+  ASSERT_TRUE(curve.empty());
+
+  // Read 50 keys in a loop, so that each lookup after the first pass needs
+  // a cache of 50 to hit
+  const int kNumKeys = 50;
+  const int kNumPasses = 4;
+  for (int pass = 0; pass < kNumPasses; pass++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      std::string key = ToString(i);
+      Cache::Handle* h = mrc_cache->Lookup(key);
+      if (h == nullptr) {
+        ASSERT_OK(mrc_cache->Insert(key, nullptr, 1,
+                                    [](const Slice& k, void* v) {}));
+      } else {
+        mrc_cache->Release(h);
+      }
+    }
+  }
+  ASSERT_EQ(kNumKeys * kNumPasses, mrc_cache->get_lookup_counter());
+  ASSERT_EQ(kNumKeys * kNumPasses, mrc_cache->get_sampled_lookup_counter());
+
+  mrc_cache->GetMissRatioCurve(&curve);
+  ASSERT_EQ(MissRatioCurveCache::kCurvePoints, curve.size());
+  ASSERT_EQ(100, curve.rbegin()->first);
+  for (const auto& point : curve) {
+    if (point.first < kNumKeys) {
+      ASSERT_EQ(1.0, point.second);
+    } else {
+      ASSERT_EQ(1.0 / kNumPasses, point.second);
+    }
+  }
+
+  mrc_cache->reset_counter();
+  ASSERT_EQ(0, mrc_cache->get_lookup_counter());
+  mrc_cache->GetMissRatioCurve(&curve);
+  ASSERT_TRUE(curve.empty());
+  // The keys are still tracked
+  Cache::Handle* h = mrc_cache->Lookup("0");
+  ASSERT_NE(nullptr, h);
+  mrc_cache->Release(h);
+  mrc_cache->GetMissRatioCurve(&curve);
+  ASSERT_EQ(0.0, curve.rbegin()->second);
+}
+
+TEST_F(SimCacheTest, MissRatioCurveProperty) {
+  auto table_options = GetTableOptions();
+  auto options = GetOptions(table_options);
+  Reopen(options);
+  std::string value;
+  ASSERT_FALSE(
+      db_->GetProperty(DB::Properties::kBlockCacheMissRatioCurve, &value));
+
+  std::shared_ptr<MissRatioCurveCache> mrc_cache =
+      NewMissRatioCurveCache(NewLRUCache(1 << 20), 1 << 20, 1.0);
+  table_options.block_cache = mrc_cache;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+  InitTable(options);
+  ASSERT_OK(Flush());
+
+  for (int pass = 0; pass < 2; pass++) {
+    for (size_t i = 0; i < kNumBlocks; i++) {
+      ASSERT_EQ(std::string(kValueSize, 'a'), Get(ToString(i)));
+    }
+  }
+  ASSERT_TRUE(
+      db_->GetProperty(DB::Properties::kBlockCacheMissRatioCurve, &value));
+  ASSERT_EQ(mrc_cache->ToString(), value);
+
+  std::map<std::string, double> curve;
+  ASSERT_TRUE(
+      db_->GetMapProperty(DB::Properties::kBlockCacheMissRatioCurve, &curve));
+  ASSERT_EQ(MissRatioCurveCache::kCurvePoints, curve.size());
+  // All blocks fit in the largest capacity, so only the first reads miss
+  ASSERT_EQ(0.5, curve[ToString(1 << 20)]);
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {